@@ -108,6 +108,44 @@ namespace shh {
 	}
 
 
+	// --------------------------------------------------------------------------						
+	// Function:	DumpMemoryProfile
+	// Description:	Writes memory profile as json.
+	// Arguments:	file name
+	// Returns:		if successful
+	// --------------------------------------------------------------------------
+	bool Api::DumpMemoryProfile(const std::string& filename)
+	{
+		return DUMP_MEMORY_PROFILE(filename);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	SaveCheckpoint
+	// Description:	Saves a checkpoint of God and all Worlds, call between
+	//				updates.
+	// Arguments:	file name, if incremental
+	// Returns:		if successful
+	// --------------------------------------------------------------------------
+	bool Api::SaveCheckpoint(const std::string& filename, bool incremental)
+	{
+		return God::GetGod()->SaveCheckpoint(filename, incremental);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	RestoreCheckpoint
+	// Description:	Restores a checkpoint of God and all Worlds, call between
+	//				updates once Worlds have booted.
+	// Arguments:	file name
+	// Returns:		if successful
+	// --------------------------------------------------------------------------
+	bool Api::RestoreCheckpoint(const std::string& filename)
+	{
+		return God::GetGod()->RestoreCheckpoint(filename);
+	}
+
+
 	// --------------------------------------------------------------------------						
 	// Function:	CreateGod
 	// Description:	Creates God object.
@@ -123,6 +161,10 @@ namespace shh {
 		sd.Set("boot_script", God::ourBootFileName.c_str());
 		sd.Set("update_script", God::ourUpdateFileName.c_str());
 		god->Initialize(god, name, sd);
+
+		// restored at the end of the first update once boot has created worlds
+		if (!God::ourRestoreFileName.empty())
+			god->RequestRestore(God::ourRestoreFileName, GCPtr<Process>(), "");
 	}
 
 
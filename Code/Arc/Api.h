@@ -57,6 +57,9 @@ namespace shh {
 		static bool CreateWorld(const ::std::string& name, const StringKeyDictionary& config, const std::string& templateRealm);
 		static void DestroyWorld(const std::string& name);
 		static void DestroyWorlds();
+		static bool DumpMemoryProfile(const std::string& filename);
+		static bool SaveCheckpoint(const std::string& filename, bool incremental);
+		static bool RestoreCheckpoint(const std::string& filename);
 		static void CreateGod(const std::string& name, const std::string& realmTemplate);
 		static void DestroyGod();
 		static inline const GCPtr<God>& GetGod();
@@ -81,6 +84,7 @@ namespace shh {
 		template< typename C, typename F >
 		static inline void RegisterMemberFunction(const C* ownerExampe, const ::std::string& functionName, F *f, unsigned int firstReturnArg, const GCPtr<Module>& module);
 		static inline void RegisterHardClass(const GCPtr<Class>& cls);
+		static inline bool RegisterNodeKernel(const std::string& className, NodeKernel::Function kernel);
 
 		static inline unsigned int CreateCollection(const GCPtr<Whole>& w, std::string& collectionName);
 		static inline void DestroyCollection(const GCPtr<Whole>& w, std::string& collectionName);
@@ -514,6 +518,20 @@ namespace shh {
 		Registry::GetRegistry().RegisterHardClass(cls);
 	}
 
+
+	// --------------------------------------------------------------------------						
+	// Function:	RegisterNodeKernel
+	// Description:	Registers a c++ function that updates all nodes of a class 
+	//				in one call directly on their interface buffers, bypassing
+	//				the nodes process and messaging.
+	// Arguments:	name of node class, kernel function
+	// Returns:		if registered
+	// --------------------------------------------------------------------------
+	inline bool Api::RegisterNodeKernel(const std::string& className, NodeKernel::Function kernel)
+	{
+		return NodeKernel::Register(className, kernel);
+	}
+
 	// --------------------------------------------------------------------------						
 	// Function:	LuaRegisterFunction
 	// Description:	Registers a Lua format function to be used in script.
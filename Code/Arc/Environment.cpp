@@ -336,4 +336,57 @@ namespace shh
 
 	}
 
+
+	// --------------------------------------------------------------------------						
+	// Function:	Write
+	// Description:	serialization out of locals and scheduler
+	// Arguments:	io stream interface, version to log as
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void Environment::Write(IOInterface& io, int version) const
+	{
+#if MULTI_THREADED
+		myMutex.LockMutex();
+#endif
+		StringKeyDictionary locals(myLocalConfig);
+#if MULTI_THREADED
+		myMutex.UnlockMutex();
+#endif
+		IODictionary<std::string> ioLocals(locals);
+		SERIALIZE_OUT(io, ioLocals);
+
+		bool hasScheduler = myScheduler.IsValid();
+		SERIALIZE_OUT(io, hasScheduler);
+		if (hasScheduler)
+			myScheduler->Write(io, version);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Read
+	// Description:	serialization in of locals and scheduler
+	// Arguments:	io stream interface, version to log as
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void Environment::Read(IOInterface& io, int version)
+	{
+		StringKeyDictionary locals;
+		IODictionary<std::string> ioLocals(locals);
+		SERIALIZE_IN(io, ioLocals);
+#if MULTI_THREADED
+		myMutex.LockMutex();
+#endif
+		myLocalConfig = locals;
+#if MULTI_THREADED
+		myMutex.UnlockMutex();
+#endif
+
+		bool hasScheduler;
+		SERIALIZE_IN(io, hasScheduler);
+		if (hasScheduler != myScheduler.IsValid())
+			Exception::Throw("Checkpoint scheduler of environment %s does not match", myId.c_str());
+		if (hasScheduler)
+			myScheduler->Read(io, version, GCPtr<Environment>(this));
+	}
+
 }
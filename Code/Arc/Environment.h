@@ -36,6 +36,7 @@
 namespace shh {
 
 	class VM;
+	class IOInterface;
 
 	class ClassManager;
 	class Scheduler;
@@ -88,6 +89,9 @@ namespace shh {
 
 		void FinalizeObjects();
 
+		void Write(IOInterface& io, int version) const;
+		void Read(IOInterface& io, int version);
+
 	protected:
 
 		typedef std::map<GCPtr<Environment>, StringKeyDictionary> Locals;
@@ -25,26 +25,36 @@
 
 #include "God.h"
 #include "../Common/Exception.h"
+#include "../Common/PreciseTime.h"
 #include "Registry.h"
 #include "../VM/VM.h"
 #include "../VM/Scheduler.h"
+#include "../VM/Message.h"
 #include "../VM/ClassManager.h"
 #include "../File/FileSystem.h"
 #include "../File/ConfigurationFile.h"
 #include "../File/JsonFile.h"
+#include "../File/BinaryFile.h"
+#include "../File/IOVariant.h"
 #include "../LuaProcess/LuaProcess.h"
 #include "../LuaProcess/LuaLibrary.h"
 #include "../Schema/Node.h"
 #include "../Schema/Agent.h"
 #include "../Config/MemoryDefines.h"
+#include <set>
+#include <cstdio>
 
 #ifdef _WIN64
 #include <windows.h>
+#else
+#include <unistd.h>
+#include <sys/wait.h>
+#include <cerrno>
 #endif
 
 namespace shh {
 
-	//IMPLEMENT_ARCHIVE(God, "God")
+	IMPLEMENT_ARCHIVE(God, "God")
 
 
 
@@ -52,6 +62,7 @@ namespace shh {
 	std::string God::ourBootFileName;
 	std::string God::ourConfigFileName;
 	std::string God::ourUpdateFileName;
+	std::string God::ourRestoreFileName;
 	std::string God::ourGodRealm;
 	StringKeyDictionary God::ourConfigFileDict;
 	GCPtr<God> God::ourGod;
@@ -100,7 +111,12 @@ namespace shh {
 	// Returns:		none
 	// --------------------------------------------------------------------------
 	God::God() :
-		Realm("", GodPrivilege, "__GOD")
+		Realm("", GodPrivilege, "__GOD"),
+		myPaceMaker(0),
+		myCheckpointIncrement(0),
+		myCheckpointFailed(false),
+		myCheckpointRequested(false),
+		myCheckpointPid(0)
 	{
 	}
 
@@ -113,6 +129,14 @@ namespace shh {
 	// --------------------------------------------------------------------------
 	God::~God()
 	{
+#ifndef _WIN64
+		// let a background checkpoint finish writing
+		if (myCheckpointPid != 0)
+		{
+			int status;
+			waitpid((pid_t)myCheckpointPid, &status, 0);
+		}
+#endif
 	}
 
 
@@ -189,6 +213,15 @@ namespace shh {
 			ourUpdateFileName = "update.lua";
 		}
 
+		// get checkpoint to restore once booted
+		switchPos = (int)ourCommandLineArgs.find("-restore");
+		if (switchPos < ourCommandLineArgs.size())
+		{
+			int startPos = (int)ourCommandLineArgs.find_first_of(" ", switchPos) + 1;
+			int endPos = (int)ourCommandLineArgs.find_first_of(" ", startPos);
+			ourRestoreFileName = ourCommandLineArgs.substr(startPos, endPos - startPos);
+		}
+
 
 		// get and set root directory
 		std::string root;
@@ -231,14 +264,14 @@ namespace shh {
 
 		ArrayKeyDictionary paths;		
 		paths = pathsFile.Get("paths", paths);
-		ArrayKeyDictionary::OrderedVariables::const_iterator pit = paths.OrderedBegin();
-		ArrayKeyDictionary::OrderedVariables::const_iterator pend = paths.OrderedEnd();
+		ArrayKeyDictionary::OrderedVariablesConstIterator pit = paths.OrderedBegin();
+		ArrayKeyDictionary::OrderedVariablesConstIterator pend = paths.OrderedEnd();
 		while (pit != pend)
 		{
 			StringKeyDictionary path;
 			path = paths.GetFromIt(pit, path);
-			StringKeyDictionary::OrderedVariables::const_iterator it = path.OrderedBegin();
-			StringKeyDictionary::OrderedVariables::const_iterator end = path.OrderedEnd();
+			StringKeyDictionary::OrderedVariablesConstIterator it = path.OrderedBegin();
+			StringKeyDictionary::OrderedVariablesConstIterator end = path.OrderedEnd();
 			while (it != end)
 			{
 				std::string str;
@@ -289,6 +322,9 @@ namespace shh {
 		StringKeyDictionary memory;
 		memory = ourConfigFileDict.Get("memory", memory);
 		CONFIGURE_MEMORYMANAGEMENT(memory);
+#if GC_CYCLE_COLLECTION
+		CycleCollector::ourBudget = (unsigned int)memory.Get("cycle_budget", (long)CycleCollector::ourBudget);
+#endif
 		
 
 		StringKeyDictionary priorities;
@@ -380,8 +416,8 @@ namespace shh {
 		RELEASE_ASSERT(realms.Size() > 0);
 
 		Realm::DictMap unorderedRealms;
-		StringKeyDictionary::OrderedVariables::const_iterator it = realms.OrderedBegin();
-		StringKeyDictionary::OrderedVariables::const_iterator end = realms.OrderedEnd();
+		StringKeyDictionary::OrderedVariablesConstIterator it = realms.OrderedBegin();
+		StringKeyDictionary::OrderedVariablesConstIterator end = realms.OrderedEnd();
 		while (it != end)
 		{
 			std::string name = *it->first;
@@ -532,6 +568,7 @@ namespace shh {
 	// --------------------------------------------------------------------------
 	bool God::Update(double timeSinceLastUpdate)
 	{
+		double updateStart = GetPreciseTime();
 		double now = myLastUpdateTime + timeSinceLastUpdate;
 		if (myStartTime == -1)
 		{
@@ -597,7 +634,23 @@ namespace shh {
 		}
 		myWorldsToDestroy.clear();
 		Unlock();
+
+		// checkpoint at tick boundary when no scheduler is mid update
+		PollCheckpoint();
+		if (myCheckpointRequested && !IsCheckpointing())
+			TakeCheckpoint();
 		
+#if GC_CYCLE_COLLECTION
+		// reclaim a slice of unreachable reference cycles left by this update
+		CycleCollector::Collect(CycleCollector::ourBudget);
+#endif
+
+		// compact a slice of managed memory in wall clock time left of this 
+		// update, done here so no scheduler has managed objects on the stack
+		double updateBudget = GetMeta("update_budget", 0.016); // Wall clock seconds an update may take, any left over is spent compacting memory.
+		double idleTime = updateBudget - (GetPreciseTime() - updateStart);
+		if (idleTime > 0.0)
+			UPDATE_MEMORYMANAGER(idleTime);
 
 		SetAsActiveRealm();
 		myLastUpdateTime = now;
@@ -665,7 +718,7 @@ namespace shh {
 		// need to queue for deletion after 
 		Lock();
 		RealmMap::iterator it = myWorlds.find(name);
-		if (it != myWorlds.end())
+		if (it == myWorlds.end())
 		{
 			Unlock();
 			return false;
@@ -696,11 +749,462 @@ namespace shh {
 	// --------------------------------------------------------------------------
 	void God::DestroyWorlds()
 	{
-		while (!myWorlds.empty())
+		Lock();
+		RealmMap worlds;
+		worlds.swap(myWorlds);
+		myWorldsToDestroy.clear();
+		Unlock();
+
+		for (RealmMap::iterator it = worlds.begin(); it != worlds.end(); it++)
+			it->second.Destroy();
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	SaveCheckpoint
+	// Description:	saves a snapshot of god and all worlds, an incremental 
+	//				checkpoint only holds the processes of vms run since the last 
+	//				checkpoint and is saved to the file name post fixed with its 
+	//				increment number, must be called between updates
+	// Arguments:	file name, if incremental
+	// Returns:		if successful
+	// --------------------------------------------------------------------------
+	bool God::SaveCheckpoint(const std::string& file, bool incremental)
+	{
+		if (IsCheckpointing())
+			return false;
+
+		CheckpointRequest request;
+		request.myFile = file;
+		request.myIncremental = incremental;
+		return WriteCheckpoint(request);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	RestoreCheckpoint
+	// Description:	restores a snapshot and then any increments saved after
+	//				it, the worlds must have been booted from the same config
+	//				as they were when saved, must be called between updates,
+	//				later incremental checkpoints to the file carry on from it.
+	//				The current state is staged in memory first and read back
+	//				if any file fails so a failed restore changes nothing
+	// Arguments:	file name
+	// Returns:		if successful
+	// --------------------------------------------------------------------------
+	bool God::RestoreCheckpoint(const std::string& file)
+	{
+		if (IsCheckpointing() || !FileSystem::IsValidFile(file))
+			return false;
+
+		bool ok = true;
+		bool staged = false;
+		unsigned int increment = 0;
+		BinaryBuffer staging;
+		try
+		{
+			{
+				Archive archive(staging, false, ourVersion);
+				God::WriteArchive(archive, this);
+			}
+			staged = true;
+
+			std::string path = file;
+			while (FileSystem::IsValidFile(path))
+			{
+				IBinaryFile in(path, IOInterface::In);
+				Archive archive(in, false, ourVersion);
+				God::ReadArchive(archive, this);
+				path = GetCheckpointPath(file, ++increment);
+			}
+		}
+		catch (std::exception& e)
+		{
+			std::string errorMessage = "Exception caught restoring checkpoint: ";
+			errorMessage += e.what();
+			errorMessage += ".\n";
+			ERROR_TRACE(errorMessage.c_str());
+			ok = false;
+		}
+		catch (...)
 		{
-			RealmMap::iterator it = myWorlds.begin();
-			DestroyWorld(it->second->GetId());
+			ERROR_TRACE("Unknown Error: Restoring checkpoint.\n");
+			ok = false;
 		}
+
+		// put back the state as it was before the restore started
+		if (!ok && staged)
+		{
+			try
+			{
+				BinaryBuffer in(staging.GetBytes());
+				Archive archive(in, false, ourVersion);
+				God::ReadArchive(archive, this);
+			}
+			catch (std::exception& e)
+			{
+				std::string errorMessage = "Exception caught undoing failed checkpoint restore: ";
+				errorMessage += e.what();
+				errorMessage += ".\n";
+				ERROR_TRACE(errorMessage.c_str());
+			}
+			catch (...)
+			{
+				ERROR_TRACE("Unknown Error: Undoing failed checkpoint restore.\n");
+			}
+		}
+
+		// state now matches the file so only changes from here are dirty
+		myCheckpointIncrement = increment > 0 ? increment - 1 : 0;
+		myCheckpointFailed = !ok;
+		myCheckpointBase = ok ? file : std::string();
+		if (ok)
+			ClearDirty();
+
+		return ok;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	RequestCheckpoint
+	// Description:	requests a checkpoint be taken at the end of this update 
+	//				when no scheduler is mid update, a background checkpoint 
+	//				is written by a forked copy of the process so updates 
+	//				carry on, when saved the callback is sent to the 
+	//				requester with if successful and the file name
+	// Arguments:	file name, if incremental, if background, process
+	//				requesting, callback function name
+	// Returns:		if requested
+	// --------------------------------------------------------------------------
+	bool God::RequestCheckpoint(const std::string& file, bool incremental, bool background, const GCPtr<Process>& requester, const std::string& callback)
+	{
+		if (myCheckpointRequested)
+			return false;
+
+		myCheckpointRequest = CheckpointRequest();
+		myCheckpointRequest.myFile = file;
+		myCheckpointRequest.myIncremental = incremental;
+		myCheckpointRequest.myBackground = background;
+		myCheckpointRequest.myRequester = requester;
+		myCheckpointRequest.myCallback = callback;
+		myCheckpointRequested = true;
+		return true;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	RequestRestore
+	// Description:	requests a checkpoint be restored at the end of this 
+	//				update when no scheduler is mid update and no background
+	//				checkpoint is being written, when done the callback is 
+	//				sent to the requester with if successful and the file name
+	// Arguments:	file name, process requesting, callback function name
+	// Returns:		if requested
+	// --------------------------------------------------------------------------
+	bool God::RequestRestore(const std::string& file, const GCPtr<Process>& requester, const std::string& callback)
+	{
+		if (myCheckpointRequested)
+			return false;
+
+		myCheckpointRequest = CheckpointRequest();
+		myCheckpointRequest.myFile = file;
+		myCheckpointRequest.myRestore = true;
+		myCheckpointRequest.myRequester = requester;
+		myCheckpointRequest.myCallback = callback;
+		myCheckpointRequested = true;
+		return true;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	IsCheckpointing
+	// Description:	returns if a background checkpoint is being written
+	// Arguments:	none
+	// Returns:		bool
+	// --------------------------------------------------------------------------
+	bool God::IsCheckpointing() const
+	{
+		return myCheckpointPid != 0;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	GetCheckpointPath
+	// Description:	gets file a checkpoint increment is kept in, increment 0
+	//				being the full snapshot
+	// Arguments:	file name, increment
+	// Returns:		path
+	// --------------------------------------------------------------------------
+	std::string God::GetCheckpointPath(const std::string& file, unsigned int increment) const
+	{
+		if (increment == 0)
+			return file;
+
+		return file + "." + std::to_string(increment);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	CanIncrement
+	// Description:	returns if a checkpoint to file may be incremental, it 
+	//				may only if this session wrote or restored the snapshot it
+	//				builds on and dirty flags have been kept since
+	// Arguments:	file name
+	// Returns:		bool
+	// --------------------------------------------------------------------------
+	bool God::CanIncrement(const std::string& file) const
+	{
+		return !myCheckpointFailed && myCheckpointBase == file && FileSystem::IsValidFile(file);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	DeleteIncrements
+	// Description:	deletes increments of a checkpoint from one given on
+	// Arguments:	file name, first increment to delete
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void God::DeleteIncrements(const std::string& file, unsigned int from)
+	{
+		for (unsigned int i = from; FileSystem::IsValidFile(GetCheckpointPath(file, i)); i++)
+			FileSystem::Delete(GetCheckpointPath(file, i));
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	ClearDirty
+	// Description:	flags the vms of god and all worlds as saved
+	// Arguments:	none
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void God::ClearDirty()
+	{
+		if (GetScheduler().IsValid())
+			GetScheduler()->ClearDirty();
+
+		for (RealmMap::iterator it = myWorlds.begin(); it != myWorlds.end(); it++)
+			if (it->second->GetScheduler().IsValid())
+				it->second->GetScheduler()->ClearDirty();
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	ArchiveCheckpoint
+	// Description:	writes god and worlds to a checkpoint file under a 
+	//				temporary name then renames it into place so a failed 
+	//				write never replaces a good checkpoint
+	// Arguments:	file name, if incremental
+	// Returns:		if successful
+	// --------------------------------------------------------------------------
+	bool God::ArchiveCheckpoint(const std::string& file, bool incremental)
+	{
+		unsigned int increment = incremental ? myCheckpointIncrement + 1 : 0;
+		std::string path = GetCheckpointPath(file, increment);
+		std::string temporary = path + ".tmp";
+
+		bool ok = true;
+		Scheduler::ourIncrementalWrite = incremental;
+		try
+		{
+			OBinaryFile out(temporary, IOInterface::Out);
+			Archive archive(out, false, ourVersion);
+			God::WriteArchive(archive, this);
+		}
+		catch (std::exception& e)
+		{
+			std::string errorMessage = "Exception caught saving checkpoint: ";
+			errorMessage += e.what();
+			errorMessage += ".\n";
+			ERROR_TRACE(errorMessage.c_str());
+			ok = false;
+		}
+		catch (...)
+		{
+			ERROR_TRACE("Unknown Error: Saving checkpoint.\n");
+			ok = false;
+		}
+		Scheduler::ourIncrementalWrite = false;
+
+		// increments after this one belong to an older snapshot so go 
+		// before it is in place, else a restore would apply them on top
+		if (ok)
+		{
+			DeleteIncrements(file, increment + 1);
+			ok = FileSystem::Replace(temporary, path);
+		}
+		if (!ok)
+			FileSystem::Delete(temporary);
+
+		return ok;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	WriteCheckpoint
+	// Description:	writes a checkpoint blocking till done
+	// Arguments:	request
+	// Returns:		if successful
+	// --------------------------------------------------------------------------
+	bool God::WriteCheckpoint(CheckpointRequest& request)
+	{
+		request.myIncremental = request.myIncremental && CanIncrement(request.myFile);
+
+		Lock();
+		bool ok = ArchiveCheckpoint(request.myFile, request.myIncremental);
+		if (ok)
+			ClearDirty();
+		Unlock();
+
+		FinishCheckpoint(request, ok);
+		return ok;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	ForkCheckpoint
+	// Description:	forks so the child writes the checkpoint from its copy on
+	//				write snapshot of memory while this process carries on
+	//				updating, child is reaped by PollCheckpoint
+	// Arguments:	request
+	// Returns:		if forked
+	// --------------------------------------------------------------------------
+	bool God::ForkCheckpoint(CheckpointRequest& request)
+	{
+#ifdef _WIN64
+		return false;
+#else
+		request.myIncremental = request.myIncremental && CanIncrement(request.myFile);
+
+		pid_t pid = fork();
+		if (pid < 0)
+		{
+			ERROR_TRACE("Could not fork to save checkpoint %s.\n", request.myFile.c_str());
+			return false;
+		}
+
+		if (pid == 0)
+		{
+			// leave without running any of the parents exit handlers or 
+			// destructors
+			bool ok = ArchiveCheckpoint(request.myFile, request.myIncremental);
+			_exit(ok ? 0 : 1);
+		}
+
+		myCheckpointPid = pid;
+		myCheckpointRunning = request;
+		ClearDirty();
+		return true;
+#endif
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	FinishCheckpoint
+	// Description:	records the snapshot increments build on after a 
+	//				checkpoint and sends the callback
+	// Arguments:	request, if successful
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void God::FinishCheckpoint(const CheckpointRequest& request, bool ok)
+	{
+		// dirty flags were already cleared so next one must be full
+		myCheckpointFailed = !ok;
+
+		if (ok && request.myIncremental)
+		{
+			myCheckpointIncrement++;
+		}
+		else if (ok)
+		{
+			myCheckpointBase = request.myFile;
+			myCheckpointIncrement = 0;
+		}
+
+		SendCheckpointCallback(request, ok);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	SendCheckpointCallback
+	// Description:	sends the callback of a checkpoint or restore to its 
+	//				requester with if successful and the file name
+	// Arguments:	request, if successful
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void God::SendCheckpointCallback(const CheckpointRequest& request, bool ok)
+	{
+		GCPtr<Process> requester = request.myRequester.Lock();
+		if (requester.IsValid() && !request.myCallback.empty())
+		{
+			Message* msg = new Message;
+			msg->myFunctionName = request.myCallback;
+			msg->myTo = requester;
+			msg->SetCallType(Message::Decoupled);
+			msg->myPriority = Priority::GetSystem();
+			msg->AddArgument(new bool(ok));
+			msg->AddArgument(new std::string(request.myFile));
+			if (!msg->SendMsg(0.0, 0))
+			{
+				msg->DeleteArguments();
+				delete msg;
+			}
+		}
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	TakeCheckpoint
+	// Description:	takes requested checkpoint, in the background if asked 
+	//				and able, or restores requested checkpoint
+	// Arguments:	none
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void God::TakeCheckpoint()
+	{
+		CheckpointRequest request = myCheckpointRequest;
+		myCheckpointRequest = CheckpointRequest();
+		myCheckpointRequested = false;
+
+		if (request.myRestore)
+		{
+			bool ok = RestoreCheckpoint(request.myFile);
+			SendCheckpointCallback(request, ok);
+			return;
+		}
+
+		if (request.myBackground && ForkCheckpoint(request))
+			return;
+
+		WriteCheckpoint(request);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	PollCheckpoint
+	// Description:	reaps a background checkpoint if it has finished
+	// Arguments:	none
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void God::PollCheckpoint()
+	{
+#ifndef _WIN64
+		if (myCheckpointPid == 0)
+			return;
+
+		int status = 0;
+		pid_t pid = waitpid((pid_t)myCheckpointPid, &status, WNOHANG);
+		if (pid == 0 || (pid < 0 && errno == EINTR))
+			return;
+
+		bool ok = pid == (pid_t)myCheckpointPid && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+		if (!ok)
+			ERROR_TRACE("Background checkpoint %s failed.\n", myCheckpointRunning.myFile.c_str());
+
+		CheckpointRequest request = myCheckpointRunning;
+		myCheckpointRunning = CheckpointRequest();
+		myCheckpointPid = 0;
+		FinishCheckpoint(request, ok);
+#endif
 	}
 
 
@@ -712,13 +1216,28 @@ namespace shh {
 	// --------------------------------------------------------------------------
 	void God::Write(IOInterface& io, int version) const
 	{
-		//INITIALIZE_SERIAL_OUT(io);
-
-		//SERIALIZE_OUT(io, ourMetaConfig);
-		//Realm::WriteStatic(io, version);
-
-		//FINALIZE_SERIAL(io);
+		INITIALIZE_SERIAL_OUT(io);
+
+		IODictionary<std::string> ioMetaConfig(ourMetaConfig);
+		SERIALIZE_OUT(io, ioMetaConfig);
+		Realm::Write(io, version);
+		SERIALIZE_OUT(io, myPaceMaker);
+
+		// every world is written as its time moves on each update, in an
+		// incremental checkpoint its schedulers only write dirty vms
+		unsigned int worlds = (unsigned int)myWorlds.size();
+		SERIALIZE_OUT(io, worlds);
+		for (RealmMap::const_iterator it = myWorlds.begin(); it != myWorlds.end(); it++)
+		{
+			const Realm* world = it->second.GetObject();
+			SERIALIZE_OUT(io, it->first);
+			SERIALIZE_OUT(io, world->myTemplateName);
+			IODictionary<std::string> ioConfig(const_cast<StringKeyDictionary&>(world->myConfig));
+			SERIALIZE_OUT(io, ioConfig);
+			world->Write(io, version);
+		}
 
+		FINALIZE_SERIAL(io);
 	}
 
 
@@ -730,12 +1249,57 @@ namespace shh {
 	// --------------------------------------------------------------------------
 	void God::Read(IOInterface& io, int version)
 	{
-		//INITIALIZE_SERIAL_IN(io);
+		INITIALIZE_SERIAL_IN(io);
+
+		StringKeyDictionary metaConfig;
+		IODictionary<std::string> ioMetaConfig(metaConfig);
+		SERIALIZE_IN(io, ioMetaConfig);
+		SetMetaVariables(metaConfig);
+		Realm::Read(io, version);
+		SERIALIZE_IN(io, myPaceMaker);
+
+		std::set<std::string> names;
+		unsigned int worlds;
+		SERIALIZE_IN(io, worlds);
+		for (unsigned int w = 0; w != worlds; w++)
+		{
+			std::string name;
+			SERIALIZE_IN(io, name);
+			names.insert(name);
+
+			std::string templateName;
+			StringKeyDictionary config;
+			IODictionary<std::string> ioConfig(config);
+			SERIALIZE_IN(io, templateName);
+			SERIALIZE_IN(io, ioConfig);
+
+			if (!GetWorld(name).IsValid())
+			{
+				RealmMap::iterator rit = ourRealmMap.find(templateName);
+				CreateWorld(name, config, rit != ourRealmMap.end() ? rit->second : GCPtr<Realm>());
+			}
+			GetWorld(name)->Read(io, version);
+		}
 
-		//SERIALIZE_IN(io, ourMetaConfig);
-		//Realm::ReadStatic(io, version);
+		// worlds created since the checkpoint
+		Lock();
+		RealmMap::iterator it = myWorlds.begin();
+		while (it != myWorlds.end())
+		{
+			if (names.find(it->first) == names.end())
+			{
+				GCPtr<Realm> world = it->second;
+				myWorlds.erase(it++);
+				world.Destroy();
+			}
+			else
+			{
+				it++;
+			}
+		}
+		Unlock();
 
-		//FINALIZE_SERIAL(io);
+		FINALIZE_SERIAL(io);
 	}
 
 }
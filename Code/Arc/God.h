@@ -37,9 +37,11 @@
 
 namespace shh {
 
+	class Process;
+
 	class God : public Realm
 	{
-		//DECLARE_ARCHIVE(God)
+		DECLARE_ARCHIVE(God)
 
 	public:
 
@@ -47,6 +49,7 @@ namespace shh {
 		static std::string ourConfigFileName;
 		static std::string ourBootFileName;
 		static std::string ourUpdateFileName;
+		static std::string ourRestoreFileName;
 		static std::string ourGodRealm;
 		static StringKeyDictionary ourConfigFileDict;
 		static unsigned int ourVersion;
@@ -64,6 +67,12 @@ namespace shh {
 		const RealmMap& GetWorlds() const;
 		void DestroyWorlds();
 
+		bool SaveCheckpoint(const std::string& file, bool incremental);
+		bool RestoreCheckpoint(const std::string& file);
+		bool RequestCheckpoint(const std::string& file, bool incremental, bool background, const GCPtr<Process>& requester, const std::string& callback);
+		bool RequestRestore(const std::string& file, const GCPtr<Process>& requester, const std::string& callback);
+		bool IsCheckpointing() const;
+
 		void Write(IOInterface& io, int version) const;
 		void Read(IOInterface& io, int version);
 
@@ -81,14 +90,45 @@ namespace shh {
 
 	private:
 
+		class CheckpointRequest
+		{
+		public:
+			CheckpointRequest() : myIncremental(false), myBackground(false), myRestore(false) {}
+			std::string myFile;
+			bool myIncremental;
+			bool myBackground;
+			bool myRestore;
+			WeakGCPtr<Process> myRequester;
+			std::string myCallback;
+		};
+
 		static GCPtr<God> ourGod;
 		double myPaceMaker;
 		std::vector<std::string> myWorldsToDestroy;
+		std::string myCheckpointBase;
+		unsigned int myCheckpointIncrement;
+		bool myCheckpointFailed;
+		bool myCheckpointRequested;
+		CheckpointRequest myCheckpointRequest;
+		CheckpointRequest myCheckpointRunning;
+		long myCheckpointPid;
 
 		God(const God&);
 		God& operator=(const God&);
 		static void Boot();
 		static bool BuildHierachry(Realm::DictMap& unorderedRealms);
+
+		std::string GetCheckpointPath(const std::string& file, unsigned int increment) const;
+		bool CanIncrement(const std::string& file) const;
+		void DeleteIncrements(const std::string& file, unsigned int from);
+		void ClearDirty();
+		bool ArchiveCheckpoint(const std::string& file, bool incremental);
+		bool WriteCheckpoint(CheckpointRequest& request);
+		bool ForkCheckpoint(CheckpointRequest& request);
+		void FinishCheckpoint(const CheckpointRequest& request, bool ok);
+		void SendCheckpointCallback(const CheckpointRequest& request, bool ok);
+		void TakeCheckpoint();
+		void PollCheckpoint();
 	};
 
 
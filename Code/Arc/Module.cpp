@@ -440,5 +440,18 @@ namespace shh {
 		unsigned int flag = (unsigned int)1 << flagNo;
 		return (myFlags & flag) != 0;
 	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	TraceReferences
+	// Description:	reports vm to the cycle collector, owner is weak
+	// Arguments:	tracer
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void Module::TraceReferences(GCTracer& tracer) const
+	{
+		tracer.Trace(myVM);
+	}
+
 }//namespace shh
 
@@ -84,6 +84,7 @@ namespace shh {
 		virtual bool Register(const std::string& alias, const StringKeyDictionary& sd, Privileges privileges);
 		virtual bool Initialize(const GCPtr<GCObject>& owner, const std::string& id, const StringKeyDictionary& sd);
 		virtual bool Finalize(GCObject* me);
+		virtual void TraceReferences(GCTracer& tracer) const;
 
 		virtual bool Update(double until, unsigned int phase);
 		virtual void FlagUpdateCompleted();
@@ -98,7 +99,7 @@ namespace shh {
 
 		inline bool RequiresUpdate() const;
 		inline bool SetOwner(const GCPtr<GCObject>& owner);
-		inline const GCPtr<GCObject>& GetOwner() const;
+		inline GCPtr<GCObject> GetOwner() const;
 		inline const GCPtr<GCObject>& GetVM() const;
 		inline int GetPriority() const;
 		inline int GetSubPriority()const;
@@ -121,7 +122,7 @@ namespace shh {
 	protected:
 
 		unsigned int myFlags;
-		GCPtr<GCObject> myOwner;
+		WeakGCPtr<GCObject> myOwner;
 		std::string myId;
 		GCPtr<GCObject> myVM;
 		int myPriority;
@@ -157,9 +158,9 @@ namespace shh {
 		return false;
 	}
 
-	inline const GCPtr<GCObject>& Module::GetOwner() const
+	inline GCPtr<GCObject> Module::GetOwner() const
 	{ 
-		return myOwner; 
+		return myOwner.Lock(); 
 	}
 
 	inline const GCPtr<GCObject>& Module::GetVM() const
@@ -44,6 +44,7 @@
 #include "../Modules/WholeModule.h"
 #include "../Modules/NodeAuxilaryModule.h"
 #include "../File/IOVariant.h"
+#include "../Config/MemoryDefines.h"
 #include <algorithm>
 
 //! /library shh
@@ -63,7 +64,7 @@ namespace shh
 	REGISTER_OBJECT_MODULE(Node, ClassManager)
 	REGISTER_MODULE(NodeAuxilaryModule)
 	
-	//IMPLEMENT_ARCHIVE(Realm, "Realm")
+	IMPLEMENT_ARCHIVE(Realm, "Realm")
 	Realm::RealmMap Realm::ourRealmMap;
 	GCPtr<Realm> Realm::ourActiveRealm;
 	GCPtr<LuaProcess> Realm::ourLuaTypeBase;
@@ -116,6 +117,18 @@ namespace shh
 	}
 
 
+	// --------------------------------------------------------------------------						
+	// Function:	Realm
+	// Description:	constructor
+	// Arguments:	none
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	Realm::Realm() :
+		Realm("", Privileges(), "")
+	{
+	}
+
+
 	// --------------------------------------------------------------------------						
 	// Function:	Realm
 	// Description:	constructor
@@ -130,7 +143,11 @@ namespace shh
 			myName = name;
 		myPaused = true;
 		myPrivileges = privileges;
+		myTime = 0;
 		myStartTime = -1;
+		myLastUpdateTime = 0;
+		myObjectStartTime = 0;
+		myArena = NULL;
 	}
 
 
@@ -142,6 +159,22 @@ namespace shh
 	// --------------------------------------------------------------------------
 	void Realm::Configure(const StringKeyDictionary & config, const GCPtr<Realm>&other) 
 	{
+#if USE_SHHARC_MEMORY_MANAGEMENT
+		// objects of realm are allocated in its own arena so its memory is 
+		// kept apart and its chunks are released together when it goes
+		if (myArena == NULL && config.Get("arena", false))
+			myArena = new Arena(myName);
+#endif
+		Arena* previousArena = Arena::SetCurrent(myArena);
+#if MEMORY_PROFILING
+		std::string previousOwner = MemoryProfiler::GetOwner();
+		MemoryProfiler::SetOwner(myName);
+#endif
+
+		// kept so a checkpoint can recreate this realm
+		myConfig = config;
+		myTemplateName = other.IsValid() ? other->myName : std::string();
+
 		StringKeyDictionary languages;
 		languages = GetMeta("languages", languages);
 
@@ -149,6 +182,11 @@ namespace shh
 		scheduler = config.Get("scheduler", scheduler);
 		myScheduler = Scheduler::CreateScheduler(0, 10000, myPrivileges);
 
+		// processes idle for hibernate_after are hibernated to hibernate_path
+		// or in memory if no path given
+		std::string hibernatePath = scheduler.Get("hibernate_path", "");
+		myScheduler->SetHibernation(scheduler.Get("hibernate_after", (double)0.0), hibernatePath);
+
 
 		// set up scheduler and base processes
 		GCPtr<LuaProcess> schemaBaseLua;
@@ -466,11 +504,11 @@ namespace shh
 					
 				StringKeyDictionary reg;
 				reg = config.Get("modules", reg);
-				StringKeyDictionary::OrderedVariables::const_iterator it = reg.OrderedBegin();
-				StringKeyDictionary::OrderedVariables::const_iterator end = reg.OrderedEnd();
+				StringKeyDictionary::OrderedVariablesConstIterator it = reg.OrderedBegin();
+				StringKeyDictionary::OrderedVariablesConstIterator end = reg.OrderedEnd();
 				while (it != end)
 				{
-					const std::string moduleName = *it->first.myKey;
+					const std::string moduleName = *it->first;
 					StringKeyDictionary modSpec;
 					if (it->second->Get(modSpec))
 					{
@@ -524,7 +562,11 @@ namespace shh
 				om->BuildHierachry(myVM);
 			}
 		}
-		
+
+		Arena::SetCurrent(previousArena);
+#if MEMORY_PROFILING
+		MemoryProfiler::SetOwner(previousOwner);
+#endif
 	}
 
 
@@ -540,6 +582,9 @@ namespace shh
 		RealmMap::iterator it = ourRealmMap.find(myName);
 		if (it != ourRealmMap.end())
 			ourRealmMap.erase(it);
+
+		if (myArena != NULL)
+			myArena->Detach();
 	}
 
 
@@ -765,6 +810,10 @@ namespace shh
 		else
 		{
 			ourActiveRealm = GCPtr<Realm>(this);
+			Arena::SetCurrent(myArena);
+#if MEMORY_PROFILING
+			MemoryProfiler::SetOwner(myName);
+#endif
 			for (Module::Map::iterator m = mySubModules.begin(); m != mySubModules.end(); m++)
 				m->second->SetActive(ourActiveRealm);
 			return true;
@@ -785,6 +834,10 @@ namespace shh
 			m->second->SetAsInactive();
 
 		ourActiveRealm.SetNull();
+		Arena::SetCurrent(NULL);
+#if MEMORY_PROFILING
+		MemoryProfiler::SetOwner("");
+#endif
 	}
 
 
@@ -881,13 +934,23 @@ namespace shh
 	// --------------------------------------------------------------------------
 	void Realm::Read(IOInterface& io, int version)
 	{
-		//INITIALIZE_SERIAL_IN(io);
-
-		//SERIALIZE_IN(io, myLocalConfig)		
-		//Realm::ReadStatic(io, version);
-
-		//FINALIZE_SERIAL(io);
-		
+		INITIALIZE_SERIAL_IN(io);
+
+		Environment::Read(io, version);
+		SERIALIZE_IN(io, myPaused);
+		SERIALIZE_IN(io, myTime);
+		SERIALIZE_IN(io, myStartTime);
+		SERIALIZE_IN(io, myLastUpdateTime);
+		SERIALIZE_IN(io, myObjectStartTime);
+		SERIALIZE_IN(io, myBootPath);
+		SERIALIZE_IN(io, myUpdatePath);
+
+		StringKeyDictionary updaterDict;
+		IODictionary<std::string> ioUpdaterDict(updaterDict);
+		SERIALIZE_IN(io, ioUpdaterDict);
+		myUpdaterDict = updaterDict;
+
+		FINALIZE_SERIAL(io);
 	}
 
 
@@ -899,13 +962,21 @@ namespace shh
 	// --------------------------------------------------------------------------
 	void Realm::Write(IOInterface& io, int version) const
 	{
-		//INITIALIZE_SERIAL_OUT(io);
+		INITIALIZE_SERIAL_OUT(io);
 
-		//SERIALIZE_OUT(io, myLocalConfig);
-		//Realm::WriteStatic(io, version);
+		Environment::Write(io, version);
+		SERIALIZE_OUT(io, myPaused);
+		SERIALIZE_OUT(io, myTime);
+		SERIALIZE_OUT(io, myStartTime);
+		SERIALIZE_OUT(io, myLastUpdateTime);
+		SERIALIZE_OUT(io, myObjectStartTime);
+		SERIALIZE_OUT(io, myBootPath);
+		SERIALIZE_OUT(io, myUpdatePath);
 
-		//FINALIZE_SERIAL(io);
+		IODictionary<std::string> ioUpdaterDict(const_cast<StringKeyDictionary&>(myUpdaterDict));
+		SERIALIZE_OUT(io, ioUpdaterDict);
 
+		FINALIZE_SERIAL(io);
 	}
 
 
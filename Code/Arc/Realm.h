@@ -39,10 +39,11 @@ namespace shh {
 
 	class LuaProcess;
 	class SoftProcess;
+	class Arena;
 
 	class Realm : public Environment
 	{
-		//DECLARE_ARCHIVE(Realm)
+		DECLARE_ARCHIVE(Realm)
 
 		friend class God;
 
@@ -101,6 +102,11 @@ namespace shh {
 		GCPtr<SoftProcess> myUpdaterProcess;
 		StringKeyDictionary myUpdaterDict;
 
+		StringKeyDictionary myConfig;
+		std::string myTemplateName;
+
+		Arena* myArena;
+
 	
 		Realm();
 		Realm(const std::string& name, const Privileges& privileges, const std::string& id);
@@ -590,8 +590,8 @@ namespace shh {
 	{
 		const GCPtr<Process> previous = Scheduler::GetCurrentProcess();
 		Scheduler::SetCurrentProcess(process);
-		StringKeyDictionary::OrderedVariables::const_iterator dit = moduleList.OrderedBegin();
-		StringKeyDictionary::OrderedVariables::const_iterator dend = moduleList.OrderedEnd();
+		StringKeyDictionary::OrderedVariablesConstIterator dit = moduleList.OrderedBegin();
+		StringKeyDictionary::OrderedVariablesConstIterator dend = moduleList.OrderedEnd();
 		while(dit != dend)
 		{
 			std::string moduleName = *dit->first;
@@ -29,15 +29,108 @@
 
 #include "SecureStl.h"
 #include "Variant.h"
-#include <map>
 #include <string>
 #include <string.h>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <atomic>
 
 
 
 namespace shh {
 
 
+	// DictionaryKey /////////////////////////////////////////////////////////////
+
+	template<typename KEY>
+	class DictionaryKey
+	{
+	public:
+
+		inline KEY* Set(const KEY& key) { myKey = key; return &myKey; }
+		inline KEY* Move(DictionaryKey& other, KEY* key) { myKey = std::move(other.myKey); return &myKey; }
+		inline void Clear(KEY* key) { myKey = KEY(); }
+
+	private:
+
+		KEY myKey;
+	};
+
+
+	template<>
+	class DictionaryKey<Variant>
+	{
+	public:
+
+		enum { inlineKeySize = 24 };
+
+		inline Variant* Set(const Variant& key) 
+		{ 
+			Variant* k = key.NewClone(myKey, inlineKeySize);
+			return k != NULL ? k : key.NewClone(); 
+		}
+		inline Variant* Move(DictionaryKey& other, Variant* key) 
+		{ 
+			if ((void*)key != (void*)other.myKey)
+				return key;
+			Variant* k = key->NewClone(myKey, inlineKeySize);
+			key->~Variant();
+			return k;
+		}
+		inline void Clear(Variant* key) 
+		{ 
+			if ((void*)key == (void*)myKey)
+				key->~Variant();
+			else
+				delete key; 
+		}
+
+	private:
+
+		alignas(8) unsigned char myKey[inlineKeySize];
+	};
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	GetDenseKey
+	// Description:	gets array index of key if it is of a type that can be stored 
+	//				densely, that is unsigned or integer variant keys
+	// Arguments:	key, index to return, type id of key to return
+	// Returns:		true if key can be stored densely
+	// --------------------------------------------------------------------------
+	template<typename KEY> inline bool GetDenseKey(const KEY& key, unsigned int& index, unsigned int& typeId)
+	{
+		return false;
+	}
+	inline bool GetDenseKey(const unsigned int& key, unsigned int& index, unsigned int& typeId)
+	{
+		index = key;
+		typeId = 0;
+		return true;
+	}
+	inline bool GetDenseKey(const Variant& key, unsigned int& index, unsigned int& typeId)
+	{
+		long long value;
+		switch (key.GetKind())
+		{
+		case Variant::IntKind: value = key.GetUnchecked<int>(); break;
+		case Variant::UnsignedIntKind: value = key.GetUnchecked<unsigned int>(); break;
+		case Variant::LongKind: value = key.GetUnchecked<long>(); break;
+		case Variant::LongLongKind: value = key.GetUnchecked<long long>(); break;
+		default: return false;
+		}
+		if (value < 0 || value > 0xFFFFFFFFll)
+			return false;
+
+		index = (unsigned int)value;
+		typeId = key.GetTypeId();
+		return true;
+	}
+
+
+	// Dictionary /////////////////////////////////////////////////////////////
+
 	template<typename KEY>
 	class Dictionary 
 	{
@@ -45,6 +138,8 @@ namespace shh {
 	
 	public:
 
+		enum { linearSearchSize = 8, inlineValueSize = 24 };
+
 
 		class Sorter
 		{
@@ -82,20 +177,123 @@ namespace shh {
 
 		};
 
-		struct CompareKeyByValue {
-			bool operator()(const KEY* a, const KEY* b) const { return *a < *b; }
+
+		class Entry
+		{
+
+		public:
+			KEY* first;
+			Variant* second;
+			unsigned int mySortId;
+			unsigned int myHash;
+
+			Entry(const KEY& key, unsigned int hash, unsigned int sortId);
+			Entry(const Entry& other);
+			Entry(Entry&& other) noexcept;
+			~Entry();
+
+			void SetValue(const Variant& variant);
+			template<class T> void SetValue(const T& value);
+			void AdoptValue(Variant* variant);
+			void Clear();
+
+		private:
+
+			DictionaryKey<KEY> myKeyStore;
+			alignas(8) unsigned char myValue[inlineValueSize];
+
+			inline bool IsInline() const { return (const void*)second == (const void*)myValue; }
+			void ClearValue();
+			Entry& operator=(const Entry& other) = delete;
+		};
+
+
+		class ConstIterator
+		{
+
+		public:
+
+			ConstIterator() : myEntry(NULL), myEnd(NULL) {}
+			ConstIterator(const Entry* entry, const Entry* end) : myEntry(entry), myEnd(end) { Skip(); }
+
+			inline const Entry& operator*() const { return *myEntry; }
+			inline const Entry* operator->() const { return myEntry; }
+			inline ConstIterator& operator++() { myEntry++; Skip(); return *this; }
+			inline ConstIterator operator++(int) { ConstIterator old(*this); myEntry++; Skip(); return old; }
+			inline bool operator==(const ConstIterator& other) const { return myEntry == other.myEntry; }
+			inline bool operator!=(const ConstIterator& other) const { return myEntry != other.myEntry; }
+
+		private:
+
+			const Entry* myEntry;
+			const Entry* myEnd;
+
+			inline void Skip() { while (myEntry != myEnd && myEntry->second == NULL) myEntry++; }
+		};
+
+
+		class SortedConstIterator
+		{
+
+		public:
+
+			SortedConstIterator() : myEntries(NULL), myOrder(NULL) {}
+			SortedConstIterator(const Entry* entries, const unsigned int* order) : myEntries(entries), myOrder(order) {}
+
+			inline const Entry& operator*() const { return myEntries[*myOrder]; }
+			inline const Entry* operator->() const { return myEntries + *myOrder; }
+			inline SortedConstIterator& operator++() { myOrder++; return *this; }
+			inline SortedConstIterator operator++(int) { SortedConstIterator old(*this); myOrder++; return old; }
+			inline bool operator==(const SortedConstIterator& other) const { return myOrder == other.myOrder; }
+			inline bool operator!=(const SortedConstIterator& other) const { return myOrder != other.myOrder; }
+
+		private:
+
+			const Entry* myEntries;
+			const unsigned int* myOrder;
 		};
 
 
+		typedef std::vector<Entry> Entries;
+		typedef std::vector<unsigned int> Index;
+
+
+		class Table
+		{
 
+		public:
+			Entries myEntries;
+			Index myIndex;
+			Index mySorted;
+			unsigned int mySortedSize;
+			unsigned int mySize;
+			unsigned int myNextArrayIndex;
+			std::atomic<unsigned int> myReferences;
+			bool myDense;
+			unsigned int myDenseBase;
+			unsigned int myDenseTypeId;
+
+			Table();
+			Table(const Table& other);
+
+			int Find(const KEY& variableKey, unsigned int hash) const;
+			Entry& Insert(Entry& entry);
+			void Remove(unsigned int i);
+			void AddToIndex(unsigned int i);
+			void AddToSorted(unsigned int i);
+			void RemoveFromSorted(unsigned int i);
+			void Sort();
+			void Reindex();
+			void Compact();
+
+		private:
+
+			Table& operator=(const Table& other) = delete;
+		};
 
-		typedef std::map<KEY*, Variant*, CompareKeyByValue> Variables;
-		typedef std::map<Sorter, Variant*> OrderedVariables;
-		typedef typename Variables::iterator VariablesIterator;
-		typedef typename Variables::const_iterator VariablesConstIterator;
-		typedef typename OrderedVariables::iterator OrderedVariablesIterator;
-		typedef typename OrderedVariables::const_iterator OrderedVariablesConstIterator;
 
+		typedef SortedConstIterator VariablesConstIterator;
+		typedef ConstIterator OrderedVariablesConstIterator;
 
 
 
@@ -126,6 +324,7 @@ namespace shh {
 		Variant const* const Get(const KEY& variableKey) const;
 		template<class T> const T Get(const KEY& variableKey, const T& defaultValue) const;
 		template<class T> T* GetPtr(const KEY& variableKey, T* defaultValue);
+		template<class T> const T* GetConstPtr(const KEY& variableKey, const T* defaultValue) const;
 
 		void Set(const char variableKey[], const char value[]);
 		template<class K> void Set(const K& variableKey, const char value[]);
@@ -140,14 +339,15 @@ namespace shh {
 		KEY GetFromIt(const VariablesConstIterator& it, const char defaultValue[]) const;
 		template<class T> const T GetFromIt(const VariablesConstIterator& it, const T& defaultValue) const;
 		template<class T> T* GetPtr(const VariablesConstIterator& it, T* defaultValue);
+		template<class T> const T* GetConstPtr(const VariablesConstIterator& it, const T* defaultValue) const;
 
 		OrderedVariablesConstIterator OrderedBegin() const;
 		OrderedVariablesConstIterator OrderedEnd() const;
 
-
 		KEY GetFromIt(const OrderedVariablesConstIterator& it, const char defaultValue[]) const;
 		template<class T> const T GetFromIt(const OrderedVariablesConstIterator& it, const T& defaultValue) const;
 		template<class T> T* GetPtr(const OrderedVariablesConstIterator& it, T* defaultValue);
+
 		int IncNextArrayIndex();
 		int GetNextArrayIndex() const;
 
@@ -168,11 +368,12 @@ namespace shh {
 	protected:
 
 
-		Variables myVariables;
-		OrderedVariables myOrderedVariables;
-		unsigned int myNextArrayIndex;
+		Table* myTable;
 
-		void AddSorter(const KEY& variableKey, Variant* n);
+		static unsigned int Hash(const KEY& variableKey);
+		Table& GetUniqueTable();
+		void Release();
+		void Adopt(const KEY& variableKey, Variant* variant, unsigned int sortId);
 		static KEY* Clone(const void* k);
 
 	};
@@ -202,11 +403,11 @@ namespace shh {
 			std::string key;
 			if (it->first->Get(key))
 			{
-				VariantKeyDictionary dict;
-				if (it->second->Get(dict))
+				VariantKeyDictionary* dict;
+				if (it->second->GetPtr(dict))
 				{
 					StringKeyDictionary subDict;
-					ConvertVariantDictToStringDict(dict, subDict);
+					ConvertVariantDictToStringDict(*dict, subDict);
 					sd.Set(key, subDict);
 				}
 				else
@@ -228,25 +429,19 @@ namespace shh {
 	{
 		for (StringKeyDictionary::VariablesConstIterator it = sd.Begin(); it != sd.End(); it++)
 		{
-			if (it->second->IsType<StringKeyDictionary>())
+			StringKeyDictionary* stringDict;
+			ArrayKeyDictionary* arrayDict;
+			if (it->second->GetPtr(stringDict))
 			{
-				StringKeyDictionary dict;
-				if (it->second->Get(dict))
-				{
-					VariantKeyDictionary subDict;
-					ConvertStringDictToVarientDict(dict, subDict);
-					vd.Set(NonVariant<std::string>(*it->first), subDict);
-				}
+				VariantKeyDictionary subDict;
+				ConvertStringDictToVarientDict(*stringDict, subDict);
+				vd.Set(NonVariant<std::string>(*it->first), subDict);
 			}
-			if (it->second->IsType<ArrayKeyDictionary>())
+			else if (it->second->GetPtr(arrayDict))
 			{
-				ArrayKeyDictionary dict;
-				if (it->second->Get(dict))
-				{
-					VariantKeyDictionary subDict;
-					ConvertArrayDictToVarientDict(dict, subDict);
-					vd.Set(NonVariant<std::string>(*it->first), subDict);
-				}
+				VariantKeyDictionary subDict;
+				ConvertArrayDictToVarientDict(*arrayDict, subDict);
+				vd.Set(NonVariant<std::string>(*it->first), subDict);
 			}
 			else
 			{
@@ -267,25 +462,19 @@ namespace shh {
 	{
 		for (ArrayKeyDictionary::VariablesConstIterator it = ad.Begin(); it != ad.End(); it++)
 		{
-			if (it->second->IsType<StringKeyDictionary>())
+			StringKeyDictionary* stringDict;
+			ArrayKeyDictionary* arrayDict;
+			if (it->second->GetPtr(stringDict))
 			{
-				StringKeyDictionary dict;
-				if (it->second->Get(dict))
-				{
-					VariantKeyDictionary subDict;
-					ConvertStringDictToVarientDict(dict, subDict);
-					vd.Set(NonVariant<unsigned int>(*it->first), subDict);
-				}
+				VariantKeyDictionary subDict;
+				ConvertStringDictToVarientDict(*stringDict, subDict);
+				vd.Set(NonVariant<unsigned int>(*it->first), subDict);
 			}
-			if (it->second->IsType<ArrayKeyDictionary>())
+			else if (it->second->GetPtr(arrayDict))
 			{
-				ArrayKeyDictionary dict;
-				if (it->second->Get(dict))
-				{
-					VariantKeyDictionary subDict;
-					ConvertArrayDictToVarientDict(dict, subDict);
-					vd.Set(NonVariant<unsigned int>(*it->first), subDict);
-				}
+				VariantKeyDictionary subDict;
+				ConvertArrayDictToVarientDict(*arrayDict, subDict);
+				vd.Set(NonVariant<unsigned int>(*it->first), subDict);
 			}
 			else
 			{
@@ -331,23 +520,487 @@ namespace shh {
 	}
 
 
+	// --------------------------------------------------------------------------						
+	// Function:	Entry
+	// Description:	constructor
+	// Arguments:	key, hash of key, sort id
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	template<typename KEY> Dictionary<KEY>::Entry::Entry(const KEY& key, unsigned int hash, unsigned int sortId) :
+		first(NULL),
+		second(NULL),
+		mySortId(sortId),
+		myHash(hash)
+	{
+		first = myKeyStore.Set(key);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Entry
+	// Description:	copy constructor
+	// Arguments:	entry to copy
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	template<typename KEY> Dictionary<KEY>::Entry::Entry(const Entry& other) :
+		first(NULL),
+		second(NULL),
+		mySortId(other.mySortId),
+		myHash(other.myHash)
+	{
+		if (other.first != NULL)
+			first = myKeyStore.Set(*other.first);
+		if (other.second != NULL)
+			SetValue(*other.second);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Entry
+	// Description:	move constructor, inline values are recloned into this entry
+	// Arguments:	entry to move
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	template<typename KEY> Dictionary<KEY>::Entry::Entry(Entry&& other) noexcept :
+		first(NULL),
+		second(NULL),
+		mySortId(other.mySortId),
+		myHash(other.myHash)
+	{
+		if (other.first != NULL)
+			first = myKeyStore.Move(other.myKeyStore, other.first);
+		other.first = NULL;
+
+		if (other.IsInline())
+		{
+			second = other.second->NewClone(myValue, inlineValueSize);
+			other.second->~Variant();
+		}
+		else
+		{
+			second = other.second;
+		}
+		other.second = NULL;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	~Entry
+	// Description:	destructor
+	// Arguments:	none
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	template<typename KEY> Dictionary<KEY>::Entry::~Entry()
+	{
+		Clear();
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	SetValue
+	// Description:	sets value of entry, inline if it fits
+	// Arguments:	value
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	template<typename KEY> void Dictionary<KEY>::Entry::SetValue(const Variant& variant)
+	{
+		if (second == &variant)
+			return;
+
+		ClearValue();
+		second = variant.NewClone(myValue, inlineValueSize);
+		if (second == NULL)
+			second = variant.NewClone();
+	}
+	template<typename KEY>
+	template<class T> void Dictionary<KEY>::Entry::SetValue(const T& value)
+	{
+		if (second != NULL && second->GetValuePtr() == &value)
+			return;
+
+		ClearValue();
+		if (std::is_trivially_copyable<T>::value && sizeof(NonVariant<T>) <= inlineValueSize)
+			second = new (myValue) NonVariant<T>(value);
+		else
+			second = new NonVariant<T>(value);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	AdoptValue
+	// Description:	sets value of entry taking ownership of a heap variant
+	// Arguments:	heap variant
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	template<typename KEY> void Dictionary<KEY>::Entry::AdoptValue(Variant* variant)
+	{
+		ClearValue();
+		second = variant;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Clear
+	// Description:	removes key and value from entry leaving it dead
+	// Arguments:	none
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	template<typename KEY> void Dictionary<KEY>::Entry::Clear()
+	{
+		ClearValue();
+		if (first != NULL)
+		{
+			myKeyStore.Clear(first);
+			first = NULL;
+		}
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	ClearValue
+	// Description:	destroys value of entry
+	// Arguments:	none
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	template<typename KEY> void Dictionary<KEY>::Entry::ClearValue()
+	{
+		if (second == NULL)
+			return;
+
+		if (IsInline())
+			second->~Variant();
+		else
+			delete second;
+		second = NULL;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Table
+	// Description:	constructor
+	// Arguments:	none
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	template<typename KEY> Dictionary<KEY>::Table::Table() : 
+		mySortedSize(0),
+		mySize(0), 
+		myNextArrayIndex(0), 
+		myReferences(1),
+		myDense(false),
+		myDenseBase(0),
+		myDenseTypeId(0)
+	{}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Table
+	// Description:	copy constructor, keeps dead entries so entry positions match
+	// Arguments:	table to copy
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	template<typename KEY> Dictionary<KEY>::Table::Table(const Table& other) :
+		myEntries(other.myEntries),
+		myIndex(other.myIndex),
+		mySorted(other.mySorted),
+		mySortedSize(other.mySortedSize),
+		mySize(other.mySize),
+		myNextArrayIndex(other.myNextArrayIndex),
+		myReferences(1),
+		myDense(other.myDense),
+		myDenseBase(other.myDenseBase),
+		myDenseTypeId(other.myDenseTypeId)
+	{}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Find
+	// Description:	finds entry of key, dense tables are indexed directly, small
+	//				ones are searched linearly and larger ones through the open 
+	//				addressed index
+	// Arguments:	key, hash of key
+	// Returns:		index of entry or -1 if not found
+	// --------------------------------------------------------------------------
+	template<typename KEY> int Dictionary<KEY>::Table::Find(const KEY& variableKey, unsigned int hash) const
+	{
+		if (myDense)
+		{
+			unsigned int index, typeId;
+			if (!GetDenseKey(variableKey, index, typeId) || typeId != myDenseTypeId)
+				return -1;
+			index -= myDenseBase;
+			return index < (unsigned int)myEntries.size() ? (int)index : -1;
+		}
+
+		if (myIndex.empty())
+		{
+			for (unsigned int i = 0; i != (unsigned int)myEntries.size(); i++)
+			{
+				const Entry& entry = myEntries[i];
+				if (entry.second != NULL && entry.myHash == hash && *entry.first == variableKey)
+					return (int)i;
+			}
+			return -1;
+		}
+
+		unsigned int mask = (unsigned int)myIndex.size() - 1;
+		for (unsigned int slot = hash & mask; myIndex[slot] != 0; slot = (slot + 1) & mask)
+		{
+			const Entry& entry = myEntries[myIndex[slot] - 1];
+			if (entry.myHash == hash && *entry.first == variableKey)
+				return (int)myIndex[slot] - 1;
+		}
+		return -1;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Insert
+	// Description:	appends new entry, taking its key and value, tables whose keys
+	//				run on from 0 or 1 stay dense and need no index and are
+	//				already in key order
+	// Arguments:	entry
+	// Returns:		entry in table
+	// --------------------------------------------------------------------------
+	template<typename KEY> typename Dictionary<KEY>::Entry& Dictionary<KEY>::Table::Insert(Entry& entry)
+	{
+		unsigned int index, typeId;
+		bool denseKey = GetDenseKey(*entry.first, index, typeId);
+		if (myEntries.empty() && denseKey && index <= 1)
+		{
+			myDense = true;
+			myDenseBase = index;
+			myDenseTypeId = typeId;
+		}
+		else if (myDense && (!denseKey || typeId != myDenseTypeId || index != myDenseBase + (unsigned int)myEntries.size()))
+		{
+			myDense = false;
+		}
+
+		if (myDense)
+		{
+			myEntries.push_back(std::move(entry));
+			mySize++;
+			mySorted.push_back((unsigned int)myEntries.size() - 1);
+			mySortedSize = (unsigned int)mySorted.size();
+			return myEntries.back();
+		}
+
+		if (myEntries.size() > linearSearchSize && myEntries.size() - mySize > mySize)
+			Compact();
+
+		myEntries.push_back(std::move(entry));
+		mySize++;
+		AddToSorted((unsigned int)myEntries.size() - 1);
+
+		if (myIndex.empty() ? myEntries.size() > linearSearchSize : mySize * 4 > myIndex.size() * 3)
+			Reindex();
+		else if (!myIndex.empty())
+			AddToIndex((unsigned int)myEntries.size() - 1);
+
+		return myEntries.back();
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Remove
+	// Description:	removes entry from index and leaves it dead in the entries
+	//				until they are compacted
+	// Arguments:	entry index
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	template<typename KEY> void Dictionary<KEY>::Table::Remove(unsigned int i)
+	{
+		if (myDense)
+		{
+			if (i + 1 == (unsigned int)myEntries.size())
+			{
+				myEntries.pop_back();
+				mySorted.pop_back();
+				mySortedSize = (unsigned int)mySorted.size();
+				mySize--;
+				myDense = mySize != 0;
+				return;
+			}
+			myDense = false;
+			Reindex();
+		}
+
+		if (!myIndex.empty())
+		{
+			unsigned int mask = (unsigned int)myIndex.size() - 1;
+			unsigned int slot = myEntries[i].myHash & mask;
+			while (myIndex[slot] != i + 1)
+				slot = (slot + 1) & mask;
+
+			// shift back any following entries that probed past this slot
+			myIndex[slot] = 0;
+			for (unsigned int next = (slot + 1) & mask; myIndex[next] != 0; next = (next + 1) & mask)
+			{
+				unsigned int home = myEntries[myIndex[next] - 1].myHash & mask;
+				if (((next - home) & mask) >= ((next - slot) & mask))
+				{
+					myIndex[slot] = myIndex[next];
+					myIndex[next] = 0;
+					slot = next;
+				}
+			}
+		}
+
+		RemoveFromSorted(i);
+		myEntries[i].Clear();
+		mySize--;
+		if (mySize == 0)
+		{
+			myEntries.clear();
+			myIndex.clear();
+			mySorted.clear();
+			mySortedSize = 0;
+		}
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	AddToIndex
+	// Description:	adds entry to open addressed index
+	// Arguments:	entry index
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	template<typename KEY> void Dictionary<KEY>::Table::AddToIndex(unsigned int i)
+	{
+		unsigned int mask = (unsigned int)myIndex.size() - 1;
+		unsigned int slot = myEntries[i].myHash & mask;
+		while (myIndex[slot] != 0)
+			slot = (slot + 1) & mask;
+		myIndex[slot] = i + 1;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	AddToSorted
+	// Description:	adds entry to key order, it is appended and only counted as
+	//				sorted if all before it are and its key is greater, the 
+	//				rest are sorted together when next needed
+	// Arguments:	entry index
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	template<typename KEY> void Dictionary<KEY>::Table::AddToSorted(unsigned int i)
+	{
+		if (mySortedSize == (unsigned int)mySorted.size() && 
+			(mySorted.empty() || *myEntries[mySorted.back()].first < *myEntries[i].first))
+			mySortedSize++;
+		mySorted.push_back(i);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	RemoveFromSorted
+	// Description:	removes entry from key order
+	// Arguments:	entry index
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	template<typename KEY> void Dictionary<KEY>::Table::RemoveFromSorted(unsigned int i)
+	{
+		Sort();
+		const Entries& entries = myEntries;
+		Index::iterator it = std::lower_bound(mySorted.begin(), mySorted.end(), i, 
+			[&entries](unsigned int a, unsigned int b) { return *entries[a].first < *entries[b].first; });
+		if (it != mySorted.end() && *it == i)
+		{
+			mySorted.erase(it);
+			mySortedSize--;
+		}
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Sort
+	// Description:	sorts entries appended out of key order and merges them into
+	//				the sorted ones
+	// Arguments:	none
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	template<typename KEY> void Dictionary<KEY>::Table::Sort()
+	{
+		if (mySortedSize == (unsigned int)mySorted.size())
+			return;
+
+		const Entries& entries = myEntries;
+		auto less = [&entries](unsigned int a, unsigned int b) { return *entries[a].first < *entries[b].first; };
+		std::sort(mySorted.begin() + mySortedSize, mySorted.end(), less);
+		std::inplace_merge(mySorted.begin(), mySorted.begin() + mySortedSize, mySorted.end(), less);
+		mySortedSize = (unsigned int)mySorted.size();
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Reindex
+	// Description:	rebuilds open addressed index, small tables have none
+	// Arguments:	none
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	template<typename KEY> void Dictionary<KEY>::Table::Reindex()
+	{
+		myIndex.clear();
+		if (myEntries.size() <= linearSearchSize)
+			return;
+
+		unsigned int capacity = linearSearchSize * 2;
+		while (capacity < mySize * 2)
+			capacity <<= 1;
+		myIndex.assign(capacity, 0);
+
+		for (unsigned int i = 0; i != (unsigned int)myEntries.size(); i++)
+		{
+			if (myEntries[i].second != NULL)
+				AddToIndex(i);
+		}
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Compact
+	// Description:	removes dead entries keeping order, renumbering key order
+	// Arguments:	none
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	template<typename KEY> void Dictionary<KEY>::Table::Compact()
+	{
+		Index moved(myEntries.size(), 0);
+		Entries entries;
+		entries.reserve(mySize + 1);
+		for (unsigned int i = 0; i != (unsigned int)myEntries.size(); i++)
+		{
+			if (myEntries[i].second != NULL)
+			{
+				moved[i] = (unsigned int)entries.size();
+				entries.push_back(std::move(myEntries[i]));
+			}
+		}
+		myEntries.swap(entries);
+		for (unsigned int s = 0; s != (unsigned int)mySorted.size(); s++)
+			mySorted[s] = moved[mySorted[s]];
+		Reindex();
+	}
+
+
 	// --------------------------------------------------------------------------						
 	// Function:	Dictionary
 	// Description:	constructor
 	// Arguments:	none
 	// Returns:		none
 	// --------------------------------------------------------------------------
-	template<typename KEY> Dictionary<KEY>::Dictionary() : myNextArrayIndex(0) 
+	template<typename KEY> Dictionary<KEY>::Dictionary() : myTable(NULL) 
 	{}
 
 
 	// --------------------------------------------------------------------------						
 	// Function:	Dictionary
-	// Description:	copy constructor
+	// Description:	copy constructor, shares table of other until either is 
+	//				changed
 	// Arguments:	dict to copy
 	// Returns:		none
 	// --------------------------------------------------------------------------
-	template<typename KEY> Dictionary<KEY>::Dictionary(const Dictionary<KEY>& other) : myNextArrayIndex(0) 
+	template<typename KEY> Dictionary<KEY>::Dictionary(const Dictionary<KEY>& other) : myTable(NULL) 
 	{ 
 		*this = other; 
 	}
@@ -361,26 +1014,30 @@ namespace shh {
 	// --------------------------------------------------------------------------
 	template<typename KEY> Dictionary<KEY>::~Dictionary() 
 	{ 
-		Clean(); 
+		Release(); 
 	}
 
 
 	// --------------------------------------------------------------------------						
 	// Function:	=
-	// Description:	assigner
+	// Description:	assigner, shares table of other until either is changed
 	// Arguments:	dict to copy
 	// Returns:		this
 	// --------------------------------------------------------------------------
 	template<typename KEY> const Dictionary<KEY>& Dictionary<KEY>::operator=(const Dictionary<KEY>& other)
 	{
-		Clean();
-		for (OrderedVariablesConstIterator it = other.myOrderedVariables.begin(); it != other.myOrderedVariables.end(); it++)
+		if (myTable == other.myTable)
+			return *this;
+
+		Release();
+		myTable = other.myTable;
+		if (myTable != NULL)
 		{
-			Variant* v = it->second->NewClone();
-			myVariables[NewKey(it->first.myKey)] = v;
-			myOrderedVariables[Sorter(*it->first, IncNextArrayIndex())] = v;
+			// tables are sorted before being shared so only an unshared one
+			// is ever sorted when iterated
+			myTable->Sort();
+			myTable->myReferences++;
 		}
-		myNextArrayIndex = other.myNextArrayIndex;
 		return *this;
 	}
 
@@ -393,11 +1050,18 @@ namespace shh {
 	// --------------------------------------------------------------------------
 	template<typename KEY> bool Dictionary<KEY>::operator==(const Dictionary<KEY>& other) const
 	{
-		OrderedVariablesConstIterator it = myOrderedVariables.begin();
-		OrderedVariablesConstIterator oit = other.myOrderedVariables.begin();
-		for (; it != myOrderedVariables.end() && oit != other.myOrderedVariables.end(); it++, oit++)
+		if (myTable == other.myTable)
+			return true;
+		if (Size() != other.Size())
+			return false;
+
+		// compared in key order so order keys were added does not matter
+
+		VariablesConstIterator it = Begin();
+		VariablesConstIterator oit = other.Begin();
+		for (; it != End() && oit != other.End(); it++, oit++)
 		{
-			if (it->first != oit->first || *it->second != *oit->second)
+			if (!(*it->first == *oit->first) || !(*it->second == *oit->second))
 				return false;
 		}
 		return true;
@@ -412,14 +1076,7 @@ namespace shh {
 	// --------------------------------------------------------------------------
 	template<typename KEY> bool Dictionary<KEY>::operator!=(const Dictionary<KEY>& other) const
 	{
-		OrderedVariablesConstIterator it = myOrderedVariables.begin();
-		OrderedVariablesConstIterator oit = other.myOrderedVariables.begin();
-		for (; it != myOrderedVariables.end() && oit != other.myOrderedVariables.end(); it++, oit++)
-		{
-			if (it->first == oit->first && *it->second == *oit->second)
-				return false;
-		}
-		return true;
+		return !(*this == other);
 	}
 
 
@@ -431,14 +1088,16 @@ namespace shh {
 	// --------------------------------------------------------------------------
 	template<typename KEY> bool Dictionary<KEY>::operator<(const Dictionary<KEY>& other) const
 	{
-		OrderedVariablesConstIterator it = myOrderedVariables.begin();
-		OrderedVariablesConstIterator oit = other.myOrderedVariables.begin();
-		for (; it != myOrderedVariables.end() && oit != other.myOrderedVariables.end(); it++, oit++)
+		VariablesConstIterator it = Begin();
+		VariablesConstIterator oit = other.Begin();
+		for (; it != End() && oit != other.End(); it++, oit++)
 		{
-			if (it->first > oit->first)
+			if (*it->first < *oit->first)
+				return true;
+			if (*oit->first < *it->first)
 				return false;
 		}
-		return true;
+		return it == End() && oit != other.End();
 	}
 
 
@@ -450,14 +1109,7 @@ namespace shh {
 	// --------------------------------------------------------------------------
 	template<typename KEY> bool Dictionary<KEY>::operator>(const Dictionary<KEY>& other) const
 	{
-		OrderedVariablesConstIterator it = myOrderedVariables.begin();
-		OrderedVariablesConstIterator oit = other.myOrderedVariables.begin();
-		for (; it != myOrderedVariables.end() && oit != other.myOrderedVariables.end(); it++, oit++)
-		{
-			if (it->first < oit->first)
-				return false;
-		}
-		return true;
+		return other < *this;
 	}
 
 
@@ -469,7 +1121,7 @@ namespace shh {
 	// --------------------------------------------------------------------------
 	template<typename KEY> bool Dictionary<KEY>::Exists(const KEY& variableKey) const 
 	{ 
-		return myVariables.find((KEY*)&variableKey) != myVariables.end(); 
+		return myTable != NULL && myTable->Find(variableKey, Hash(variableKey)) >= 0; 
 	}
 
 
@@ -481,25 +1133,11 @@ namespace shh {
 	// --------------------------------------------------------------------------
 	template<typename KEY> void Dictionary<KEY>::Null(const KEY& variableKey)
 	{
-		VariablesIterator it = myVariables.find((KEY*)&variableKey);
-		if (it != myVariables.end())
-		{
-			delete it->first;
-			delete it->second;
-			myVariables.erase(it);
-			OrderedVariablesIterator oit = myOrderedVariables.begin();
-			OrderedVariablesIterator oend = myOrderedVariables.end();
-			while (oit != oend)
-			{
-				if (*oit->first.myKey == variableKey)
-				{
-					((Sorter*)(&oit->first))->Null();
-					myOrderedVariables.erase(oit);
-					return;
-				}
-				oit++;
-			}
-		}
+		if (!Exists(variableKey))
+			return;
+
+		Table& table = GetUniqueTable();
+		table.Remove((unsigned int)table.Find(variableKey, Hash(variableKey)));
 	}
 
 
@@ -512,11 +1150,11 @@ namespace shh {
 	template<typename KEY>
 	template<class T> bool Dictionary<KEY>::IsType(const KEY& variableKey, const T* t) const
 	{
-		VariablesConstIterator it = myVariables.find((KEY*)&variableKey);
-		if (it == myVariables.end() || !it->second->IsType(t))
+		Variant const* const variant = Get(variableKey);
+		if (variant == NULL)
 			return false;
 
-		return it->second->IsType(t);
+		return variant->IsType(t);
 	}
 
 
@@ -529,12 +1167,13 @@ namespace shh {
 	template<typename KEY>
 	template<class T> bool Dictionary<KEY>::IsType(const VariablesConstIterator& it, const T* t) const
 	{
-		if (it == myVariables.end() || !it->second->IsType(t))
+		if (it == End())
 			return false;
 
 		return it->second->IsType(t);
 	}
 
+
 	// --------------------------------------------------------------------------						
 	// Function:	Get
 	// Description:	gets variable with given key
@@ -545,27 +1184,29 @@ namespace shh {
 	const std::string Dictionary<KEY>::Get(const KEY& variableKey, const char str[]) const
 	{
 		std::string value;
-		std::string defaultValue(str);
-		VariablesConstIterator it = myVariables.find((KEY*)&variableKey);
-		if (it == myVariables.end() || !it->second->Get(value))
-			return defaultValue;
+		Variant const* const variant = Get(variableKey);
+		if (variant == NULL || !variant->Get(value))
+			return std::string(str);
 		else
 			return value;
 	}
 	template<typename KEY> Variant const* const Dictionary<KEY>::Get(const KEY& variableKey) const
 	{
-		VariablesConstIterator it = myVariables.find((KEY*)&variableKey);
-		if (it == myVariables.end())
+		if (myTable == NULL)
+			return NULL;
+
+		int i = myTable->Find(variableKey, Hash(variableKey));
+		if (i < 0)
 			return NULL;
 
-		return it->second;
+		return myTable->myEntries[i].second;
 	}
 	template<typename KEY>
 	template<class T> const T Dictionary<KEY>::Get(const KEY& variableKey, const T& defaultValue) const
 	{
 		T value;
-		VariablesConstIterator it = myVariables.find((KEY*)&variableKey);
-		if (it == myVariables.end() || !it->second->Get(value))
+		Variant const* const variant = Get(variableKey);
+		if (variant == NULL || !variant->Get(value))
 			return defaultValue;
 		else
 			return value;
@@ -574,7 +1215,8 @@ namespace shh {
 
 	// --------------------------------------------------------------------------						
 	// Function:	GetPtr
-	// Description:	gets pointer variable with given key
+	// Description:	gets pointer variable with given key to change, pointer is only
+	//				valid until next key is added to or removed from dictionary
 	// Arguments:	key, default value if not found
 	// Returns:		pointer to variable or default value
 	// --------------------------------------------------------------------------
@@ -582,8 +1224,31 @@ namespace shh {
 	template<class T> T* Dictionary<KEY>::GetPtr(const KEY& variableKey, T* defaultValue)
 	{
 		static T* value;
-		VariablesConstIterator it = myVariables.find((KEY*)&variableKey);
-		if (it == myVariables.end() || !it->second->GetPtr(value))
+		if (!Exists(variableKey))
+			return defaultValue;
+
+		Table& table = GetUniqueTable();
+		int i = table.Find(variableKey, Hash(variableKey));
+		if (!table.myEntries[i].second->GetPtr(value))
+			return defaultValue;
+		else
+			return value;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	GetConstPtr
+	// Description:	borrows pointer to variable with given key without copying it,
+	//				pointer is only valid until dictionary is next changed
+	// Arguments:	key, default value if not found
+	// Returns:		pointer to variable or default value
+	// --------------------------------------------------------------------------
+	template<typename KEY>
+	template<class T> const T* Dictionary<KEY>::GetConstPtr(const KEY& variableKey, const T* defaultValue) const
+	{
+		T* value;
+		Variant const* const variant = Get(variableKey);
+		if (variant == NULL || !variant->GetPtr(value))
 			return defaultValue;
 		else
 			return value;
@@ -592,7 +1257,7 @@ namespace shh {
 
 	// --------------------------------------------------------------------------						
 	// Function:	Set
-	// Description:	Sets variable with given key
+	// Description:	Sets variable with given key, an existing key keeps its place
 	// Arguments:	key, value 
 	// Returns:		none
 	// --------------------------------------------------------------------------
@@ -609,22 +1274,42 @@ namespace shh {
 	template<typename KEY> 
 	template<class K> void Dictionary<KEY>::Set(const K& variableKey, const Variant& variant)
 	{
-		K* key = (K*)&variableKey;
-		KEY* exactKey = static_cast<KEY*>(key);
-		Null(*exactKey);
-		Variant* n = variant.NewClone();
-		myVariables[NewKey(exactKey)] = n;
-		AddSorter(*exactKey, n);
+		const KEY& exactKey = static_cast<const KEY&>(variableKey);
+		unsigned int hash = Hash(exactKey);
+		Entry entry(exactKey, hash, 0);
+		entry.SetValue(variant);
+
+		Table& table = GetUniqueTable();
+		int i = table.Find(exactKey, hash);
+		if (i >= 0)
+		{
+			table.myEntries[i].SetValue(*entry.second);
+		}
+		else
+		{
+			entry.mySortId = table.myNextArrayIndex++;
+			table.Insert(entry);
+		}
 	}
 	template<typename KEY>
 	template<class K, class T> void Dictionary<KEY>::Set(const K& variableKey, const T& value)
 	{
-		K* key = (K*)&variableKey;
-		KEY* exactKey = static_cast<KEY*>(key);
-		Null(*exactKey);
-		NonVariant<T>* n = new NonVariant<T>(value);
-		myVariables[NewKey(exactKey)] = n;
-		AddSorter(*exactKey, n);
+		const KEY& exactKey = static_cast<const KEY&>(variableKey);
+		unsigned int hash = Hash(exactKey);
+		Entry entry(exactKey, hash, 0);
+		entry.SetValue(value);
+
+		Table& table = GetUniqueTable();
+		int i = table.Find(exactKey, hash);
+		if (i >= 0)
+		{
+			table.myEntries[i].SetValue(*entry.second);
+		}
+		else
+		{
+			entry.mySortId = table.myNextArrayIndex++;
+			table.Insert(entry);
+		}
 	}
 
 
@@ -636,19 +1321,23 @@ namespace shh {
 	// --------------------------------------------------------------------------
 	template<typename KEY> int Dictionary<KEY>::Size() const 
 	{ 
-		return (int)myVariables.size(); 
+		return myTable == NULL ? 0 : (int)myTable->mySize; 
 	}
 
 
 	// --------------------------------------------------------------------------						
 	// Function:	Begin
-	// Description:	returns start iterator of dictionary
+	// Description:	returns start iterator of dictionary, iterates in key order
+	//				sorting any keys added out of order first
 	// Arguments:	none
 	// Returns:		iterator
 	// --------------------------------------------------------------------------
 	template<typename KEY> typename Dictionary<KEY>::VariablesConstIterator Dictionary<KEY>::Begin() const 
 	{ 
-		return myVariables.begin(); 
+		if (myTable == NULL)
+			return VariablesConstIterator();
+		myTable->Sort();
+		return VariablesConstIterator(myTable->myEntries.data(), myTable->mySorted.data()); 
 	}
 
 
@@ -660,7 +1349,9 @@ namespace shh {
 	// --------------------------------------------------------------------------
 	template<typename KEY> typename Dictionary<KEY>::VariablesConstIterator Dictionary<KEY>::End() const 
 	{ 
-		return myVariables.end(); 
+		if (myTable == NULL)
+			return VariablesConstIterator();
+		return VariablesConstIterator(myTable->myEntries.data(), myTable->mySorted.data() + myTable->mySorted.size()); 
 	}
 
 
@@ -678,7 +1369,7 @@ namespace shh {
 	template<class T> const T Dictionary<KEY>::GetFromIt(const VariablesConstIterator& it, const T& defaultValue) const
 	{
 		T value;
-		if (it == myVariables.end() || !it->second->Get(value))
+		if (it == End() || !it->second->Get(value))
 			return defaultValue;
 		else
 			return value;
@@ -687,15 +1378,34 @@ namespace shh {
 
 	// --------------------------------------------------------------------------						
 	// Function:	GetPtr
-	// Description:	returns variable pointer from iterator of dictionary
-	// Arguments:	none
+	// Description:	returns variable pointer to change from iterator of dictionary,
+	//				found by key as the iterator may be into a table since 
+	//				unshared
+	// Arguments:	iterator, default value if not found
 	// Returns:		variable
 	// --------------------------------------------------------------------------
 	template<typename KEY>
 	template<class T> T* Dictionary<KEY>::GetPtr(const VariablesConstIterator& it, T* defaultValue)
 	{
-		static T* value;
-		if (it == myVariables.end() || !it->second->GetPtr(value))
+		if (it == End())
+			return defaultValue;
+
+		KEY key(*it->first);
+		return GetPtr(key, defaultValue);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	GetConstPtr
+	// Description:	borrows variable pointer from iterator of dictionary
+	// Arguments:	iterator, default value if not found
+	// Returns:		variable
+	// --------------------------------------------------------------------------
+	template<typename KEY>
+	template<class T> const T* Dictionary<KEY>::GetConstPtr(const VariablesConstIterator& it, const T* defaultValue) const
+	{
+		T* value;
+		if (it == End() || !it->second->GetPtr(value))
 			return defaultValue;
 		else
 			return value;
@@ -704,11 +1414,17 @@ namespace shh {
 
 	// --------------------------------------------------------------------------						
 	// Function:	OrderedBegin
-	// Description:	returns start iterator of ordered dictionary
+	// Description:	returns start iterator of ordered dictionary, iterates in
+	//				the order keys were added
 	// Arguments:	none
 	// Returns:		iterator
 	// --------------------------------------------------------------------------
-	template<typename KEY> typename Dictionary<KEY>::OrderedVariablesConstIterator Dictionary<KEY>::OrderedBegin() const { return myOrderedVariables.begin(); }
+	template<typename KEY> typename Dictionary<KEY>::OrderedVariablesConstIterator Dictionary<KEY>::OrderedBegin() const 
+	{ 
+		if (myTable == NULL)
+			return OrderedVariablesConstIterator();
+		return OrderedVariablesConstIterator(myTable->myEntries.data(), myTable->myEntries.data() + myTable->myEntries.size()); 
+	}
 
 
 	// --------------------------------------------------------------------------						
@@ -717,7 +1433,13 @@ namespace shh {
 	// Arguments:	none
 	// Returns:		iterator
 	// --------------------------------------------------------------------------
-	template<typename KEY> typename Dictionary<KEY>::OrderedVariablesConstIterator Dictionary<KEY>::OrderedEnd() const { return myOrderedVariables.end(); }
+	template<typename KEY> typename Dictionary<KEY>::OrderedVariablesConstIterator Dictionary<KEY>::OrderedEnd() const 
+	{ 
+		if (myTable == NULL)
+			return OrderedVariablesConstIterator();
+		const Entry* end = myTable->myEntries.data() + myTable->myEntries.size();
+		return OrderedVariablesConstIterator(end, end); 
+	}
 
 
 	// --------------------------------------------------------------------------						
@@ -734,7 +1456,7 @@ namespace shh {
 	template<class T> const T Dictionary<KEY>::GetFromIt(const OrderedVariablesConstIterator& it, const T& defaultValue) const
 	{
 		T value;
-		if (it == myOrderedVariables.end() || !it->second->Get(value))
+		if (it == OrderedEnd() || !it->second->Get(value))
 			return defaultValue;
 		else
 			return value;
@@ -743,18 +1465,20 @@ namespace shh {
 
 	// --------------------------------------------------------------------------						
 	// Function:	GetPtr
-	// Description:	returns variable pointer from iterator of ordered dictionary
-	// Arguments:	none
+	// Description:	returns variable pointer to change from iterator of ordered 
+	//				dictionary, found by key as the iterator may be into a 
+	//				table since unshared
+	// Arguments:	iterator, default value if not found
 	// Returns:		variable
 	// --------------------------------------------------------------------------
 	template<typename KEY>
 	template<class T> T* Dictionary<KEY>::GetPtr(const OrderedVariablesConstIterator& it, T* defaultValue)
 	{
-		T* value;
-		if (it == myOrderedVariables.end() || !it->second->GetPtr(value))
+		if (it == OrderedEnd())
 			return defaultValue;
-		else
-			return value;
+
+		KEY key(*it->first);
+		return GetPtr(key, defaultValue);
 	}
 
 
@@ -766,7 +1490,7 @@ namespace shh {
 	// --------------------------------------------------------------------------
 	template<typename KEY> int Dictionary<KEY>::IncNextArrayIndex() 
 	{ 
-		return myNextArrayIndex++; 
+		return GetUniqueTable().myNextArrayIndex++; 
 	}
 
 
@@ -778,7 +1502,7 @@ namespace shh {
 	// --------------------------------------------------------------------------
 	template<typename KEY> int Dictionary<KEY>::GetNextArrayIndex() const 
 	{ 
-		return myNextArrayIndex; 
+		return myTable == NULL ? 0 : myTable->myNextArrayIndex; 
 	}
 
 
@@ -790,8 +1514,8 @@ namespace shh {
 	// --------------------------------------------------------------------------
 	template<typename KEY> void Dictionary<KEY>::SetNextArrayIndex(unsigned int i)
 	{
-		if (i > myNextArrayIndex)
-			myNextArrayIndex = i;
+		if (i > (unsigned int)GetNextArrayIndex())
+			GetUniqueTable().myNextArrayIndex = i;
 	}
 
 
@@ -803,50 +1527,32 @@ namespace shh {
 	// --------------------------------------------------------------------------
 	template<typename KEY> void Dictionary<KEY>::Clean()
 	{
-		for (VariablesIterator it = myVariables.begin(); it != myVariables.end(); it++)
-		{
-			delete it->first;
-			delete it->second;
-		}
-		myVariables.clear();
-
-		for (OrderedVariablesIterator oit = myOrderedVariables.begin(); oit != myOrderedVariables.end(); oit++)
-			((Sorter*)(&oit->first))->Null();
-		myOrderedVariables.clear();
-		myNextArrayIndex = 0;
+		Release();
 	}
 
 
 	// --------------------------------------------------------------------------						
 	// Function:	Merges
-	// Description:	merges other dictionary into this
+	// Description:	merges other dictionary into this, sub dictionaries of the
+	//				same key type are merged recursively
 	// Arguments:	other dictionary
 	// Returns:		none
 	// --------------------------------------------------------------------------
 	template<typename KEY> void Dictionary<KEY>::Merge(const Dictionary<KEY>& other)
 	{
-		for (StringKeyDictionary::VariablesConstIterator it = other.Begin(); it != other.End(); it++)
+		Dictionary<KEY> source(other);
+		for (VariablesConstIterator it = source.Begin(); it != source.End(); it++)
 		{
-			KEY name = *it->first;
-			if (!Exists(name))
-			{
-				Set(name, it->second);
-			}
+			const Dictionary<KEY>* otherSubDict = source.GetConstPtr(it, (const Dictionary<KEY>*)NULL);
+			Dictionary<KEY>* subDict = otherSubDict == NULL ? NULL : GetPtr(*it->first, (Dictionary<KEY>*)NULL);
+			if (subDict != NULL)
+				subDict->Merge(*otherSubDict);
 			else
-			{
-				Dictionary<KEY> otherSubDict;
-				bool ok1 = it->second->Get(otherSubDict);
-				Dictionary<KEY> subDict;
-				subDict = Get(name, subDict);
-				if (ok1 && subDict.Size() != 0)
-					subDict.Merge(otherSubDict);
-				else
-					Set(name, it->second);
-			}
+				Set(*it->first, *it->second);
 		}
-
 	}
 
+
 	// --------------------------------------------------------------------------						
 	// Function:	NewKey
 	// Description:	clones key
@@ -864,25 +1570,75 @@ namespace shh {
 
 
 	// --------------------------------------------------------------------------						
-	// Function:	AddSorter
-	// Description:	adds key to ordered list of keys with pointer to variable
-	// Arguments:	key, variable pointer
+	// Function:	Hash
+	// Description:	hashes key and spreads it over all bits
+	// Arguments:	key
+	// Returns:		hash
+	// --------------------------------------------------------------------------
+	template<typename KEY> unsigned int Dictionary<KEY>::Hash(const KEY& variableKey)
+	{
+		unsigned long long hash = (unsigned long long)HashValue(variableKey) * 0x9E3779B97F4A7C15ull;
+		return (unsigned int)(hash >> 32);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	GetUniqueTable
+	// Description:	gets table to change, copying it first if it is shared
+	// Arguments:	none
+	// Returns:		table
+	// --------------------------------------------------------------------------
+	template<typename KEY> typename Dictionary<KEY>::Table& Dictionary<KEY>::GetUniqueTable()
+	{
+		if (myTable == NULL)
+		{
+			myTable = new Table;
+		}
+		else if (myTable->myReferences != 1)
+		{
+			Table* table = new Table(*myTable);
+			Release();
+			myTable = table;
+		}
+		return *myTable;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Release
+	// Description:	releases reference to table, deleting it if last one
+	// Arguments:	none
 	// Returns:		none
 	// --------------------------------------------------------------------------
-	template<typename KEY> void Dictionary<KEY>::AddSorter(const KEY& variableKey, Variant* n)
+	template<typename KEY> void Dictionary<KEY>::Release()
 	{
-		OrderedVariablesIterator oit = myOrderedVariables.begin();
-		OrderedVariablesIterator oend = myOrderedVariables.end();
-		while (oit != oend)
+		if (myTable != NULL && --myTable->myReferences == 0)
+			delete myTable;
+		myTable = NULL;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Adopt
+	// Description:	adds key with a heap variant the dictionary takes ownership of
+	// Arguments:	key, variant, sort id
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	template<typename KEY> void Dictionary<KEY>::Adopt(const KEY& variableKey, Variant* variant, unsigned int sortId)
+	{
+		unsigned int hash = Hash(variableKey);
+		Table& table = GetUniqueTable();
+		int i = table.Find(variableKey, hash);
+		if (i >= 0)
 		{
-			if (*oit->first.myKey == variableKey)
-			{
-				oit->second = n;
-				return;
-			}
-			oit++;
+			table.myEntries[i].AdoptValue(variant);
+		}
+		else
+		{
+			Entry entry(variableKey, hash, sortId);
+			entry.AdoptValue(variant);
+			table.Insert(entry);
 		}
-		myOrderedVariables[Sorter(variableKey, IncNextArrayIndex())] = n;
 	}
 
 
@@ -904,10 +1660,10 @@ namespace shh {
 	template<typename KEY> bool Dictionary<KEY>::ReadPrivileges(const std::string& name, Privileges& privileges) const
 	{
 		privileges = NoPrivilege;
-		ArrayKeyDictionary p;
-		p = Get(name, p);
+		ArrayKeyDictionary none;
+		const ArrayKeyDictionary* p = GetConstPtr(name, &none);
 
-		for (ArrayKeyDictionary::VariablesConstIterator pit = p.Begin(); pit != p.End(); pit++)
+		for (ArrayKeyDictionary::VariablesConstIterator pit = p->Begin(); pit != p->End(); pit++)
 		{
 			std::string id;
 			if (pit->second->Get(id))
@@ -26,6 +26,8 @@
 
 
 #include "SecureStl.h"
+#include <type_traits>
+#include <utility>
 
 
 namespace shh {
@@ -44,13 +46,17 @@ namespace shh {
 		explicit GCPtrInterface(T* object);
 		template< typename Other > GCPtrInterface(GCPtrInterface<Other, BASE> const& other);
 		template< typename Other > GCPtrInterface(GCPtrInterface<Other, BASE> const& other, bool dummy);
+		template< typename Other, typename = typename std::enable_if<std::is_convertible<Other*, T*>::value>::type > GCPtrInterface(GCPtrInterface<Other, BASE>&& other);
 		GCPtrInterface(GCPtrInterface const& other);
+		GCPtrInterface(GCPtrInterface&& other);
 		~GCPtrInterface();
 
 
 		template< typename Other > inline bool DynamicCast(GCPtrInterface<Other, BASE> const& other);
 		template< typename Other > inline bool StaticCast(GCPtrInterface<Other, BASE> const& other);
 		template< typename Other > inline GCPtrInterface& operator=(GCPtrInterface< Other, BASE > const& other);
+		inline GCPtrInterface& operator=(GCPtrInterface const& other);
+		inline GCPtrInterface& operator=(GCPtrInterface&& other);
 		template< typename Other > inline bool operator<(GCPtrInterface< Other, BASE > const& other) const;
 		inline operator bool() const;
 
@@ -181,10 +187,35 @@ namespace shh {
 	// Arguments:	ptr to object this will point to
 	// Returns:		none
 	// --------------------------------------------------------------------------
+	// --------------------------------------------------------------------------						
+	// Function:	GCPtrInterface
+	// Description:	move constructor from pointer to derived type
+	// Arguments:	ptr to object this will point to, left null
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	template< typename T, template <typename> class BASE> 
+	template< typename Other, typename > GCPtrInterface<T, BASE>::GCPtrInterface(GCPtrInterface<Other, BASE>&& other) :
+		BASE<T>(std::move((BASE<Other>&)other))
+	{ 
+	}
+	
+
 	template< typename T, template <typename> class BASE> GCPtrInterface<T, BASE>::GCPtrInterface(GCPtrInterface const& other) :
 		BASE<T>(other)
 	{ 
 	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	GCPtrInterface
+	// Description:	move constructor
+	// Arguments:	ptr to object this will point to, left null
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	template< typename T, template <typename> class BASE> GCPtrInterface<T, BASE>::GCPtrInterface(GCPtrInterface&& other) :
+		BASE<T>(std::move((BASE<T>&)other))
+	{ 
+	}
 	
 
 	// --------------------------------------------------------------------------						
@@ -240,6 +271,34 @@ namespace shh {
 	}
 
 
+	// --------------------------------------------------------------------------						
+	// Function:	=
+	// Description:	assigns pointer
+	// Arguments:	pointer to set to
+	// Returns:		this
+	// --------------------------------------------------------------------------	
+	template< typename T, template <typename> class BASE>
+	inline GCPtrInterface<T, BASE>& GCPtrInterface<T, BASE>::operator=(GCPtrInterface const& other)
+	{ 
+		BASE<T>::operator=(other);
+		return *this;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	=
+	// Description:	move assigns pointer
+	// Arguments:	pointer to set to, left null
+	// Returns:		this
+	// --------------------------------------------------------------------------	
+	template< typename T, template <typename> class BASE>
+	inline GCPtrInterface<T, BASE>& GCPtrInterface<T, BASE>::operator=(GCPtrInterface&& other)
+	{ 
+		BASE<T>::operator=(std::move((BASE<T>&)other));
+		return *this;
+	}
+
+
 	// --------------------------------------------------------------------------						
 	// Function:	<
 	// Description:	test if object address if less than other pointer
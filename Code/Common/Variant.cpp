@@ -23,6 +23,7 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 #include "Variant.h"
+#include "Dictionary.h"
 
 
 #ifdef _MSC_VER
@@ -35,5 +36,34 @@ namespace shh
 {
 
 	unsigned int Variant::ourLastTypeId = 0;
-	
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Accept
+	// Description:	calls the visitor function matching the kind of value
+	// Arguments:	visitor
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void Variant::Accept(VariantVisitor& visitor) const
+	{
+		switch (GetKind())
+		{
+		case NullKind: visitor.Visit(GetUnchecked<NullType>()); break;
+		case BoolKind: visitor.Visit(GetUnchecked<bool>()); break;
+		case IntKind: visitor.Visit(GetUnchecked<int>()); break;
+		case UnsignedIntKind: visitor.Visit(GetUnchecked<unsigned int>()); break;
+		case LongKind: visitor.Visit(GetUnchecked<long>()); break;
+		case UnsignedLongKind: visitor.Visit(GetUnchecked<unsigned long>()); break;
+		case LongLongKind: visitor.Visit(GetUnchecked<long long>()); break;
+		case UnsignedLongLongKind: visitor.Visit(GetUnchecked<unsigned long long>()); break;
+		case FloatKind: visitor.Visit(GetUnchecked<float>()); break;
+		case DoubleKind: visitor.Visit(GetUnchecked<double>()); break;
+		case StringKind: visitor.Visit(GetUnchecked<std::string>()); break;
+		case StringKeyDictionaryKind: visitor.Visit(GetUnchecked<StringKeyDictionary>()); break;
+		case ArrayKeyDictionaryKind: visitor.Visit(GetUnchecked<ArrayKeyDictionary>()); break;
+		case VariantKeyDictionaryKind: visitor.Visit(GetUnchecked<VariantKeyDictionary>()); break;
+		default: visitor.Visit(*this); break;
+		}
+	}
+
 }
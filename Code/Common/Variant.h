@@ -28,13 +28,18 @@
 #include "TypeLog.h"
 #include <map>
 #include <string>
+#include <functional>
+#include <new>
+#include <type_traits>
 
 
 namespace shh {
 
 	class IOInterface;
+	class VariantVisitor;
 	template<class V> class NonVariant;
 	template<class V> class IONonVariant;
+	template<typename KEY> class Dictionary;
 
 	// Variant /////////////////////////////////////////////////////////////
 
@@ -52,17 +57,28 @@ namespace shh {
 			bool operator!=(const NullType& other) const { return true; }
 		};
 
+		enum Kind { 
+			OtherKind, NullKind, BoolKind, IntKind, UnsignedIntKind, LongKind, UnsignedLongKind, 
+			LongLongKind, UnsignedLongLongKind, FloatKind, DoubleKind, StringKind, 
+			StringKeyDictionaryKind, ArrayKeyDictionaryKind, VariantKeyDictionaryKind 
+		};
+
 		virtual ~Variant() {};
 		template<class T> bool Get(T& value) const;
 		template<class T> bool GetPtr(T*& value) const;
 		template<class T> bool IsType(const T* t = NULL) const;
+		template<class T> const T& GetUnchecked() const;
+		void Accept(VariantVisitor& visitor) const;
 
 		virtual const void* GetValuePtr() const = 0;
 		virtual unsigned int GetTypeId() const = 0;
+		virtual Kind GetKind() const = 0;
 		virtual BaseType* GetRegisteredType() const = 0;
 
 		virtual const Variant* New() = 0;
 		virtual Variant* NewClone() const = 0;
+		virtual Variant* NewClone(void* memory, unsigned int size) const = 0;
+		virtual size_t GetHash() const = 0;
 
 		virtual Variant &ConvertToIO() const = 0;
 		virtual void Write(IOInterface& io, unsigned int version) const = 0;
@@ -105,10 +121,13 @@ namespace shh {
 
 		static unsigned int GetOurTypeId();
 		virtual unsigned int GetTypeId() const;
+		virtual Kind GetKind() const;
 		virtual BaseType* GetRegisteredType() const;
 
 		virtual const Variant* New();
 		virtual Variant* NewClone() const;
+		virtual Variant* NewClone(void* memory, unsigned int size) const;
+		virtual size_t GetHash() const;
 		
 		virtual Variant& ConvertToIO() const;
 		virtual void Write(IOInterface& io, unsigned int version) const;
@@ -127,7 +146,82 @@ namespace shh {
 	};
 
 
-	template<class V> unsigned int NonVariant<V>::ourTypeId = Variant::GetNextTypeId();
+	template<class V> unsigned int NonVariant<V>::ourTypeId = NonVariant<V>::GetOurTypeId();
+
+
+	// VariantKindOf /////////////////////////////////////////////////////////////
+
+	template<class V> class VariantKindOf { public: static const Variant::Kind ourKind = Variant::OtherKind; };
+	template<> class VariantKindOf<Variant::NullType> { public: static const Variant::Kind ourKind = Variant::NullKind; };
+	template<> class VariantKindOf<bool> { public: static const Variant::Kind ourKind = Variant::BoolKind; };
+	template<> class VariantKindOf<int> { public: static const Variant::Kind ourKind = Variant::IntKind; };
+	template<> class VariantKindOf<unsigned int> { public: static const Variant::Kind ourKind = Variant::UnsignedIntKind; };
+	template<> class VariantKindOf<long> { public: static const Variant::Kind ourKind = Variant::LongKind; };
+	template<> class VariantKindOf<unsigned long> { public: static const Variant::Kind ourKind = Variant::UnsignedLongKind; };
+	template<> class VariantKindOf<long long> { public: static const Variant::Kind ourKind = Variant::LongLongKind; };
+	template<> class VariantKindOf<unsigned long long> { public: static const Variant::Kind ourKind = Variant::UnsignedLongLongKind; };
+	template<> class VariantKindOf<float> { public: static const Variant::Kind ourKind = Variant::FloatKind; };
+	template<> class VariantKindOf<double> { public: static const Variant::Kind ourKind = Variant::DoubleKind; };
+	template<> class VariantKindOf<std::string> { public: static const Variant::Kind ourKind = Variant::StringKind; };
+	template<> class VariantKindOf<Dictionary<std::string> > { public: static const Variant::Kind ourKind = Variant::StringKeyDictionaryKind; };
+	template<> class VariantKindOf<Dictionary<unsigned int> > { public: static const Variant::Kind ourKind = Variant::ArrayKeyDictionaryKind; };
+	template<> class VariantKindOf<Dictionary<Variant> > { public: static const Variant::Kind ourKind = Variant::VariantKeyDictionaryKind; };
+
+
+	// VariantVisitor /////////////////////////////////////////////////////////////
+
+	class VariantVisitor
+	{
+
+	public:
+
+		virtual ~VariantVisitor() {}
+
+		virtual void Visit(const Variant::NullType& value) {}
+		virtual void Visit(bool value) {}
+		virtual void Visit(int value) {}
+		virtual void Visit(unsigned int value) {}
+		virtual void Visit(long value) {}
+		virtual void Visit(unsigned long value) {}
+		virtual void Visit(long long value) {}
+		virtual void Visit(unsigned long long value) {}
+		virtual void Visit(float value) {}
+		virtual void Visit(double value) {}
+		virtual void Visit(const std::string& value) {}
+		virtual void Visit(const Dictionary<std::string>& value) {}
+		virtual void Visit(const Dictionary<unsigned int>& value) {}
+		virtual void Visit(const Dictionary<Variant>& value) {}
+		virtual void Visit(const Variant& other) {}
+	};
+
+
+
+	// Hash Helpers /////////////////////////////////////////////////////////////////////
+
+	// --------------------------------------------------------------------------						
+	// Function:	HashValue
+	// Description:	hashes a value, types with no hash all hash to zero so are 
+	//				only told apart by their type id and equality
+	// Arguments:	value
+	// Returns:		hash
+	// --------------------------------------------------------------------------
+	template<class V> inline typename std::enable_if<std::is_arithmetic<V>::value || std::is_pointer<V>::value, size_t>::type HashValue(const V& value)
+	{
+		return std::hash<V>()(value);
+	}
+	template<class V> inline typename std::enable_if<!std::is_arithmetic<V>::value && !std::is_pointer<V>::value, size_t>::type HashValue(const V& value)
+	{
+		return 0;
+	}
+	inline size_t HashValue(const std::string& value)
+	{
+		return std::hash<std::string>()(value);
+	}
+	inline size_t HashValue(const Variant& value)
+	{
+		return value.GetHash();
+	}
+
 
 	// Variant Inlines //////////////////////////////////////////////////////////////////
 	
@@ -140,10 +234,9 @@ namespace shh {
 	// --------------------------------------------------------------------------
 	template<class T> bool Variant::Get(T& value) const
 	{
-		const NonVariant<T>* v = dynamic_cast<const NonVariant<T>*>(this);
-		if (!v)
+		if (GetTypeId() != NonVariant<T>::GetOurTypeId())
 			return false;
-		value = v->GetValue();
+		value = static_cast<const NonVariant<T>*>(this)->GetValue();
 		return true;
 	}
 
@@ -156,10 +249,9 @@ namespace shh {
 	// --------------------------------------------------------------------------
 	template<class T> bool Variant::GetPtr(T*& value) const
 	{
-		const NonVariant<T>* v = dynamic_cast<const NonVariant<T>*>(this);
-		if (!v)
+		if (GetTypeId() != NonVariant<T>::GetOurTypeId())
 			return false;
-		value = (T*)&v->GetValue();
+		value = (T*)&static_cast<const NonVariant<T>*>(this)->GetValue();
 		return true;
 	}
 
@@ -172,11 +264,19 @@ namespace shh {
 	// --------------------------------------------------------------------------
 	template<class T> bool Variant::IsType(const T* t) const
 	{
-		NonVariant<T> const* const v = dynamic_cast<NonVariant<T> const* const>(this);
-		if (v == NULL)
-			return false;
-		else
-			return true;
+		return GetTypeId() == NonVariant<T>::GetOurTypeId();
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	GetUnchecked
+	// Description:	gets value of a type already checked with GetKind or IsType
+	// Arguments:	none
+	// Returns:		value
+	// --------------------------------------------------------------------------
+	template<class T> const T& Variant::GetUnchecked() const
+	{
+		return static_cast<const NonVariant<T>*>(this)->GetValue();
 	}
 
 
@@ -274,7 +374,9 @@ namespace shh {
 	// --------------------------------------------------------------------------
 	template<class V> unsigned int NonVariant<V>::GetOurTypeId() 
 	{ 
-		return ourTypeId; 
+		// assigned on first use so it is valid during static initialization
+		static const unsigned int id = Variant::GetNextTypeId();
+		return id; 
 	}
 
 
@@ -286,7 +388,19 @@ namespace shh {
 	// --------------------------------------------------------------------------
 	template<class V> unsigned int NonVariant<V>::GetTypeId() const 
 	{ 
-		return ourTypeId; 
+		return GetOurTypeId(); 
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	GetKind
+	// Description:	get which of the common types the value is
+	// Arguments:	none
+	// Returns:		kind
+	// --------------------------------------------------------------------------
+	template<class V> Variant::Kind NonVariant<V>::GetKind() const 
+	{ 
+		return VariantKindOf<V>::ourKind; 
 	}
 
 
@@ -326,6 +440,33 @@ namespace shh {
 	}
 
 
+	// --------------------------------------------------------------------------						
+	// Function:	NewClone
+	// Description:	create clone of this in given memory if it is small and 
+	//				trivially copyable, so it can be stored inline by owners
+	// Arguments:	memory, size of memory
+	// Returns:		new object or NULL if it does not fit
+	// --------------------------------------------------------------------------
+	template<class V> Variant* NonVariant<V>::NewClone(void* memory, unsigned int size) const 
+	{ 
+		if (!std::is_trivially_copyable<V>::value || sizeof(NonVariant<V>) > size)
+			return NULL;
+		return new (memory) NonVariant<V>(myValue); 
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	GetHash
+	// Description:	hashes type and value
+	// Arguments:	none
+	// Returns:		hash
+	// --------------------------------------------------------------------------
+	template<class V> size_t NonVariant<V>::GetHash() const 
+	{ 
+		return HashValue(myValue) ^ ((size_t)GetOurTypeId() * 0x9E3779B9u); 
+	}
+
+
 	// --------------------------------------------------------------------------						
 	// Function:	Write
 	// Description:	writes variant to file
@@ -354,7 +495,7 @@ namespace shh {
 	// --------------------------------------------------------------------------
 	template<class V> bool NonVariant<V>::operator<(const Variant& other) const 
 	{ 
-		return ourTypeId < other.GetTypeId() || (ourTypeId == other.GetTypeId() && myValue < *(V*)other.GetValuePtr()); 
+		return GetOurTypeId() < other.GetTypeId() || (GetOurTypeId() == other.GetTypeId() && myValue < *(V*)other.GetValuePtr()); 
 	}
 
 
@@ -368,7 +509,7 @@ namespace shh {
 	// --------------------------------------------------------------------------
 	template<class V> bool NonVariant<V>::operator==(const Variant& other) const 
 	{ 
-		return ourTypeId == other.GetTypeId() && myValue == *(V*)other.GetValuePtr(); 
+		return GetOurTypeId() == other.GetTypeId() && myValue == *(V*)other.GetValuePtr(); 
 	}
 
 
@@ -380,7 +521,7 @@ namespace shh {
 	// --------------------------------------------------------------------------
 	template<class V> bool NonVariant<V>::operator!=(const Variant& other) const 
 	{ 
-		return ourTypeId != other.GetTypeId() && myValue != *(V*)other.GetValuePtr(); 
+		return GetOurTypeId() != other.GetTypeId() || !(myValue == *(V*)other.GetValuePtr()); 
 	}
 
 
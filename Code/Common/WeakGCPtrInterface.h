@@ -0,0 +1,124 @@
+///////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2025 David K Bhowmik. All rights reserved.
+// This file is part of shhArc.
+//
+// This Software is available under the MIT License with a No Modification clause.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this file and associated documentation files (the "Software"), to use the
+// Software for any purpose, including commercial applications, provided that:
+//
+//   1. You do NOT modify, alter, or create derivative works of this file.
+//   2. Redistributions must include this notice and may only distribute it 
+//      unmodified.
+//
+// The full MIT License text, including this Custom No Modification clause,
+// is available in the LICENSE file in the root of the project.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND.
+//
+// You may alternatively use this source under the terms of a specific 
+// version of the shhArc Unrestricted License provided you have obtained 
+// such a license from the copyright holder.
+///////////////////////////////////////////////////////////////////////////////
+#ifndef WEAKGCPTRINTERFACE_H
+#define WEAKGCPTRINTERFACE_H
+
+
+#include "GCPtrInterface.h"
+
+
+namespace shh {
+
+
+	// WeakGCPtrInterface ///////////////////////////////////////////////////////////////////////
+
+	template< typename T, template <typename> class BASE, template <typename> class WEAKBASE> class WeakGCPtrInterface : public WEAKBASE<T>
+	{
+	public:
+
+		WeakGCPtrInterface();
+		template< typename Other > WeakGCPtrInterface(GCPtrInterface<Other, BASE> const& strong);
+
+		template< typename Other > inline WeakGCPtrInterface& operator=(GCPtrInterface<Other, BASE> const& strong);
+		inline operator bool() const;
+
+		inline GCPtrInterface<T, BASE> Lock() const;
+
+	};
+
+
+
+	// WeakGCPtr Inlines ////////////////////////////////////////////////////////////////
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	WeakGCPtrInterface
+	// Description:	constructor
+	// Arguments:	none
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	template< typename T, template <typename> class BASE, template <typename> class WEAKBASE> 
+	WeakGCPtrInterface<T, BASE, WEAKBASE>::WeakGCPtrInterface() :
+		WEAKBASE<T>()
+	{
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	WeakGCPtrInterface
+	// Description:	constructor
+	// Arguments:	strong pointer to observe
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	template< typename T, template <typename> class BASE, template <typename> class WEAKBASE> 
+	template< typename Other > WeakGCPtrInterface<T, BASE, WEAKBASE>::WeakGCPtrInterface(GCPtrInterface<Other, BASE> const& strong) :
+		WEAKBASE<T>(strong)
+	{
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	=
+	// Description:	observe object pointed to by strong pointer
+	// Arguments:	strong pointer
+	// Returns:		this
+	// --------------------------------------------------------------------------
+	template< typename T, template <typename> class BASE, template <typename> class WEAKBASE> 
+	template< typename Other > inline WeakGCPtrInterface<T, BASE, WEAKBASE>& WeakGCPtrInterface<T, BASE, WEAKBASE>::operator=(GCPtrInterface<Other, BASE> const& strong)
+	{
+		WEAKBASE<T>::operator=(strong);
+		return *this;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	bool
+	// Description:	test if object observed is still alive
+	// Arguments:	none
+	// Returns:		bool
+	// --------------------------------------------------------------------------
+	template< typename T, template <typename> class BASE, template <typename> class WEAKBASE> 
+	inline WeakGCPtrInterface<T, BASE, WEAKBASE>::operator bool() const
+	{
+		return WEAKBASE<T>::IsValid();
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Lock
+	// Description:	gets a strong pointer to the object observed
+	// Arguments:	none
+	// Returns:		strong pointer, null if object is dead
+	// --------------------------------------------------------------------------
+	template< typename T, template <typename> class BASE, template <typename> class WEAKBASE> 
+	inline GCPtrInterface<T, BASE> WeakGCPtrInterface<T, BASE, WEAKBASE>::Lock() const
+	{
+		GCPtrInterface<T, BASE> strong;
+		WEAKBASE<T>::Lock(strong);
+		return strong;
+	}
+
+}
+
+#endif // WEAKGCPTRINTERFACE_H
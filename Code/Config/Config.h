@@ -30,6 +30,18 @@
 
 #define USE_SHHARC_MEMORY_MANAGEMENT 1
 
+// number of free blocks each thread caches per allocator so allocation and
+// deallocation do not need to lock (0 disables the caches)
+#define ALLOCATOR_MAGAZINE_SIZE 32
+
+// buffer objects whose reference count drops without reaching zero so the
+// cycle collector can reclaim unreachable GCPtr cycles between updates
+#define GC_CYCLE_COLLECTION 1
+
+// allow live bytes of memory managed types, lua processes and realms to be
+// profiled when switched on by the memory config
+#define MEMORY_PROFILING 1
+
 #define USE_TIMEOUTS 0
 #define MULTI_THREADED 0
 #define LUA_DEBUG_LIB 1
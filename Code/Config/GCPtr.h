@@ -25,15 +25,19 @@
 
 #include "../Common/GCPtrInterface.h"
 #include "../Common/GCObjectInterface.h"
+#include "../Common/WeakGCPtrInterface.h"
 #include "../GCPtr/GCPtrBase.h"
+#include "../GCPtr/WeakGCPtrBase.h"
 
 #define GCOBJECTBASE GCObjectBase
 #define GCPTRBASE GCPtrBase
+#define WEAKGCPTRBASE WeakGCPtrBase
 
 namespace shh {
 
 	typedef GCObjectInterface<GCOBJECTBASE> GCObject;
 	template <typename T> using GCPtr = GCPtrInterface<T, GCPTRBASE>;
+	template <typename T> using WeakGCPtr = WeakGCPtrInterface<T, GCPTRBASE, WEAKGCPTRBASE>;
 	
 	// --------------------------------------------------------------------------						
 	// Function:	DestroyObjectVirtuallyIfPossible
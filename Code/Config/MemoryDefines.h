@@ -33,17 +33,24 @@
 #define IMPLEMENT_NOT_MEMORY_MANAGED(CLASS)
 #define MOT_CONFIGURE_MEMORYMANAGEMENT(DICT)
 #define MOT_UPDATE_MEMORYMANAGER(ARG)
+#define NOT_DUMP_MEMORY_PROFILE(FILE) false
 
 #if USE_SHHARC_MEMORY_MANAGEMENT
 #define CONFIGURE_MEMORYMANAGEMENT(DICT) CONFIGURE_SHHARC_MEMORYMANAGEMENT(DICT)
 #define UPDATE_MEMORYMANAGER(ARG) UPDATE_SHHARC_MEMORYMANAGER(ARG)
+#define DUMP_MEMORY_PROFILE(FILE) DUMP_SHHARC_MEMORY_PROFILE(FILE)
 #define DECLARE_MEMORY_MANAGED(CLASS) DECLARE_SHHARC_MEMORY_MANAGED(CLASS)
 #define IMPLEMENT_MEMORY_MANAGED(CLASS) IMPLEMENT_SHHARC_MEMORY_MANAGED(CLASS)
+#define DECLARE_COMPACT_MEMORY_MANAGED(CLASS) DECLARE_SHHARC_COMPACT_MEMORY_MANAGED(CLASS)
+#define IMPLEMENT_COMPACT_MEMORY_MANAGED(CLASS) IMPLEMENT_SHHARC_COMPACT_MEMORY_MANAGED(CLASS)
 #else
 #define CONFIGURE_MEMORYMANAGEMENT(DICT) MOT_CONFIGURE_MEMORYMANAGEMENT(DICT)
 #define UPDATE_MEMORYMANAGER(ARG) MOT_UPDATE_MEMORYMANAGER(ARG)
+#define DUMP_MEMORY_PROFILE(FILE) NOT_DUMP_MEMORY_PROFILE(FILE)
 #define DECLARE_MEMORY_MANAGED(CLASS) DECLARE_NOT_MANAGED(CLASS)
 #define IMPLEMENT_MEMORY_MANAGED(CLASS) IMPLEMENT_NOT_MEMORY_MANAGED(CLASS)
+#define DECLARE_COMPACT_MEMORY_MANAGED(CLASS) DECLARE_NOT_MEMORY_MANAGED(CLASS)
+#define IMPLEMENT_COMPACT_MEMORY_MANAGED(CLASS) IMPLEMENT_NOT_MEMORY_MANAGED(CLASS)
 #endif
 
 
@@ -79,6 +79,28 @@ public:
 };
 
 
+// kernel for DemoKernelNode, copies each input interface to the output
+// interface of the same name for every node of the class in one call,
+// node "3" of Schemas/test.schema runs through it
+void DemoKernel(const NodeKernel::Batch& batch, double delta)
+{
+	for (unsigned int n = 0; n != batch.size(); n++)
+	{
+		Node::Interface& inputs = batch[n]->GetInputs();
+		Node::Interface& outputs = batch[n]->GetOutputs();
+		for (Node::Interface::iterator it = inputs.begin(); it != inputs.end(); it++)
+		{
+			Node::Interface::iterator out = outputs.find(it->first);
+			if (out != outputs.end())
+			{
+				for (unsigned int i = 0; i != it->second.size() && i != out->second.size(); i++)
+					out->second[i] = it->second[i];
+			}
+		}
+	}
+}
+
+
 int TestAgent();
 
 
@@ -123,6 +145,10 @@ int TestAgent()
 		GCPtr<Class> cls = Api::CreateClass("DemoHardNode", "Node", demoProcess, GENERICPROCESSCREATE, NODECREATE);
 		Api::RegisterHardClass(cls);
 
+		GCPtr<Class> kernelCls = Api::CreateClass("DemoKernelNode", "Node", demoProcess, GENERICPROCESSCREATE, NODECREATE);
+		Api::RegisterHardClass(kernelCls);
+		Api::RegisterNodeKernel("DemoKernelNode", DemoKernel);
+
 		Api::CreateGod("test", "god");
 		GCPtr<God> god = Api::GetGod();
 
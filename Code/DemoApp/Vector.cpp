@@ -24,6 +24,6 @@
 
 namespace shh {
 
-	IMPLEMENT_MEMORY_MANAGED(Vector);
+	IMPLEMENT_COMPACT_MEMORY_MANAGED(Vector);
 
 }
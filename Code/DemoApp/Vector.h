@@ -30,7 +30,7 @@
 namespace shh {
 	class  Vector : public GCObject
 	{
-		DECLARE_MEMORY_MANAGED(Vector);
+		DECLARE_COMPACT_MEMORY_MANAGED(Vector);
 
 
 	public:
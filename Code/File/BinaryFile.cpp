@@ -293,4 +293,91 @@ namespace shh
 		return IBinaryFile::Peek();
 	}
 
+
+	// BinaryBuffer //////////////////////////////////////////////////////////////////////////
+
+	// --------------------------------------------------------------------------						
+	// Function:	BinaryBuffer
+	// Description:	constructor, empty buffer in memory 
+	// Arguments:	none
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	BinaryBuffer::BinaryBuffer()
+	{
+		BinaryBuffer::Open(std::string(), IOInterface::None);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	BinaryBuffer
+	// Description:	constructor, buffer in memory to read given bytes from
+	// Arguments:	bytes
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	BinaryBuffer::BinaryBuffer(const std::string& bytes)
+	{
+		BinaryBuffer::Open(bytes, IOInterface::None);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Open
+	// Description:	opens buffer holding given bytes
+	// Arguments:	bytes, flags
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void BinaryBuffer::Open(const std::string& bytes, IOInterface::Flags flags)
+	{
+		Close();
+		myStream = new std::stringstream(bytes, std::ios_base::in | std::ios_base::out | std::ios_base::binary);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	GetBytes
+	// Description:	returns bytes in buffer
+	// Arguments:	none
+	// Returns:		bytes
+	// --------------------------------------------------------------------------
+	std::string BinaryBuffer::GetBytes() const
+	{
+		return static_cast<std::stringstream*>(myStream)->str();
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Read
+	// Description:	reads number of chars into buffer
+	// Arguments:	buffer,number of chars
+	// Returns:		number of chars
+	// --------------------------------------------------------------------------
+	unsigned int BinaryBuffer::Read(char* buffer, unsigned int count)
+	{
+		return IBinaryFile::Read(buffer, count);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Write
+	// Description:	writes number of chars from  buffer
+	// Arguments:	buffer,number of chars
+	// Returns:		number of chars
+	// --------------------------------------------------------------------------
+	unsigned int BinaryBuffer::Write(const char* buffer, unsigned int count)
+	{
+		return OBinaryFile::Write(buffer, count);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Peek
+	// Description:	reads but does not move on
+	// Arguments:	none
+	// Returns:		value
+	// --------------------------------------------------------------------------
+	int BinaryBuffer::Peek()
+	{
+		return IBinaryFile::Peek();
+	}
+
 }
\ No newline at end of file
@@ -32,6 +32,7 @@
 #include <ios>
 #include <iostream>
 #include <fstream>
+#include <sstream>
 
 namespace shh
 {
@@ -107,6 +108,23 @@ namespace shh
 	};
 
 
+
+	class BinaryBuffer : public OBinaryFile, public IBinaryFile
+	{
+	public:
+
+		BinaryBuffer();
+		BinaryBuffer(const std::string& bytes);
+		void Open(const std::string& bytes, IOInterface::Flags flags);
+
+		std::string GetBytes() const;
+		virtual unsigned int Read(char* buffer, unsigned int count);
+		virtual unsigned int Write(const char* buffer, unsigned int count);
+		virtual int Peek();
+
+	};
+
+
 	// BaseBinaryFile Inlines //////////////////////////////////////////////////////////
 
 	// --------------------------------------------------------------------------						
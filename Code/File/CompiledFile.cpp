@@ -0,0 +1,810 @@
+///////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2025 David K Bhowmik. All rights reserved.
+// This file is part of shhArc.
+//
+// This Software is available under the MIT License with a No Modification clause.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this file and associated documentation files (the "Software"), to use the
+// Software for any purpose, including commercial applications, provided that:
+//
+//   1. You do NOT modify, alter, or create derivative works of this file.
+//   2. Redistributions must include this notice and may only distribute it 
+//      unmodified.
+//
+// The full MIT License text, including this Custom No Modification clause,
+// is available in the LICENSE file in the root of the project.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND.
+//
+// You may alternatively use this source under the terms of a specific 
+// version of the shhArc Unrestricted License provided you have obtained 
+// such a license from the copyright holder.
+///////////////////////////////////////////////////////////////////////////////
+#ifdef _WIN64
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "CompiledFile.h"
+#include "FileSystem.h"
+#include "JsonFile.h"
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <vector>
+#include <thread>
+#include <functional>
+
+namespace shh {
+
+	const std::string CompiledFile::ourCompiledExtension = "bin";
+	const unsigned int CompiledFile::ourVersion = 1;
+
+	static const char ourMagic[4] = { 's', 'h', 'h', 'c' };
+
+	struct CompiledHeader
+	{
+		char myMagic[4];
+		unsigned int myVersion;
+		unsigned int myStringCount;
+		unsigned int myStringsOffset;	// offset of string offset table
+		unsigned int myRootOffset;
+		unsigned int mySize;			// size of whole file
+	};
+
+	struct CompiledBlock
+	{
+		unsigned int myCount;
+		unsigned int myPadding;
+	};
+
+
+	// CompiledWriter /////////////////////////////////////////////////////////
+
+	class CompiledWriter
+	{
+	public:
+
+		void Write(const StringKeyDictionary& dict, std::vector<char>& buffer);
+
+	private:
+
+		typedef std::map<std::string, unsigned int> Strings;
+		typedef std::vector<CompiledDictionary::Entry> Entries;
+
+		std::vector<char> myBuffer;
+		Strings myStrings;
+		std::vector<const std::string*> myStringOrder;
+
+		unsigned int AddString(const std::string& str);
+		unsigned int WriteObject(const StringKeyDictionary& dict);
+		unsigned int WriteArray(const ArrayKeyDictionary& dict);
+		bool MakeEntry(const Variant& value, CompiledDictionary::Entry& entry);
+		unsigned int Append(const void* data, size_t size);
+		void Align(size_t alignment);
+	};
+
+
+
+	// CompiledDictionary //////////////////////////////////////////////////////
+
+	// --------------------------------------------------------------------------						
+	// Function:	CompiledDictionary
+	// Description:	constructor
+	// Arguments:	none
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	CompiledDictionary::CompiledDictionary() :
+		myFile(NULL),
+		myFileSize(0),
+		myEntries(NULL),
+		mySorted(NULL),
+		mySize(0),
+		myDepth(0),
+		myArray(false)
+	{}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	CompiledDictionary
+	// Description:	constructor, left invalid if block lies outside file or 
+	//				is nested too deeply
+	// Arguments:	mapped file, size of file, offset of block, if array, 
+	//				depth nested in root
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	CompiledDictionary::CompiledDictionary(const char* file, size_t fileSize, unsigned long long offset, bool isArray, unsigned int depth) :
+		CompiledDictionary()
+	{
+		if (depth > maxDepth || offset % sizeof(unsigned long long) != 0 || offset < sizeof(CompiledHeader) || 
+			offset > fileSize || fileSize - offset < sizeof(CompiledBlock))
+			return;
+
+		const CompiledBlock* block = (const CompiledBlock*)(file + offset);
+		unsigned long long end = offset + sizeof(CompiledBlock) + block->myCount * (unsigned long long)(sizeof(Entry) + (isArray ? 0 : sizeof(unsigned int)));
+		if (end > fileSize)
+			return;
+
+		myFile = file;
+		myFileSize = fileSize;
+		myEntries = (const Entry*)(block + 1);
+		mySorted = isArray ? NULL : (const unsigned int*)(myEntries + block->myCount);
+		mySize = block->myCount;
+		myDepth = depth;
+		myArray = isArray;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Find
+	// Description:	binary searches sorted index for key
+	// Arguments:	key
+	// Returns:		entry or NULL if not found
+	// --------------------------------------------------------------------------
+	const CompiledDictionary::Entry* CompiledDictionary::Find(const std::string& key) const
+	{
+		if (myArray)
+			return NULL;
+
+		unsigned int low = 0;
+		unsigned int high = mySize;
+		while (low < high)
+		{
+			unsigned int middle = low + (high - low) / 2;
+			unsigned int index = mySorted[middle];
+			unsigned int length;
+			const char* str = index < mySize ? GetString(myEntries[index].myKey, length) : NULL;
+			if (str == NULL)
+				return NULL;
+
+			int compare = key.compare(0, std::string::npos, str, length);
+			if (compare == 0)
+				return myEntries + index;
+			else if (compare < 0)
+				high = middle;
+			else
+				low = middle + 1;
+		}
+		return NULL;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Find
+	// Description:	finds array element, direct when keys are 0..n-1
+	// Arguments:	key
+	// Returns:		entry or NULL if not found
+	// --------------------------------------------------------------------------
+	const CompiledDictionary::Entry* CompiledDictionary::Find(unsigned int key) const
+	{
+		if (!myArray)
+			return NULL;
+
+		if (key < mySize && myEntries[key].myKey == key)
+			return myEntries + key;
+
+		for (const Entry* entry = Begin(); entry != End(); entry++)
+		{
+			if (entry->myKey == key)
+				return entry;
+		}
+		return NULL;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	GetKey
+	// Description:	gets key of object entry
+	// Arguments:	entry, key to return
+	// Returns:		if successful
+	// --------------------------------------------------------------------------
+	bool CompiledDictionary::GetKey(const Entry& entry, std::string& key) const
+	{
+		unsigned int length;
+		const char* str = myArray ? NULL : GetString(entry.myKey, length);
+		if (str == NULL)
+			return false;
+		key.assign(str, length);
+		return true;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	GetValue
+	// Description:	gets value of entry if of matching type
+	// Arguments:	entry, value to return
+	// Returns:		if of matching type
+	// --------------------------------------------------------------------------
+	bool CompiledDictionary::GetValue(const Entry& entry, bool& value) const
+	{
+		if (entry.myType != BoolType)
+			return false;
+		value = entry.myInteger != 0;
+		return true;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	GetValue
+	// Description:	gets value of entry if of matching type
+	// Arguments:	entry, value to return
+	// Returns:		if of matching type
+	// --------------------------------------------------------------------------
+	bool CompiledDictionary::GetValue(const Entry& entry, long& value) const
+	{
+		if (entry.myType != IntegerType)
+			return false;
+		value = (long)entry.myInteger;
+		return true;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	GetValue
+	// Description:	gets value of entry if of matching type
+	// Arguments:	entry, value to return
+	// Returns:		if of matching type
+	// --------------------------------------------------------------------------
+	bool CompiledDictionary::GetValue(const Entry& entry, double& value) const
+	{
+		if (entry.myType != RealType)
+			return false;
+		value = entry.myReal;
+		return true;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	GetValue
+	// Description:	gets value of entry if of matching type
+	// Arguments:	entry, value to return
+	// Returns:		if of matching type
+	// --------------------------------------------------------------------------
+	bool CompiledDictionary::GetValue(const Entry& entry, std::string& value) const
+	{
+		unsigned int length;
+		const char* str = entry.myType == StringType && entry.myOffset <= 0xFFFFFFFF ? GetString((unsigned int)entry.myOffset, length) : NULL;
+		if (str == NULL)
+			return false;
+		value.assign(str, length);
+		return true;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	GetValue
+	// Description:	gets view of sub object or array without reading it, 
+	//				blocks are written before their parents so one at or 
+	//				after its parent is damaged and could loop
+	// Arguments:	entry, value to return
+	// Returns:		if of matching type
+	// --------------------------------------------------------------------------
+	bool CompiledDictionary::GetValue(const Entry& entry, CompiledDictionary& value) const
+	{
+		value = CompiledDictionary();
+		unsigned long long offset = (const char*)myEntries - sizeof(CompiledBlock) - myFile;
+		if ((entry.myType != ObjectType && entry.myType != ArrayType) || entry.myOffset >= offset)
+			return false;
+		value = CompiledDictionary(myFile, myFileSize, entry.myOffset, entry.myType == ArrayType, myDepth + 1);
+		return value.IsValid();
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	GetValue
+	// Description:	expands sub object into dictionary
+	// Arguments:	entry, value to return
+	// Returns:		if of matching type
+	// --------------------------------------------------------------------------
+	bool CompiledDictionary::GetValue(const Entry& entry, StringKeyDictionary& value) const
+	{
+		CompiledDictionary sub;
+		return entry.myType == ObjectType && GetValue(entry, sub) && sub.Expand(value);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	GetValue
+	// Description:	expands sub array into dictionary
+	// Arguments:	entry, value to return
+	// Returns:		if of matching type
+	// --------------------------------------------------------------------------
+	bool CompiledDictionary::GetValue(const Entry& entry, ArrayKeyDictionary& value) const
+	{
+		CompiledDictionary sub;
+		return entry.myType == ArrayType && GetValue(entry, sub) && sub.Expand(value);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Expand
+	// Description:	reads whole object into dictionary
+	// Arguments:	dict to read into
+	// Returns:		if successful
+	// --------------------------------------------------------------------------
+	bool CompiledDictionary::Expand(StringKeyDictionary& dict) const
+	{
+		if (!IsValid() || myArray)
+			return false;
+
+		std::string key;
+		for (const Entry* entry = Begin(); entry != End(); entry++)
+		{
+			if (!GetKey(*entry, key) || !ExpandValue(*entry, dict, key))
+				return false;
+		}
+		return true;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Expand
+	// Description:	reads whole array into dictionary
+	// Arguments:	dict to read into
+	// Returns:		if successful
+	// --------------------------------------------------------------------------
+	bool CompiledDictionary::Expand(ArrayKeyDictionary& dict) const
+	{
+		if (!IsValid() || !myArray)
+			return false;
+
+		for (const Entry* entry = Begin(); entry != End(); entry++)
+		{
+			if (!ExpandValue(*entry, dict, entry->myKey))
+				return false;
+		}
+		return true;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	GetString
+	// Description:	looks up string in string table
+	// Arguments:	index of string, length to return
+	// Returns:		string or NULL if index or string out of bounds
+	// --------------------------------------------------------------------------
+	const char* CompiledDictionary::GetString(unsigned int index, unsigned int& length) const
+	{
+		const CompiledHeader* header = (const CompiledHeader*)myFile;
+		if (index >= header->myStringCount)
+			return NULL;
+
+		unsigned int offset = ((const unsigned int*)(myFile + header->myStringsOffset))[index];
+		if (offset % sizeof(unsigned int) != 0 || offset + (unsigned long long)sizeof(unsigned int) > myFileSize)
+			return NULL;
+
+		length = *(const unsigned int*)(myFile + offset);
+		if (offset + sizeof(unsigned int) + (unsigned long long)length > myFileSize)
+			return NULL;
+
+		return myFile + offset + sizeof(unsigned int);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	ExpandValue
+	// Description:	sets entry value in dict, sub objects and arrays are 
+	//				expanded in place in the dict rather than copied in
+	// Arguments:	entry, dict to set value in, key
+	// Returns:		if successful
+	// --------------------------------------------------------------------------
+	template<class D, class K> bool CompiledDictionary::ExpandValue(const Entry& entry, D& dict, const K& key) const
+	{
+		switch (entry.myType)
+		{
+		case NullType: dict.Set(key, Variant::NullType()); return true;
+		case BoolType: dict.Set(key, entry.myInteger != 0); return true;
+		case IntegerType: dict.Set(key, (long)entry.myInteger); return true;
+		case RealType: dict.Set(key, entry.myReal); return true;
+		case StringType:
+		{
+			std::string str;
+			if (!GetValue(entry, str))
+				return false;
+			dict.Set(key, str);
+			return true;
+		}
+		case ObjectType:
+		{
+			CompiledDictionary sub;
+			if (!GetValue(entry, sub))
+				return false;
+			dict.Set(key, StringKeyDictionary());
+			return sub.Expand(*dict.GetPtr(key, (StringKeyDictionary*)NULL));
+		}
+		case ArrayType:
+		{
+			CompiledDictionary sub;
+			if (!GetValue(entry, sub))
+				return false;
+			dict.Set(key, ArrayKeyDictionary());
+			return sub.Expand(*dict.GetPtr(key, (ArrayKeyDictionary*)NULL));
+		}
+		default:
+			return false;
+		}
+	}
+
+
+
+	// CompiledFile ////////////////////////////////////////////////////////////
+
+	// --------------------------------------------------------------------------						
+	// Function:	CompiledFile
+	// Description:	constructor
+	// Arguments:	none
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	CompiledFile::CompiledFile()
+	{}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Open
+	// Description:	maps compiled form of json source file, compiling it first
+	//				if it is missing or older than the source, if it can't be
+	//				written the source is compiled into memory instead
+	// Arguments:	path of json source
+	// Returns:		if successful
+	// --------------------------------------------------------------------------
+	bool CompiledFile::Open(const std::string& sourcePath)
+	{
+		Close();
+
+		std::string compiledPath = GetCompiledPath(sourcePath);
+		bool haveSource = FileSystem::IsValidFile(sourcePath);
+		if (haveSource && (!FileSystem::IsValidFile(compiledPath) || FileSystem::Oldest(compiledPath, sourcePath) != 2))
+		{
+			if (!Compile(sourcePath, compiledPath))
+				return Load(sourcePath);
+		}
+
+		if (Map(compiledPath))
+			return true;
+
+		// compiled by another version or damaged so rebuild once
+		if (!haveSource)
+			return false;
+		if (Compile(sourcePath, compiledPath) && Map(compiledPath))
+			return true;
+		return Load(sourcePath);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Close
+	// Description:	unmaps file, views of it must no longer be used
+	// Arguments:	none
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void CompiledFile::Close()
+	{
+		myRoot = CompiledDictionary();
+		myMappedFile.Close();
+		myBuffer.clear();
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Read
+	// Description:	reads whole json source file into dict via its compiled 
+	//				form, only for callers that need a Dictionary as views of
+	//				an open file are read in place
+	// Arguments:	path of json source, dict to read into
+	// Returns:		if successful
+	// --------------------------------------------------------------------------
+	bool CompiledFile::Read(const std::string& sourcePath, StringKeyDictionary& dict)
+	{
+		CompiledFile file;
+		return file.Open(sourcePath) && file.GetRoot().Expand(dict);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Compile
+	// Description:	compiles json source file, written under a temporary name
+	//				unique to the process and thread and renamed so a reader 
+	//				never maps a partly written file
+	// Arguments:	path of json source, path to write compiled file to
+	// Returns:		if successful
+	// --------------------------------------------------------------------------
+	bool CompiledFile::Compile(const std::string& sourcePath, const std::string& compiledPath)
+	{
+		StringKeyDictionary dict;
+		{
+			BinaryFile in(sourcePath, IOInterface::In);
+			if (!JsonFile::Read(in, dict))
+				return false;
+		}
+
+#ifdef _WIN64
+		unsigned long long processId = GetCurrentProcessId();
+#else
+		unsigned long long processId = getpid();
+#endif
+		size_t threadId = std::hash<std::thread::id>()(std::this_thread::get_id());
+		std::string temporary = compiledPath + "." + std::to_string(processId) + "." + std::to_string(threadId) + ".tmp";
+		bool ok;
+		{
+			BinaryFile out(temporary, IOInterface::Out);
+			ok = Compile(dict, out);
+		}
+		if (ok && FileSystem::Replace(temporary, compiledPath))
+			return true;
+
+		FileSystem::Delete(temporary);
+		return false;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Compile
+	// Description:	writes dict in compiled form, values json cannot represent
+	//				are left out
+	// Arguments:	dict, file to write to
+	// Returns:		if successful
+	// --------------------------------------------------------------------------
+	bool CompiledFile::Compile(const StringKeyDictionary& dict, OBinaryFile& file)
+	{
+		std::vector<char> buffer;
+		CompiledWriter writer;
+		writer.Write(dict, buffer);
+		file.GetStream().write(buffer.data(), buffer.size());
+		file.GetStream().flush();
+		return file.GetStream().good();
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	GetCompiledPath
+	// Description:	returns path of compiled form of source file
+	// Arguments:	path of json source
+	// Returns:		path
+	// --------------------------------------------------------------------------
+	std::string CompiledFile::GetCompiledPath(const std::string& sourcePath)
+	{
+		return sourcePath + "." + ourCompiledExtension;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Map
+	// Description:	maps compiled file and checks header
+	// Arguments:	path of compiled file
+	// Returns:		if successful
+	// --------------------------------------------------------------------------
+	bool CompiledFile::Map(const std::string& compiledPath)
+	{
+		if (!myMappedFile.Open(compiledPath))
+			return false;
+
+		if (!View(myMappedFile.GetData(), myMappedFile.GetSize()))
+		{
+			myMappedFile.Close();
+			return false;
+		}
+		return true;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Load
+	// Description:	compiles json source file into memory held by me
+	// Arguments:	path of json source
+	// Returns:		if successful
+	// --------------------------------------------------------------------------
+	bool CompiledFile::Load(const std::string& sourcePath)
+	{
+		Close();
+
+		StringKeyDictionary dict;
+		BinaryFile in(sourcePath, IOInterface::In);
+		if (!JsonFile::Read(in, dict))
+			return false;
+
+		CompiledWriter writer;
+		writer.Write(dict, myBuffer);
+		if (!View(myBuffer.data(), myBuffer.size()))
+		{
+			myBuffer.clear();
+			return false;
+		}
+		return true;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	View
+	// Description:	checks header of compiled data and views its root
+	// Arguments:	compiled data, size of data
+	// Returns:		if successful
+	// --------------------------------------------------------------------------
+	bool CompiledFile::View(const char* data, size_t size)
+	{
+		const CompiledHeader* header = (const CompiledHeader*)data;
+		if (size < sizeof(CompiledHeader) || memcmp(header->myMagic, ourMagic, sizeof(ourMagic)) != 0 || header->myVersion != ourVersion || header->mySize != size ||
+			header->myStringsOffset % sizeof(unsigned int) != 0 || header->myStringsOffset + header->myStringCount * (unsigned long long)sizeof(unsigned int) > size)
+			return false;
+
+		myRoot = CompiledDictionary(data, size, header->myRootOffset, false, 0);
+		return myRoot.IsValid();
+	}
+
+
+
+	// CompiledWriter //////////////////////////////////////////////////////////
+
+	// --------------------------------------------------------------------------						
+	// Function:	Write
+	// Description:	lays out dict in compiled form, blocks are written before
+	//				their parents so the root comes last and strings after it
+	// Arguments:	dict, buffer to return file contents in
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void CompiledWriter::Write(const StringKeyDictionary& dict, std::vector<char>& buffer)
+	{
+		CompiledHeader header;
+		memset(&header, 0, sizeof(header));
+		Append(&header, sizeof(header));
+
+		header.myRootOffset = WriteObject(dict);
+
+		Align(sizeof(unsigned long long));
+		header.myStringCount = (unsigned int)myStringOrder.size();
+		header.myStringsOffset = (unsigned int)myBuffer.size();
+		std::vector<unsigned int> offsets(myStringOrder.size());
+		Append(offsets.data(), offsets.size() * sizeof(unsigned int));
+		for (size_t i = 0; i != myStringOrder.size(); i++)
+		{
+			unsigned int length = (unsigned int)myStringOrder[i]->size();
+			offsets[i] = Append(&length, sizeof(length));
+			Append(myStringOrder[i]->c_str(), length + 1);
+			Align(sizeof(unsigned int));
+		}
+		memcpy(myBuffer.data() + header.myStringsOffset, offsets.data(), offsets.size() * sizeof(unsigned int));
+
+		memcpy(header.myMagic, ourMagic, sizeof(ourMagic));
+		header.myVersion = CompiledFile::ourVersion;
+		header.mySize = (unsigned int)myBuffer.size();
+		memcpy(myBuffer.data(), &header, sizeof(header));
+
+		buffer.swap(myBuffer);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	AddString
+	// Description:	adds string to string table if not already there
+	// Arguments:	string
+	// Returns:		index of string
+	// --------------------------------------------------------------------------
+	unsigned int CompiledWriter::AddString(const std::string& str)
+	{
+		std::pair<Strings::iterator, bool> added = myStrings.insert(Strings::value_type(str, (unsigned int)myStringOrder.size()));
+		if (added.second)
+			myStringOrder.push_back(&added.first->first);
+		return added.first->second;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	WriteObject
+	// Description:	writes object block followed by its index sorted by key
+	// Arguments:	dict
+	// Returns:		offset of block
+	// --------------------------------------------------------------------------
+	unsigned int CompiledWriter::WriteObject(const StringKeyDictionary& dict)
+	{
+		Entries entries;
+		entries.reserve(dict.Size());
+		for (StringKeyDictionary::VariablesConstIterator it = dict.Begin(); it != dict.End(); it++)
+		{
+			CompiledDictionary::Entry entry;
+			if (!MakeEntry(*it->second, entry))
+				continue;
+			entry.myKey = AddString(*it->first);
+			entries.push_back(entry);
+		}
+
+		std::vector<unsigned int> sorted(entries.size());
+		for (unsigned int i = 0; i != sorted.size(); i++)
+			sorted[i] = i;
+		std::sort(sorted.begin(), sorted.end(), [&](unsigned int a, unsigned int b) { return *myStringOrder[entries[a].myKey] < *myStringOrder[entries[b].myKey]; });
+
+		Align(sizeof(unsigned long long));
+		CompiledBlock block = { (unsigned int)entries.size(), 0 };
+		unsigned int offset = Append(&block, sizeof(block));
+		Append(entries.data(), entries.size() * sizeof(CompiledDictionary::Entry));
+		Append(sorted.data(), sorted.size() * sizeof(unsigned int));
+		return offset;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	WriteArray
+	// Description:	writes array block, values that can't be written are null
+	// Arguments:	dict
+	// Returns:		offset of block
+	// --------------------------------------------------------------------------
+	unsigned int CompiledWriter::WriteArray(const ArrayKeyDictionary& dict)
+	{
+		Entries entries;
+		entries.reserve(dict.Size());
+		for (ArrayKeyDictionary::VariablesConstIterator it = dict.Begin(); it != dict.End(); it++)
+		{
+			CompiledDictionary::Entry entry;
+			if (!MakeEntry(*it->second, entry))
+			{
+				entry.myType = CompiledDictionary::NullType;
+				entry.myInteger = 0;
+			}
+			entry.myKey = *it->first;
+			entries.push_back(entry);
+		}
+
+		Align(sizeof(unsigned long long));
+		CompiledBlock block = { (unsigned int)entries.size(), 0 };
+		unsigned int offset = Append(&block, sizeof(block));
+		Append(entries.data(), entries.size() * sizeof(CompiledDictionary::Entry));
+		return offset;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	MakeEntry
+	// Description:	fills in type and value of entry, writing sub objects and
+	//				arrays out first
+	// Arguments:	value, entry to fill in
+	// Returns:		false if value is of a type json cannot represent
+	// --------------------------------------------------------------------------
+	bool CompiledWriter::MakeEntry(const Variant& value, CompiledDictionary::Entry& entry)
+	{
+		memset(&entry, 0, sizeof(entry));
+		switch (value.GetKind())
+		{
+		case Variant::NullKind: entry.myType = CompiledDictionary::NullType; return true;
+		case Variant::BoolKind: entry.myType = CompiledDictionary::BoolType; entry.myInteger = value.GetUnchecked<bool>(); return true;
+		case Variant::IntKind: entry.myType = CompiledDictionary::IntegerType; entry.myInteger = value.GetUnchecked<int>(); return true;
+		case Variant::UnsignedIntKind: entry.myType = CompiledDictionary::IntegerType; entry.myInteger = value.GetUnchecked<unsigned int>(); return true;
+		case Variant::LongKind: entry.myType = CompiledDictionary::IntegerType; entry.myInteger = value.GetUnchecked<long>(); return true;
+		case Variant::UnsignedLongKind: entry.myType = CompiledDictionary::IntegerType; entry.myInteger = value.GetUnchecked<unsigned long>(); return true;
+		case Variant::LongLongKind: entry.myType = CompiledDictionary::IntegerType; entry.myInteger = value.GetUnchecked<long long>(); return true;
+		case Variant::UnsignedLongLongKind: entry.myType = CompiledDictionary::IntegerType; entry.myInteger = (long long)value.GetUnchecked<unsigned long long>(); return true;
+		case Variant::FloatKind: entry.myType = CompiledDictionary::RealType; entry.myReal = value.GetUnchecked<float>(); return true;
+		case Variant::DoubleKind: entry.myType = CompiledDictionary::RealType; entry.myReal = value.GetUnchecked<double>(); return true;
+		case Variant::StringKind: entry.myType = CompiledDictionary::StringType; entry.myOffset = AddString(value.GetUnchecked<std::string>()); return true;
+		case Variant::StringKeyDictionaryKind: entry.myType = CompiledDictionary::ObjectType; entry.myOffset = WriteObject(value.GetUnchecked<StringKeyDictionary>()); return true;
+		case Variant::ArrayKeyDictionaryKind: entry.myType = CompiledDictionary::ArrayType; entry.myOffset = WriteArray(value.GetUnchecked<ArrayKeyDictionary>()); return true;
+		default: return false;
+		}
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Append
+	// Description:	appends data to buffer
+	// Arguments:	data, size of data
+	// Returns:		offset data was written at
+	// --------------------------------------------------------------------------
+	unsigned int CompiledWriter::Append(const void* data, size_t size)
+	{
+		unsigned int offset = (unsigned int)myBuffer.size();
+		myBuffer.insert(myBuffer.end(), (const char*)data, (const char*)data + size);
+		return offset;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Align
+	// Description:	pads buffer to alignment
+	// Arguments:	alignment, must be power of 2
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void CompiledWriter::Align(size_t alignment)
+	{
+		myBuffer.resize((myBuffer.size() + alignment - 1) & ~(alignment - 1), 0);
+	}
+
+}	// namespace shh
@@ -0,0 +1,230 @@
+///////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2025 David K Bhowmik. All rights reserved.
+// This file is part of shhArc.
+//
+// This Software is available under the MIT License with a No Modification clause.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this file and associated documentation files (the "Software"), to use the
+// Software for any purpose, including commercial applications, provided that:
+//
+//   1. You do NOT modify, alter, or create derivative works of this file.
+//   2. Redistributions must include this notice and may only distribute it 
+//      unmodified.
+//
+// The full MIT License text, including this Custom No Modification clause,
+// is available in the LICENSE file in the root of the project.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND.
+//
+// You may alternatively use this source under the terms of a specific 
+// version of the shhArc Unrestricted License provided you have obtained 
+// such a license from the copyright holder.
+///////////////////////////////////////////////////////////////////////////////
+#ifndef COMPILEDFILE_H
+#define COMPILEDFILE_H
+
+
+#include "../Common/SecureStl.h"
+#include "../Common/Debug.h"
+#include "../Common/Dictionary.h"
+#include "BinaryFile.h"
+#include "MappedFile.h"
+#include <vector>
+
+
+namespace shh {
+
+	// Compiled files are a binary form of json dictionaries laid out to be
+	// memory mapped and read in place. The layout is a header, value blocks
+	// and a string table holding every key and string value once. Each object
+	// or array is a block of fixed size entries followed, for objects, by an
+	// index of the entries sorted by key so members can be found by binary
+	// search without touching the rest of the file.
+
+	class CompiledDictionary
+	{
+		friend class CompiledFile;
+
+	public:
+
+		enum Type { NullType, BoolType, IntegerType, RealType, StringType, ObjectType, ArrayType };
+		enum { maxDepth = 256 };
+
+		struct Entry
+		{
+			unsigned int myKey;		// string index for objects, key for arrays
+			unsigned int myType;
+			union
+			{
+				long long myInteger;
+				double myReal;
+				unsigned long long myOffset;	// string index or block offset
+			};
+		};
+
+		CompiledDictionary();
+
+		inline bool IsValid() const;
+		inline bool IsArray() const;
+		inline unsigned int Size() const;
+		inline const Entry* Begin() const;
+		inline const Entry* End() const;
+
+		const Entry* Find(const std::string& key) const;
+		const Entry* Find(unsigned int key) const;
+		bool GetKey(const Entry& entry, std::string& key) const;
+
+		template<class K, class T> T Get(const K& key, const T& defaultValue) const;
+
+		bool GetValue(const Entry& entry, bool& value) const;
+		bool GetValue(const Entry& entry, long& value) const;
+		bool GetValue(const Entry& entry, double& value) const;
+		bool GetValue(const Entry& entry, std::string& value) const;
+		bool GetValue(const Entry& entry, CompiledDictionary& value) const;
+		bool GetValue(const Entry& entry, StringKeyDictionary& value) const;
+		bool GetValue(const Entry& entry, ArrayKeyDictionary& value) const;
+
+		bool Expand(StringKeyDictionary& dict) const;
+		bool Expand(ArrayKeyDictionary& dict) const;
+
+	private:
+
+		const char* myFile;
+		size_t myFileSize;
+		const Entry* myEntries;
+		const unsigned int* mySorted;
+		unsigned int mySize;
+		unsigned int myDepth;
+		bool myArray;
+
+		CompiledDictionary(const char* file, size_t fileSize, unsigned long long offset, bool isArray, unsigned int depth);
+		const char* GetString(unsigned int index, unsigned int& length) const;
+		template<class D, class K> bool ExpandValue(const Entry& entry, D& dict, const K& key) const;
+	};
+
+
+	class CompiledFile
+	{
+	public:
+
+		static const std::string ourCompiledExtension;
+		static const unsigned int ourVersion;
+
+		CompiledFile();
+
+		bool Open(const std::string& sourcePath);
+		void Close();
+		inline const CompiledDictionary& GetRoot() const;
+
+		static bool Read(const std::string& sourcePath, StringKeyDictionary& dict);
+		static bool Compile(const std::string& sourcePath, const std::string& compiledPath);
+		static bool Compile(const StringKeyDictionary& dict, OBinaryFile& file);
+		static std::string GetCompiledPath(const std::string& sourcePath);
+
+	private:
+
+		MappedFile myMappedFile;
+		std::vector<char> myBuffer;
+		CompiledDictionary myRoot;
+
+		bool Map(const std::string& compiledPath);
+		bool Load(const std::string& sourcePath);
+		bool View(const char* data, size_t size);
+	};
+
+
+	// CompiledDictionary Inlines /////////////////////////////////////////////////
+
+	// --------------------------------------------------------------------------						
+	// Function:	IsValid
+	// Description:	tests if dictionary refers to a block in a mapped file
+	// Arguments:	none
+	// Returns:		if valid
+	// --------------------------------------------------------------------------
+	inline bool CompiledDictionary::IsValid() const
+	{
+		return myFile != NULL;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	IsArray
+	// Description:	tests if dictionary is an array rather than an object
+	// Arguments:	none
+	// Returns:		if array
+	// --------------------------------------------------------------------------
+	inline bool CompiledDictionary::IsArray() const
+	{
+		return myArray;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Size
+	// Description:	returns number of entries
+	// Arguments:	none
+	// Returns:		size
+	// --------------------------------------------------------------------------
+	inline unsigned int CompiledDictionary::Size() const
+	{
+		return mySize;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Begin
+	// Description:	returns first entry in original order
+	// Arguments:	none
+	// Returns:		entry
+	// --------------------------------------------------------------------------
+	inline const CompiledDictionary::Entry* CompiledDictionary::Begin() const
+	{
+		return myEntries;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	End
+	// Description:	returns one past last entry
+	// Arguments:	none
+	// Returns:		entry
+	// --------------------------------------------------------------------------
+	inline const CompiledDictionary::Entry* CompiledDictionary::End() const
+	{
+		return myEntries + mySize;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Get
+	// Description:	returns value of key converted to type of default
+	// Arguments:	key, value to return if key missing or of different type
+	// Returns:		value
+	// --------------------------------------------------------------------------
+	template<class K, class T> T CompiledDictionary::Get(const K& key, const T& defaultValue) const
+	{
+		const Entry* entry = Find(key);
+		T value;
+		if (entry == NULL || !GetValue(*entry, value))
+			return defaultValue;
+		return value;
+	}
+
+
+	// CompiledFile Inlines ///////////////////////////////////////////////////////
+
+	// --------------------------------------------------------------------------						
+	// Function:	GetRoot
+	// Description:	returns root object, only valid while file is open
+	// Arguments:	none
+	// Returns:		root
+	// --------------------------------------------------------------------------
+	inline const CompiledDictionary& CompiledFile::GetRoot() const
+	{
+		return myRoot;
+	}
+
+}	// namespace shh
+
+#endif
@@ -361,8 +361,8 @@ namespace shh {
 	bool ConfigurationFile::Write(OTextFile& file, const StringKeyDictionary& map, const std::string& key, const std::string& indent)
 	{
 
-		StringKeyDictionary::Variables::const_iterator it = map.Begin();
-		StringKeyDictionary::Variables::const_iterator end = map.End();
+		StringKeyDictionary::VariablesConstIterator it = map.Begin();
+		StringKeyDictionary::VariablesConstIterator end = map.End();
 
 		while (it != end)
 		{
@@ -371,7 +371,7 @@ namespace shh {
 			if (map.IsType(it, &v))
 			{
 				StringKeyDictionary temp;
-				StringKeyDictionary* x = const_cast<StringKeyDictionary*>(&map)->GetPtr(it, &temp);
+				const StringKeyDictionary* x = map.GetConstPtr(it, &temp);
 				if (x->GetNextArrayIndex() == 0)
 					isArray = true;
 			}
@@ -440,7 +440,7 @@ namespace shh {
 					file.Put('\n');
 				}
 				StringKeyDictionary v;
-				Write(file, *const_cast<StringKeyDictionary*>(&map)->GetPtr(it, &v), *it->first, isArray ? indent : indent + "\t");
+				Write(file, *map.GetConstPtr(it, &v), *it->first, isArray ? indent : indent + "\t");
 				if (!isArray)
 				{
 					file << indent;
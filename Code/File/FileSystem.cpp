@@ -611,6 +611,23 @@ namespace shh {
 	}
 
 
+	// --------------------------------------------------------------------------						
+	// Function:	Replace
+	// Description:	renames file over destination in one step so readers 
+	//				see either the old or the new file
+	// Arguments:	source file, destinstation file
+	// Returns:		if sucessfull
+	// --------------------------------------------------------------------------
+	bool FileSystem::Replace(const std::string& source, const std::string& destination)
+	{
+#ifdef _WIN64
+		return ::MoveFileEx((LPCWSTR)CStrToWide(source).data(), (LPCWSTR)CStrToWide(destination).data(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+		return ::rename(source.c_str(), destination.c_str()) == 0;
+#endif
+	}
+
+
 	// --------------------------------------------------------------------------						
 	// Function:	Delete
 	// Description:	delete file
@@ -1125,10 +1142,10 @@ namespace shh {
 			return 2;
 		else if (o1 == 0 && o2 != 0)
 			return 1;
-		if (o1 == 0 && o2 == 0)
+		if (o1 != 0 && o2 != 0)
 			return -1;
 
-		if (buffer1.st_mtime < buffer1.st_mtime)
+		if (buffer1.st_mtime < buffer2.st_mtime)
 			return 1;
 		else if (buffer2.st_mtime < buffer1.st_mtime)
 			return 2;
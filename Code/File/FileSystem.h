@@ -60,6 +60,7 @@ namespace shh
 
 		static bool Copy(const std::string& source, const std::string& destination, const bool overwrite);
 		static bool Move(const std::string& source, const std::string& destination);
+		static bool Replace(const std::string& source, const std::string& destination);
 		static bool Delete(const std::string& path);
 		static bool MakeDirectory(const std::string& name);
 
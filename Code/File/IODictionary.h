@@ -217,7 +217,6 @@ namespace shh {
 				IODictionary iodict(d->myValue);
 				SERIALIZE_IN(io, iodict);
 				myInMap[id] = d;
-				myDictionary->myVariables[key] = d;
 			}
 			else if (alias == dictIntAlias)
 			{
@@ -225,7 +224,6 @@ namespace shh {
 				IODictionary<unsigned int> iodict(d->myValue);
 				SERIALIZE_IN(io, iodict);
 				myInMap[id] = d;
-				myDictionary->myVariables[key] = d;
 			}
 			else if (alias == dictStrAlias)
 			{
@@ -233,7 +231,6 @@ namespace shh {
 				IODictionary<std::string> iodict(d->myValue);
 				SERIALIZE_IN(io, iodict);
 				myInMap[id] = d;
-				myDictionary->myVariables[key] = d;
 			}
 			else if (alias == dictVarAlias)
 			{
@@ -241,7 +238,6 @@ namespace shh {
 				IODictionary<Variant> iodict(d->myValue);
 				SERIALIZE_IN(io, iodict);
 				myInMap[id] = d;
-				myDictionary->myVariables[key] = d;
 			}
 			else
 			{
@@ -249,12 +245,10 @@ namespace shh {
 				Variant* variant = (Variant*)iovariant->New();
 				iovariant->Read(io, version);
 				myInMap[id] = variant;
-				myDictionary->myVariables[key] = variant;
 			}
-
+			delete key;
 		}
 
-		size = (int)myDictionary->myOrderedVariables.size();
 		SERIALIZE_IN(io, size);
 		for (unsigned int count = 0; count != size; count++)
 		{
@@ -264,10 +258,14 @@ namespace shh {
 			unsigned int id;
 			SERIALIZE_IN(io, id);
 			Variant* v = myInMap.find(id)->second;
-			myDictionary->myOrderedVariables[sorter] = v;
+			myDictionary->Adopt(*sorter, v, sorter.mySortId);
+			sorter.Null();
 		}
+		myInMap.clear();
 
-		SERIALIZE_IN(io, myDictionary->myNextArrayIndex);
+		unsigned int nextArrayIndex;
+		SERIALIZE_IN(io, nextArrayIndex);
+		myDictionary->SetNextArrayIndex(nextArrayIndex);
 
 		FINALIZE_SERIAL(io);
 
@@ -286,9 +284,9 @@ namespace shh {
 
 		int nextId = 0;
 
-		unsigned int size = (unsigned int)myDictionary->myVariables.size();
+		unsigned int size = (unsigned int)myDictionary->Size();
 		SERIALIZE_OUT(io, size);
-		for (typename Dictionary<KEY>::VariablesConstIterator vit = myDictionary->myVariables.begin(); vit != myDictionary->myVariables.end(); vit++)
+		for (typename Dictionary<KEY>::VariablesConstIterator vit = myDictionary->Begin(); vit != myDictionary->End(); vit++)
 		{
 			myOutMap[vit->second] = nextId;
 
@@ -336,17 +334,20 @@ namespace shh {
 			}
 		}
 
-		size = (int)myDictionary->myOrderedVariables.size();
 		SERIALIZE_OUT(io, size);
-		for (typename Dictionary<KEY>::OrderedVariablesConstIterator ovit = myDictionary->myOrderedVariables.begin(); ovit != myDictionary->myOrderedVariables.end(); ovit++)
+		for (typename Dictionary<KEY>::OrderedVariablesConstIterator ovit = myDictionary->OrderedBegin(); ovit != myDictionary->OrderedEnd(); ovit++)
 		{
-			IOSorter s((typename Dictionary<KEY>::Sorter&)ovit->first);
+			typename Dictionary<KEY>::Sorter sorter(*ovit->first, ovit->mySortId);
+			IOSorter s(sorter);
 			SERIALIZE_OUT(io, s);
+			sorter.Null();
 			unsigned int id = myOutMap.find(ovit->second)->second;
 			SERIALIZE_OUT(io, id);
 		}
+		myOutMap.clear();
 
-		SERIALIZE_OUT(io, myDictionary->myNextArrayIndex);
+		unsigned int nextArrayIndex = (unsigned int)myDictionary->GetNextArrayIndex();
+		SERIALIZE_OUT(io, nextArrayIndex);
 
 		FINALIZE_SERIAL(io);
 	}
@@ -22,14 +22,68 @@
 // such a license from the copyright holder.
 ///////////////////////////////////////////////////////////////////////////////
 #include "JsonFile.h"
-#include <json/json.h>
+#include <istream>
+#include <ostream>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <climits>
+#include <cstring>
+#include <cerrno>
 
 namespace shh {
 
-	static bool ConvertToDict(const Json::Value& object, StringKeyDictionary& dict);
-	static bool ConvertToDict(const Json::Value& object, ArrayKeyDictionary& dict);
-	static bool ConvertToValue(const StringKeyDictionary& dict, Json::Value& object);
-	static bool ConvertToValue(const ArrayKeyDictionary& dict, Json::Value& object);
+
+	// JsonReader /////////////////////////////////////////////////////////////
+
+	class JsonReader
+	{
+	public:
+
+		JsonReader(std::istream& stream);
+
+		bool Read(StringKeyDictionary& dict);
+
+	private:
+
+		std::streambuf* myBuffer;
+		unsigned int myLine;
+
+		int Peek();
+		int Get();
+		bool SkipSpace();
+		bool Expect(char c);
+		bool ReadObject(StringKeyDictionary& dict);
+		bool ReadArray(ArrayKeyDictionary& dict);
+		template<class D, class K> bool ReadValue(D& dict, const K& key);
+		template<class D, class K> bool ReadNumber(D& dict, const K& key);
+		bool ReadString(std::string& str);
+		bool ReadLiteral(const char* literal);
+		bool Fail();
+	};
+
+
+	// JsonWriter /////////////////////////////////////////////////////////////
+
+	class JsonWriter
+	{
+	public:
+
+		JsonWriter(std::ostream& stream);
+
+		void Write(const StringKeyDictionary& dict);
+
+	private:
+
+		std::ostream& myStream;
+
+		void WriteObject(const StringKeyDictionary& dict, const std::string& indent);
+		void WriteArray(const ArrayKeyDictionary& dict, const std::string& indent);
+		void WriteValue(const Variant& value, const std::string& indent);
+		void WriteString(const std::string& str);
+		static bool IsWritable(const Variant& value);
+		static bool IsDictionary(const Variant& value);
+	};
 
 
 
@@ -41,247 +95,630 @@ namespace shh {
 	// --------------------------------------------------------------------------
 	bool JsonFile::Read(IBinaryFile& file, StringKeyDictionary& dict)
 	{
-		Json::Value root;
-		Json::CharReaderBuilder rbuilder;
-		std::string errs;
+		JsonReader reader(file.GetStream());
+		return reader.Read(dict);
+	}
 
-		bool parsingSuccessful = Json::parseFromStream(rbuilder, file.GetStream(), &root, &errs);
 
-		if (!parsingSuccessful)
-			return false;
-		
-		RELEASE_ASSERT(root.isObject());
-		return ConvertToDict(root, dict);
-		
+	// --------------------------------------------------------------------------						
+	// Function:	Write
+	// Description:	writes dict to file
+	// Arguments:	file, dict
+	// Returns:		if successful
+	// --------------------------------------------------------------------------
+	bool JsonFile::Write(OBinaryFile& file, const StringKeyDictionary& dict)
+	{
+		JsonWriter writer(file.GetStream());
+		writer.Write(dict);
+		return true;
 	}
-	
-	
-	bool ConvertToDict(const Json::Value& object, StringKeyDictionary& dict)
+
+
+
+	// JsonReader //////////////////////////////////////////////////////////////
+
+	// --------------------------------------------------------------------------						
+	// Function:	JsonReader
+	// Description:	constructor
+	// Arguments:	stream to read
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	JsonReader::JsonReader(std::istream& stream) :
+		myBuffer(stream.rdbuf()),
+		myLine(1)
+	{}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Read
+	// Description:	reads json object in a single pass straight into dict
+	// Arguments:	dict to read into
+	// Returns:		if successful
+	// --------------------------------------------------------------------------
+	bool JsonReader::Read(StringKeyDictionary& dict)
 	{
-		// JsonCpp uses getMemberNames() to get the keys of an object
-		Json::Value::Members members = object.getMemberNames();
+		if (!SkipSpace())
+			return Fail();
 
-		for (const std::string& key : members) 
-		{
-			const Json::Value& value = object[key]; // Access the value by key
-			Json::ValueType type = value.type();
+		RELEASE_ASSERT(Peek() == '{');
+		return ReadObject(dict);
+	}
 
 
-			if (value.isNull())
-			{
-				dict.Set(key, Variant::NullType());
-			}
-			else if (value.isBool()) 
-			{
-				dict.Set(key, value.asBool());
-			}
-			else if (type == Json::intValue)
-			{
-				dict.Set(key, (long)value.asInt64());
-			}
-			else if (type == Json::realValue)
-			{
-				dict.Set(key, (double)value.asDouble());
-			}
-			else if (value.isString()) 
+	// --------------------------------------------------------------------------						
+	// Function:	Peek
+	// Description:	gets next character without consuming it
+	// Arguments:	none
+	// Returns:		character or EOF
+	// --------------------------------------------------------------------------
+	int JsonReader::Peek()
+	{
+		return myBuffer->sgetc();
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Get
+	// Description:	consumes next character
+	// Arguments:	none
+	// Returns:		character or EOF
+	// --------------------------------------------------------------------------
+	int JsonReader::Get()
+	{
+		int c = myBuffer->sbumpc();
+		if (c == '\n')
+			myLine++;
+		return c;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	SkipSpace
+	// Description:	skips white space and comments
+	// Arguments:	none
+	// Returns:		false if at end of stream
+	// --------------------------------------------------------------------------
+	bool JsonReader::SkipSpace()
+	{
+		for (;;)
+		{
+			int c = Peek();
+			if (c == ' ' || c == '\t' || c == '\n' || c == '\r')
 			{
-				dict.Set(key, value.asString());
+				Get();
 			}
-			else if (value.isArray())
+			else if (c == '/')
 			{
-				ArrayKeyDictionary subDict;
-				if (ConvertToDict(value, subDict))
-					dict.Set(key, subDict);
+				Get();
+				c = Get();
+				if (c == '/')
+				{
+					while (c != '\n' && c != EOF)
+						c = Get();
+				}
+				else if (c == '*')
+				{
+					int last = 0;
+					for (c = Get(); c != EOF && !(last == '*' && c == '/'); c = Get())
+						last = c;
+					if (c == EOF)
+						return false;
+				}
+				else
+				{
+					return false;
+				}
 			}
-			else if (value.isObject())
+			else
 			{
-				StringKeyDictionary subDict;
-				if (ConvertToDict(value, subDict))
-					dict.Set(key, subDict);
+				return c != EOF;
 			}
 		}
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Expect
+	// Description:	consumes given character after any white space
+	// Arguments:	character
+	// Returns:		true if it was next
+	// --------------------------------------------------------------------------
+	bool JsonReader::Expect(char c)
+	{
+		if (!SkipSpace() || Peek() != c)
+			return false;
+		Get();
 		return true;
 	}
-	
 
 
+	// --------------------------------------------------------------------------						
+	// Function:	ReadObject
+	// Description:	reads object members into dict
+	// Arguments:	dict to read into
+	// Returns:		if successful
+	// --------------------------------------------------------------------------
+	bool JsonReader::ReadObject(StringKeyDictionary& dict)
+	{
+		if (!Expect('{'))
+			return Fail();
+		if (Expect('}'))
+			return true;
+
+		do
+		{
+			if (Expect('}'))
+				return true;	// trailing comma
+
+			std::string key;
+			if (!SkipSpace() || !ReadString(key) || !Expect(':') || !ReadValue(dict, key))
+				return Fail();
+		} 
+		while (Expect(','));
 
-	bool ConvertToDict(const Json::Value& object, ArrayKeyDictionary& dict)
+		return Expect('}') || Fail();
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	ReadArray
+	// Description:	reads array elements into dict
+	// Arguments:	dict to read into
+	// Returns:		if successful
+	// --------------------------------------------------------------------------
+	bool JsonReader::ReadArray(ArrayKeyDictionary& dict)
 	{
-		for (Json::ArrayIndex i = 0; i < object.size(); i++) 
+		if (!Expect('['))
+			return Fail();
+		if (Expect(']'))
+			return true;
+
+		unsigned int i = 0;
+		do
 		{
-			const Json::Value& value = object[i]; // Access the value by index
-			Json::ValueType type = value.type();
+			if (Expect(']'))
+				return true;	// trailing comma
 
+			if (!ReadValue(dict, i++))
+				return Fail();
+		} 
+		while (Expect(','));
 
-			if (value.isNull())
-			{
-				dict.Set(i, Variant::NullType());
-			}
-			else if (value.isBool())
-			{
-				dict.Set(i, value.asBool());
-			}
-			else if (type == Json::intValue)
+		return Expect(']') || Fail();
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	ReadValue
+	// Description:	reads value and sets it in dict, sub objects and arrays are
+	//				read in place in the dict rather than copied in
+	// Arguments:	dict to set value in, key
+	// Returns:		if successful
+	// --------------------------------------------------------------------------
+	template<class D, class K> bool JsonReader::ReadValue(D& dict, const K& key)
+	{
+		if (!SkipSpace())
+			return false;
+
+		switch (Peek())
+		{
+		case '{':
+		{
+			dict.Set(key, StringKeyDictionary());
+			return ReadObject(*dict.GetPtr(key, (StringKeyDictionary*)NULL));
+		}
+		case '[':
+		{
+			dict.Set(key, ArrayKeyDictionary());
+			return ReadArray(*dict.GetPtr(key, (ArrayKeyDictionary*)NULL));
+		}
+		case '"':
+		{
+			std::string str;
+			if (!ReadString(str))
+				return false;
+			dict.Set(key, str);
+			return true;
+		}
+		case 't':
+			if (!ReadLiteral("true"))
+				return false;
+			dict.Set(key, true);
+			return true;
+		case 'f':
+			if (!ReadLiteral("false"))
+				return false;
+			dict.Set(key, false);
+			return true;
+		case 'n':
+			if (!ReadLiteral("null"))
+				return false;
+			dict.Set(key, Variant::NullType());
+			return true;
+		default:
+			return ReadNumber(dict, key);
+		}
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	ReadNumber
+	// Description:	reads number, integers are stored as long and others 
+	//				as double
+	// Arguments:	dict to set value in, key
+	// Returns:		if successful
+	// --------------------------------------------------------------------------
+	template<class D, class K> bool JsonReader::ReadNumber(D& dict, const K& key)
+	{
+		char buffer[64];
+		unsigned int length = 0;
+		bool real = false;
+		for (int c = Peek(); (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E'; c = Peek())
+		{
+			if (length == sizeof(buffer) - 1)
+				return false;
+			real = real || c == '.' || c == 'e' || c == 'E';
+			buffer[length++] = (char)Get();
+		}
+		buffer[length] = 0;
+		if (length == 0)
+			return false;
+
+		char* end;
+		if (!real)
+		{
+			errno = 0;
+			long long value = strtoll(buffer, &end, 10);
+			if (*end == 0 && errno != ERANGE && value >= LONG_MIN && value <= LONG_MAX)
 			{
-				dict.Set(i, (long)value.asInt64());
+				dict.Set(key, (long)value);
+				return true;
 			}
-			else if (type == Json::realValue)
+		}
+
+		double value = strtod(buffer, &end);
+		if (*end != 0)
+			return false;
+		dict.Set(key, value);
+		return true;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	ReadString
+	// Description:	reads quoted string converting escapes and utf16 code 
+	//				points to utf8
+	// Arguments:	string to return
+	// Returns:		if successful
+	// --------------------------------------------------------------------------
+	bool JsonReader::ReadString(std::string& str)
+	{
+		if (Get() != '"')
+			return false;
+
+		for (;;)
+		{
+			int c = Get();
+			if (c == EOF)
+				return false;
+			if (c == '"')
+				return true;
+			if (c != '\\')
 			{
-				dict.Set(i, (double)value.asDouble());
+				str += (char)c;
+				continue;
 			}
-			else if (value.isString())
+
+			c = Get();
+			switch (c)
 			{
-				dict.Set(i, value.asString());
-			}
-			else if (value.isArray())
+			case '"': str += '"'; break;
+			case '\\': str += '\\'; break;
+			case '/': str += '/'; break;
+			case 'b': str += '\b'; break;
+			case 'f': str += '\f'; break;
+			case 'n': str += '\n'; break;
+			case 'r': str += '\r'; break;
+			case 't': str += '\t'; break;
+			case 'u':
 			{
-				ArrayKeyDictionary subDict;
-				if (ConvertToDict(value, subDict))
-					dict.Set(i, subDict);
+				unsigned int code = 0;
+				for (int pair = 0; pair != 2; pair++)
+				{
+					unsigned int unit = 0;
+					for (int i = 0; i != 4; i++)
+					{
+						c = Get();
+						unit <<= 4;
+						if (c >= '0' && c <= '9')
+							unit |= c - '0';
+						else if (c >= 'a' && c <= 'f')
+							unit |= c - 'a' + 10;
+						else if (c >= 'A' && c <= 'F')
+							unit |= c - 'A' + 10;
+						else
+							return false;
+					}
+
+					if (pair == 0 && unit >= 0xD800 && unit <= 0xDBFF)
+					{
+						// high surrogate so low surrogate must follow
+						code = unit;
+						if (Get() != '\\' || Get() != 'u')
+							return false;
+					}
+					else
+					{
+						code = pair == 0 ? unit : 0x10000 + ((code - 0xD800) << 10) + (unit - 0xDC00);
+						break;
+					}
+				}
+
+				if (code < 0x80)
+				{
+					str += (char)code;
+				}
+				else if (code < 0x800)
+				{
+					str += (char)(0xC0 | (code >> 6));
+					str += (char)(0x80 | (code & 0x3F));
+				}
+				else if (code < 0x10000)
+				{
+					str += (char)(0xE0 | (code >> 12));
+					str += (char)(0x80 | ((code >> 6) & 0x3F));
+					str += (char)(0x80 | (code & 0x3F));
+				}
+				else
+				{
+					str += (char)(0xF0 | (code >> 18));
+					str += (char)(0x80 | ((code >> 12) & 0x3F));
+					str += (char)(0x80 | ((code >> 6) & 0x3F));
+					str += (char)(0x80 | (code & 0x3F));
+				}
+				break;
 			}
-			else if (value.isObject())
-			{
-				StringKeyDictionary subDict;
-				if (ConvertToDict(value, subDict))
-					dict.Set(i, subDict);
+			default:
+				return false;
 			}
 		}
-		return true;
 	}
 
 
 	// --------------------------------------------------------------------------						
-	// Function:	Write
-	// Description:	writes dict to file
-	// Arguments:	file, dict
+	// Function:	ReadLiteral
+	// Description:	reads expected literal
+	// Arguments:	literal
 	// Returns:		if successful
 	// --------------------------------------------------------------------------
-	bool JsonFile::Write(OBinaryFile& file, const StringKeyDictionary& dict)
+	bool JsonReader::ReadLiteral(const char* literal)
 	{
-		Json::Value root;
-		ConvertToValue(dict, root);
-		file.GetStream() << root;
+		for (; *literal != 0; literal++)
+		{
+			if (Get() != *literal)
+				return false;
+		}
 		return true;
 	}
 
 
-	bool ConvertToValue(const StringKeyDictionary& dict, Json::Value& object)
+	// --------------------------------------------------------------------------						
+	// Function:	Fail
+	// Description:	reports parse error
+	// Arguments:	none
+	// Returns:		false
+	// --------------------------------------------------------------------------
+	bool JsonReader::Fail()
+	{
+		ERROR_TRACE("Json parse error at line %d.\n", myLine);
+		return false;
+	}
+
+
+
+	// JsonWriter //////////////////////////////////////////////////////////////
+
+	// --------------------------------------------------------------------------						
+	// Function:	JsonWriter
+	// Description:	constructor
+	// Arguments:	stream to write
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	JsonWriter::JsonWriter(std::ostream& stream) :
+		myStream(stream)
+	{}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Write
+	// Description:	writes dict straight to stream as json object
+	// Arguments:	dict
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void JsonWriter::Write(const StringKeyDictionary& dict)
 	{
+		WriteObject(dict, "");
+		myStream << '\n';
+	}
 
+
+	// --------------------------------------------------------------------------						
+	// Function:	WriteObject
+	// Description:	writes object one member per line, values of types json 
+	//				cannot represent are left out
+	// Arguments:	dict, indent of object
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void JsonWriter::WriteObject(const StringKeyDictionary& dict, const std::string& indent)
+	{
+		std::string memberIndent = indent + '\t';
+		bool first = true;
+		myStream << '{';
 		for (StringKeyDictionary::VariablesConstIterator it = dict.Begin(); it != dict.End(); it++)
 		{
-			std::string key = *it->first;
-			Variant &value = *it->second;
+			if (!IsWritable(*it->second))
+				continue;
 
-			if (value.IsType<Variant::NullType>())
-			{
-				Variant::NullType data;
-				value.Get(data);
-				//object[key.c_str()] = data;
-			}
-			else if (value.IsType<bool>())
-			{
-				bool data;
-				value.Get(data);
-				object[key] = data;
-			}
-			else if (value.IsType<int>())
-			{
-				int data;
-				value.Get(data);
-				object[key] = data;
-			}
-			else if (value.IsType<double>())
-			{
-				double data;
-				value.Get(data);
-				object[key] = data;
-			}
-			else if (value.IsType<std::string>())
-			{
-				std::string data;
-				value.Get(data);
-				object[key] = data;
-			}
-			else if (value.IsType<ArrayKeyDictionary>())
-			{
-				Json::Value subDict;
-				ArrayKeyDictionary data;
-				value.Get(data);
-				if (ConvertToValue(data, subDict))
-					object[key] = subDict;
-			}
-			else if (value.IsType<StringKeyDictionary>())
-			{
-				Json::Value subDict;
-				StringKeyDictionary data;
-				value.Get(data);
-				if (ConvertToValue(data, subDict))
-					object[key] = subDict;
-			}
+			myStream << (first ? "\n" : ",\n") << memberIndent;
+			WriteString(*it->first);
+			myStream << " : ";
+			WriteValue(*it->second, memberIndent);
+			first = false;
 		}
-		return true;
+		if (!first)
+			myStream << '\n' << indent;
+		myStream << '}';
 	}
 
 
+	// --------------------------------------------------------------------------						
+	// Function:	WriteArray
+	// Description:	writes array, on one line unless it holds objects or arrays,
+	//				values json cannot represent are written as null
+	// Arguments:	dict, indent of array
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void JsonWriter::WriteArray(const ArrayKeyDictionary& dict, const std::string& indent)
+	{
+		bool multiLine = false;
+		for (ArrayKeyDictionary::VariablesConstIterator it = dict.Begin(); it != dict.End() && !multiLine; it++)
+			multiLine = IsDictionary(*it->second);
 
+		std::string elementIndent = indent + '\t';
+		bool first = true;
+		myStream << '[';
+		for (ArrayKeyDictionary::VariablesConstIterator it = dict.Begin(); it != dict.End(); it++)
+		{
+			myStream << (first ? "" : ",");
+			if (multiLine)
+				myStream << '\n' << elementIndent;
+			else
+				myStream << ' ';
 
-	bool ConvertToValue(const ArrayKeyDictionary& dict, Json::Value& object)
-	{
-		int i = 0;
-		for (ArrayKeyDictionary::VariablesConstIterator it = dict.Begin(); it != dict.End(); it++, i++)
+			if (IsWritable(*it->second))
+				WriteValue(*it->second, elementIndent);
+			else
+				myStream << "null";
+			first = false;
+		}
+		if (!first)
 		{
-			Variant& value = *it->second;
+			if (multiLine)
+				myStream << '\n' << indent;
+			else
+				myStream << ' ';
+		}
+		myStream << ']';
+	}
 
-			if (value.IsType<Variant::NullType>())
-			{
-				Variant::NullType data;
-				value.Get(data);
-				//object[i] = data;
-			}
-			else if (value.IsType<bool>())
-			{
-				bool data;
-				value.Get(data);
-				object[i] = data;
-			}
-			else if (value.IsType<int>())
-			{
-				int data;
-				value.Get(data);
-				object[i] = data;
-			}
-			else if (value.IsType<double>())
-			{
-				double data;
-				value.Get(data);
-				object[i] = data;
-			}
-			else if (value.IsType<std::string>())
-			{
-				std::string data;
-				value.Get(data);
-				object[i] = data;
-			}
-			else if (value.IsType<ArrayKeyDictionary>())
+
+	// --------------------------------------------------------------------------						
+	// Function:	WriteValue
+	// Description:	writes value of a writable variant
+	// Arguments:	value, indent of value
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void JsonWriter::WriteValue(const Variant& value, const std::string& indent)
+	{
+		switch (value.GetKind())
+		{
+		case Variant::NullKind: myStream << "null"; break;
+		case Variant::BoolKind: myStream << (value.GetUnchecked<bool>() ? "true" : "false"); break;
+		case Variant::IntKind: myStream << value.GetUnchecked<int>(); break;
+		case Variant::UnsignedIntKind: myStream << value.GetUnchecked<unsigned int>(); break;
+		case Variant::LongKind: myStream << value.GetUnchecked<long>(); break;
+		case Variant::UnsignedLongKind: myStream << value.GetUnchecked<unsigned long>(); break;
+		case Variant::LongLongKind: myStream << value.GetUnchecked<long long>(); break;
+		case Variant::UnsignedLongLongKind: myStream << value.GetUnchecked<unsigned long long>(); break;
+		case Variant::StringKind: WriteString(value.GetUnchecked<std::string>()); break;
+		case Variant::StringKeyDictionaryKind: WriteObject(value.GetUnchecked<StringKeyDictionary>(), indent); break;
+		case Variant::ArrayKeyDictionaryKind: WriteArray(value.GetUnchecked<ArrayKeyDictionary>(), indent); break;
+		case Variant::FloatKind:
+		case Variant::DoubleKind:
+		{
+			double d = value.GetKind() == Variant::FloatKind ? value.GetUnchecked<float>() : value.GetUnchecked<double>();
+			if (!std::isfinite(d))
 			{
-				Json::Value subDict;
-				ArrayKeyDictionary data;
-				value.Get(data);
-				if (ConvertToValue(data, subDict))
-					object[i] = subDict;
+				myStream << "null";
+				break;
 			}
-			else if (value.IsType<StringKeyDictionary>())
+
+			// enough digits to read back the same double, always with a point or exponent
+			char buffer[32];
+			snprintf(buffer, sizeof(buffer), "%.17g", d);
+			myStream << buffer;
+			if (strpbrk(buffer, ".eE") == NULL)
+				myStream << ".0";
+			break;
+		}
+		default:
+			break;
+		}
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	WriteString
+	// Description:	writes quoted string escaping control characters
+	// Arguments:	string
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void JsonWriter::WriteString(const std::string& str)
+	{
+		myStream << '"';
+		for (std::string::const_iterator it = str.begin(); it != str.end(); it++)
+		{
+			unsigned char c = (unsigned char)*it;
+			switch (c)
 			{
-				Json::Value subDict;
-				StringKeyDictionary data;
-				value.Get(data);
-				if (ConvertToValue(data, subDict))
-					object[i] = subDict;
+			case '"': myStream << "\\\""; break;
+			case '\\': myStream << "\\\\"; break;
+			case '\b': myStream << "\\b"; break;
+			case '\f': myStream << "\\f"; break;
+			case '\n': myStream << "\\n"; break;
+			case '\r': myStream << "\\r"; break;
+			case '\t': myStream << "\\t"; break;
+			default:
+				if (c < 0x20)
+				{
+					char buffer[8];
+					snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+					myStream << buffer;
+				}
+				else
+				{
+					myStream << (char)c;
+				}
+				break;
 			}
-		}		
-		return true;
+		}
+		myStream << '"';
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	IsWritable
+	// Description:	tests if variant is of a type json can represent
+	// Arguments:	value
+	// Returns:		true if writable
+	// --------------------------------------------------------------------------
+	bool JsonWriter::IsWritable(const Variant& value)
+	{
+		Variant::Kind kind = value.GetKind();
+		return kind != Variant::OtherKind && kind != Variant::VariantKeyDictionaryKind;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	IsDictionary
+	// Description:	tests if variant is an object or array
+	// Arguments:	value
+	// Returns:		true if dictionary
+	// --------------------------------------------------------------------------
+	bool JsonWriter::IsDictionary(const Variant& value)
+	{
+		Variant::Kind kind = value.GetKind();
+		return kind == Variant::StringKeyDictionaryKind || kind == Variant::ArrayKeyDictionaryKind;
 	}
 
 
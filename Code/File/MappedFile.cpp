@@ -0,0 +1,151 @@
+///////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2025 David K Bhowmik. All rights reserved.
+// This file is part of shhArc.
+//
+// This Software is available under the MIT License with a No Modification clause.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this file and associated documentation files (the "Software"), to use the
+// Software for any purpose, including commercial applications, provided that:
+//
+//   1. You do NOT modify, alter, or create derivative works of this file.
+//   2. Redistributions must include this notice and may only distribute it 
+//      unmodified.
+//
+// The full MIT License text, including this Custom No Modification clause,
+// is available in the LICENSE file in the root of the project.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND.
+//
+// You may alternatively use this source under the terms of a specific 
+// version of the shhArc Unrestricted License provided you have obtained 
+// such a license from the copyright holder.
+///////////////////////////////////////////////////////////////////////////////
+#ifdef _WIN64
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#include "MappedFile.h"
+
+namespace shh {
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	MappedFile
+	// Description:	constructor
+	// Arguments:	none
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	MappedFile::MappedFile() :
+		myData(NULL),
+		mySize(0)
+#ifdef _WIN64
+		, myFile(INVALID_HANDLE_VALUE),
+		myMapping(NULL)
+#endif
+	{}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	~MappedFile
+	// Description:	destructor
+	// Arguments:	none
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	MappedFile::~MappedFile()
+	{
+		Close();
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Open
+	// Description:	maps whole file into memory read only, pages are only
+	//				loaded by the os when first touched
+	// Arguments:	filename
+	// Returns:		if successful
+	// --------------------------------------------------------------------------
+	bool MappedFile::Open(const std::string& filename)
+	{
+		Close();
+
+#ifdef _WIN64
+		myFile = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		if (myFile == INVALID_HANDLE_VALUE)
+			return false;
+
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(myFile, &size) || size.QuadPart == 0)
+		{
+			Close();
+			return false;
+		}
+
+		myMapping = CreateFileMappingA(myFile, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (myMapping == NULL)
+		{
+			Close();
+			return false;
+		}
+
+		myData = (const char*)MapViewOfFile(myMapping, FILE_MAP_READ, 0, 0, 0);
+		if (myData == NULL)
+		{
+			Close();
+			return false;
+		}
+		mySize = (size_t)size.QuadPart;
+#else
+		int file = open(filename.c_str(), O_RDONLY);
+		if (file < 0)
+			return false;
+
+		struct stat buffer;
+		if (fstat(file, &buffer) != 0 || buffer.st_size == 0)
+		{
+			close(file);
+			return false;
+		}
+
+		void* data = mmap(NULL, (size_t)buffer.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+		close(file);
+		if (data == MAP_FAILED)
+			return false;
+
+		myData = (const char*)data;
+		mySize = (size_t)buffer.st_size;
+#endif
+		return true;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Close
+	// Description:	unmaps file
+	// Arguments:	none
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void MappedFile::Close()
+	{
+#ifdef _WIN64
+		if (myData != NULL)
+			UnmapViewOfFile(myData);
+		if (myMapping != NULL)
+			CloseHandle(myMapping);
+		if (myFile != INVALID_HANDLE_VALUE)
+			CloseHandle(myFile);
+		myMapping = NULL;
+		myFile = INVALID_HANDLE_VALUE;
+#else
+		if (myData != NULL)
+			munmap((void*)myData, mySize);
+#endif
+		myData = NULL;
+		mySize = 0;
+	}
+
+}	// namespace shh
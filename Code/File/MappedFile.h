@@ -0,0 +1,102 @@
+///////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2025 David K Bhowmik. All rights reserved.
+// This file is part of shhArc.
+//
+// This Software is available under the MIT License with a No Modification clause.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this file and associated documentation files (the "Software"), to use the
+// Software for any purpose, including commercial applications, provided that:
+//
+//   1. You do NOT modify, alter, or create derivative works of this file.
+//   2. Redistributions must include this notice and may only distribute it 
+//      unmodified.
+//
+// The full MIT License text, including this Custom No Modification clause,
+// is available in the LICENSE file in the root of the project.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND.
+//
+// You may alternatively use this source under the terms of a specific 
+// version of the shhArc Unrestricted License provided you have obtained 
+// such a license from the copyright holder.
+///////////////////////////////////////////////////////////////////////////////
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+
+#include "../Common/SecureStl.h"
+#include "../Common/Debug.h"
+#include <string>
+
+
+namespace shh {
+
+	class MappedFile
+	{
+	public:
+
+		MappedFile();
+		~MappedFile();
+
+		bool Open(const std::string& filename);
+		void Close();
+
+		inline bool IsOpen() const;
+		inline const char* GetData() const;
+		inline size_t GetSize() const;
+
+	private:
+
+		MappedFile(const MappedFile& other) = delete;
+		MappedFile& operator=(const MappedFile& other) = delete;
+
+		const char* myData;
+		size_t mySize;
+#ifdef _WIN64
+		void* myFile;
+		void* myMapping;
+#endif
+	};
+
+
+	// MappedFile Inlines /////////////////////////////////////////////////////////
+
+	// --------------------------------------------------------------------------						
+	// Function:	IsOpen
+	// Description:	tests if file is mapped
+	// Arguments:	none
+	// Returns:		if open
+	// --------------------------------------------------------------------------
+	inline bool MappedFile::IsOpen() const
+	{
+		return myData != NULL;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	GetData
+	// Description:	returns start of mapped file
+	// Arguments:	none
+	// Returns:		read only file contents
+	// --------------------------------------------------------------------------
+	inline const char* MappedFile::GetData() const
+	{
+		return myData;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	GetSize
+	// Description:	returns size of mapped file
+	// Arguments:	none
+	// Returns:		size in bytes
+	// --------------------------------------------------------------------------
+	inline size_t MappedFile::GetSize() const
+	{
+		return mySize;
+	}
+
+}	// namespace shh
+
+#endif
@@ -0,0 +1,457 @@
+///////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2025 David K Bhowmik. All rights reserved.
+// This file is part of shhArc.
+//
+// This Software is available under the MIT License with a No Modification clause.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this file and associated documentation files (the "Software"), to use the
+// Software for any purpose, including commercial applications, provided that:
+//
+//   1. You do NOT modify, alter, or create derivative works of this file.
+//   2. Redistributions must include this notice and may only distribute it 
+//      unmodified.
+//
+// The full MIT License text, including this Custom No Modification clause,
+// is available in the LICENSE file in the root of the project.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND.
+//
+// You may alternatively use this source under the terms of a specific 
+// version of the shhArc Unrestricted License provided you have obtained 
+// such a license from the copyright holder.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifdef _MSC_VER
+#pragma warning(disable:4786 4503)
+#endif
+
+#include "../Common/ThreadSafety.h"
+#include "../Common/Mutex.h"
+#include "../Config/GCPtr.h"
+#include "CycleCollector.h"
+#include <map>
+
+
+namespace shh {
+
+	unsigned int CycleCollector::ourBudget = 1024;
+	thread_local bool CycleCollector::ourThreadClosed = false;
+
+
+	// Trial ////////////////////////////////////////////////////////////////////////
+
+	// working state of one collection slice, Bacon-Rajan trial deletion run
+	// synchronously over the subgraphs reachable from the suspects taken
+	class CycleCollector::Trial : public GCTracer
+	{
+	public:
+
+		enum Colour { Black, Gray, White };
+
+		struct Entry
+		{
+			int myCount;
+			Colour myColour;
+			std::vector<MemoryInfo*> myChildren;
+		};
+
+		typedef std::map<MemoryInfo*, Entry> Entries;
+
+		Trial();
+
+		static bool IsCollectable(MemoryInfo* info);
+
+		inline unsigned int GetSize() const { return (unsigned int)myEntries.size(); }
+
+		bool MarkGray(MemoryInfo* root, unsigned int budget);
+		void Scan(MemoryInfo* root);
+		void CollectWhite(std::vector<GCPtr<GCObject>>& garbage);
+
+		virtual void Trace(const MemoryPtr& reference);
+
+	private:
+
+		Entries myEntries;
+		std::vector<MemoryInfo*>* myTracing;
+
+		Entry& GetEntry(MemoryInfo* info);
+		void ScanBlack(MemoryInfo* root);
+	};
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Trial
+	// Description:	constructor
+	// Arguments:	none
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	CycleCollector::Trial::Trial() :
+		myTracing(NULL)
+	{
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	IsCollectable
+	// Description:	tests if info refers to a live gc object the collector may
+	//				trace
+	// Arguments:	info
+	// Returns:		bool
+	// --------------------------------------------------------------------------
+	bool CycleCollector::Trial::IsCollectable(MemoryInfo* info)
+	{
+		return info != NULL && info->IsValid() && !info->IsDying() && info->myGCObject != NULL;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Trace
+	// Description:	records a reference held by the object being traced
+	// Arguments:	reference
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void CycleCollector::Trial::Trace(const MemoryPtr& reference)
+	{
+		MemoryInfo* info = reference.GetInfo();
+		if (IsCollectable(info))
+			myTracing->push_back(info);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	GetEntry
+	// Description:	gets the entry for an info, tracing its object on first visit
+	// Arguments:	info
+	// Returns:		entry
+	// --------------------------------------------------------------------------
+	CycleCollector::Trial::Entry& CycleCollector::Trial::GetEntry(MemoryInfo* info)
+	{
+		Entries::iterator it = myEntries.find(info);
+		if (it != myEntries.end())
+			return it->second;
+
+		Entry& entry = myEntries[info];
+		entry.myCount = info->GetReferenceCount();
+		entry.myColour = Black;
+		myTracing = &entry.myChildren;
+		info->myGCObject->TraceReferences(*this);
+		myTracing = NULL;
+		return entry;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	MarkGray
+	// Description:	removes the counts contributed by internal references in the
+	//				subgraph reachable from root, stopping once the trial has
+	//				traced budget objects. Objects left unmarked keep their 
+	//				counts so scanning a partly marked subgraph stays safe, it 
+	//				just finds no garbage in the unmarked part
+	// Arguments:	root info, maximum objects traced by the trial, 0 for no
+	//				limit
+	// Returns:		false if stopped by the budget
+	// --------------------------------------------------------------------------
+	bool CycleCollector::Trial::MarkGray(MemoryInfo* root, unsigned int budget)
+	{
+		std::vector<MemoryInfo*> stack(1, root);
+		while (!stack.empty())
+		{
+			if (budget != 0 && GetSize() >= budget)
+				return false;
+
+			MemoryInfo* info = stack.back();
+			stack.pop_back();
+			Entry& entry = GetEntry(info);
+			if (entry.myColour == Gray)
+				continue;
+
+			entry.myColour = Gray;
+			for (unsigned int c = 0; c < entry.myChildren.size(); c++)
+			{
+				MemoryInfo* child = entry.myChildren[c];
+				Entry& childEntry = GetEntry(child);
+				childEntry.myCount--;
+				if (childEntry.myColour != Gray)
+					stack.push_back(child);
+			}
+		}
+		return true;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Scan
+	// Description:	colours gray objects with no external references white and
+	//				restores those still referenced from outside to black
+	// Arguments:	root info
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void CycleCollector::Trial::Scan(MemoryInfo* root)
+	{
+		std::vector<MemoryInfo*> stack(1, root);
+		while (!stack.empty())
+		{
+			MemoryInfo* info = stack.back();
+			stack.pop_back();
+			Entry& entry = myEntries[info];
+			if (entry.myColour != Gray)
+				continue;
+
+			if (entry.myCount > 0)
+			{
+				ScanBlack(info);
+				continue;
+			}
+
+			entry.myColour = White;
+			for (unsigned int c = 0; c < entry.myChildren.size(); c++)
+				stack.push_back(entry.myChildren[c]);
+		}
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	ScanBlack
+	// Description:	restores the internal counts of everything reachable from an
+	//				externally referenced object
+	// Arguments:	root info
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void CycleCollector::Trial::ScanBlack(MemoryInfo* root)
+	{
+		myEntries[root].myColour = Black;
+		std::vector<MemoryInfo*> stack(1, root);
+		while (!stack.empty())
+		{
+			MemoryInfo* info = stack.back();
+			stack.pop_back();
+			Entry& entry = myEntries[info];
+			for (unsigned int c = 0; c < entry.myChildren.size(); c++)
+			{
+				MemoryInfo* child = entry.myChildren[c];
+				Entry& childEntry = myEntries[child];
+				childEntry.myCount++;
+				if (childEntry.myColour != Black)
+				{
+					childEntry.myColour = Black;
+					stack.push_back(child);
+				}
+			}
+		}
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	CollectWhite
+	// Description:	takes pointers to all objects found to be garbage
+	// Arguments:	array to fill
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void CycleCollector::Trial::CollectWhite(std::vector<GCPtr<GCObject>>& garbage)
+	{
+		for (Entries::iterator it = myEntries.begin(); it != myEntries.end(); it++)
+		{
+			if (it->second.myColour != White)
+				continue;
+
+			GCObject* object = dynamic_cast<GCObject*>(it->first->myGCObject);
+			if (object != NULL)
+				garbage.push_back(GCPtr<GCObject>(object));
+		}
+	}
+
+
+
+	// CycleCollector /////////////////////////////////////////////////////////////////
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Suspect
+	// Description:	buffers an info whose count dropped without reaching zero as
+	//				a possible root of a garbage cycle. The suspect flag is 
+	//				claimed atomically so an info is buffered once, in the 
+	//				calling threads buffer which needs no lock
+	// Arguments:	info
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void CycleCollector::Suspect(MemoryInfo* info)
+	{
+		if (!LOCKCLAIMGCFLAG(info->mySuspected))
+			return;
+
+		Suspects* local = GetThreadSuspects();
+		if (local == NULL)
+		{
+			// thread is exiting so hand straight to the collector
+			Mutex* mutex = GetMutex();
+			LOCK_MUTEX(mutex);
+			GetSuspects().push_back(info);
+			UNLOCK_MUTEX(mutex);
+			return;
+		}
+
+		local->push_back(info);
+		if (local->size() >= ourThreadBatch)
+			FlushThreadSuspects(*local);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Collect
+	// Description:	runs trial deletion from buffered suspects until the budget
+	//				of objects visited is spent, destroying unreachable cycles
+	// Arguments:	maximum objects to visit, 0 for no limit
+	// Returns:		number of objects destroyed
+	// --------------------------------------------------------------------------
+	unsigned int CycleCollector::Collect(unsigned int budget)
+	{
+		Trial trial;
+		std::vector<MemoryInfo*> roots;
+		Suspects& suspects = GetSuspects();
+		Mutex* mutex = GetMutex();
+
+		Suspects* local = GetThreadSuspects();
+		if (local != NULL)
+			FlushThreadSuspects(*local);
+
+		// the budget is checked as objects are traced, a root whose subgraph
+		// is cut short is buffered again behind the other suspects
+		MemoryInfo* unfinished = NULL;
+		LOCK_MUTEX(mutex);
+		while (!suspects.empty() && (budget == 0 || trial.GetSize() < budget))
+		{
+			MemoryInfo* info = suspects.back();
+			suspects.pop_back();
+			info->mySuspected = 0;
+
+			if (info->IsOrphaned())
+				delete info;
+			else if (info->GetReferenceCount() > 0 && Trial::IsCollectable(info))
+			{
+				roots.push_back(info);
+				if (!trial.MarkGray(info, budget))
+				{
+					unfinished = info;
+					break;
+				}
+			}
+		}
+		if (unfinished != NULL)
+		{
+			unfinished->mySuspected = 1;
+			suspects.insert(suspects.begin(), unfinished);
+		}
+		UNLOCK_MUTEX(mutex);
+
+		if (roots.empty())
+			return 0;
+
+		for (unsigned int r = 0; r < roots.size(); r++)
+			trial.Scan(roots[r]);
+
+		// hold every white object before destroying any so destructors
+		// releasing their references cannot delete infos still to be visited
+		std::vector<GCPtr<GCObject>> garbage;
+		trial.CollectWhite(garbage);
+		for (unsigned int g = 0; g < garbage.size(); g++)
+			garbage[g].Destroy();
+
+		unsigned int destroyed = (unsigned int)garbage.size();
+		garbage.clear();
+		return destroyed;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	GetNumSuspects
+	// Description:	gets number of suspects handed to the collector awaiting 
+	//				collection, those still buffered by threads are not counted
+	// Arguments:	none
+	// Returns:		count
+	// --------------------------------------------------------------------------
+	unsigned int CycleCollector::GetNumSuspects()
+	{
+		Mutex* mutex = GetMutex();
+		LOCK_MUTEX(mutex);
+		unsigned int n = (unsigned int)GetSuspects().size();
+		UNLOCK_MUTEX(mutex);
+		return n;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	GetSuspects
+	// Description:	gets suspect buffer, created on first use as pointers may be
+	//				released during static initialization
+	// Arguments:	none
+	// Returns:		suspects
+	// --------------------------------------------------------------------------
+	CycleCollector::Suspects& CycleCollector::GetSuspects()
+	{
+		static Suspects* suspects = new Suspects;
+		return *suspects;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	GetThreadSuspects
+	// Description:	gets suspect buffer of calling thread
+	// Arguments:	none
+	// Returns:		suspects or NULL if thread is exiting
+	// --------------------------------------------------------------------------
+	CycleCollector::Suspects* CycleCollector::GetThreadSuspects()
+	{
+		if (ourThreadClosed)
+			return NULL;
+
+		static thread_local ThreadSuspects threadSuspects;
+		return &threadSuspects.mySuspects;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	FlushThreadSuspects
+	// Description:	hands suspects buffered by a thread to the collector
+	// Arguments:	thread suspect buffer
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void CycleCollector::FlushThreadSuspects(Suspects& local)
+	{
+		if (local.empty())
+			return;
+
+		Mutex* mutex = GetMutex();
+		LOCK_MUTEX(mutex);
+		Suspects& suspects = GetSuspects();
+		suspects.insert(suspects.end(), local.begin(), local.end());
+		UNLOCK_MUTEX(mutex);
+		local.clear();
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	~ThreadSuspects
+	// Description:	destructor, hands suspects of exiting thread to collector
+	// Arguments:	none
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	CycleCollector::ThreadSuspects::~ThreadSuspects()
+	{
+		ourThreadClosed = true;
+		FlushThreadSuspects(mySuspects);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	GetMutex
+	// Description:	gets suspect buffer mutex
+	// Arguments:	none
+	// Returns:		mutex
+	// --------------------------------------------------------------------------
+	Mutex* CycleCollector::GetMutex()
+	{
+		static Mutex* mutex = new Mutex;
+		return mutex;
+	}
+}
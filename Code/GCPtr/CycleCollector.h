@@ -0,0 +1,69 @@
+///////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2025 David K Bhowmik. All rights reserved.
+// This file is part of shhArc.
+//
+// This Software is available under the MIT License with a No Modification clause.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this file and associated documentation files (the "Software"), to use the
+// Software for any purpose, including commercial applications, provided that:
+//
+//   1. You do NOT modify, alter, or create derivative works of this file.
+//   2. Redistributions must include this notice and may only distribute it 
+//      unmodified.
+//
+// The full MIT License text, including this Custom No Modification clause,
+// is available in the LICENSE file in the root of the project.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND.
+//
+// You may alternatively use this source under the terms of a specific 
+// version of the shhArc Unrestricted License provided you have obtained 
+// such a license from the copyright holder.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef CYCLECOLLECTOR_H
+#define CYCLECOLLECTOR_H
+
+#include <vector>
+
+namespace shh {
+
+	class MemoryInfo;
+	class Mutex;
+
+	class CycleCollector
+	{
+	public:
+
+		static unsigned int ourBudget;
+
+		static void Suspect(MemoryInfo* info);
+		static unsigned int Collect(unsigned int budget);
+		static unsigned int GetNumSuspects();
+
+	private:
+
+		class Trial;
+		typedef std::vector<MemoryInfo*> Suspects;
+
+		// suspects released on a thread are buffered without locking and
+		// handed to the collector in batches, or when the thread exits
+		enum { ourThreadBatch = 64 };
+		class ThreadSuspects
+		{
+		public:
+			~ThreadSuspects();
+			Suspects mySuspects;
+		};
+
+		static thread_local bool ourThreadClosed;
+
+		static Suspects& GetSuspects();
+		static Suspects* GetThreadSuspects();
+		static void FlushThreadSuspects(Suspects& local);
+		static Mutex* GetMutex();
+	};
+}
+
+#endif // CYCLECOLLECTOR_H
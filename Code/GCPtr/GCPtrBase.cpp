@@ -187,6 +187,18 @@ namespace shh {
 	}
 
 
+	// --------------------------------------------------------------------------						
+	// Function:	TraceReferences
+	// Description:	reports the pointers this object owns to the cycle collector,
+	//				untraced pointers count as external so are never collected
+	// Arguments:	tracer
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void GCObjectBase::TraceReferences(GCTracer& tracer) const
+	{
+	}
+
+
 	// --------------------------------------------------------------------------						
 	// Function:	VoidGCInfo
 	// Description:	clear gc info
@@ -197,7 +209,9 @@ namespace shh {
 	{
 		if (myGCInfo != NULL)
 		{
+			// weak pointers may keep the info alive past the block so unlink it now
 			myGCInfo->SetValid(false);
+			myGCInfo->Detach();
 			GCInfo* null = NULL;
 			LOCKEXCHANGEGCOBJECT(myGCInfo, null);
 		}
@@ -280,20 +294,10 @@ namespace shh {
 		}
 		else
 		{
-			if (MemoryLocator::IsVariableSizeData((char*)myMemoryStart))
-			{
-				MemoryLocator::VariableHeader& header = MemoryLocator::GetVariableHeader((char*)myMemoryStart);
-				GCInfo* info = new GCInfo(*header.myLocator, header.myLocator->AddressOffset(this), true);
-				LOCKEXCHANGEGCOBJECT(myGCInfo, info);
-				header.myMemoryInfo = myGCInfo;
-			}
-			else
-			{
-				MemoryLocator::FixedHeader& header = MemoryLocator::GetFixedHeader((char*)myMemoryStart);
-				GCInfo* info = new GCInfo(*header.myLocator, header.myLocator->AddressOffset(this), true);
-				LOCKEXCHANGEGCOBJECT(myGCInfo, info);
-				header.myMemoryInfo = myGCInfo;
-			}
+			MemoryLocator* locator = MemoryLocator::GetLocator((char*)myMemoryStart);
+			GCInfo* info = new GCInfo(*locator, locator->AddressOffset(this), true);
+			LOCKEXCHANGEGCOBJECT(myGCInfo, info);
+			MemoryLocator::GetMemoryInfo((char*)myMemoryStart) = myGCInfo;
 			return myGCInfo;
 		}
 	}
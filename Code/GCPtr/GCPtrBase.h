@@ -30,12 +30,15 @@
 #include "SecureStl.h"
 #include "MemoryPtr.h"
 #include <algorithm>
+#include <map>
+#include <type_traits>
 
 
 namespace shh {
 
 	class GCObjectBase;
 	template<class BASE> class GCObjectBaseInterface;
+	template<typename T> class WeakGCPtrBase;
 
 	// GCInfo ///////////////////////////////////////////////////////////////////////
 
@@ -67,6 +70,23 @@ namespace shh {
 
 
 
+	// GCTracer /////////////////////////////////////////////////////////////////////////
+
+	// visitor handed to GCObjectBase::TraceReferences to report the pointers an
+	// object owns, used by the cycle collector
+	class GCTracer
+	{
+	public:
+
+		virtual ~GCTracer() {}
+		virtual void Trace(const MemoryPtr& reference) = 0;
+
+		template<class C> inline void TraceAll(const C& references);
+		template<class K, class V> inline void TraceValues(const std::map<K, V>& references);
+	};
+
+
+
 	// GCObjectBase /////////////////////////////////////////////////////////////////////
 
 	class GCObjectBase
@@ -82,6 +102,7 @@ namespace shh {
 		GCObjectBase();
 		virtual ~GCObjectBase();
 		virtual bool Finalize(GCObjectInterface<GCObjectBase>* gc);
+		virtual void TraceReferences(GCTracer& tracer) const;
 
 		void VoidGCInfo();
 		void Init();
@@ -122,6 +143,8 @@ namespace shh {
 	{
 
 		friend typename T;
+		template< typename Other > friend class GCPtrBase;
+		template< typename Other > friend class WeakGCPtrBase;
 
 	public:
 
@@ -129,7 +152,9 @@ namespace shh {
 		explicit GCPtrBase(T* object);
 		template< typename Other > GCPtrBase(GCPtrBase<Other> const& other);
 		template< typename Other > GCPtrBase(GCPtrBase<Other> const& other, bool dummy);
+		template< typename Other, typename = typename std::enable_if<std::is_convertible<Other*, T*>::value>::type > GCPtrBase(GCPtrBase<Other>&& other);
 		GCPtrBase(GCPtrBase const& other);
+		GCPtrBase(GCPtrBase&& other);
 		~GCPtrBase();
 
 
@@ -138,6 +163,7 @@ namespace shh {
 		template< typename Other > inline bool StaticCast(GCPtrBase<Other> const& other);
 		template< typename Other > inline GCPtrBase& operator=(GCPtrBase< Other > const& other);
 		inline GCPtrBase& operator=(GCPtrBase const& other);
+		inline GCPtrBase& operator=(GCPtrBase&& other);
 
 		void BlankInit();
 		void Init(GCObjectBase* const& object);
@@ -155,11 +181,14 @@ namespace shh {
 	protected:
 
 		static bool ourMemoryManaged;
-		T* myObject;
-		void* myInfoObject;
+		mutable T* myObject;
+		mutable void* myInfoObject;
 
+		GCPtrBase(GCInfo* info, T* object, void* infoObject);
 		template< typename Other > inline  GCPtrBase& Assign(GCPtrBase< Other > const& other);
 		inline T* SetObject() const;
+		template< typename Other > inline void SetObject(GCPtrBase<Other> const& other, std::true_type upcast) const;
+		template< typename Other > inline void SetObject(GCPtrBase<Other> const& other, std::false_type upcast) const;
 
 	};
 
@@ -251,6 +280,36 @@ namespace shh {
 
 
 
+	// GCTracer  //////////////////////////////////////////////////////////////
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	TraceAll
+	// Description:	traces every pointer in a container
+	// Arguments:	container of pointers
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	template<class C> inline void GCTracer::TraceAll(const C& references)
+	{
+		for (typename C::const_iterator it = references.begin(); it != references.end(); it++)
+			Trace(*it);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	TraceValues
+	// Description:	traces every pointer held as a value in a map
+	// Arguments:	map of pointers
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	template<class K, class V> inline void GCTracer::TraceValues(const std::map<K, V>& references)
+	{
+		for (typename std::map<K, V>::const_iterator it = references.begin(); it != references.end(); it++)
+			Trace(it->second);
+	}
+
+
+
 	// GCObjectBase  //////////////////////////////////////////////////////////
 
 	
@@ -306,7 +365,12 @@ namespace shh {
 		myObject(NULL), 
 		myInfoObject(NULL) 
 	{ 
-		SetObject(); 
+		// object type is known so no need to cast from the info
+		if (IsValid())
+		{
+			myObject = object;
+			myInfoObject = GetGCInfo()->GetObject();
+		}
 	}
 	
 
@@ -323,7 +387,7 @@ namespace shh {
 		myObject(NULL), 
 		myInfoObject(NULL) 
 	{ 
-		SetObject(); 
+		SetObject(other, typename std::is_convertible<Other*, T*>::type());
 	}
 
 
@@ -339,8 +403,33 @@ namespace shh {
 		myObject(NULL), 
 		myInfoObject(NULL) 
 	{ 
-		SetObject(); 
+		if (IsValid())
+		{
+			myObject = static_cast<T*>(other.GetObject());
+			myInfoObject = GetGCInfo()->GetObject();
+		}
 	} 	//Static-cast constructor
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	GCPtrBase
+	// Description:	move constructor from pointer to derived type, other is 
+	//				left null
+	// Arguments:	ptr to object this will point to
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	template< typename T > 
+	template< typename Other, typename > GCPtrBase<T>::GCPtrBase(GCPtrBase<Other>&& other) : 
+		MemoryPtr(GCInfo::CreateNull()), 
+		myObject(NULL), 
+		myInfoObject(NULL) 
+	{ 
+		std::swap(myInfo, other.myInfo);
+		myObject = other.myObject;
+		myInfoObject = other.myInfoObject;
+		other.myObject = NULL;
+		other.myInfoObject = NULL;
+	}
 	
 
 	// --------------------------------------------------------------------------						
@@ -351,13 +440,44 @@ namespace shh {
 	// --------------------------------------------------------------------------
 	template< typename T > GCPtrBase<T>::GCPtrBase(GCPtrBase const& other) : 
 		MemoryPtr(other.GetInfo()), 
+		myObject(other.myObject), 
+		myInfoObject(other.myInfoObject) 
+	{ 
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	GCPtrBase
+	// Description:	move constructor, other is left null
+	// Arguments:	ptr to object this will point to
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	template< typename T > GCPtrBase<T>::GCPtrBase(GCPtrBase&& other) : 
+		MemoryPtr(GCInfo::CreateNull()), 
 		myObject(NULL), 
 		myInfoObject(NULL) 
 	{ 
-		SetObject(); 
+		std::swap(myInfo, other.myInfo);
+		std::swap(myObject, other.myObject);
+		std::swap(myInfoObject, other.myInfoObject);
 	}
 	
 
+	// --------------------------------------------------------------------------						
+	// Function:	GCPtrBase
+	// Description:	constructor from an info whose object is already known, 
+	//				used when locking weak pointers
+	// Arguments:	info, object, object address held by info
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	template< typename T > GCPtrBase<T>::GCPtrBase(GCInfo* info, T* object, void* infoObject) : 
+		MemoryPtr(info), 
+		myObject(object), 
+		myInfoObject(infoObject) 
+	{ 
+	}
+
+
 	// --------------------------------------------------------------------------						
 	// Function:	~GCPtrBase
 	// Description:	destructor
@@ -379,11 +499,16 @@ namespace shh {
 	// --------------------------------------------------------------------------
 	template< typename T > inline void GCPtrBase<T>::Swap(GCPtrBase& other)
 	{
+		// cached objects stay correct for their info so swap them too
 		MemoryInfo* info = myInfo;
 		LOCKEXCHANGEGCOBJECT(myInfo, other.myInfo);
 		LOCKEXCHANGEGCOBJECT(other.myInfo, info);
-		SetObject();
-		other.SetObject();
+		T* object = myObject;
+		LOCKEXCHANGEGCOBJECT(myObject, other.myObject);
+		LOCKEXCHANGEGCOBJECT(other.myObject, object);
+		void* infoObject = myInfoObject;
+		LOCKEXCHANGEGCOBJECT(myInfoObject, other.myInfoObject);
+		LOCKEXCHANGEGCOBJECT(other.myInfoObject, infoObject);
 	}
 
 
@@ -459,6 +584,20 @@ namespace shh {
 	}
 
 
+	// --------------------------------------------------------------------------						
+	// Function:	=
+	// Description:	move assigns pointer, other is left null
+	// Arguments:	pointer to set to
+	// Returns:		this
+	// --------------------------------------------------------------------------
+	template< typename T > inline GCPtrBase<T>& GCPtrBase<T>::operator=(GCPtrBase&& other) 
+	{ 
+		GCPtrBase temp(std::move(other));
+		Swap(temp);
+		return *this;
+	}
+
+
 	// --------------------------------------------------------------------------						
 	// Function:	BlankInit
 	// Description:	initializes blank pointerf
@@ -480,14 +619,11 @@ namespace shh {
 	// --------------------------------------------------------------------------
 	template< typename T > void GCPtrBase<T>::Init(GCObjectBase* const& object)
 	{
-		GCInfo* i = myInfo;
+		MemoryInfo* i = myInfo;
 		myInfo = GetGCInfoFromObject(object, ourMemoryManaged);
 		myInfo->IncrementReferenceCount();
 		if (i != NULL)
-		{
-			if (i->DecrementReferenceCount() == 0)
-				delete i;
-		}
+			Release(i);
 	}
 
 
@@ -637,6 +773,36 @@ namespace shh {
 	}
 
 
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	SetObject
+	// Description:	sets the myObject from a pointer to a type known to 
+	//				derive from T without casting
+	// Arguments:	pointer copied from, upcast flag
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	template< typename T > 
+	template< typename Other > inline void GCPtrBase<T>::SetObject(GCPtrBase<Other> const& other, std::true_type upcast) const
+	{
+		myObject = other.myObject;
+		myInfoObject = other.myInfoObject;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	SetObject
+	// Description:	sets the myObject from a pointer to a type not known to
+	//				derive from T by dynamic casting
+	// Arguments:	pointer copied from, upcast flag
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	template< typename T > 
+	template< typename Other > inline void GCPtrBase<T>::SetObject(GCPtrBase<Other> const& other, std::false_type upcast) const
+	{
+		SetObject();
+	}
+
 }
 
 #endif // GCPtrBase_H
@@ -22,12 +22,111 @@
 // such a license from the copyright holder.
 ///////////////////////////////////////////////////////////////////////////////
 
+#include "../Common/ThreadSafety.h"
+#include "../Common/Mutex.h"
 #include "MemoryInfo.h"
 
 
 namespace shh {
 
 
+	// InfoPool ///////////////////////////////////////////////////////////////////////
+
+	// slab allocator for info records so creating smart pointers to many small 
+	// objects does not double the number of heap allocations
+	class InfoPool
+	{
+	public:
+
+		enum { slabRecords = 1024 };
+
+		InfoPool();
+		void* Allocate();
+		void Deallocate(void* p);
+
+		static InfoPool& GetPool();
+
+	private:
+
+		void* myFree;
+		Mutex* myMutex;
+	};
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	InfoPool
+	// Description:	constructor
+	// Arguments:	none
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	InfoPool::InfoPool() :
+		myFree(NULL)
+	{
+		myMutex = new Mutex;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Allocate
+	// Description:	takes a record from the free list, adding a slab if empty
+	// Arguments:	none
+	// Returns:		record memory
+	// --------------------------------------------------------------------------
+	void* InfoPool::Allocate()
+	{
+		LOCK_MUTEX(myMutex);
+		if (myFree == NULL)
+		{
+			// slabs live for the life of the process
+			char* slab = (char*)::operator new(slabRecords * sizeof(MemoryInfo));
+			for (int r = slabRecords - 1; r >= 0; r--)
+			{
+				void* record = slab + r * sizeof(MemoryInfo);
+				*(void**)record = myFree;
+				myFree = record;
+			}
+		}
+		void* p = myFree;
+		myFree = *(void**)p;
+		UNLOCK_MUTEX(myMutex);
+		return p;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Deallocate
+	// Description:	returns a record to the free list
+	// Arguments:	record memory
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void InfoPool::Deallocate(void* p)
+	{
+		LOCK_MUTEX(myMutex);
+		*(void**)p = myFree;
+		myFree = p;
+		UNLOCK_MUTEX(myMutex);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	GetPool
+	// Description:	gets pool, created on first use as infos may be created
+	//				during static initialization
+	// Arguments:	none
+	// Returns:		pool
+	// --------------------------------------------------------------------------
+	InfoPool& InfoPool::GetPool()
+	{
+		static InfoPool* pool = new InfoPool;
+		return *pool;
+	}
+
+
+
+	// MemoryInfo /////////////////////////////////////////////////////////////////////
+
+
+
 	// --------------------------------------------------------------------------						
 	// Function:	MemoryInfo
 	// Description:	constructor
@@ -40,6 +139,8 @@ namespace shh {
 		myValid(0), 
 		myDying(0), 
 		myReferenceCount(0), 
+		myWeakCount(0),
+		mySuspected(0),
 		myObject(NULL), 
 		myGCObject(NULL) 
 	{ 
@@ -59,6 +160,8 @@ namespace shh {
 		myValid((int)valid), 
 		myDying(0), 
 		myReferenceCount(count), 
+		myWeakCount(0),
+		mySuspected(0),
 		myObject(object), 
 		myGCObject(NULL) 
 	{ 
@@ -78,6 +181,8 @@ namespace shh {
 		myLocator(l), 
 		myValid((int)valid), 
 		myDying(0), myReferenceCount(count), 
+		myWeakCount(0),
+		mySuspected(0),
 		myGCObject(NULL)
 	{
 		LOCKEXCHANGEGCOBJECT(myOffset.ptr, offset.ptr);
@@ -88,30 +193,47 @@ namespace shh {
 	
 	// --------------------------------------------------------------------------						
 	// Function:	~MemoryInfo
-	// Description:	destructor
+	// Description:	destructor, an info still linked to a block is one whose
+	//				block is live as freeing or destroying the object detaches it
 	// Arguments:	none
 	// Returns:		none
 	// --------------------------------------------------------------------------
 	MemoryInfo::~MemoryInfo()
 	{
 		Invalidate();
-		if (myLocator)
-		{
+		Detach();
+	}
 
-			if (MemoryLocator::IsVariableSizeData((char*)myObject))
-			{
-				MemoryLocator::VariableHeader& header = MemoryLocator::GetVariableHeader((char*)myObject);
-				MemoryInfo *null = NULL;
-				LOCKEXCHANGEGCOBJECT(header.myMemoryInfo, null);
-			}
-			else
-			{
-				MemoryLocator::FixedHeader& header = MemoryLocator::GetFixedHeader((char*)myObject);
-				MemoryInfo* null = NULL;
-				LOCKEXCHANGEGCOBJECT(header.myMemoryInfo, null);
-			}
 
-		}
+	// --------------------------------------------------------------------------						
+	// Function:	new
+	// Description:	allocates info record from the pool, records of other
+	//				sizes (derived types with members) use the heap
+	// Arguments:	size of record
+	// Returns:		memory
+	// --------------------------------------------------------------------------
+	void* MemoryInfo::operator new(std::size_t size)
+	{
+		if (size != sizeof(MemoryInfo))
+			return ::operator new(size);
+		return InfoPool::GetPool().Allocate();
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	delete
+	// Description:	returns info record to the pool
+	// Arguments:	memory, size of record
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void MemoryInfo::operator delete(void* p, std::size_t size)
+	{
+		if (p == NULL)
+			return;
+		if (size != sizeof(MemoryInfo))
+			::operator delete(p);
+		else
+			InfoPool::GetPool().Deallocate(p);
 	}
 
 
@@ -128,6 +250,33 @@ namespace shh {
 	}
 
 
+	// --------------------------------------------------------------------------						
+	// Function:	Detach
+	// Description:	cuts the link between this info and its memory block header,
+	//				must be called while the block is still live so an info
+	//				deleted later never writes into freed or reused memory
+	// Arguments:	none
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void MemoryInfo::Detach()
+	{
+		if (myLocator == NULL)
+			return;
+
+		MemoryInfo*& header = MemoryLocator::GetMemoryInfo((char*)myObject);
+		if (header == this)
+		{
+			MemoryInfo* null = NULL;
+			LOCKEXCHANGEGCOBJECT(header, null);
+		}
+
+		MemoryLocator* noLocator = NULL;
+		LOCKEXCHANGEGCOBJECT(myLocator, noLocator);
+		void* noObject = NULL;
+		LOCKEXCHANGEGCOBJECT(myObject, noObject);
+	}
+
+
 	// --------------------------------------------------------------------------						
 	// Function:	RegisterMoveAll
 	// Description: point all pointers to new location (batch usage)
@@ -26,15 +26,19 @@
 #define MEMORYINFO_H
 
 
+#include "../Config/Config.h"
+
 #ifdef _WIN64
 
 #include <windows.h>
 #undef GetObject
 
-
+#if MULTI_THREADED
 #define LOCKEXCHANGEGCOBJECT(a, b) InterlockedExchange64((LONGLONG*)&a, *(LONGLONG*)&b)
-#define LOCKINCREMENTGCREFCOUNT(a) InterlockedIncrement64((LONGLONG*)&a)
-#define LOCKDECREMENTGCREFCOUNT(a) InterlockedDecrement64((LONGLONG*)&a)
+#define LOCKINCREMENTGCREFCOUNT(a) InterlockedIncrement((LONG*)&a)
+#define LOCKDECREMENTGCREFCOUNT(a) InterlockedDecrement((LONG*)&a)
+#define LOCKCLAIMGCFLAG(a) (InterlockedCompareExchange((LONG*)&a, 1, 0) == 0)
+#endif
 #define GETTHREADID() GetCurrentThreadId()
 
 
@@ -42,15 +46,25 @@
 
 #include <pthread.h>
 
-
+#if MULTI_THREADED
 #define LOCKEXCHANGEGCOBJECT(a, b) __sync_val_compare_and_swap((long long*)&a, *(long long*)&a,*(long long*)&b)
 #define LOCKINCREMENTGCREFCOUNT(a) __sync_add_and_fetch(&a, 1)
-#define LOCKDECREMENT64(a) __sync_add_and_fetch(a, -1)
+#define LOCKDECREMENTGCREFCOUNT(a) __sync_add_and_fetch(&a, -1)
+#define LOCKCLAIMGCFLAG(a) __sync_bool_compare_and_swap(&a, 0, 1)
+#endif
 #define GETTHREADID() pthread_self()
 
 
 #endif 
 
+#if !MULTI_THREADED
+// single threaded so reference counts and pointer swaps need not be atomic
+#define LOCKEXCHANGEGCOBJECT(a, b) (a = b)
+#define LOCKINCREMENTGCREFCOUNT(a) (++a)
+#define LOCKDECREMENTGCREFCOUNT(a) (--a)
+#define LOCKCLAIMGCFLAG(a) (a == 0 ? (a = 1, true) : false)
+#endif
+
 #include "../Common/SecureStl.h"
 #include "../Common/Exception.h"
 #include "MemoryLocator.h"
@@ -67,6 +81,7 @@ namespace shh {
 		friend class GCObjectBase;
 		friend class MemoryFrame;
 		friend class Chunk;
+		friend class CycleCollector;
 
 	public:
 
@@ -75,7 +90,11 @@ namespace shh {
 		MemoryInfo(MemoryLocator* l, MemoryOffset offset, bool memoryManaged, int count = 0, bool valid = true);
 		virtual ~MemoryInfo();
 
+		static void* operator new(std::size_t size);
+		static void operator delete(void* p, std::size_t size);
+
 		bool Invalidate();
+		void Detach();
 	
 		inline MemoryOffset GetOffset() const;
 		inline char* AbsoluteAddress() const;
@@ -88,6 +107,10 @@ namespace shh {
 		inline void IncrementReferenceCount();
 		inline int DecrementReferenceCount();
 		inline int GetReferenceCount() const;
+		inline void IncrementWeakCount();
+		inline int DecrementWeakCount();
+		inline int GetWeakCount() const;
+		inline bool IsOrphaned() const;
 		inline bool IsMemoryManaged() const;
 
 	protected:
@@ -101,6 +124,8 @@ namespace shh {
 		int myValid;
 		int myDying;
 		int myReferenceCount;
+		int myWeakCount;
+		int mySuspected;
 		void* myObject;
 		GCObjectBase* myGCObject;
 
@@ -223,6 +248,55 @@ namespace shh {
 	}
 
 
+	// --------------------------------------------------------------------------						
+	// Function:	IncrementWeakCount
+	// Description:	increments number of weak pointers observing this object
+	// Arguments:	none
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	inline void MemoryInfo::IncrementWeakCount() 
+	{ 
+		LOCKINCREMENTGCREFCOUNT(myWeakCount); 
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	DecrementWeakCount
+	// Description:	decrements number of weak pointers observing this object
+	// Arguments:	none
+	// Returns:		weak count
+	// --------------------------------------------------------------------------
+	inline int MemoryInfo::DecrementWeakCount() 
+	{ 
+		return (int)LOCKDECREMENTGCREFCOUNT(myWeakCount); 
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	GetWeakCount
+	// Description:	gets number of weak pointers observing this object
+	// Arguments:	none
+	// Returns:		weak count
+	// --------------------------------------------------------------------------
+	inline int MemoryInfo::GetWeakCount() const 
+	{ 
+		return myWeakCount; 
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	IsOrphaned
+	// Description:	tests if nothing refers to this info any more so it can be
+	//				deleted, weak pointers and the cycle collector keep it alive
+	// Arguments:	none
+	// Returns:		bool
+	// --------------------------------------------------------------------------
+	inline bool MemoryInfo::IsOrphaned() const 
+	{ 
+		return myReferenceCount == 0 && myWeakCount == 0 && !mySuspected; 
+	}
+
+
 	// --------------------------------------------------------------------------						
 	// Function:	IsMemoryManaged
 	// Description:	returns if memory managed
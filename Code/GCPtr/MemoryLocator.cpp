@@ -133,12 +133,32 @@ namespace shh {
 	MemoryLocator::Header* MemoryLocator::Deallocate(void* p, bool invalidateInfo)
 	{
 		
-		if (IsVariableSizeData(p))
+		if (IsCompactData(p))
+		{
+			CompactHeader* head = &GetCompactHeader(p);
+
+			if (head->myMemoryInfo)
+			{
+				if (invalidateInfo)
+					head->myMemoryInfo->Invalidate();
+				head->myMemoryInfo->Detach();
+			}
+
+			head->myMemoryInfo = NULL;
+			head->myInUse = false;
+
+			return NULL;
+		}
+		else if (IsVariableSizeData(p))
 		{
 			VariableHeader* head = &GetVariableHeader(p);
 
-			if (head->myMemoryInfo && invalidateInfo)
-				head->myMemoryInfo->Invalidate();
+			if (head->myMemoryInfo)
+			{
+				if (invalidateInfo)
+					head->myMemoryInfo->Invalidate();
+				head->myMemoryInfo->Detach();
+			}
 
 			head->myMemoryInfo = NULL;
 			head->myDestructor = NULL;
@@ -152,8 +172,12 @@ namespace shh {
 		{
 			FixedHeader* head = &GetFixedHeader(p);
 			
-			if(head->myMemoryInfo && invalidateInfo)
-				head->myMemoryInfo->Invalidate();
+			if (head->myMemoryInfo)
+			{
+				if (invalidateInfo)
+					head->myMemoryInfo->Invalidate();
+				head->myMemoryInfo->Detach();
+			}
 
 			head->myMemoryInfo = NULL;
 			head->myDestructor = NULL;
@@ -104,10 +104,26 @@ namespace shh {
 		class FixedHeader : public Header
 		{
 		public:
-			FixedHeader(MemoryLocator* l) : Header(l), myPreviousHeader(NULL), myNextHeader(NULL), myVariable(false) {}
+			FixedHeader(MemoryLocator* l) : Header(l), myPreviousHeader(NULL), myNextHeader(NULL), myVariable(false), myCompact(false), myCached(false) {}
 			FixedHeader* myPreviousHeader;
 			FixedHeader* myNextHeader;
 			bool myVariable;
+			bool myCompact;
+			bool myCached;
+		};
+
+		// header of blocks in compact chunks, the locator is found by masking
+		// the block address to the chunk alignment, the destructor is held 
+		// by the allocator and free blocks are linked through their data
+		class CompactHeader
+		{
+		public:
+			CompactHeader() : myMemoryInfo(NULL), myVariable(false), myCompact(true), myInUse(true), myCached(false) {}
+			MemoryInfo* myMemoryInfo;
+			bool myVariable;
+			bool myCompact;
+			bool myInUse;
+			bool myCached;
 		};
 
 		class VariableHeader : public Header
@@ -125,6 +141,8 @@ namespace shh {
 
 		enum { fixedHeaderSize = sizeof(MemoryLocator::FixedHeader) };
 		enum { variableHeaderSize = sizeof(MemoryLocator::VariableHeader) };
+		enum { compactHeaderSize = sizeof(MemoryLocator::CompactHeader) };
+		enum { compactChunkSize = 65536 };
 		typedef enum Direction { None = 0, Up, Down } Direction;
 
 
@@ -143,9 +161,14 @@ namespace shh {
 		inline bool IsValid() const;
 
 		static inline bool IsVariableSizeData(void* address);
+		static inline bool IsCompactData(void* address);
 		static inline FixedHeader& GetFixedHeader(void* address);
 		static inline VariableHeader& GetVariableHeader(void* address);
+		static inline CompactHeader& GetCompactHeader(void* address);
 		static inline Header& GetHeader(void* address);
+		static inline MemoryLocator* GetLocator(void* address);
+		static inline MemoryInfo*& GetMemoryInfo(void* address);
+		static inline void SetDestructor(void* address, void (*destructor)(void*));
 
 	protected:
 
@@ -224,7 +247,7 @@ namespace shh {
 	// --------------------------------------------------------------------------
 	template< class T > void  MemoryLocator::MemoryDestructor<T>::Add(void* p)
 	{
-		MemoryLocator::GetHeader(p).myDestructor = &Destroy;
+		MemoryLocator::SetDestructor(p, &Destroy);
 	}
 
 
@@ -321,6 +344,19 @@ namespace shh {
 	}
 	
 
+	// --------------------------------------------------------------------------						
+	// Function:	IsCompactData
+	// Description:	return if object is in a compact chunk
+	// Arguments:	address of object type
+	// Returns:		bool
+	// --------------------------------------------------------------------------
+	inline bool MemoryLocator::IsCompactData(void* address) 
+	{ 
+		bool* flags = reinterpret_cast<bool*>(((char*)address) - sizeof(MemorySize));
+		return !flags[0] && flags[1]; 
+	}
+	
+
 	// --------------------------------------------------------------------------						
 	// Function:	GetFixedHeader
 	// Description:	returns header for fixed size object
@@ -345,6 +381,18 @@ namespace shh {
 	}
 	
 
+	// --------------------------------------------------------------------------						
+	// Function:	GetCompactHeader
+	// Description:	returns header for object in compact chunk
+	// Arguments:	address of object/type
+	// Returns:		compact header
+	// --------------------------------------------------------------------------
+	inline MemoryLocator::CompactHeader& MemoryLocator::GetCompactHeader(void* address)
+	{ 
+		return *reinterpret_cast<CompactHeader*>(((char*)address) - compactHeaderSize); 
+	}
+	
+
 	// --------------------------------------------------------------------------						
 	// Function:	GetHeader
 	// Description:	returns base header for object
@@ -357,6 +405,49 @@ namespace shh {
 	}
 
 
+	// --------------------------------------------------------------------------						
+	// Function:	GetLocator
+	// Description:	returns locator owning object, for compact data this is 
+	//				stored at the start of the aligned chunk
+	// Arguments:	address of object/type
+	// Returns:		memory locator
+	// --------------------------------------------------------------------------
+	inline MemoryLocator* MemoryLocator::GetLocator(void* address)
+	{ 
+		if (IsCompactData(address))
+			return *reinterpret_cast<MemoryLocator**>((MemorySize)address & ~(MemorySize)(compactChunkSize - 1));
+		return GetHeader(address).myLocator; 
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	GetMemoryInfo
+	// Description:	returns info slot in object header
+	// Arguments:	address of object/type
+	// Returns:		reference to info pointer
+	// --------------------------------------------------------------------------
+	inline MemoryInfo*& MemoryLocator::GetMemoryInfo(void* address)
+	{ 
+		if (IsCompactData(address))
+			return GetCompactHeader(address).myMemoryInfo;
+		return GetHeader(address).myMemoryInfo; 
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	SetDestructor
+	// Description:	sets destructor in object header, compact data uses its
+	//				allocators destructor
+	// Arguments:	address of object/type, destructor
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	inline void MemoryLocator::SetDestructor(void* address, void (*destructor)(void*))
+	{ 
+		if (!IsCompactData(address))
+			GetHeader(address).myDestructor = destructor; 
+	}
+
+
 	// --------------------------------------------------------------------------						
 	// Function:	GetBase
 	// Description:	returns memory base of the locator
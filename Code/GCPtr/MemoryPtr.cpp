@@ -75,8 +75,8 @@ namespace shh {
 	// --------------------------------------------------------------------------
 	MemoryPtr::~MemoryPtr()
 	{
-		if (myInfo != NULL && myInfo->DecrementReferenceCount() == 0)
-			delete myInfo;
+		if (myInfo != NULL)
+			Release(myInfo);
 	}
 
 
@@ -30,6 +30,7 @@
 #include "../Common/SecureStl.h"
 #include "../Common/Exception.h"
 #include "MemoryInfo.h"
+#include "CycleCollector.h"
 
 namespace shh {
 
@@ -62,6 +63,8 @@ namespace shh {
 	protected:
 
 		MemoryInfo* myInfo;
+
+		static inline void Release(MemoryInfo* info);
 		
 	};
 
@@ -78,10 +81,7 @@ namespace shh {
 	inline void MemoryPtr::operator=(const MemoryPtr& p)
 	{
 		if (myInfo != NULL)
-		{
-			if (myInfo->DecrementReferenceCount() == 0)
-				delete myInfo;
-		}
+			Release(myInfo);
 		MemoryInfo* info = p.myInfo;
 		LOCKEXCHANGEGCOBJECT(myInfo, info);
 		if (myInfo != NULL)
@@ -187,6 +187,29 @@ namespace shh {
 	{
 		return myInfo < other.myInfo;
 	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Release
+	// Description:	drops a reference, deleting the info when none remain or
+	//				buffering it as a possible garbage cycle root when some do
+	// Arguments:	info to release
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	inline void MemoryPtr::Release(MemoryInfo* info)
+	{
+		if (info->DecrementReferenceCount() == 0)
+		{
+			// a suspected info is still buffered and is deleted by the collector,
+			// one still observed is deleted by the last weak pointer
+			if (info->IsOrphaned())
+				delete info;
+		}
+#if GC_CYCLE_COLLECTION
+		else if (info->myGCObject != NULL && !info->mySuspected && info->IsValid())
+			CycleCollector::Suspect(info);
+#endif
+	}
 }
 
 #endif //MEMORYPTR_H
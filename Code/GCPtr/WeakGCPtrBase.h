@@ -0,0 +1,296 @@
+///////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2025 David K Bhowmik. All rights reserved.
+// This file is part of shhArc.
+//
+// This Software is available under the MIT License with a No Modification clause.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this file and associated documentation files (the "Software"), to use the
+// Software for any purpose, including commercial applications, provided that:
+//
+//   1. You do NOT modify, alter, or create derivative works of this file.
+//   2. Redistributions must include this notice and may only distribute it 
+//      unmodified.
+//
+// The full MIT License text, including this Custom No Modification clause,
+// is available in the LICENSE file in the root of the project.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND.
+//
+// You may alternatively use this source under the terms of a specific 
+// version of the shhArc Unrestricted License provided you have obtained 
+// such a license from the copyright holder.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef WEAKGCPTRBASE_H
+#define WEAKGCPTRBASE_H
+
+#include "GCPtrBase.h"
+
+namespace shh {
+
+
+	// WeakGCPtrBase ///////////////////////////////////////////////////////////////////////
+
+	// observes the info of a gc object without owning the object, the info
+	// outlives the object while weak pointers remain so validity can be tested
+	template< typename T > class WeakGCPtrBase
+	{
+		template< typename Other > friend class WeakGCPtrBase;
+
+	public:
+
+		WeakGCPtrBase();
+		template< typename Other > WeakGCPtrBase(GCPtrBase<Other> const& strong);
+		WeakGCPtrBase(WeakGCPtrBase const& other);
+		~WeakGCPtrBase();
+
+		template< typename Other > inline WeakGCPtrBase& operator=(GCPtrBase<Other> const& strong);
+		inline WeakGCPtrBase& operator=(WeakGCPtrBase const& other);
+		template< typename Other > inline bool operator==(GCPtrBase<Other> const& strong) const;
+		inline bool operator==(WeakGCPtrBase const& other) const;
+
+		inline bool IsValid() const;
+		inline bool Lock(GCPtrBase<T>& strong) const;
+		inline void SetNull();
+
+		inline T* operator->() const;
+		inline T* GetObject() const;
+		inline GCInfo* GetGCInfo() const;
+
+	protected:
+
+		GCInfo* myInfo;
+		mutable T* myObject;
+		mutable void* myInfoObject;
+
+		inline void Observe(GCInfo* info, T* object);
+	};
+
+
+
+	// WeakGCPtrBase Inlines ////////////////////////////////////////////////////////////
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	WeakGCPtrBase
+	// Description:	constructor
+	// Arguments:	none
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	template< typename T > WeakGCPtrBase<T>::WeakGCPtrBase() :
+		myInfo(GCInfo::CreateNull()), myObject(NULL), myInfoObject(NULL)
+	{
+		myInfo->IncrementWeakCount();
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	WeakGCPtrBase
+	// Description:	constructor
+	// Arguments:	strong pointer to observe
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	template< typename T >
+	template< typename Other > WeakGCPtrBase<T>::WeakGCPtrBase(GCPtrBase<Other> const& strong) :
+		myInfo(strong.GetGCInfo()), myObject(strong.GetObject()), myInfoObject(NULL)
+	{
+		myInfo->IncrementWeakCount();
+		if (myInfo->IsValid())
+			myInfoObject = myInfo->GetObject();
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	WeakGCPtrBase
+	// Description:	copy constructor
+	// Arguments:	weak pointer to copy
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	template< typename T > WeakGCPtrBase<T>::WeakGCPtrBase(WeakGCPtrBase const& other) :
+		myInfo(other.myInfo), myObject(other.myObject), myInfoObject(other.myInfoObject)
+	{
+		myInfo->IncrementWeakCount();
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	~WeakGCPtrBase
+	// Description:	destructor
+	// Arguments:	none
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	template< typename T > WeakGCPtrBase<T>::~WeakGCPtrBase()
+	{
+		Observe(NULL, NULL);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	=
+	// Description:	observe object pointed to by strong pointer
+	// Arguments:	strong pointer
+	// Returns:		this
+	// --------------------------------------------------------------------------
+	template< typename T >
+	template< typename Other > inline WeakGCPtrBase<T>& WeakGCPtrBase<T>::operator=(GCPtrBase<Other> const& strong)
+	{
+		Observe(strong.GetGCInfo(), strong.GetObject());
+		return *this;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	=
+	// Description:	assign operator
+	// Arguments:	weak pointer to copy
+	// Returns:		this
+	// --------------------------------------------------------------------------
+	template< typename T > inline WeakGCPtrBase<T>& WeakGCPtrBase<T>::operator=(WeakGCPtrBase const& other)
+	{
+		if (this != &other)
+			Observe(other.myInfo, other.GetObject());
+		return *this;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	==
+	// Description:	compare is same object pointed to
+	// Arguments:	strong pointer
+	// Returns:		if same
+	// --------------------------------------------------------------------------
+	template< typename T >
+	template< typename Other > inline bool WeakGCPtrBase<T>::operator==(GCPtrBase<Other> const& strong) const
+	{
+		return myInfo == strong.GetGCInfo();
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	==
+	// Description:	compare is same object pointed to
+	// Arguments:	weak pointer
+	// Returns:		if same
+	// --------------------------------------------------------------------------
+	template< typename T > inline bool WeakGCPtrBase<T>::operator==(WeakGCPtrBase const& other) const
+	{
+		return myInfo == other.myInfo;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	IsValid
+	// Description:	test if object observed is still alive
+	// Arguments:	none
+	// Returns:		bool
+	// --------------------------------------------------------------------------
+	template< typename T > inline bool WeakGCPtrBase<T>::IsValid() const
+	{
+		return myInfo->IsValid() && !myInfo->IsDying();
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Lock
+	// Description:	sets strong pointer to the observed object if still alive, 
+	//				takes the info directly so no cast or lookup is needed
+	// Arguments:	strong pointer to set
+	// Returns:		if object alive
+	// --------------------------------------------------------------------------
+	template< typename T > inline bool WeakGCPtrBase<T>::Lock(GCPtrBase<T>& strong) const
+	{
+		if (!IsValid())
+			return false;
+
+		GCPtrBase<T> locked(myInfo, GetObject(), myInfoObject);
+		strong.Swap(locked);
+		return true;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	SetNull
+	// Description:	stop observing
+	// Arguments:	none
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	template< typename T > inline void WeakGCPtrBase<T>::SetNull()
+	{
+		Observe(GCInfo::CreateNull(), NULL);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	->
+	// Description:	dereference, only safe while something else owns the object
+	// Arguments:	none
+	// Returns:		object pointed to
+	// --------------------------------------------------------------------------
+	template< typename T > inline T* WeakGCPtrBase<T>::operator->() const
+	{
+		if (!IsValid())
+			Exception::Throw("Bad WeakGCPtrBase dereference");
+		return GetObject();
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	GetObject
+	// Description:	gets object observed, recasting if it has been relocated
+	// Arguments:	none
+	// Returns:		object pointed to or NULL if dead
+	// --------------------------------------------------------------------------
+	template< typename T > inline T* WeakGCPtrBase<T>::GetObject() const
+	{
+		if (!myInfo->IsValid())
+			return NULL;
+
+		void* infoObject = myInfo->GetObject();
+		if (infoObject != myInfoObject)
+		{
+			LOCKEXCHANGEGCOBJECT(myInfoObject, infoObject);
+			T* object = dynamic_cast<T*>(myInfo->GetGCObject());
+			LOCKEXCHANGEGCOBJECT(myObject, object);
+		}
+		return myObject;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	GetGCInfo
+	// Description:	returns gcinfo observed
+	// Arguments:	none
+	// Returns:		gcinfo
+	// --------------------------------------------------------------------------
+	template< typename T > inline GCInfo* WeakGCPtrBase<T>::GetGCInfo() const
+	{
+		return myInfo;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Observe
+	// Description:	switches info observed, deleting the old one if this was 
+	//				the last thing referring to it, an info outliving its object
+	//				was detached from the block when the object was destroyed
+	// Arguments:	info to observe or NULL, object
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	template< typename T > inline void WeakGCPtrBase<T>::Observe(GCInfo* info, T* object)
+	{
+		if (info != NULL)
+			info->IncrementWeakCount();
+
+		GCInfo* old = myInfo;
+		LOCKEXCHANGEGCOBJECT(myInfo, info);
+		LOCKEXCHANGEGCOBJECT(myObject, object);
+		void* infoObject = (info != NULL && info->IsValid()) ? info->GetObject() : NULL;
+		LOCKEXCHANGEGCOBJECT(myInfoObject, infoObject);
+
+		if (old->DecrementWeakCount() == 0 && old->IsOrphaned())
+			delete old;
+	}
+}
+
+#endif // WEAKGCPTRBASE_H
@@ -29,8 +29,11 @@
 #include "../Arc/Type.h"
 #include "../Arc/Type.inl"
 #include "../Common/Dictionary.h"
+#include "../Common/Exception.h"
+#include "../File/IOVariant.h"
 #include "LuaProcess.h"
 #include "LuaApi.h"
+#include <set>
 
 
 
@@ -745,6 +748,777 @@ namespace shh
 	}
 
 
+	// tags written before each value in a serialized lua stream
+	enum SerialTag
+	{
+		SerialNil,
+		SerialFalse,
+		SerialTrue,
+		SerialInteger,
+		SerialFloat,
+		SerialString,
+		SerialTable,
+		SerialClosure,
+		SerialCFunction,
+		SerialUserType,
+		SerialUserData, // no longer written, kept so tags keep their values
+		SerialReference,
+		SerialSharedClosure
+	};
+
+
+	// state kept whilst serializing, objects are numbered in the order they
+	// are first written so later references to them need only the number
+	class SerialWriter
+	{
+	public:
+		IOInterface* myIO;
+		bool myLossless;
+		std::map<const void*, unsigned int> myReferences;
+		std::map<const void*, unsigned int> myProtos;
+		std::map<const void*, std::pair<unsigned int, int> > myUpValues;
+		std::map<const void*, std::string> myCFunctionNames;
+		std::map<const void*, std::string> mySharedNames;
+	};
+
+
+	// state kept whilst deserializing, objects read are held in a table on 
+	// the stack by their number so they are not collected 
+	class SerialReader
+	{
+	public:
+		IOInterface* myIO;
+		int myReferences;
+		unsigned int myNumReferences;
+		int myCFunctions;
+		int myShared;
+		std::vector<std::string> myProtos;
+	};
+
+
+	// single chunk of bytecode fed to lua_load
+	class SerialChunk
+	{
+	public:
+		const std::string* myBytes;
+		bool myRead;
+	};
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	DumpProto	
+	// Description:	lua_dump writer appending bytecode to a string
+	// Arguments:	lua state, bytes, number of bytes, string
+	// Returns:		0 if ok
+	// --------------------------------------------------------------------------
+	static int DumpProto(lua_State* L, const void* p, size_t size, void* ud)
+	{
+		static_cast<std::string*>(ud)->append(static_cast<const char*>(p), size);
+		return 0;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	LoadProto	
+	// Description:	lua_load reader giving bytecode as a single chunk
+	// Arguments:	lua state, chunk, number of bytes returned
+	// Returns:		bytes, NULL when all read
+	// --------------------------------------------------------------------------
+	static const char* LoadProto(lua_State* L, void* ud, size_t* size)
+	{
+		SerialChunk* chunk = static_cast<SerialChunk*>(ud);
+		if (chunk->myRead)
+		{
+			*size = 0;
+			return NULL;
+		}
+		chunk->myRead = true;
+		*size = chunk->myBytes->size();
+		return chunk->myBytes->data();
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	IsSerializable	
+	// Description:	returns if value on stack can be serialized, threads and
+	//				light user data only have meaning in this process
+	// Arguments:	lua state, stack index
+	// Returns:		bool
+	// --------------------------------------------------------------------------
+	static bool IsSerializable(lua_State* L, int idx)
+	{
+		int type = lua_type(L, idx);
+		return type != LUA_TNIL && type != LUA_TNONE && type != LUA_TTHREAD && type != LUA_TLIGHTUSERDATA;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	GetKeyName	
+	// Description:	gets path name of a string or integer table key 
+	// Arguments:	lua state, stack index of key, path prefix, name got
+	// Returns:		if key can be named
+	// --------------------------------------------------------------------------
+	static bool GetKeyName(lua_State* L, int idx, const std::string& prefix, std::string& name)
+	{
+		if (lua_type(L, idx) == LUA_TSTRING)
+			name = prefix + lua_tostring(L, idx);
+		else if (lua_isinteger(L, idx))
+			name = prefix + std::to_string((long long)lua_tointeger(L, idx));
+		else
+			return false;
+		return true;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	GetCFunctionNames	
+	// Description:	recursively names c functions in a table by their path 
+	//				as c functions can only be serialized by name
+	// Arguments:	lua state, stack index of table, path prefix, names 
+	//				found, tables already visited
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	static void GetCFunctionNames(lua_State* L, int idx, const std::string& prefix, std::map<const void*, std::string>& names, std::set<const void*>& visited)
+	{
+		if (!visited.insert(lua_topointer(L, idx)).second || !lua_checkstack(L, 4))
+			return;
+
+		lua_pushnil(L);
+		while (lua_next(L, idx))
+		{
+			std::string name;
+			if (GetKeyName(L, -2, prefix, name))
+			{
+				if (lua_iscfunction(L, -1))
+				{
+					if (names.find(lua_topointer(L, -1)) == names.end())
+						names[lua_topointer(L, -1)] = name;
+				}
+				else if (lua_type(L, -1) == LUA_TTABLE)
+				{
+					GetCFunctionNames(L, lua_gettop(L), name + ".", names, visited);
+				}
+			}
+			lua_pop(L, 1);
+		}
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	GetFunctions	
+	// Description:	recursively adds c or lua functions in a table to a table
+	//				of functions keyed by their path
+	// Arguments:	lua state, stack index of table, path prefix, stack index
+	//				of functions table, tables already visited, whether c or
+	//				lua functions are added
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	static void GetFunctions(lua_State* L, int idx, const std::string& prefix, int functions, std::set<const void*>& visited, bool cFunctions = true)
+	{
+		if (!visited.insert(lua_topointer(L, idx)).second || !lua_checkstack(L, 4))
+			return;
+
+		lua_pushnil(L);
+		while (lua_next(L, idx))
+		{
+			std::string name;
+			if (GetKeyName(L, -2, prefix, name))
+			{
+				if (lua_type(L, -1) == LUA_TFUNCTION && lua_iscfunction(L, -1) == (int)cFunctions)
+				{
+					lua_pushvalue(L, -1);
+					lua_setfield(L, functions, name.c_str());
+				}
+				else if (lua_type(L, -1) == LUA_TTABLE)
+				{
+					GetFunctions(L, lua_gettop(L), name + ".", functions, visited, cFunctions);
+				}
+			}
+			lua_pop(L, 1);
+		}
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	WriteValue	
+	// Description:	recursively serializes a value on the stack, objects 
+	//				referenced more than once are written once
+	// Arguments:	lua state, stack index, writer
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	static void WriteValue(lua_State* L, int idx, SerialWriter& writer)
+	{
+		IOInterface& io = *writer.myIO;
+		idx = lua_absindex(L, idx);
+		if (!lua_checkstack(L, 4))
+			Exception::Throw("Lua stack overflow serializing");
+
+		int type = lua_type(L, idx);
+		if (!IsSerializable(L, idx))
+		{
+			if (type != LUA_TNIL && type != LUA_TNONE)
+				writer.myLossless = false;
+			SERIALIZE_OUT(io, (unsigned char)SerialNil);
+			return;
+		}
+		else if (type == LUA_TBOOLEAN)
+		{
+			SERIALIZE_OUT(io, (unsigned char)(lua_toboolean(L, idx) ? SerialTrue : SerialFalse));
+			return;
+		}
+		else if (type == LUA_TNUMBER)
+		{
+			if (lua_isinteger(L, idx))
+			{
+				SERIALIZE_OUT(io, (unsigned char)SerialInteger);
+				SERIALIZE_OUT(io, (__int64)lua_tointeger(L, idx));
+			}
+			else
+			{
+				SERIALIZE_OUT(io, (unsigned char)SerialFloat);
+				SERIALIZE_OUT(io, (double)lua_tonumber(L, idx));
+			}
+			return;
+		}
+
+		const void* object = lua_topointer(L, idx);
+		std::map<const void*, unsigned int>::iterator rit = writer.myReferences.find(object);
+		if (rit != writer.myReferences.end())
+		{
+			SERIALIZE_OUT(io, (unsigned char)SerialReference);
+			SERIALIZE_OUT(io, rit->second);
+			return;
+		}
+		unsigned int reference = (unsigned int)writer.myReferences.size() + 1;
+		writer.myReferences[object] = reference;
+
+		TValue* value = LuaGetStackValue(L, idx);
+		if (type == LUA_TSTRING)
+		{
+			size_t length;
+			const char* str = lua_tolstring(L, idx, &length);
+			SERIALIZE_OUT(io, (unsigned char)SerialString);
+			SERIALIZE_OUT(io, std::string(str, length));
+		}
+		else if (type == LUA_TTABLE)
+		{
+			SERIALIZE_OUT(io, (unsigned char)SerialTable);
+			lua_pushnil(L);
+			while (lua_next(L, idx))
+			{
+				if (IsSerializable(L, -2) && IsSerializable(L, -1))
+				{
+					SERIALIZE_OUT(io, true);
+					WriteValue(L, -2, writer);
+					WriteValue(L, -1, writer);
+				}
+				else
+				{
+					writer.myLossless = false;
+				}
+				lua_pop(L, 1);
+			}
+			SERIALIZE_OUT(io, false);
+
+			if (lua_getmetatable(L, idx))
+			{
+				WriteValue(L, -1, writer);
+				lua_pop(L, 1);
+			}
+			else
+			{
+				SERIALIZE_OUT(io, (unsigned char)SerialNil);
+			}
+		}
+		else if (type == LUA_TFUNCTION && lua_iscfunction(L, idx))
+		{
+			std::map<const void*, std::string>::iterator nit = writer.myCFunctionNames.find(object);
+			if (nit == writer.myCFunctionNames.end())
+			{
+				// not reachable from globals so cant be found when read
+				DEBUG_TRACE("C function not reachable from globals serialized as nil.\n");
+				writer.myLossless = false;
+				writer.myReferences.erase(object);
+				SERIALIZE_OUT(io, (unsigned char)SerialNil);
+				return;
+			}
+
+			SERIALIZE_OUT(io, (unsigned char)SerialCFunction);
+			SERIALIZE_OUT(io, nit->second);
+		}
+		else if (type == LUA_TFUNCTION)
+		{
+			LClosure* closure = LuaGetLClosure(value);
+			std::map<const void*, std::string>::iterator sit = writer.mySharedNames.find(object);
+			if (sit != writer.mySharedNames.end())
+			{
+				// reader already has the function so only its name and 
+				// upvalues are written
+				SERIALIZE_OUT(io, (unsigned char)SerialSharedClosure);
+				SERIALIZE_OUT(io, sit->second);
+			}
+			else
+			{
+				// bytecode of each proto is written once however many 
+				// closures of it there are
+				SERIALIZE_OUT(io, (unsigned char)SerialClosure);
+				std::map<const void*, unsigned int>::iterator pit = writer.myProtos.find(closure->p);
+				if (pit != writer.myProtos.end())
+				{
+					SERIALIZE_OUT(io, pit->second);
+				}
+				else
+				{
+					unsigned int proto = (unsigned int)writer.myProtos.size();
+					writer.myProtos[closure->p] = proto;
+
+					std::string bytes;
+					lua_pushvalue(L, idx);
+					lua_dump(L, DumpProto, &bytes, 0);
+					lua_pop(L, 1);
+					SERIALIZE_OUT(io, proto);
+					SERIALIZE_OUT(io, bytes);
+				}
+			}
+
+			// upvalues shared between closures are written once and 
+			// rejoined when read
+			int numUpValues = closure->nupvalues;
+			SERIALIZE_OUT(io, numUpValues);
+			for (int n = 1; n <= numUpValues; n++)
+			{
+				const void* id = lua_upvalueid(L, idx, n);
+				std::map<const void*, std::pair<unsigned int, int> >::iterator uit = writer.myUpValues.find(id);
+				if (uit != writer.myUpValues.end())
+				{
+					SERIALIZE_OUT(io, true);
+					SERIALIZE_OUT(io, uit->second.first);
+					SERIALIZE_OUT(io, uit->second.second);
+				}
+				else
+				{
+					writer.myUpValues[id] = std::pair<unsigned int, int>(reference, n);
+					SERIALIZE_OUT(io, false);
+					lua_getupvalue(L, idx, n);
+					WriteValue(L, -1, writer);
+					lua_pop(L, 1);
+				}
+			}
+		}
+		else if (LuaGetTypeId(value) < 0)
+		{
+			// shhArc registered type serialized by its type
+			const BaseType* baseType = LuaGetType(L, value);
+			VariantKeyDictionary dict;
+			NonVariant<unsigned int> key(0);
+			if (baseType == NULL || !baseType->SetDictionary(&key, LuaGetUserData(L, value), &dict))
+			{
+				DEBUG_TRACE("User type that cannot be serialized serialized as nil.\n");
+				writer.myLossless = false;
+				writer.myReferences.erase(object);
+				SERIALIZE_OUT(io, (unsigned char)SerialNil);
+				return;
+			}
+
+			SERIALIZE_OUT(io, (unsigned char)SerialUserType);
+			IODictionary<Variant> ioDict(dict);
+			SERIALIZE_OUT(io, ioDict);
+		}
+		else
+		{
+			// other user data may hold pointers that would dangle once read
+			DEBUG_TRACE("Unregistered user data serialized as nil.\n");
+			writer.myLossless = false;
+			writer.myReferences.erase(object);
+			SERIALIZE_OUT(io, (unsigned char)SerialNil);
+		}
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	AddReference	
+	// Description:	holds object on top of stack by its number so it can be
+	//				referenced by objects read after it
+	// Arguments:	lua state, reader
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	static void AddReference(lua_State* L, SerialReader& reader)
+	{
+		lua_pushvalue(L, -1);
+		lua_rawseti(L, reader.myReferences, ++reader.myNumReferences);
+	}
+
+
+	static void ReadValue(lua_State* L, SerialReader& reader, int into = 0);
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	ReadUpValues	
+	// Description:	deserializes upvalues of a closure, those shared with a
+	//				closure read before are joined to it
+	// Arguments:	lua state, reader, stack index of closure
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	static void ReadUpValues(lua_State* L, SerialReader& reader, int function)
+	{
+		IOInterface& io = *reader.myIO;
+		int numUpValues;
+		SERIALIZE_IN(io, numUpValues);
+		for (int n = 1; n <= numUpValues; n++)
+		{
+			bool shared;
+			SERIALIZE_IN(io, shared);
+			if (shared)
+			{
+				unsigned int reference;
+				int upValue;
+				SERIALIZE_IN(io, reference);
+				SERIALIZE_IN(io, upValue);
+				lua_rawgeti(L, reader.myReferences, reference);
+				lua_upvaluejoin(L, function, n, -1, upValue);
+				lua_pop(L, 1);
+			}
+			else
+			{
+				ReadValue(L, reader);
+				if (lua_setupvalue(L, function, n) == NULL)
+					lua_pop(L, 1);
+			}
+		}
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	ReadValue	
+	// Description:	recursively deserializes a value and pushes it on stack
+	// Arguments:	lua state, reader, stack index of table to read table 
+	//				into (0 for new table)
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	static void ReadValue(lua_State* L, SerialReader& reader, int into)
+	{
+		IOInterface& io = *reader.myIO;
+		if (!lua_checkstack(L, 4))
+			Exception::Throw("Lua stack overflow deserializing");
+
+		unsigned char tag;
+		SERIALIZE_IN(io, tag);
+		switch (tag)
+		{
+		case SerialNil:
+			lua_pushnil(L);
+			break;
+		case SerialFalse:
+			lua_pushboolean(L, 0);
+			break;
+		case SerialTrue:
+			lua_pushboolean(L, 1);
+			break;
+		case SerialInteger:
+		{
+			__int64 i;
+			SERIALIZE_IN(io, i);
+			lua_pushinteger(L, (lua_Integer)i);
+			break;
+		}
+		case SerialFloat:
+		{
+			double d;
+			SERIALIZE_IN(io, d);
+			lua_pushnumber(L, d);
+			break;
+		}
+		case SerialString:
+		{
+			std::string str;
+			SERIALIZE_IN(io, str);
+			lua_pushlstring(L, str.data(), str.size());
+			AddReference(L, reader);
+			break;
+		}
+		case SerialTable:
+		{
+			if (into != 0)
+				lua_pushvalue(L, into);
+			else
+				lua_newtable(L);
+			AddReference(L, reader);
+
+			int table = lua_gettop(L);
+			bool entry;
+			SERIALIZE_IN(io, entry);
+			while (entry)
+			{
+				ReadValue(L, reader);
+				ReadValue(L, reader);
+				if (lua_isnil(L, -2))
+					lua_pop(L, 2);
+				else
+					lua_rawset(L, table);
+				SERIALIZE_IN(io, entry);
+			}
+
+			ReadValue(L, reader);
+			if (lua_type(L, -1) == LUA_TTABLE)
+				lua_setmetatable(L, table);
+			else
+				lua_pop(L, 1);
+			break;
+		}
+		case SerialClosure:
+		{
+			unsigned int proto;
+			SERIALIZE_IN(io, proto);
+			if (proto == reader.myProtos.size())
+			{
+				std::string bytes;
+				SERIALIZE_IN(io, bytes);
+				reader.myProtos.push_back(bytes);
+			}
+			else if (proto > reader.myProtos.size())
+			{
+				Exception::Throw("Lua function %d out of order deserializing", proto);
+			}
+
+			SerialChunk chunk;
+			chunk.myBytes = &reader.myProtos[proto];
+			chunk.myRead = false;
+			if (lua_load(L, LoadProto, &chunk, "=checkpoint", "b") != LUA_OK)
+			{
+				std::string error = lua_tostring(L, -1);
+				lua_pop(L, 1);
+				Exception::Throw("Cannot load Lua function: %s", error.c_str());
+			}
+			AddReference(L, reader);
+			ReadUpValues(L, reader, lua_gettop(L));
+			break;
+		}
+		case SerialSharedClosure:
+		{
+			std::string name;
+			SERIALIZE_IN(io, name);
+			if (reader.myShared != 0)
+				lua_getfield(L, reader.myShared, name.c_str());
+			else
+				lua_pushnil(L);
+			if (lua_type(L, -1) != LUA_TFUNCTION || lua_iscfunction(L, -1))
+			{
+				lua_pop(L, 1);
+				Exception::Throw("Lua function %s not found deserializing", name.c_str());
+			}
+			AddReference(L, reader);
+			ReadUpValues(L, reader, lua_gettop(L));
+			break;
+		}
+		case SerialCFunction:
+		{
+			std::string name;
+			SERIALIZE_IN(io, name);
+			lua_getfield(L, reader.myCFunctions, name.c_str());
+			if (!lua_iscfunction(L, -1))
+			{
+				lua_pop(L, 1);
+				Exception::Throw("C function %s not found deserializing", name.c_str());
+			}
+			AddReference(L, reader);
+			break;
+		}
+		case SerialUserType:
+		{
+			VariantKeyDictionary dict;
+			IODictionary<Variant> ioDict(dict);
+			SERIALIZE_IN(io, ioDict);
+
+			// pushed on to state of current process
+			int top = lua_gettop(L);
+			Variant const* const value = dict.Get(NonVariant<unsigned int>(0));
+			BaseType* baseType = value != NULL ? value->GetRegisteredType() : NULL;
+			if (baseType == NULL || !baseType->Push(Lua, baseType->Clone((void*)value->GetValuePtr())) || lua_gettop(L) != top + 1)
+			{
+				lua_settop(L, top);
+				Exception::Throw("Cannot deserialize user type");
+			}
+			AddReference(L, reader);
+			break;
+		}
+		case SerialReference:
+		{
+			unsigned int reference;
+			SERIALIZE_IN(io, reference);
+			if (reference == 0 || reference > reader.myNumReferences)
+				Exception::Throw("Lua reference %d out of order deserializing", reference);
+			lua_rawgeti(L, reader.myReferences, reference);
+			break;
+		}
+		default:
+			Exception::Throw("Unknown Lua value %d deserializing", (int)tag);
+		}
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Serialize	
+	// Description:	serializes a value (recursively if table or closure) 
+	//				preserving shared references, closures are written as
+	//				bytecode and their upvalues, c functions by their name in
+	//				the globals and shhArc user types by their type. Lua 
+	//				functions in a table of shared functions the reader also
+	//				has are written by their name there and their upvalues.
+	//				Only what is reachable from the value is written, state 
+	//				held only by the registry such as references made with 
+	//				luaL_ref for callbacks is not and does not make the 
+	//				serialization lossy
+	// Arguments:	lua state, value, io stream interface, table of shared 
+	//				functions keyed by name or NULL
+	// Returns:		false if anything could not be serialized and was 
+	//				written as nil
+	// --------------------------------------------------------------------------
+	bool LuaHelperFunctions::Serialize(lua_State* L, const TValue* value, IOInterface& io, const TValue* shared)
+	{
+		int top = lua_gettop(L);
+		if (!lua_checkstack(L, 4))
+			Exception::Throw("Lua stack overflow serializing");
+
+		SerialWriter writer;
+		writer.myIO = &io;
+		writer.myLossless = true;
+		std::set<const void*> visited;
+
+		try
+		{
+			LuaGetGlobalsStack(L);
+			GetCFunctionNames(L, lua_gettop(L), "", writer.myCFunctionNames, visited);
+			lua_pop(L, 1);
+
+			if (shared != NULL && LuaGetTypeId(shared) == LUA_TTABLE)
+			{
+				LuaSetStackValue(L, 0, shared);
+				LuaIncStack(L);
+				lua_pushnil(L);
+				while (lua_next(L, -2))
+				{
+					if (lua_type(L, -2) == LUA_TSTRING && lua_type(L, -1) == LUA_TFUNCTION && !lua_iscfunction(L, -1))
+						writer.mySharedNames[lua_topointer(L, -1)] = lua_tostring(L, -2);
+					lua_pop(L, 1);
+				}
+				lua_pop(L, 1);
+			}
+
+			LuaSetStackValue(L, 0, value);
+			LuaIncStack(L);
+			if (lua_type(L, -1) == LUA_TTABLE)
+				GetCFunctionNames(L, lua_gettop(L), "", writer.myCFunctionNames, visited);
+
+			WriteValue(L, -1, writer);
+		}
+		catch (...)
+		{
+			lua_settop(L, top);
+			throw;
+		}
+		lua_settop(L, top);
+		return writer.myLossless;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Deserialize	
+	// Description:	deserializes a value written by Serialize and pushes it 
+	//				on stack, if a table is given it is cleared and the value
+	//				read in to it, c functions are found by name in the
+	//				globals and the given table and shared lua functions in
+	//				the table of them
+	// Arguments:	lua state, io stream interface, table to read in to, 
+	//				table of shared functions keyed by name or NULL
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void LuaHelperFunctions::Deserialize(lua_State* L, IOInterface& io, const TValue* into, const TValue* shared)
+	{
+		int top = lua_gettop(L);
+		if (!lua_checkstack(L, 6))
+			Exception::Throw("Lua stack overflow deserializing");
+
+		SerialReader reader;
+		reader.myIO = &io;
+		reader.myNumReferences = 0;
+		std::set<const void*> visited;
+
+		try
+		{
+			lua_newtable(L);
+			reader.myReferences = lua_gettop(L);
+			lua_newtable(L);
+			reader.myCFunctions = lua_gettop(L);
+			reader.myShared = 0;
+			if (shared != NULL && LuaGetTypeId(shared) == LUA_TTABLE)
+			{
+				LuaSetStackValue(L, 0, shared);
+				LuaIncStack(L);
+				reader.myShared = lua_gettop(L);
+			}
+
+			LuaGetGlobalsStack(L);
+			GetFunctions(L, lua_gettop(L), "", reader.myCFunctions, visited);
+			lua_pop(L, 1);
+
+			int table = 0;
+			if (into != NULL && LuaGetTypeId(into) == LUA_TTABLE)
+			{
+				LuaSetStackValue(L, 0, into);
+				LuaIncStack(L);
+				table = lua_gettop(L);
+				GetFunctions(L, table, "", reader.myCFunctions, visited);
+
+				// functions found are held so clearing does not collect them
+				lua_pushnil(L);
+				while (lua_next(L, table))
+				{
+					lua_pop(L, 1);
+					lua_pushvalue(L, -1);
+					lua_pushnil(L);
+					lua_rawset(L, table);
+				}
+			}
+
+			ReadValue(L, reader, table);
+		}
+		catch (...)
+		{
+			lua_settop(L, top);
+			throw;
+		}
+
+		lua_copy(L, -1, top + 1);
+		lua_settop(L, top + 1);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	PushFunctions	
+	// Description:	pushes a table of the lua functions reachable from a table
+	//				keyed by their path, to be given to Serialize and 
+	//				Deserialize as shared functions
+	// Arguments:	lua state, table
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void LuaHelperFunctions::PushFunctions(lua_State* L, const TValue* table)
+	{
+		if (!lua_checkstack(L, 6))
+			Exception::Throw("Lua stack overflow getting functions");
+
+		std::set<const void*> visited;
+		lua_newtable(L);
+		int functions = lua_gettop(L);
+		if (LuaGetTypeId(table) == LUA_TTABLE)
+		{
+			LuaSetStackValue(L, 0, table);
+			LuaIncStack(L);
+			GetFunctions(L, lua_gettop(L), "", functions, visited, false);
+			lua_pop(L, 1);
+		}
+	}
+
+
 	// --------------------------------------------------------------------------						
 	// Function:	DeepCompare
 	// Description:	compares two object for full value equvalence 
@@ -39,6 +39,7 @@ namespace shh
 {
     class Process;
     class BaseType;
+    class IOInterface;
 
     class LuaHelperFunctions
     {
@@ -48,6 +49,9 @@ namespace shh
 
         static void DeepCopy(lua_State* from, lua_State* to, const TValue* toClone, bool global = false, bool registry = false);
         static bool DeepCompare(lua_State* L, const TValue* o1, const TValue* o2);
+        static bool Serialize(lua_State* L, const TValue* value, IOInterface& io, const TValue* shared = NULL);
+        static void Deserialize(lua_State* L, IOInterface& io, const TValue* into = NULL, const TValue* shared = NULL);
+        static void PushFunctions(lua_State* L, const TValue* table);
         static void Print(lua_State* L, TValue* value, std::string& result, int indent = 0);
         static bool PushVariant(lua_State* to, const Variant* toClone);
 		template<class V>
@@ -32,6 +32,7 @@
 #include "../File/FileSystem.h"
 #include "../File/FileSystem.h"
 #include "../File/IOVariant.h"
+#include "../File/BinaryFile.h"
 #include "../VM/VM.h"
 #include "LuaProcess.h"
 #include "LuaWrapper.h"
@@ -116,6 +117,32 @@ namespace shh {
 	}
 
 
+	// --------------------------------------------------------------------------						
+	// Function:	CloneHosted
+	// Description:	clones process to run as a coroutine with its own global 
+	//				table inside the lua state of the host process, rather than 
+	//				in a lua state of its own
+	// Arguments:	host process
+	// Returns:		cloned process (a normal clone if host is not a LuaProcess)
+	// --------------------------------------------------------------------------
+	GCPtr<Process> LuaProcess::CloneHosted(const GCPtr<Process>& host)
+	{
+		GCPtr<LuaProcess> luaHost;
+		luaHost.DynamicCast(host);
+		if (!luaHost.IsValid())
+			return Clone();
+
+		// host the clone in the hosts host so all share a single lua state
+		if (luaHost->IsHosted())
+			luaHost = luaHost->myHost;
+
+		GCPtr<Process> oldProcess = Scheduler::GetCurrentProcess();
+		GCPtr<Process> p(new LuaProcess(GetPrivileges(), GCPtr<LuaProcess>(this), luaHost));
+		Scheduler::SetCurrentProcess(oldProcess);
+		return p;
+	}
+
+
 	// --------------------------------------------------------------------------						
 	// Function:	LuaProcess
 	// Description:	constructor
@@ -123,7 +150,14 @@ namespace shh {
 	// Returns:		none
 	// --------------------------------------------------------------------------
 	LuaProcess::LuaProcess(Privileges privileges, const GCPtr<LuaProcess> &spawnFrom) :
-		SoftProcess(privileges)
+		SoftProcess(privileges),
+		myHeap(NULL),
+		mySpawnFrom(spawnFrom),
+		myNumHosted(0),
+		myThreadRef(LUA_NOREF),
+		myGlobalsRef(LUA_NOREF),
+		mySpawnFunctionsRef(LUA_NOREF),
+		myHibernating(false)
 	{
 		myScriptError = false;
 		Scheduler::SetCurrentProcess(GCPtr<Process>(this));
@@ -185,41 +219,100 @@ namespace shh {
 		}
 		else
 		{
+			spawnFrom->Wake();
 			toClone = spawnFrom->myLuaState;
 			myRegisteredModules = spawnFrom->myRegisteredModules;
 			myPaths = spawnFrom->myPaths;
 		}
 
 			
-		myLuaState = luaL_newstate();
+		// heap of state lives in arena of realm creating it if it has one
+		Heap heap;
+		heap.myArena = Arena::GetCurrent();
+		heap.myProfile = NULL;
+		heap.myOwnerProfile = NULL;
+#if MEMORY_PROFILING
+		if (MemoryProfiler::ourEnabled)
+		{
+			heap.myName = std::to_string(GetId());
+			heap.myProfile = MemoryProfiler::GetUsage("lua_processes", heap.myName);
+			heap.myOwnerProfile = MemoryProfiler::GetUsage("realms", MemoryProfiler::GetOwner());
+		}
+#endif
+		if (heap.myArena != NULL || heap.myProfile != NULL)
+		{
+			if (heap.myArena != NULL)
+				heap.myArena->Attach();
+			myHeap = new Heap(heap);
+		}
 
-	
+		OpenLuaState(toClone, spawnFrom.IsValid() ? spawnFrom->GetGlobalsValue() : LuaGetGlobalsValue(toClone));
 
-		//OverloadTable may not be cloned before cloning other types
-		//in the registry that need it first member functions thier
-		//so put it in 
-		GCPtr<Registry::OverloadTable> *ot = NULL;
-		LuaApiTemplate::RegisterType(ot, "shh::OverloadTable", NULL, NULL, false);
+		myInheritedFixedGCs = NULL;
+		myInheritedAllGCs = NULL;
+		
+		ourNumLuaProcesses++;
 
-		// Need to reference metatable of inherited class
-		TValue* registryToClone = LuaGetRegistry(toClone);
-		LuaHelperFunctions::DeepCopy(toClone, myLuaState, registryToClone, false, true);
-		LuaSetRegistry(myLuaState, LuaGetStackValue(myLuaState,-1));
-		LuaDecStack(myLuaState);
+		SetReady();
 		
-		// need to deep copy global tables 
-		LuaHelperFunctions::DeepCopy(toClone, myLuaState, LuaGetGlobalsValue(toClone), true, false);
-		LuaSetGlobals(myLuaState);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	LuaProcess
+	// Description:	constructor for a process hosted in another processes lua
+	//				state. The process gets a coroutine of the hosts state and a
+	//				copy of the spawned from processes global table, the registry
+	//				and heap are shared with the host
+	// Arguments:	privileges of process, process to clone, host process
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	LuaProcess::LuaProcess(Privileges privileges, const GCPtr<LuaProcess>& spawnFrom, const GCPtr<LuaProcess>& host) :
+		SoftProcess(privileges),
+		myHeap(NULL),
+		myHost(host),
+		mySpawnFrom(spawnFrom),
+		myNumHosted(0),
+		mySpawnFunctionsRef(LUA_NOREF),
+		myHibernating(false)
+	{
+		myScriptError = false;
+		Scheduler::SetCurrentProcess(GCPtr<Process>(this));
+
+		myImplementation = Lua;
+		myRegisteredModules = spawnFrom->myRegisteredModules;
+		myPaths = spawnFrom->myPaths;
+
+		spawnFrom->Wake();
+		myHost->Wake();
+		myHost->myNumHosted++;
+
+		lua_State* hostState = myHost->myLuaState;
+
+		// coroutine to run in, referenced from the hosts registry so it is
+		// not collected
+		myLuaState = lua_newthread(hostState);
+		myThreadRef = luaL_ref(hostState, LUA_REGISTRYINDEX);
+
+		// deep copy global table into a new table which is made the global
+		// table while copying so functions copied take it as their _ENV
+		TValue previous = *LuaGetGlobalsValue(hostState);
+		lua_newtable(hostState);
+		*LuaGetGlobalsValue(hostState) = *LuaGetStackValue(hostState, -1);
+		LuaDecStack(hostState);
+		LuaHelperFunctions::DeepCopy(spawnFrom->myLuaState, hostState, spawnFrom->GetGlobalsValue(), true, false);
+		myGlobals = *LuaGetStackValue(hostState, -1);
+		myGlobalsRef = luaL_ref(hostState, LUA_REGISTRYINDEX);
+		*LuaGetGlobalsValue(hostState) = previous;
 
 		myInheritedFixedGCs = NULL;
 		myInheritedAllGCs = NULL;
-		
+
 		ourNumLuaProcesses++;
 
 		myDebugStackSize = LuaGetStackSize(myLuaState);
 		myDebugCI = myLuaState->ci;
 		SetReady();
-		
 	}
 
 
@@ -231,7 +324,30 @@ namespace shh {
 	// --------------------------------------------------------------------------
 	LuaProcess::~LuaProcess()
 	{
-		lua_close(myLuaState);
+		if (IsHosted())
+		{
+			// thread and globals are collected by the host once unreferenced
+			if (myHost.IsValid())
+			{
+				luaL_unref(myHost->myLuaState, LUA_REGISTRYINDEX, myGlobalsRef);
+				luaL_unref(myHost->myLuaState, LUA_REGISTRYINDEX, myThreadRef);
+				myHost->myNumHosted--;
+			}
+		}
+		else
+		{
+			if (!myHibernating)
+				lua_close(myLuaState);
+			DiscardHibernated();
+			if (myHeap != NULL)
+			{
+				if (myHeap->myArena != NULL)
+					myHeap->myArena->Detach();
+				if (myHeap->myProfile != NULL)
+					MemoryProfiler::RemoveUsage("lua_processes", myHeap->myName);
+				delete myHeap;
+			}
+		}
 		ourNumLuaProcesses--;
 		ourMasterLuaState = NULL;
 		if (ourNumLuaProcesses == 0 && ourMasterLuaState)
@@ -240,6 +356,100 @@ namespace shh {
 			ourMasterLuaState = NULL;
 		}
 	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	OpenLuaState
+	// Description:	creates the lua state of the process in its heap, cloning
+	//				the registry and globals of the given state into it
+	// Arguments:	lua state to clone, global table to clone
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void LuaProcess::OpenLuaState(lua_State* toClone, TValue* globalsToClone)
+	{
+		if (myHeap != NULL)
+		{
+			myLuaState = lua_newstate(HeapAlloc, myHeap);
+			lua_atpanic(myLuaState, HeapPanic);
+		}
+		else
+		{
+			myLuaState = luaL_newstate();
+		}
+
+		//OverloadTable may not be cloned before cloning other types
+		//in the registry that need it first member functions thier
+		//so put it in 
+		GCPtr<Registry::OverloadTable> *ot = NULL;
+		LuaApiTemplate::RegisterType(ot, "shh::OverloadTable", NULL, NULL, false);
+
+		// Need to reference metatable of inherited class
+		TValue* registryToClone = LuaGetRegistry(toClone);
+		LuaHelperFunctions::DeepCopy(toClone, myLuaState, registryToClone, false, true);
+		LuaSetRegistry(myLuaState, LuaGetStackValue(myLuaState,-1));
+		LuaDecStack(myLuaState);
+		
+		// need to deep copy global tables 
+		LuaHelperFunctions::DeepCopy(toClone, myLuaState, globalsToClone, true, false);
+		LuaSetGlobals(myLuaState);
+
+		// functions cloned from the process spawned from are referenced so
+		// hibernation can write them by name as reviving clones them again
+		if (mySpawnFrom.IsValid())
+		{
+			LuaHelperFunctions::PushFunctions(myLuaState, LuaGetGlobalsValue(myLuaState));
+			mySpawnFunctionsRef = luaL_ref(myLuaState, LUA_REGISTRYINDEX);
+		}
+
+		myDebugStackSize = LuaGetStackSize(myLuaState);
+		myDebugCI = myLuaState->ci;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	HeapAlloc
+	// Description:	lua allocation function for states with heap in an arena
+	//				or whose heap is profiled
+	// Arguments:	heap, block or NULL, old size, new size
+	// Returns:		block or NULL if freed
+	// --------------------------------------------------------------------------
+	void* LuaProcess::HeapAlloc(void* heap, void* p, size_t oldSize, size_t newSize)
+	{
+		Heap* h = (Heap*)heap;
+		void* q;
+		if (h->myArena != NULL)
+		{
+			q = h->myArena->Reallocate(p, oldSize, newSize);
+		}
+		else if (newSize == 0)
+		{
+			free(p);
+			q = NULL;
+		}
+		else
+		{
+			q = realloc(p, newSize);
+		}
+
+#if MEMORY_PROFILING
+		if (h->myProfile != NULL && (q != NULL || newSize == 0))
+			MemoryProfiler::Resize(h->myProfile, h->myOwnerProfile, p == NULL ? 0 : oldSize, newSize);
+#endif
+		return q;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	HeapPanic
+	// Description:	panic function for states with their own heap function
+	// Arguments:	lua state
+	// Returns:		0
+	// --------------------------------------------------------------------------
+	int LuaProcess::HeapPanic(lua_State* L)
+	{
+		ERROR_TRACE("LuaProcess::Unprotected error in lua state: %s\n", lua_tostring(L, -1));
+		return 0;
+	}
 	
 
 	// --------------------------------------------------------------------------						
@@ -252,6 +462,7 @@ namespace shh {
 	// --------------------------------------------------------------------------						
 	void LuaProcess::SetGarbageCollectionGeneratiobnal(int pause, int stepmul, int stepsize)
 	{
+		Wake();
 		lua_gc(myLuaState, LUA_GCINC, pause, stepmul, stepsize);
 	}
 
@@ -265,6 +476,7 @@ namespace shh {
 	// --------------------------------------------------------------------------						
 	void LuaProcess::SetGarbageCollectionGeneratiobnal(int minormul, int majormul)
 	{
+		Wake();
 		lua_gc(myLuaState, LUA_GCGEN, minormul, majormul);
 
 	}
@@ -318,6 +530,10 @@ namespace shh {
 	// --------------------------------------------------------------------------						
 	void LuaProcess::CollectAllGarbage()
 	{
+		// nothing to collect in a hibernating process
+		if (myHibernating)
+			return;
+
 		lua_gc(myLuaState, LUA_GCGEN);
 		lua_gc(myLuaState, LUA_GCCOLLECT);
 		lua_gc(myLuaState, LUA_GCINC);
@@ -332,6 +548,7 @@ namespace shh {
 	// --------------------------------------------------------------------------
 	bool LuaProcess::ValidateFunctionNames(bool allowClassOnlyFunctions)
 	{
+		Wake();
 		std::string errorMessage;
 		if (!LuaHelperFunctions::ValidateFunctionNames(myLuaState, allowClassOnlyFunctions,
 			LuaProcess::ourOverideSeperator,
@@ -360,6 +577,7 @@ namespace shh {
 	// --------------------------------------------------------------------------
 	bool LuaProcess::Overide(const std::string& derivedCode, const std::string& overidePrefix) 
 	{
+		Wake();
 		GCPtr<Process> oldProcess = Scheduler::GetCurrentProcess();
 		Scheduler::SetCurrentProcess(GCPtr<Process>(this));
 	
@@ -404,6 +622,11 @@ namespace shh {
 	// --------------------------------------------------------------------------
 	bool LuaProcess::Execute(const std::string& s, bool isFile, bool isYieldable, Paths paths)
 	{
+		Wake();
+		if (FailedToRevive())
+			return false;
+		if (GetVM().IsValid())
+			GetVM()->SetDirty();
 		Lock();
 		bool retVal = false;
 		int stackSize = LuaGetStackSize(myLuaState);
@@ -439,6 +662,8 @@ namespace shh {
 		if (codeOk)
 		{
 			GetVM()->SwapProcessIn(GCPtr<LuaProcess>(this));
+			TValue previousGlobals;
+			EnterGlobals(previousGlobals);
 
 			try
 			{
@@ -515,6 +740,7 @@ namespace shh {
 				retVal = false;
 			}
 
+			LeaveGlobals(previousGlobals);
 			GetVM()->SwapProcessOut();
 		}
 		else
@@ -538,7 +764,7 @@ namespace shh {
 	// --------------------------------------------------------------------------
 	void LuaProcess::UnwindCallStack()
 	{
-
+		Wake();
 		while (myLuaState->ci != myDebugCI)
 			myLuaState->ci = myLuaState->ci->previous;
 
@@ -556,6 +782,7 @@ namespace shh {
 	// --------------------------------------------------------------------------
 	void LuaProcess::Clone(TValue *valueToClone, TValue* valueCloned)
 	{
+		Wake();
 		LuaTypeId type = LuaGetTypeId(valueToClone);
 		if (type == LUA_TTABLE || type < 0)
 		{
@@ -586,7 +813,8 @@ namespace shh {
 	// --------------------------------------------------------------------------						
 	bool LuaProcess::GetTable(const std::string& name, TValue& table)
 	{
-		TValue* thisTable = LuaGetGlobalsValue(myLuaState);
+		Wake();
+		TValue* thisTable = GetGlobalsValue();
 		// if no name use global
 		if (name.empty())
 		{
@@ -698,6 +926,8 @@ namespace shh {
 	// --------------------------------------------------------------------------						
 	void LuaProcess::OpenNamespace(const std::string& fullNameSpace)
 	{
+		Wake();
+
 		// keep globals on stack
 		LuaGetGlobalsStack(myLuaState);
 
@@ -763,6 +993,7 @@ namespace shh {
 	// --------------------------------------------------------------------------						
 	void LuaProcess::CloseNamespace()
 	{
+		Wake();
 		LuaSetGlobals(myLuaState);
 	}
 
@@ -775,7 +1006,8 @@ namespace shh {
 	// --------------------------------------------------------------------------						
 	bool LuaProcess::HasFunction(const std::string& functionName) const
 	{
-		const TValue* function = LuaGetTableValue(LuaGetTable(LuaGetGlobalsValue(myLuaState)), LuaNewString(myLuaState, functionName.c_str()));
+		const_cast<LuaProcess*>(this)->Wake();
+		const TValue* function = LuaGetTableValue(LuaGetTable(GetGlobalsValue()), LuaNewString(myLuaState, functionName.c_str()));
 	
 		if (LuaGetTypeId(function) != LUA_TFUNCTION || LuaGetFunctionType(function) == LUA_VCCL || LuaGetFunctionType(function) == LUA_VLCF)
 			return false;
@@ -805,7 +1037,8 @@ namespace shh {
 	// --------------------------------------------------------------------------
 	const void* LuaProcess::GetFunction(const std::string& functionName, int& argsExpected)
 	{
-		const TValue* function = LuaGetTableValue(LuaGetTable(LuaGetGlobalsValue(myLuaState)), LuaNewString(myLuaState, functionName.c_str()));
+		Wake();
+		const TValue* function = LuaGetTableValue(LuaGetTable(GetGlobalsValue()), LuaNewString(myLuaState, functionName.c_str()));
 		if(LuaGetTypeId(function)!= LUA_TFUNCTION || LuaGetFunctionType(function) == LUA_VCCL) //|| LuaGetFunctionType(function) == LUA_VLCF)
 			return NULL;
 
@@ -836,8 +1069,17 @@ namespace shh {
 			return msg.myState;
 		}
 
+		Wake();
+		if (FailedToRevive())
+		{
+			msg.myState = ExecutionFailed;
+			return msg.myState;
+		}
+
 		Lock();
 		GetVM()->SwapProcessIn(msg.myTo);
+		TValue previousGlobals;
+		EnterGlobals(previousGlobals);
 		
 		bool yieldable = myYieldable;
 		myYieldable = isYieldable;
@@ -869,11 +1111,12 @@ namespace shh {
 				const TValue* function = NULL;
 				if (msg.myFunctionName != SoftProcess::ourBootMessage)
 				{
-					function = LuaGetTableValue(LuaGetTable(LuaGetGlobalsValue(myLuaState)), LuaNewString(myLuaState, msg.myFunctionName.c_str()));
+					function = LuaGetTableValue(LuaGetTable(GetGlobalsValue()), LuaNewString(myLuaState, msg.myFunctionName.c_str()));
 					if (LuaGetTypeId(function) != LUA_TFUNCTION || LuaGetFunctionType(function) == LUA_VCCL || LuaGetFunctionType(function) == LUA_VLCF)
 					{
 						ERROR_TRACE("LuaProcess::Attempt to call %s when it is not a function, from LuaProcess: %x, Bailing message handler.\n", msg.myFunctionName.c_str(), msg.myTo.GetObject());
 						msg.myState = ExecutionFailed;
+						LeaveGlobals(previousGlobals);
 						Unlock();
 						return msg.myState;
 					}
@@ -1015,6 +1258,7 @@ namespace shh {
 		{
 			myState = ExecutionError;
 			UnwindCallStack();
+			LeaveGlobals(previousGlobals);
 			Unlock();
 			LuaApi::ThrowScriptError("LuaProcess caught error\n%s\nBailing message handler.", e.what());
 
@@ -1024,6 +1268,7 @@ namespace shh {
 		{
 			myState = ExecutionError;
 			UnwindCallStack();
+			LeaveGlobals(previousGlobals);
 			Unlock();
 			LuaApi::ThrowScriptError("LuaProcess caught error\nUnknown exception type\nBailing message handler.");
 			ERROR_TRACE("LuaProcess::Unknown error in function %s, from LuaProcess: %x, Bailing message handler.\n", msg.myFunctionName.c_str(), msg.myTo.GetObject());
@@ -1032,6 +1277,7 @@ namespace shh {
 		myYieldable = yieldable;
 		myTimeOut = timeOut;
 		
+		LeaveGlobals(previousGlobals);
 		GetVM()->SwapProcessOut();
 		msg.myState = myState;
 		if(myState == ExecutionCompleted)
@@ -1053,6 +1299,7 @@ namespace shh {
 			return -1;
 	
 		// need a Process mutex here cos may be handling message on another threads
+		Wake();
 		Lock();
 
 		EnsureFreeStack(myLuaState, (int)msg.myReturnValues.size());
@@ -1082,7 +1329,7 @@ namespace shh {
 	// --------------------------------------------------------------------------
 	bool LuaProcess::CallFunction(const std::string& functionName, int numArguments, bool returnsVal)
 	{
-
+		Wake();
 		Message::Argument rv;
 		StkId oldStackTop = LuaGetTopStack(myLuaState);
 		StkId oldCodeBasebase = LuaGetCodeBase(myLuaState);
@@ -1120,7 +1367,7 @@ namespace shh {
 	// --------------------------------------------------------------------------						
 	bool LuaProcess::GetArgument(Message& msg, unsigned int arg)
 	{
-
+		Wake();
 		if (LuaGetCallStackSize(myLuaState) < arg)
 			return false;
 
@@ -1237,4 +1484,318 @@ namespace shh {
 
 
 
+	// --------------------------------------------------------------------------						
+	// Function:	GetGlobalsValue
+	// Description:	gets the global table of this process, for hosted 
+	//				processes this is not the global table of the lua state
+	// Arguments:	none
+	// Returns:		global table
+	// --------------------------------------------------------------------------						
+	TValue* LuaProcess::GetGlobalsValue() const
+	{
+		const_cast<LuaProcess*>(this)->Wake();
+		if (IsHosted())
+			return const_cast<TValue*>(&myGlobals);
+		return LuaGetGlobalsValue(myLuaState);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	GetSpawnFunctions
+	// Description:	gets the table of functions cloned from the process
+	//				spawned from when the lua state was opened, held by the
+	//				registry so the value returned stays valid
+	// Arguments:	none
+	// Returns:		table of functions by path or nil if none
+	// --------------------------------------------------------------------------						
+	TValue LuaProcess::GetSpawnFunctions() const
+	{
+		lua_rawgeti(myLuaState, LUA_REGISTRYINDEX, mySpawnFunctionsRef);
+		TValue functions = *LuaGetStackValue(myLuaState, -1);
+		lua_pop(myLuaState, 1);
+		return functions;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	EnterGlobals
+	// Description:	makes this processes global table the global table of the 
+	//				lua state whilst it runs, does nothing if not hosted
+	// Arguments:	previous global table returned
+	// Returns:		none
+	// --------------------------------------------------------------------------						
+	void LuaProcess::EnterGlobals(TValue& previous)
+	{
+		Wake();
+		if (IsHosted())
+		{
+			previous = *LuaGetGlobalsValue(myLuaState);
+			*LuaGetGlobalsValue(myLuaState) = myGlobals;
+		}
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	LeaveGlobals
+	// Description:	restores the global table of the lua state after this 
+	//				process has run, does nothing if not hosted
+	// Arguments:	previous global table
+	// Returns:		none
+	// --------------------------------------------------------------------------						
+	void LuaProcess::LeaveGlobals(const TValue& previous)
+	{
+		Wake();
+		if (IsHosted())
+			*LuaGetGlobalsValue(myLuaState) = previous;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Write
+	// Description:	serialization out, writes the globals of the process and
+	//				all they reference, a call the process is suspended in and
+	//				state held only by the registry are not written
+	// Arguments:	io stream interface, version to log as
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void LuaProcess::Write(IOInterface& io, int version) const
+	{
+		SoftProcess::Write(io, version);
+		if (myHibernated.empty() && myHibernatedFile.empty())
+		{
+			LuaHelperFunctions::Serialize(myLuaState, GetGlobalsValue(), io);
+			return;
+		}
+
+		// hibernated globals, or those that failed to revive, are already 
+		// serialized so are written as is
+		std::string bytes = myHibernated;
+		if (!myHibernatedFile.empty())
+		{
+			IBinaryFile in(myHibernatedFile, IOInterface::In);
+			SERIALIZE_IN(in, bytes);
+		}
+		io.Write(bytes.data(), (unsigned int)bytes.size());
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Read
+	// Description:	serialization in, globals are replaced by those read, 
+	//				the process must be of the same class as the one written 
+	//				so has the same c functions
+	// Arguments:	io stream interface, version to log as
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void LuaProcess::Read(IOInterface& io, int version)
+	{
+		SoftProcess::Read(io, version);
+		Wake();
+
+		// user types are pushed on to the current process
+		GCPtr<Process> oldProcess = Scheduler::GetCurrentProcess();
+		Scheduler::SetCurrentProcess(GCPtr<Process>(this));
+		try
+		{
+			LuaHelperFunctions::Deserialize(myLuaState, io, GetGlobalsValue());
+			lua_pop(myLuaState, 1);
+		}
+		catch (...)
+		{
+			Scheduler::SetCurrentProcess(oldProcess);
+			throw;
+		}
+		Scheduler::SetCurrentProcess(oldProcess);
+
+		// globals that failed to revive are replaced so the process may run
+		if (FailedToRevive())
+		{
+			DiscardHibernated();
+			SetReady();
+		}
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Hibernate
+	// Description:	serializes globals of an idle process and closes its lua 
+	//				state until it is next used, functions still those cloned
+	//				from the process spawned from are written by name only 
+	//				so just what is particular to the process is kept. Only 
+	//				globals survive, the registry is cloned again on revival.
+	//				Hosted processes, hosts, 
+	//				processes without a process to respawn from, busy processes
+	//				and those whose globals cannot be serialized without loss do
+	//				not hibernate
+	// Arguments:	directory to store state in, "" to keep in memory
+	// Returns:		if hibernated
+	// --------------------------------------------------------------------------
+	bool LuaProcess::Hibernate(const std::string& path)
+	{
+		if (myHibernating || IsHosted() || myNumHosted != 0 || !mySpawnFrom.IsValid())
+			return false;
+		if (!IsInitialized() || IsFinalizing() || myCurrentMessage != NULL || myState != ExecutionReady || Busy())
+			return false;
+
+		Lock();
+		BinaryBuffer buffer;
+		bool lossless;
+		try
+		{
+			TValue spawnFunctions = GetSpawnFunctions();
+			lossless = LuaHelperFunctions::Serialize(myLuaState, GetGlobalsValue(), buffer, &spawnFunctions);
+		}
+		catch (shh::Exception& e)
+		{
+			DEBUG_TRACE("LuaProcess::Could not hibernate process %lld: %s\n", GetId(), e.what());
+			lossless = false;
+		}
+		if (!lossless)
+		{
+			Unlock();
+			return false;
+		}
+
+		std::string bytes = buffer.GetBytes();
+		if (!path.empty())
+		{
+			std::string file = path + "/" + std::to_string(GetId()) + ".hibernated";
+			OBinaryFile out(file, IOInterface::Out);
+			SERIALIZE_OUT(out, bytes);
+			bool ok = out.GetStream().good();
+			out.Close();
+			if (!ok)
+			{
+				ERROR_TRACE("LuaProcess::Could not write hibernation file %s.\n", file.c_str());
+				FileSystem::Delete(file);
+				Unlock();
+				return false;
+			}
+			myHibernatedFile = file;
+		}
+		else
+		{
+			myHibernated.swap(bytes);
+		}
+
+		lua_close(myLuaState);
+		myLuaState = NULL;
+		myHibernating = true;
+		Unlock();
+		return true;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	IsHibernating
+	// Description:	returns if process is hibernating
+	// Arguments:	none
+	// Returns:		bool
+	// --------------------------------------------------------------------------
+	bool LuaProcess::IsHibernating() const
+	{
+		return myHibernating;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Revive
+	// Description:	recreates lua state of a hibernating process from the
+	//				process it was spawned from and restores its globals, 
+	//				the hibernated globals are kept till restored so if that
+	//				fails they are not lost and the process is left in error
+	// Arguments:	none
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void LuaProcess::Revive()
+	{
+		Lock();
+
+		// another thread may have revived it whilst waiting for the lock
+		if (!myHibernating)
+		{
+			Unlock();
+			return;
+		}
+
+		// cleared first so anything using this process whilst its state is
+		// rebuilt does not try to revive it again
+		myHibernating = false;
+		mySpawnFrom->Wake();
+		GCPtr<Process> oldProcess = Scheduler::GetCurrentProcess();
+		Scheduler::SetCurrentProcess(GCPtr<Process>(this));
+		OpenLuaState(mySpawnFrom->myLuaState, mySpawnFrom->GetGlobalsValue());
+
+		bool ok = true;
+		try
+		{
+			std::string bytes = myHibernated;
+			if (!myHibernatedFile.empty())
+			{
+				IBinaryFile in(myHibernatedFile, IOInterface::In);
+				SERIALIZE_IN(in, bytes);
+			}
+
+			BinaryBuffer buffer(bytes);
+			TValue spawnFunctions = GetSpawnFunctions();
+			LuaHelperFunctions::Deserialize(myLuaState, buffer, GetGlobalsValue(), &spawnFunctions);
+			lua_pop(myLuaState, 1);
+		}
+		catch (std::exception& e)
+		{
+			ERROR_TRACE("LuaProcess::Could not revive process %lld: %s\n", GetId(), e.what());
+			ok = false;
+		}
+		catch (...)
+		{
+			ERROR_TRACE("LuaProcess::Could not revive process %lld.\n", GetId());
+			ok = false;
+		}
+		Scheduler::SetCurrentProcess(oldProcess);
+
+		if (ok)
+		{
+			DiscardHibernated();
+		}
+		else
+		{
+			// globals are only those of the class so it must not run
+			myState = ExecutionError;
+		}
+		Unlock();
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	DiscardHibernated
+	// Description:	frees the serialized globals of a process once it no
+	//				longer needs them
+	// Arguments:	none
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void LuaProcess::DiscardHibernated()
+	{
+		if (!myHibernatedFile.empty())
+		{
+			FileSystem::Delete(myHibernatedFile);
+			myHibernatedFile.clear();
+		}
+		std::string().swap(myHibernated);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	TraceReferences
+	// Description:	reports references to the cycle collector including the
+	//				process spawned from which is needed to revive from
+	//				hibernation
+	// Arguments:	tracer
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void LuaProcess::TraceReferences(GCTracer& tracer) const
+	{
+		SoftProcess::TraceReferences(tracer);
+		tracer.Trace(mySpawnFrom);
+	}
+
 } // namespace shh
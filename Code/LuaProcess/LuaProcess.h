@@ -70,12 +70,14 @@ namespace shh {
 
 
 		virtual GCPtr<Process> Clone();
+		virtual GCPtr<Process> CloneHosted(const GCPtr<Process>& host);
+		inline bool IsHosted() const;
 
 		void SetGarbageCollectionGeneratiobnal(int pause, int stepmul, int stepsize);		
 		void SetGarbageCollectionGeneratiobnal(int minormul, int majormul);
 		static GCPtr<LuaProcess> GetCurrentLuaProcess();
 		static lua_State* GetCurrentLuaState(bool throwError = true);
-		lua_State* GetLuaState() { return myLuaState; }
+		lua_State* GetLuaState() { Wake(); return myLuaState; }
 
 		virtual void CollectAllGarbage();
 		virtual bool ValidateFunctionNames(bool allowClassOnlyFunctions);
@@ -97,6 +99,13 @@ namespace shh {
 		virtual bool HasFunction(const std::string& functionName) const;
 		virtual void AssureIntegrity(bool processOnly = false);
 
+		virtual void Write(IOInterface& io, int version) const;
+		virtual void Read(IOInterface& io, int version);
+
+		virtual bool Hibernate(const std::string& path);
+		virtual bool IsHibernating() const;
+		virtual void TraceReferences(GCTracer& tracer) const;
+
 	protected:
 
 	
@@ -104,6 +113,7 @@ namespace shh {
 		static unsigned int ourNumLuaProcesses;
 
 		LuaProcess(Privileges privileges, const GCPtr<LuaProcess> &spawnFrom);
+		LuaProcess(Privileges privileges, const GCPtr<LuaProcess>& spawnFrom, const GCPtr<LuaProcess>& host);
 		~LuaProcess();
 		virtual const void* GetFunction(const std::string& functionName, int& argsExpected);
 		virtual ExecutionState CallMessage(Message& msg, bool needReturnValues, bool isYieldable = true);
@@ -114,22 +124,99 @@ namespace shh {
 
 	private:
 
+		// heap of a lua state kept in an arena or profiled, held apart from 
+		// the process as the process may be moved in memory
+		class Heap
+		{
+		public:
+			Arena* myArena;
+			std::string myName;
+			MemoryProfiler::Usage* myProfile;
+			MemoryProfiler::Usage* myOwnerProfile;
+		};
+
 		lua_State* myLuaState;
+		Heap* myHeap;
 		LuaGCObject* myInheritedFixedGCs;
 		LuaGCObject* myInheritedAllGCs;
 		bool myScriptError;
 
 		std::vector<int> myResumeStates;
 
+		GCPtr<LuaProcess> myHost;
+		GCPtr<LuaProcess> mySpawnFrom;
+		unsigned int myNumHosted;
+		int myThreadRef;
+		int myGlobalsRef;
+		int mySpawnFunctionsRef;
+		TValue myGlobals;
+
 		unsigned int myDebugStackSize;
 		CallInfo* myDebugCI;
 
+		// globals of a hibernating process serialized in memory or to file
+		bool myHibernating;
+		std::string myHibernated;
+		std::string myHibernatedFile;
+
+		static void* HeapAlloc(void* heap, void* p, size_t oldSize, size_t newSize);
+		static int HeapPanic(lua_State* L);
+
+		void OpenLuaState(lua_State* toClone, TValue* globalsToClone);
+		inline void Wake();
+		inline bool FailedToRevive() const;
+		void Revive();
+		void DiscardHibernated();
 		void UnwindCallStack();
+		TValue* GetGlobalsValue() const;
+		TValue GetSpawnFunctions() const;
+		void EnterGlobals(TValue& previous);
+		void LeaveGlobals(const TValue& previous);
 		bool CallFunction(const std::string& functionName, int numArguments, bool returnsVal);
 		virtual bool GetArgument(Message& msg, unsigned int arg);
 		
 	};
 
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	IsHosted
+	// Description:	returns if process runs inside a host processes lua state 
+	//				rather than its own
+	// Arguments:	none
+	// Returns:		flag
+	// --------------------------------------------------------------------------
+	inline bool LuaProcess::IsHosted() const
+	{
+		return myThreadRef != LUA_NOREF;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Wake
+	// Description:	revives process if hibernating so its lua state may be used
+	// Arguments:	none
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	inline void LuaProcess::Wake()
+	{
+		if (myHibernating)
+			Revive();
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	FailedToRevive
+	// Description:	returns if process woke but its hibernated globals could
+	//				not be restored, it is left in error and does not run
+	// Arguments:	none
+	// Returns:		flag
+	// --------------------------------------------------------------------------
+	inline bool LuaProcess::FailedToRevive() const
+	{
+		return !myHibernating && (!myHibernated.empty() || !myHibernatedFile.empty());
+	}
+
 }// namespace shh
 #endif
 
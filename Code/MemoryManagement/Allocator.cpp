@@ -25,14 +25,76 @@
 #include "../Common/Debug.h"
 #include "../Common/ThreadSafety.h"
 #include "../Common/Mutex.h"
+#include "../GCPtr/MemoryInfo.h"
 #include "Allocator.h"
 #include "Chunk.h"
+#include <algorithm>
 
 
 
 namespace shh {
 
 
+	std::atomic<unsigned int> Allocator::ourNumAllocators(0);
+	thread_local bool Allocator::ourThreadClosed = false;
+
+
+	// Allocator::Magazine ///////////////////////////////////////////////////////////
+
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Magazine
+	// Description:	constructor
+	// Arguments:	owning allocator
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	Allocator::Magazine::Magazine(Allocator* owner) :
+		myAllocator(owner),
+		myCount(0)
+	{
+	}
+
+
+	// Allocator::ThreadMagazines ////////////////////////////////////////////////////
+
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	~ThreadMagazines
+	// Description:	destructor, returns cached blocks of exiting thread to 
+	//				their chunks. The magazines lock keeps allocators from 
+	//				being destroyed whilst they are flushed
+	// Arguments:	none
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	Allocator::ThreadMagazines::~ThreadMagazines()
+	{
+		ourThreadClosed = true;
+		LOCK_MUTEX(GetMagazinesMutex());
+		for (unsigned int m = 0; m != myMagazines.size(); m++)
+		{
+			Magazine* magazine = myMagazines[m];
+			if (magazine == NULL)
+				continue;
+
+			Allocator* allocator = magazine->myAllocator;
+			if (allocator != NULL)
+			{
+				allocator->Flush(*magazine, 0);
+				Magazines::iterator it = std::find(allocator->myMagazines.begin(), allocator->myMagazines.end(), magazine);
+				if (it != allocator->myMagazines.end())
+					allocator->myMagazines.erase(it);
+			}
+			delete magazine;
+		}
+		UNLOCK_MUTEX(GetMagazinesMutex());
+	}
+
+
+	// Allocator /////////////////////////////////////////////////////////////////////
+
+
 
 	// --------------------------------------------------------------------------						
 	// Function:	Allocator
@@ -41,13 +103,20 @@ namespace shh {
 	// Returns:		none
 	// --------------------------------------------------------------------------
 	Allocator::Allocator() :
+		myIndex(ourNumAllocators++),
+		myClosing(false),
 		myDataSize(0),
+		myCompact(false),
+		myDestructor(NULL),
+		myPrototype(NULL),
 		myMaxBlocks(0),
 		myBlocksInUse(0),
+		myBandBits(0),
 		myHardLimitingRatio(0.0f),
 		myLimitingRatio(0.0f),
 		myPeak(-1),
 		myTrough(-1),
+		myDefragChunk(0),
 		myAllocatingChunk(NULL)
 	{
 		myMutex = new Mutex;
@@ -61,9 +130,16 @@ namespace shh {
 	// Returns:		none
 	// --------------------------------------------------------------------------
 	Allocator::Allocator(MemorySize dataSize, unsigned int maxBlocks, float limitingRatio) :
+		myIndex(ourNumAllocators++),
+		myClosing(false),
 		myDataSize(dataSize),
+		myCompact(false),
+		myDestructor(NULL),
+		myPrototype(NULL),
 		myMaxBlocks(maxBlocks),
 		myBlocksInUse(0),
+		myBandBits(0),
+		myDefragChunk(0),
 		myAllocatingChunk(NULL)
 	{
 		myMutex = new Mutex;
@@ -71,6 +147,59 @@ namespace shh {
 	}
 
 
+	// --------------------------------------------------------------------------						
+	// Function:	Allocator
+	// Description:	constructor for allocator of blocks with compact headers,
+	//				all blocks hold the same type so share its destructor
+	// Arguments:	size of each data block, number of block, resize ratio 
+	//				metric, destructor of type
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	Allocator::Allocator(MemorySize dataSize, unsigned int maxBlocks, float limitingRatio, void (*destructor)(void*)) :
+		myIndex(ourNumAllocators++),
+		myClosing(false),
+		myDataSize(dataSize),
+		myCompact(true),
+		myDestructor(destructor),
+		myPrototype(NULL),
+		myMaxBlocks(maxBlocks),
+		myBlocksInUse(0),
+		myBandBits(0),
+		myDefragChunk(0),
+		myAllocatingChunk(NULL)
+	{
+		if (myMaxBlocks > Chunk::GetCompactBlocks(dataSize))
+			myMaxBlocks = Chunk::GetCompactBlocks(dataSize);
+		myMutex = new Mutex;
+		SetDynamicDefrag(limitingRatio);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Allocator
+	// Description:	constructor for arena allocator of same blocks as 
+	//				prototype, arena allocators do not cache in magazines
+	// Arguments:	prototype allocator
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	Allocator::Allocator(Allocator* prototype) :
+		myIndex(prototype->myIndex),
+		myClosing(false),
+		myDataSize(prototype->myDataSize),
+		myCompact(prototype->myCompact),
+		myDestructor(prototype->myDestructor),
+		myPrototype(prototype),
+		myMaxBlocks(prototype->myMaxBlocks),
+		myBlocksInUse(0),
+		myBandBits(0),
+		myDefragChunk(0),
+		myAllocatingChunk(NULL)
+	{
+		myMutex = new Mutex;
+		SetDynamicDefrag(prototype->myHardLimitingRatio);
+	}
+
+
 	// --------------------------------------------------------------------------						
 	// Function:	~Allocato
 	// Description:	destructor
@@ -79,6 +208,16 @@ namespace shh {
 	// --------------------------------------------------------------------------
 	Allocator::~Allocator()
 	{
+		// cached blocks are freed with the chunks, magazines of other threads
+		// are only unlinked, under the magazines lock, and never used again
+		// as allocator indices are not reused
+		LOCK_MUTEX(GetMagazinesMutex());
+		myClosing = true;
+		for (unsigned int m = 0; m != myMagazines.size(); m++)
+			myMagazines[m]->myAllocator = NULL;
+		myMagazines.clear();
+		UNLOCK_MUTEX(GetMagazinesMutex());
+
 		for (int c = 0; c != myChunks.size(); c++)
 			delete myChunks[c];
 
@@ -88,50 +227,285 @@ namespace shh {
 
 	// --------------------------------------------------------------------------						
 	// Function:	Allocate
-	// Description:	allocate memory block in an available chunk
+	// Description:	allocate memory block from this threads cache, refilling
+	//				it from the chunks when empty
 	// Arguments:	none
 	// Returns:		pointer to memory
 	// --------------------------------------------------------------------------
 	void* Allocator::Allocate()
 	{
+		Magazine* magazine = GetMagazine();
+		if (magazine != NULL)
+		{
+			if (magazine->myCount == 0)
+				Refill(*magazine);
+
+			void* p = magazine->myBlocks[--magazine->myCount];
+			GetCached(p) = false;
+			return p;
+		}
+
 		LOCK_MUTEX(myMutex);
+		void* p = AllocateFromChunk();
+		UNLOCK_MUTEX(myMutex);
+		return p;
+	}
 
+
+	// --------------------------------------------------------------------------						
+	// Function:	AllocateFromChunk
+	// Description:	allocate memory block in an available chunk, allocator
+	//				must be locked
+	// Arguments:	none
+	// Returns:		pointer to memory
+	// --------------------------------------------------------------------------
+	void* Allocator::AllocateFromChunk()
+	{
 		if (myAllocatingChunk == NULL || myAllocatingChunk->BlocksAvailable() == 0)
 		{
-			// find chunk with free blocks
-			unsigned int minAvailable = myMaxBlocks;
-			Chunks::iterator found = myChunks.end();
-			Chunks::iterator it = myChunks.begin();
-			while(it != myChunks.end())
-			{
-				unsigned int blocksAvailable = (*it)->BlocksAvailable();
-				if (blocksAvailable != 0 && blocksAvailable < minAvailable)
-				{
-					minAvailable = blocksAvailable;
-					found = it;
-				}
-				++it;
-			}
-
-			if (found == myChunks.end())
+			// find fullest chunk with free blocks
+			myAllocatingChunk = FindFullestAvailable();
+			if (myAllocatingChunk == NULL)
 			{
 				// create new chunk
-				Chunk* newChunk = new Chunk(this, myDataSize, myMaxBlocks);
+				Chunk* newChunk = new Chunk(this, myDataSize, myMaxBlocks, myCompact);
 				myChunks.push_back(newChunk);
-				myAllocatingChunk = myChunks.back();
+				myAllocatingChunk = newChunk;
 				myAllocatingChunk->Init();
 			}
-			else
-			{
-				// set chunk found with free blocks as currently active
-				myAllocatingChunk = *found;
-			}
 		}
 
-		Chunk* allocatungChunk = myAllocatingChunk;
+		void* p = myAllocatingChunk->Allocate();
+		UpdateBand(myAllocatingChunk);
+		return p;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	GetMagazinesMutex
+	// Description:	gets lock guarding links between allocators and the 
+	//				magazines of threads, created on first use as allocators
+	//				may be constructed during static initialization
+	// Arguments:	none
+	// Returns:		mutex
+	// --------------------------------------------------------------------------
+	Mutex* Allocator::GetMagazinesMutex()
+	{
+		static Mutex* mutex = new Mutex;
+		return mutex;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	GetMagazine
+	// Description:	gets this threads cache of free blocks for this allocator
+	// Arguments:	none
+	// Returns:		magazine or NULL if caching is not available
+	// --------------------------------------------------------------------------
+	Allocator::Magazine* Allocator::GetMagazine()
+	{
+#if ALLOCATOR_MAGAZINE_SIZE
+		if (ourThreadClosed || myClosing || myPrototype != NULL)
+			return NULL;
+
+		static thread_local ThreadMagazines threadMagazines;
+		Magazines& magazines = threadMagazines.myMagazines;
+		if (myIndex >= magazines.size())
+			magazines.resize(myIndex + 1, NULL);
+
+		Magazine*& magazine = magazines[myIndex];
+		if (magazine == NULL)
+		{
+			magazine = new Magazine(this);
+			LOCK_MUTEX(GetMagazinesMutex());
+			myMagazines.push_back(magazine);
+			UNLOCK_MUTEX(GetMagazinesMutex());
+		}
+		return magazine;
+#else
+		return NULL;
+#endif
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Refill
+	// Description:	takes a batch of blocks from the chunks into a magazine
+	// Arguments:	magazine
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void Allocator::Refill(Magazine& magazine)
+	{
+		unsigned int batch = ALLOCATOR_MAGAZINE_SIZE / 2;
+		if (batch == 0)
+			batch = 1;
+
+		LOCK_MUTEX(myMutex);
+		while (magazine.myCount < batch)
+		{
+			void* p = AllocateFromChunk();
+			GetCached(p) = true;
+			magazine.myBlocks[magazine.myCount++] = p;
+		}
+		UNLOCK_MUTEX(myMutex);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Flush
+	// Description:	returns blocks cached in a magazine to their chunks
+	// Arguments:	magazine, number of blocks to leave in magazine
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void Allocator::Flush(Magazine& magazine, unsigned int keep)
+	{
+		LOCK_MUTEX(myMutex);
+		while (magazine.myCount > keep)
+		{
+			void* p = magazine.myBlocks[--magazine.myCount];
+			GetCached(p) = false;
+			Chunk* chunk = (Chunk*)MemoryLocator::GetLocator(p);
+			chunk->Release(p, false);
+			UpdateBand(chunk);
+		}
+		UNLOCK_MUTEX(myMutex);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Cache
+	// Description:	places a deallocated block in this threads magazine, 
+	//				flushing half the magazine if it is full
+	// Arguments:	pointer to deallocate
+	// Returns:		true if cached, false if it must be released to its chunk
+	// --------------------------------------------------------------------------
+	bool Allocator::Cache(void* p)
+	{
+		Magazine* magazine = GetMagazine();
+		if (magazine == NULL)
+			return false;
+
+		if (magazine->myCount == ALLOCATOR_MAGAZINE_SIZE)
+			Flush(*magazine, ALLOCATOR_MAGAZINE_SIZE / 2);
+
+		MemoryInfo*& info = MemoryLocator::GetMemoryInfo(p);
+		if (info)
+		{
+			info->Invalidate();
+			info->Detach();
+		}
+		info = NULL;
+		MemoryLocator::SetDestructor(p, NULL);
+		GetCached(p) = true;
+
+		magazine->myBlocks[magazine->myCount++] = p;
+		return true;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Release
+	// Description:	returns a block to its chunk
+	// Arguments:	chunk, pointer to deallocate, whether to invalidate pointer
+	// Returns:		pointer to header of deallocated block
+	// --------------------------------------------------------------------------
+	MemoryLocator::Header* Allocator::Release(Chunk& chunk, void* p, bool invalidateInfo)
+	{
+		LOCK_MUTEX(myMutex);
+		MemoryLocator::Header* next = chunk.Release(p, invalidateInfo);
+		UpdateBand(&chunk);
 		UNLOCK_MUTEX(myMutex);
+		return next;
+	}
 
-		return allocatungChunk->Allocate();
+
+	// --------------------------------------------------------------------------						
+	// Function:	GetBand
+	// Description:	gets band a chunk with given available blocks is filed in
+	// Arguments:	blocks available
+	// Returns:		band, 0 if full
+	// --------------------------------------------------------------------------
+	unsigned int Allocator::GetBand(unsigned int blocksAvailable) const
+	{
+		if (blocksAvailable == 0)
+			return 0;
+		if (blocksAvailable >= myMaxBlocks)
+			return numBands - 1;
+		return 1 + (unsigned int)(((unsigned long long)(blocksAvailable - 1) * (numBands - 1)) / myMaxBlocks);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	UpdateBand
+	// Description:	refiles chunk in band for its current blocks available,
+	//				allocator must be locked
+	// Arguments:	chunk
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void Allocator::UpdateBand(Chunk* chunk)
+	{
+		if (myClosing)
+			return;
+
+		unsigned int band = GetBand(chunk->BlocksAvailable());
+		if (band == chunk->myBand && chunk->myBandIndex < myBands[band].size() && myBands[band][chunk->myBandIndex] == chunk)
+			return;
+
+		RemoveFromBand(chunk);
+		chunk->myBand = band;
+		chunk->myBandIndex = (unsigned int)myBands[band].size();
+		myBands[band].push_back(chunk);
+		myBandBits |= (1u << band);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	RemoveFromBand
+	// Description:	removes chunk from the band it is filed in
+	// Arguments:	chunk
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void Allocator::RemoveFromBand(Chunk* chunk)
+	{
+		Chunks& band = myBands[chunk->myBand];
+		if (chunk->myBandIndex >= band.size() || band[chunk->myBandIndex] != chunk)
+			return;
+
+		// swap last chunk of band into my slot
+		Chunk* last = band.back();
+		band[chunk->myBandIndex] = last;
+		last->myBandIndex = chunk->myBandIndex;
+		band.pop_back();
+		if (band.empty())
+			myBandBits &= ~(1u << chunk->myBand);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	FindFullestAvailable
+	// Description:	finds a chunk in the fullest band that has free blocks
+	// Arguments:	chunk not to return
+	// Returns:		chunk or NULL if none have free blocks
+	// --------------------------------------------------------------------------
+	Chunk* Allocator::FindFullestAvailable(const Chunk* exclude) const
+	{
+		unsigned int bits = myBandBits & ~1u;
+		while (bits != 0)
+		{
+			// lowest set bit is the fullest band
+			unsigned int band = 0;
+			while (((bits >> band) & 1u) == 0)
+				band++;
+
+			const Chunks& chunks = myBands[band];
+			for (unsigned int c = 0; c != chunks.size() && c != 2; c++)
+			{
+				if (chunks[c] != exclude)
+					return chunks[c];
+			}
+			bits &= ~(1u << band);
+		}
+		return NULL;
 	}
 
 
@@ -143,8 +517,7 @@ namespace shh {
 	// --------------------------------------------------------------------------
 	void Allocator::Deallocate(void* p)
 	{
-		MemoryLocator::Header& head = MemoryLocator::GetHeader(p);
-		((Chunk*)head.myLocator)->Deallocate(p);
+		((Chunk*)MemoryLocator::GetLocator(p))->Deallocate(p);
 	}
 
 
@@ -186,6 +559,27 @@ namespace shh {
 	}
 
 
+	// --------------------------------------------------------------------------						
+	// Function:	GetUsage
+	// Description:	counts blocks in use (including those cached by threads)
+	//				and blocks reserved in all chunks
+	// Arguments:	returned blocks in use, returned blocks reserved
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void Allocator::GetUsage(unsigned int& blocksInUse, unsigned int& blocksReserved) const
+	{
+		blocksInUse = 0;
+		blocksReserved = 0;
+		LOCK_MUTEX(myMutex);
+		for (unsigned int c = 0; c != myChunks.size(); c++)
+		{
+			blocksInUse += myChunks[c]->BlocksUsed();
+			blocksReserved += myChunks[c]->BlocksUsed() + myChunks[c]->BlocksAvailable();
+		}
+		UNLOCK_MUTEX(myMutex);
+	}
+
+
 	// --------------------------------------------------------------------------						
 	// Function:	Defrag
 	// Description:	removes gaps in all chunks
@@ -194,87 +588,150 @@ namespace shh {
 	// --------------------------------------------------------------------------
 	void Allocator::Defrag()
 	{
+		// finish any pass in progress then run a whole pass
+		MemorySize budget = (MemorySize)-1;
+		if (myDefragChunk != 0)
+			Defrag(budget);
+		budget = (MemorySize)-1;
+		Defrag(budget);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Defrag
+	// Description:	removes gaps in chunks moving no more than budget bytes, 
+	//				resuming from where last call stopped
+	// Arguments:	bytes that may be moved (decremented by bytes moved)
+	// Returns:		true if pass over all chunks completed
+	// --------------------------------------------------------------------------
+	bool Allocator::Defrag(MemorySize& budget)
+	{
+		// return this threads cached blocks so they do not pin chunks
+		Magazine* magazine = GetMagazine();
+		if (magazine != NULL)
+			Flush(*magazine, 0);
+
 		LOCK_MUTEX(myMutex);
 
-		// calculate limiting ratio
-		if (myPeak == 0)
-			myLimitingRatio = 0.0f;
-		else if (myTrough == 0)
-			myLimitingRatio = myHardLimitingRatio;
-		else
-			myLimitingRatio = (float)myTrough / (float)myPeak; // dynamic calculatiomn
+		if (myDefragChunk == 0)
+		{
+			// calculate limiting ratio at start of pass
+			if (myPeak == 0)
+				myLimitingRatio = 0.0f;
+			else if (myTrough == 0)
+				myLimitingRatio = myHardLimitingRatio;
+			else
+				myLimitingRatio = (float)myTrough / (float)myPeak; // dynamic calculatiomn
 
 
-		myPeak = -1;
-		myTrough = -1;
+			myPeak = -1;
+			myTrough = -1;
 
-		// bount blocks available in all my chunks
+			if (myLimitingRatio == 0.0f && myChunks.size() == 1)
+			{
+				UNLOCK_MUTEX(myMutex);
+				return true;
+			}
+		}
+
+		// count blocks available in all my chunks
 		unsigned int blocksAvailable = 0;
 		Chunks::iterator it = myChunks.begin();
 		while (it != myChunks.end())
 			blocksAvailable += (*(it++))->BlocksAvailable();
 
+		// always allow one block so small budgets still make progress
+		MemorySize budgetBlocks = budget / (myDataSize == 0 ? 1 : myDataSize);
+		unsigned int blocks = budgetBlocks > (unsigned int)-1 ? (unsigned int)-1 : (unsigned int)budgetBlocks;
+		if (blocks == 0)
+			blocks = 1;
+		unsigned int blocksBudget = blocks;
 
-		float totalBlocks = (float)myChunks.size() * myMaxBlocks;
-
-		it = myChunks.begin();
-		while (it != myChunks.end())
+		// each relocation either fills the target or empties the source so
+		// a pass is linear in chunks plus blocks moved
+		while (myDefragChunk < myChunks.size())
 		{
-			unsigned int chunkBlocksUsed = (*it)->BlocksUsed();
+			Chunk* chunk = myChunks[myDefragChunk];
+			unsigned int chunkBlocksUsed = chunk->BlocksUsed();
 			float chunkRatio = (float)chunkBlocksUsed / (float)myMaxBlocks;
 
-			if (!(myLimitingRatio == 0.0f && myChunks.size() == 1))
+			// if usage in this chunk is less than average usage ratio or hard defined ratio then relocate
+			if (chunkRatio <= myLimitingRatio)
 			{
-				// if usage in this chunk is less than average usage ratio or hard defined ratio then relocate
-				if (chunkRatio <= myLimitingRatio)
+				while (chunk->BlocksUsed() && chunkBlocksUsed <= (blocksAvailable - chunk->BlocksAvailable()))
 				{
-					while ((*it)->BlocksUsed() && chunkBlocksUsed <= (blocksAvailable - (*it)->BlocksAvailable()))
+					if (blocks == 0)
 					{
-						// find chunk with smallest free space
-						unsigned int smallestFree = myMaxBlocks;
-						Chunks::iterator relocateTo = myChunks.end();
-						Chunks::iterator checkIt = myChunks.begin();
-						while (checkIt != myChunks.end())
-						{
-							if (checkIt != it)
-							{
-								unsigned int available = (*(checkIt))->BlocksAvailable();
-								if (available > 0 && available < smallestFree)
-								{
-									smallestFree = available;
-									relocateTo = checkIt;
-								}
-							}
-							++checkIt;
-						}
-
-						// relocate my block in other chunks
-						if (relocateTo != myChunks.end())
-						{
-							Chunk* r = *relocateTo;
-							(*it)->Relocate(**relocateTo);
-							chunkBlocksUsed = (*it)->BlocksUsed();
-						}
+						// out of budget, resume with this chunk next call
+						budget = 0;
+						UNLOCK_MUTEX(myMutex);
+						return false;
 					}
 
+					// relocate my blocks in fullest other chunk, stopping if 
+					// only blocks cached by other threads or untracked remain
+					Chunk* relocateTo = FindFullestAvailable(chunk);
+					if (relocateTo == NULL || !chunk->Relocate(*relocateTo, blocks))
+						break;
+					UpdateBand(relocateTo);
+					UpdateBand(chunk);
+					chunkBlocksUsed = chunk->BlocksUsed();
+				}
 
-					if((*it)->BlocksAvailable() == myMaxBlocks && blocksAvailable > myMaxBlocks)
-					{
-						// delete chunk
-						MemorySize dist = std::distance(myChunks.begin(), it);
-						delete* it;
-						myChunks.erase(it);
-						it = myChunks.begin();
-						std::advance(it, dist);
+				if (chunk->BlocksAvailable() == myMaxBlocks && blocksAvailable > myMaxBlocks)
+				{
+					// delete chunk, moving last chunk into its place
+					RemoveFromBand(chunk);
+					if (myAllocatingChunk == chunk)
 						myAllocatingChunk = NULL;
-						blocksAvailable -= myMaxBlocks;
-						continue;
-					}
+					delete chunk;
+					blocksAvailable -= myMaxBlocks;
+					myChunks[myDefragChunk] = myChunks.back();
+					myChunks.pop_back();
+					continue;
 				}
 			}
-			it++;
+			myDefragChunk++;
+		}
+		myDefragChunk = 0;
+		MemorySize moved = (MemorySize)(blocksBudget - blocks) * myDataSize;
+		budget = (moved > budget ? 0 : budget - moved);
+		UNLOCK_MUTEX(myMutex);
+		return true;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Adopt
+	// Description:	takes chunks of another allocator of the same blocks, 
+	//				empty chunks are freed and chunks with blocks still in 
+	//				use are kept by me
+	// Arguments:	allocator to empty
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void Allocator::Adopt(Allocator& other)
+	{
+		DEBUG_ASSERT(other.myDataSize == myDataSize && other.myCompact == myCompact);
+
+		LOCK_MUTEX(other.myMutex);
+		LOCK_MUTEX(myMutex);
+		for (unsigned int c = 0; c != other.myChunks.size(); c++)
+		{
+			Chunk* chunk = other.myChunks[c];
+			other.RemoveFromBand(chunk);
+			if (chunk->BlocksUsed() == 0)
+			{
+				delete chunk;
+				continue;
+			}
+			chunk->myAllocator = this;
+			myChunks.push_back(chunk);
+			UpdateBand(chunk);
 		}
+		other.myChunks.clear();
+		other.myAllocatingChunk = NULL;
 		UNLOCK_MUTEX(myMutex);
+		UNLOCK_MUTEX(other.myMutex);
 	}
 
 
@@ -288,6 +745,8 @@ namespace shh {
 	{
 		if (myChunks.empty())
 		{
+			if (myCompact && blocks > Chunk::GetCompactBlocks(myDataSize))
+				blocks = Chunk::GetCompactBlocks(myDataSize);
 			myMaxBlocks = blocks;
 			myPeak = 0;
 			myTrough = blocks;
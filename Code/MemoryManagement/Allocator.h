@@ -26,7 +26,10 @@
 #define ALLOCATOR_H
 
 #include "SecureStl.h"
+#include "../Config/Config.h"
 #include "../GCPtr/MemoryLocator.h"
+#include <vector>
+#include <atomic>
 
 
 
@@ -39,10 +42,15 @@ namespace shh {
 
 	class Allocator
 	{
+		friend class Chunk;
+		friend class Arena;
+
 	public:
 
 		Allocator();
 		Allocator(MemorySize blockSize, unsigned int maxBlocks, float limitingRatio);
+		Allocator(MemorySize blockSize, unsigned int maxBlocks, float limitingRatio, void (*destructor)(void*));
+		Allocator(Allocator* prototype);
 		~Allocator();
 		void* Allocate();
 		static void Deallocate(void* p);
@@ -50,25 +58,80 @@ namespace shh {
 		void SetDynamicDefrag(float limitingRatio);
 		void RecordUsage();
 		void Defrag();
+		bool Defrag(MemorySize& budget);
 		inline unsigned int GetMaxBlocks() const;
 		void SetMaxBlocks(unsigned int blocks);
+		inline bool IsCompact() const;
+		inline unsigned int GetIndex() const;
+		inline MemorySize GetDataSize() const;
+		void GetUsage(unsigned int& blocksInUse, unsigned int& blocksReserved) const;
+		void Adopt(Allocator& other);
 
 
 	private:
 
 		typedef std::vector<Chunk*> Chunks;
 
-		
+		// chunks are filed in bands by number of blocks available, band 0
+		// holds full chunks, the lowest non empty band above it the fullest
+		enum { numBands = 32 };
+
+		// per thread cache of free blocks of one allocator
+		class Magazine
+		{
+		public:
+			Magazine(Allocator* owner);
+			Allocator* myAllocator;
+			unsigned int myCount;
+			void* myBlocks[ALLOCATOR_MAGAZINE_SIZE == 0 ? 1 : ALLOCATOR_MAGAZINE_SIZE];
+		};
+
+		typedef std::vector<Magazine*> Magazines;
+
+		// all magazines of a thread indexed by allocator, flushed on thread exit
+		class ThreadMagazines
+		{
+		public:
+			~ThreadMagazines();
+			Magazines myMagazines;
+		};
+
+		static std::atomic<unsigned int> ourNumAllocators;
+		static thread_local bool ourThreadClosed;
+
+		unsigned int myIndex;
+		bool myClosing;
+		Magazines myMagazines;
 		MemorySize myDataSize;
+		bool myCompact;
+		void (*myDestructor)(void*);
+		Allocator* myPrototype;
 		unsigned int myMaxBlocks;
 		unsigned int myBlocksInUse;
 		Chunks myChunks;
+		Chunks myBands[numBands];
+		unsigned int myBandBits;
 		Chunk* myAllocatingChunk;
 		float myHardLimitingRatio;
 		float myLimitingRatio;
 		int myPeak;
 		int myTrough;
+		unsigned int myDefragChunk;
 		Mutex* myMutex;
+
+		void* AllocateFromChunk();
+		static Mutex* GetMagazinesMutex();
+		Magazine* GetMagazine();
+		void Refill(Magazine& magazine);
+		void Flush(Magazine& magazine, unsigned int keep);
+		bool Cache(void* p);
+		MemoryLocator::Header* Release(Chunk& chunk, void* p, bool invalidateInfo);
+		inline bool& GetCached(void* p) const;
+
+		unsigned int GetBand(unsigned int blocksAvailable) const;
+		void UpdateBand(Chunk* chunk);
+		void RemoveFromBand(Chunk* chunk);
+		Chunk* FindFullestAvailable(const Chunk* exclude = NULL) const;
 	};
 
 
@@ -87,5 +150,54 @@ namespace shh {
 		return myMaxBlocks; 
 	}
 
+
+	// --------------------------------------------------------------------------						
+	// Function:	IsCompact
+	// Description:	returns if blocks have compact headers
+	// Arguments:	none
+	// Returns:		bool
+	// --------------------------------------------------------------------------
+	inline bool Allocator::IsCompact() const 
+	{ 
+		return myCompact; 
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	GetDataSize
+	// Description:	returns size of data in each block
+	// Arguments:	none
+	// Returns:		size in bytes
+	// --------------------------------------------------------------------------
+	inline MemorySize Allocator::GetDataSize() const 
+	{ 
+		return myDataSize; 
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	GetIndex
+	// Description:	returns index of allocator, arena allocators share the
+	//				index of their prototype
+	// Arguments:	none
+	// Returns:		index
+	// --------------------------------------------------------------------------
+	inline unsigned int Allocator::GetIndex() const 
+	{ 
+		return myIndex; 
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	GetCached
+	// Description:	returns cached flag in header of block
+	// Arguments:	pointer to block
+	// Returns:		cached flag
+	// --------------------------------------------------------------------------
+	inline bool& Allocator::GetCached(void* p) const 
+	{ 
+		return myCompact ? MemoryLocator::GetCompactHeader(p).myCached : MemoryLocator::GetFixedHeader(p).myCached; 
+	}
+
 } 
 #endif // ALLOCATOR_H
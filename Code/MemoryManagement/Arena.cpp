@@ -0,0 +1,286 @@
+///////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2025 David K Bhowmik. All rights reserved.
+// This file is part of shhArc.
+//
+// This Software is available under the MIT License with a No Modification clause.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this file and associated documentation files (the "Software"), to use the
+// Software for any purpose, including commercial applications, provided that:
+//
+//   1. You do NOT modify, alter, or create derivative works of this file.
+//   2. Redistributions must include this notice and may only distribute it 
+//      unmodified.
+//
+// The full MIT License text, including this Custom No Modification clause,
+// is available in the LICENSE file in the root of the project.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND.
+//
+// You may alternatively use this source under the terms of a specific 
+// version of the shhArc Unrestricted License provided you have obtained 
+// such a license from the copyright holder.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "../Common/Debug.h"
+#include "../Common/ThreadSafety.h"
+#include "../Common/Mutex.h"
+#include "MemoryManager.h"
+#include "Arena.h"
+#include <string.h>
+
+
+
+namespace shh {
+
+
+	thread_local Arena* Arena::ourCurrent = NULL;
+	Arena::Arenas Arena::ourArenas;
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Arena
+	// Description:	constructor
+	// Arguments:	name arena is reported as
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	Arena::Arena(const std::string& name) : 
+		myName(name),
+		myReferences(1)
+	{
+		myMutex = new Mutex;
+
+		Mutex* arenasMutex = GetArenasMutex();
+		LOCK_MUTEX(arenasMutex);
+		ourArenas.push_back(this);
+		UNLOCK_MUTEX(arenasMutex);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	~Arena
+	// Description:	destructor, frees empty chunks and large blocks, chunks with 
+	//				blocks still in use are handed to the global allocators so
+	//				cost is linear in chunks not a single release
+	// Arguments:	none
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	Arena::~Arena()
+	{
+		if (ourCurrent == this)
+			ourCurrent = NULL;
+
+		Mutex* arenasMutex = GetArenasMutex();
+		LOCK_MUTEX(arenasMutex);
+		for (unsigned int a = 0; a != ourArenas.size(); a++)
+		{
+			if (ourArenas[a] == this)
+			{
+				ourArenas[a] = ourArenas.back();
+				ourArenas.pop_back();
+				break;
+			}
+		}
+		UNLOCK_MUTEX(arenasMutex);
+
+		for (unsigned int a = 0; a != myAllocators.size(); a++)
+		{
+			Allocator* allocator = myAllocators[a];
+			if (allocator == NULL)
+				continue;
+			allocator->myPrototype->Adopt(*allocator);
+			delete allocator;
+		}
+
+		for (LargeBlocks::iterator it = myLargeBlocks.begin(); it != myLargeBlocks.end(); ++it)
+			MemoryManager::DeallocateLarge(it->first, it->second);
+
+		delete myMutex;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Attach
+	// Description:	adds reference to arena
+	// Arguments:	none
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void Arena::Attach()
+	{
+		LOCK_MUTEX(myMutex);
+		myReferences++;
+		UNLOCK_MUTEX(myMutex);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Detach
+	// Description:	removes reference to arena, deleting it with the last
+	// Arguments:	none
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void Arena::Detach()
+	{
+		LOCK_MUTEX(myMutex);
+		bool last = --myReferences == 0;
+		UNLOCK_MUTEX(myMutex);
+		if (last)
+			delete this;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	GetAllocator
+	// Description:	gets my twin of an allocator, creating it on first use
+	// Arguments:	global allocator
+	// Returns:		arena allocator
+	// --------------------------------------------------------------------------
+	Allocator* Arena::GetAllocator(Allocator* prototype)
+	{
+		unsigned int index = prototype->GetIndex();
+
+		LOCK_MUTEX(myMutex);
+		if (index >= myAllocators.size())
+			myAllocators.resize(index + 1, NULL);
+		if (myAllocators[index] == NULL)
+			myAllocators[index] = new Allocator(prototype);
+		Allocator* allocator = myAllocators[index];
+		UNLOCK_MUTEX(myMutex);
+		return allocator;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Malloc
+	// Description:	allocates raw memory in arena by size class, large blocks
+	//				are mapped and recorded to be unmapped with the arena
+	// Arguments:	size in bytes
+	// Returns:		pointer to memory
+	// --------------------------------------------------------------------------
+	void* Arena::Malloc(MemorySize size)
+	{
+		if (size > MemoryManager::largeObjectSize)
+		{
+			void* p = MemoryManager::AllocateLarge(size);
+			LOCK_MUTEX(myMutex);
+			myLargeBlocks[p] = size;
+			UNLOCK_MUTEX(myMutex);
+			return p;
+		}
+		return GetAllocator(MemoryManager::GetManager().GetSizeClassAllocator(size))->Allocate();
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Free
+	// Description:	frees raw memory allocated in arena
+	// Arguments:	pointer to memory, size in bytes it was allocated with
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void Arena::Free(void* p, MemorySize size)
+	{
+		if (p == NULL)
+			return;
+
+		if (size > MemoryManager::largeObjectSize)
+		{
+			LOCK_MUTEX(myMutex);
+			myLargeBlocks.erase(p);
+			UNLOCK_MUTEX(myMutex);
+			MemoryManager::DeallocateLarge(p, size);
+			return;
+		}
+		Allocator::Deallocate(p);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Reallocate
+	// Description:	resizes raw memory allocated in arena, blocks staying in 
+	//				the same size class are not moved
+	// Arguments:	pointer to memory or NULL, old size, new size
+	// Returns:		pointer to memory or NULL if new size is 0
+	// --------------------------------------------------------------------------
+	void* Arena::Reallocate(void* p, MemorySize oldSize, MemorySize newSize)
+	{
+		if (newSize == 0)
+		{
+			Free(p, oldSize);
+			return NULL;
+		}
+		if (p == NULL)
+			return Malloc(newSize);
+
+		if (oldSize <= MemoryManager::largeObjectSize && newSize <= MemoryManager::largeObjectSize &&
+			MemoryManager::GetSizeClass(oldSize) == MemoryManager::GetSizeClass(newSize))
+			return p;
+
+		void* q = Malloc(newSize);
+		memcpy(q, p, oldSize < newSize ? oldSize : newSize);
+		Free(p, oldSize);
+		return q;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	GetUsage
+	// Description:	gets bytes in use and reserved by arena
+	// Arguments:	returned usage
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void Arena::GetUsage(Usage& usage) const
+	{
+		usage.myName = myName;
+		usage.myBytesInUse = 0;
+		usage.myBytesReserved = 0;
+
+		LOCK_MUTEX(myMutex);
+		for (unsigned int a = 0; a != myAllocators.size(); a++)
+		{
+			if (myAllocators[a] == NULL)
+				continue;
+			unsigned int blocksInUse, blocksReserved;
+			myAllocators[a]->GetUsage(blocksInUse, blocksReserved);
+			usage.myBytesInUse += blocksInUse * myAllocators[a]->GetDataSize();
+			usage.myBytesReserved += blocksReserved * myAllocators[a]->GetDataSize();
+		}
+		for (LargeBlocks::const_iterator it = myLargeBlocks.begin(); it != myLargeBlocks.end(); ++it)
+		{
+			usage.myBytesInUse += it->second;
+			usage.myBytesReserved += it->second;
+		}
+		UNLOCK_MUTEX(myMutex);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	GetUsages
+	// Description:	gets usage of all arenas
+	// Arguments:	returned usages
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void Arena::GetUsages(Usages& usages)
+	{
+		Mutex* arenasMutex = GetArenasMutex();
+		LOCK_MUTEX(arenasMutex);
+		usages.resize(ourArenas.size());
+		for (unsigned int a = 0; a != ourArenas.size(); a++)
+			ourArenas[a]->GetUsage(usages[a]);
+		UNLOCK_MUTEX(arenasMutex);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	GetArenasMutex
+	// Description:	gets mutex guarding list of arenas, created once on first
+	//				use by any thread
+	// Arguments:	none
+	// Returns:		mutex
+	// --------------------------------------------------------------------------
+	Mutex* Arena::GetArenasMutex()
+	{
+		static Mutex* mutex = new Mutex;
+		return mutex;
+	}
+
+}
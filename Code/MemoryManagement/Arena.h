@@ -0,0 +1,140 @@
+///////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2025 David K Bhowmik. All rights reserved.
+// This file is part of shhArc.
+//
+// This Software is available under the MIT License with a No Modification clause.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this file and associated documentation files (the "Software"), to use the
+// Software for any purpose, including commercial applications, provided that:
+//
+//   1. You do NOT modify, alter, or create derivative works of this file.
+//   2. Redistributions must include this notice and may only distribute it 
+//      unmodified.
+//
+// The full MIT License text, including this Custom No Modification clause,
+// is available in the LICENSE file in the root of the project.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND.
+//
+// You may alternatively use this source under the terms of a specific 
+// version of the shhArc Unrestricted License provided you have obtained 
+// such a license from the copyright holder.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include "SecureStl.h"
+#include "../Config/Config.h"
+#include "Allocator.h"
+#include <string>
+#include <vector>
+#include <map>
+
+
+
+namespace shh {
+
+	class Mutex;
+
+	// an arena holds its own twin of each allocator used while it is current 
+	// so a realm's memory is kept apart, objects are still destroyed one by
+	// one but the arena's empty chunks and large blocks are released with it
+	class Arena
+	{
+	public:
+
+		class Usage
+		{
+		public:
+			std::string myName;
+			MemorySize myBytesInUse;
+			MemorySize myBytesReserved;
+		};
+		typedef std::vector<Usage> Usages;
+
+		Arena(const std::string& name = "");
+
+		void Attach();
+		void Detach();
+
+		Allocator* GetAllocator(Allocator* prototype);
+
+		void* Malloc(MemorySize size);
+		void Free(void* p, MemorySize size);
+		void* Reallocate(void* p, MemorySize oldSize, MemorySize newSize);
+		void GetUsage(Usage& usage) const;
+
+		static void GetUsages(Usages& usages);
+
+		static inline Arena* GetCurrent();
+		static inline Arena* SetCurrent(Arena* arena);
+		static inline void* Allocate(Allocator* prototype);
+
+	private:
+
+		typedef std::vector<Allocator*> Allocators;
+		typedef std::map<void*, MemorySize> LargeBlocks;
+		typedef std::vector<Arena*> Arenas;
+
+		static thread_local Arena* ourCurrent;
+		static Arenas ourArenas;
+
+		std::string myName;
+		int myReferences;
+		Allocators myAllocators;
+		LargeBlocks myLargeBlocks;
+		Mutex* myMutex;
+
+		~Arena();
+
+		static Mutex* GetArenasMutex();
+	};
+
+
+
+	// Arena Inlines ////////////////////////////////////////////////////////////
+
+	// --------------------------------------------------------------------------						
+	// Function:	GetCurrent
+	// Description:	returns arena allocations are made in on this thread
+	// Arguments:	none
+	// Returns:		arena or NULL if allocating globally
+	// --------------------------------------------------------------------------
+	inline Arena* Arena::GetCurrent()
+	{
+		return ourCurrent;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	SetCurrent
+	// Description:	sets arena allocations are made in on this thread
+	// Arguments:	arena or NULL to allocate globally
+	// Returns:		previous arena
+	// --------------------------------------------------------------------------
+	inline Arena* Arena::SetCurrent(Arena* arena)
+	{
+		Arena* previous = ourCurrent;
+		ourCurrent = arena;
+		return previous;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Allocate
+	// Description:	allocates a block from current arena's twin of allocator
+	//				or from the allocator itself if there is no arena
+	// Arguments:	allocator
+	// Returns:		pointer to memory
+	// --------------------------------------------------------------------------
+	inline void* Arena::Allocate(Allocator* prototype)
+	{
+		if (ourCurrent == NULL)
+			return prototype->Allocate();
+		return ourCurrent->GetAllocator(prototype)->Allocate();
+	}
+
+}
+#endif
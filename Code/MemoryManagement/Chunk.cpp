@@ -30,24 +30,35 @@
 #include "Chunk.h"
 #include "Allocator.h"
 
+#ifdef _WIN64
+#include <malloc.h>
+#else
+#include <stdlib.h>
+#endif
+
 namespace shh {
 
 
 	// --------------------------------------------------------------------------						
 	// Function:	Chunk
 	// Description:	constructor
-	// Arguments:	owning allocator, size of data block, num blocks
+	// Arguments:	owning allocator, size of data block, num blocks,
+	//				whether blocks have compact headers
 	// Returns:		none
 	// --------------------------------------------------------------------------
-	Chunk::Chunk(Allocator* owner, MemorySize dataSize, int blocks) :
+	Chunk::Chunk(Allocator* owner, MemorySize dataSize, int blocks, bool compact) :
 		MemoryLocator(false),
 		myAllocator(owner),
 		myDataSize(dataSize),
-		myBlockSize(dataSize + MemoryLocator::fixedHeaderSize),
+		myBlockSize(compact ? GetCompactBlockSize(dataSize) : dataSize + MemoryLocator::fixedHeaderSize),
 		myTotalBlocks(blocks),
 		myBlocksAvailable(blocks),
 		myFreeSpace(NULL),
-		myRecycledSpace(NULL)
+		myRecycledSpace(NULL),
+		myCompact(compact),
+		myFreeList(NULL),
+		myBand(0),
+		myBandIndex(0)
 	{
 		myMutex = new Mutex;
 	}
@@ -62,7 +73,33 @@ namespace shh {
 	// --------------------------------------------------------------------------
 	Chunk::~Chunk()
 	{
-		if (myBase != NULL)
+		if (myBase != NULL && myCompact)
+		{
+			// blocks cached in magazines hold no object
+			for (char* block = myBase + compactHeaderSize; block < myFreeSpace; block += myBlockSize)
+			{
+				CompactHeader* head = (CompactHeader*)block;
+				if (!head->myInUse || head->myCached)
+					continue;
+
+				if (head->myMemoryInfo && head->myMemoryInfo->myGCObject)
+				{
+					GCObject::DestroyObjectVirtuallyIfPossible(head->myMemoryInfo->myGCObject, head->myMemoryInfo->myGCObject);
+				}
+				else
+				{
+					if (myAllocator->myDestructor != NULL)
+						myAllocator->myDestructor(head + 1);
+					Release(head + 1, true);
+				}
+			}
+#ifdef _WIN64
+			_aligned_free(myBase);
+#else
+			free(myBase);
+#endif
+		}
+		else if (myBase != NULL)
 		{
 			while (myInUseHead != NULL)
 			{
@@ -74,7 +111,7 @@ namespace shh {
 				{
 					if (myInUseHead->myDestructor != NULL)
 						myInUseHead->myDestructor(((FixedHeader*)myInUseHead) + 1);
-					Deallocate(((FixedHeader*)myInUseHead) + 1);
+					Release(((FixedHeader*)myInUseHead) + 1, true);
 				}
 			}
 			delete[]myBase;
@@ -92,6 +129,25 @@ namespace shh {
 	// --------------------------------------------------------------------------
 	void Chunk::Init()
 	{
+		if (myCompact)
+		{
+			// align chunk to its size so blocks find it by masking their 
+			// address, the locator is stored at the start
+			void* base = NULL;
+#ifdef _WIN64
+			base = _aligned_malloc(compactChunkSize, compactChunkSize);
+#else
+			if (posix_memalign(&base, compactChunkSize, compactChunkSize) != 0)
+				base = NULL;
+#endif
+			RELEASE_ASSERT(base != NULL);
+			myBase = (char*)base;
+			myEnd = myBase + compactChunkSize;
+			*(MemoryLocator**)myBase = this;
+			myFreeSpace = myBase + compactHeaderSize;
+			return;
+		}
+
 		MemorySize size = myBlockSize * myBlocksAvailable;
 		myBase = new char[size];
 		myEnd = myBase + size;
@@ -111,6 +167,30 @@ namespace shh {
 
 		DEBUG_ASSERT(myBlocksAvailable != 0);
 
+		if (myCompact)
+		{
+			void* p;
+			if (myFreeList)
+			{
+				// use previously freed block, its data holds the next link
+				p = myFreeList;
+				myFreeList = *(void**)p;
+			}
+			else
+			{
+				// use space at end of chunk
+				memset(myFreeSpace, 0, myBlockSize);
+				p = myFreeSpace + compactHeaderSize;
+				myFreeSpace = myFreeSpace + myBlockSize;
+			}
+			new ((char*)p - compactHeaderSize) CompactHeader;
+			--myBlocksAvailable;
+
+			UNLOCK_MUTEX(myMutex);
+
+			return p;
+		}
+
 		FixedHeader* head;
 		if (myRecycledSpace)
 		{
@@ -146,16 +226,45 @@ namespace shh {
 
 	// --------------------------------------------------------------------------						
 	// Function:	Deallocate
-	// Description:	deallocate block in chunk
+	// Description:	deallocate block in chunk, caching it in the allocating 
+	//				threads magazine if possible
 	// Arguments:	block data ptr, whether to invalidate pointer
 	// Returns:		pointer to header of deallocated block
 	// --------------------------------------------------------------------------
 	MemoryLocator::Header* Chunk::Deallocate(void* p, bool invalidateInfo)
+	{
+		if (invalidateInfo && myAllocator->Cache(p))
+			return myCompact ? NULL : GetFixedHeader(p).myNextHeader;
+
+		return myAllocator->Release(*this, p, invalidateInfo);
+	}
+
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Release
+	// Description:	returns block to the chunks free space
+	// Arguments:	block data ptr, whether to invalidate pointer
+	// Returns:		pointer to header of deallocated block
+	// --------------------------------------------------------------------------
+	MemoryLocator::Header* Chunk::Release(void* p, bool invalidateInfo)
 	{
 		LOCK_MUTEX(myMutex);
 
 		Header* next = MemoryLocator::Deallocate(p, invalidateInfo);
 
+		if (myCompact)
+		{
+			// link block into free list through its data
+			*(void**)p = myFreeList;
+			myFreeList = p;
+			++myBlocksAvailable;
+
+			UNLOCK_MUTEX(myMutex);
+
+			return next;
+		}
+
 		FixedHeader* head = &MemoryLocator::GetFixedHeader(p);
 
 		// add me to the recycled space
@@ -175,36 +284,77 @@ namespace shh {
 
 	// --------------------------------------------------------------------------						
 	// Function:	Relocate
-	// Description:	moves data blocks from me to other chunk
-	// Arguments:	other chunk
-	// Returns:		none
+	// Description:	moves data blocks from me to other chunk, blocks cached
+	//				in thread magazines or without memory info (their owners
+	//				hold raw pointers) are left in place
+	// Arguments:	other chunk, max blocks to move (decremented by num moved)
+	// Returns:		true if any blocks were moved
 	// --------------------------------------------------------------------------
-	void Chunk::Relocate(Chunk& relocateTo)
+	bool Chunk::Relocate(Chunk& relocateTo, unsigned int& maxBlocks)
 	{
-		FixedHeader* head = NULL;
-		while (relocateTo.BlocksAvailable() && BlocksUsed())
+		bool moved = false;
+		if (myCompact)
 		{
-			head = (FixedHeader*)myInUseHead;
-			char* source = (char*)(head + 1);
-			char* target = (char*)relocateTo.Allocate();
-			memcpy(target, source, myDataSize);
-			FixedHeader* targetHead = &GetFixedHeader(target);
-			targetHead->myMemoryInfo = head->myMemoryInfo;
-
-			if (targetHead->myMemoryInfo)
+			// compact blocks have no in use list so scan used space
+			for (char* block = myBase + compactHeaderSize; maxBlocks && relocateTo.BlocksAvailable() && block < myFreeSpace; block += myBlockSize)
 			{
-				// update any smarp pointer to point to new memory
-				MemoryOffset offset = relocateTo.AddressOffset(target);
-				GCInfo* gci = dynamic_cast<GCInfo*>(targetHead->myMemoryInfo);
-				if (gci)
-					gci->RegisterMoveSingle(&relocateTo, offset);
-				else
-					targetHead->myMemoryInfo->RegisterMoveSingle(&relocateTo, offset);
+				CompactHeader* head = (CompactHeader*)block;
+				if (!head->myInUse || head->myCached || GetMemoryInfo(head + 1) == NULL)
+					continue;
 
+				Move(relocateTo, head + 1);
+				--maxBlocks;
+				moved = true;
 			}
+			return moved;
+		}
+
+		FixedHeader* head = (FixedHeader*)myInUseHead;
+		while (maxBlocks && relocateTo.BlocksAvailable() && head != NULL)
+		{
+			FixedHeader* next = head->myNextHeader;
+			if (head->myCached || GetMemoryInfo(head + 1) == NULL)
+			{
+				head = next;
+				continue;
+			}
+
+			Move(relocateTo, head + 1);
+			--maxBlocks;
+			moved = true;
+			head = next;
+		}
+		return moved;
+	}
+
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Move
+	// Description:	moves one data block from me to other chunk
+	// Arguments:	other chunk, block data ptr
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void Chunk::Move(Chunk& relocateTo, void* source)
+	{
+		char* target = (char*)relocateTo.Allocate();
+		memcpy(target, source, myDataSize);
+		MemoryInfo* info = GetMemoryInfo(source);
+		GetMemoryInfo(target) = info;
+
+		if (info)
+		{
+			// update any smarp pointer to point to new memory
+			MemoryOffset offset = relocateTo.AddressOffset(target);
+			GCInfo* gci = dynamic_cast<GCInfo*>(info);
+			if (gci)
+				gci->RegisterMoveSingle(&relocateTo, offset);
+			else
+				info->RegisterMoveSingle(&relocateTo, offset);
 
-			Deallocate(source, false);
 		}
+
+		Release(source, false);
 	}
 
 }
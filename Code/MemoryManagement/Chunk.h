@@ -38,17 +38,22 @@ namespace shh {
 
 	class Chunk : public MemoryLocator
 	{
+		friend class Allocator;
+
 	public:
 
-		Chunk(Allocator* owner, MemorySize dataSize, int blocks);
+		Chunk(Allocator* owner, MemorySize dataSize, int blocks, bool compact = false);
 		~Chunk();
 		void Init();
 		void* Allocate();
 		virtual Header* Deallocate(void* p, bool invalidateInfo = true);
-		void Relocate(Chunk& relocateTo);
+		bool Relocate(Chunk& relocateTo, unsigned int& maxBlocks);
 		inline unsigned int BlocksAvailable() const;
 		inline unsigned int BlocksUsed() const;
 
+		static inline MemorySize GetCompactBlockSize(MemorySize dataSize);
+		static inline unsigned int GetCompactBlocks(MemorySize dataSize);
+
 	private:
 
 		Allocator* myAllocator;
@@ -58,8 +63,14 @@ namespace shh {
 		unsigned int myBlocksAvailable;
 		char* myFreeSpace;
 		FixedHeader* myRecycledSpace;
+		bool myCompact;
+		void* myFreeList;
 		Mutex* myMutex;
+		unsigned int myBand;
+		unsigned int myBandIndex;
 
+		Header* Release(void* p, bool invalidateInfo);
+		void Move(Chunk& relocateTo, void* source);
 	};
 
 
@@ -91,6 +102,35 @@ namespace shh {
 	}
 
 
+	// --------------------------------------------------------------------------						
+	// Function:	GetCompactBlockSize
+	// Description:	returns size of block with compact header, data is 
+	//				rounded up so free blocks can hold the free list link
+	// Arguments:	size of data
+	// Returns:		block size
+	// --------------------------------------------------------------------------
+	inline MemorySize Chunk::GetCompactBlockSize(MemorySize dataSize)
+	{ 
+		if (dataSize < sizeof(void*))
+			dataSize = sizeof(void*);
+		dataSize = (dataSize + sizeof(void*) - 1) & ~(MemorySize)(sizeof(void*) - 1);
+		return dataSize + compactHeaderSize;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	GetCompactBlocks
+	// Description:	returns number of blocks that fit in a compact chunk
+	//				after the locator pointer at its start
+	// Arguments:	size of data
+	// Returns:		num blocks
+	// --------------------------------------------------------------------------
+	inline unsigned int Chunk::GetCompactBlocks(MemorySize dataSize)
+	{ 
+		return (unsigned int)((compactChunkSize - compactHeaderSize) / GetCompactBlockSize(dataSize));
+	}
+
+
 } 
 #endif // CHUNK_H
 
@@ -45,7 +45,8 @@ namespace shh {
 	MemoryFrame::MemoryFrame(MemoryStack* owner) : 
 		MemoryLocator(true), 
 		myTrimReserve(0), 
-		myBlanked(false) 
+		myBlanked(false),
+		myDefragOffset(0)
 	{
 		myBase = owner->myTop+1;
 		myEnd = owner->myEnd;
@@ -308,6 +309,7 @@ namespace shh {
 		if (!myBlanked)
 			ClearRange(0, AddressOffset(myTop).value);
 		myTop = myBase;
+		myDefragOffset = 0;
 	}
 
 
@@ -418,20 +420,55 @@ namespace shh {
 
 
 	// --------------------------------------------------------------------------						
-	// Function:	Malloc
+	// Function:	Defrag
 	// Description:	removes all gaps frame
 	// Arguments:	none
 	// Returns:		none
 	// --------------------------------------------------------------------------
 	void MemoryFrame::Defrag()
 	{
+		MemorySize budget = (MemorySize)-1;
+		myDefragOffset = 0;
+		Defrag(budget);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Defrag
+	// Description:	removes gaps in frame, resuming from where last call 
+	//				stopped, each header visited and each byte moved is 
+	//				charged to the budget, blocks without memory info are
+	//				held by raw pointers so are left in place
+	// Arguments:	bytes that may be processed (decremented by bytes used)
+	// Returns:		true if pass over frame completed
+	// --------------------------------------------------------------------------
+	bool MemoryFrame::Defrag(MemorySize& budget)
+	{
+		// frame may have been cleared or trimmed since last call
+		if (myBase + myDefragOffset >= myTop)
+			myDefragOffset = 0;
+
 		char* freePtr = myTop;
 		MemorySize freeSize = 0;
-		VariableHeader* nextHeader = reinterpret_cast<VariableHeader*>(myBase);
-		while ((char*)nextHeader < myTop)
+		VariableHeader* header = reinterpret_cast<VariableHeader*>(myBase + myDefragOffset);
+		while ((char*)header < myTop)
 		{
-			VariableHeader* header = nextHeader;
-			nextHeader = reinterpret_cast<VariableHeader*>(((char*)nextHeader) + variableHeaderSize + nextHeader->mySize);
+			if (budget == 0)
+			{
+				// leave gap as a free block so frame can be walked and 
+				// resume from it next call
+				if (freeSize > 0)
+				{
+					VariableHeader* gap = new (freePtr) VariableHeader(this);
+					gap->mySize = freeSize - variableHeaderSize;
+					header = gap;
+				}
+				myDefragOffset = (char*)header - myBase;
+				return false;
+			}
+
+			VariableHeader* nextHeader = reinterpret_cast<VariableHeader*>(((char*)header) + variableHeaderSize + header->mySize);
+			budget = (budget > variableHeaderSize ? budget - variableHeaderSize : 0);
 
 			if (!header->myInUse)
 			{
@@ -446,26 +483,38 @@ namespace shh {
 					freeSize += header->mySize + variableHeaderSize;
 				}
 			}
-			else if(header->myInUse && freeSize > 0)
+			else if (freeSize > 0 && header->myMemoryInfo == NULL)
+			{
+				// cannot move so leave gap below as a free block
+				VariableHeader* gap = new (freePtr) VariableHeader(this);
+				gap->mySize = freeSize - variableHeaderSize;
+				freeSize = 0;
+				freePtr = myTop;
+			}
+			else if (freeSize > 0)
 			{
 				// if in use move back down to begining of free space
 				MemorySize size = header->mySize;
 				MemorySize diff = (char*)header - freePtr;
-			
-				memcpy(freePtr, header, size + variableHeaderSize);
-				
+
+				memmove(freePtr, header, size + variableHeaderSize);
+				budget = (budget > size ? budget - size : 0);
+
 				// point all pointers to new location
 				if (((VariableHeader*)freePtr)->myMemoryInfo)
 					((VariableHeader*)freePtr)->myMemoryInfo->RegisterMoveAll(diff, Down);
 
 				freePtr = freePtr + variableHeaderSize + size;
 			}
+			header = nextHeader;
 		}
 		if (freeSize)
 		{
 			memset(freePtr, 0, freeSize);
 			myTop = (char*)freePtr;
 		}
+		myDefragOffset = 0;
+		return true;
 	}
 
 }
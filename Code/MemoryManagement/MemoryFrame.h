@@ -79,11 +79,13 @@ namespace shh {
 		inline MemoryStack* GetOwningStack() const;
 	
 		void Defrag();
+		bool Defrag(MemorySize& budget);
 
 	protected:
 
 		int myTrimReserve;
 		bool myBlanked;
+		MemorySize myDefragOffset;
 
 		MemoryFrame(MemoryStack* owner);
 		bool SetSize(MemorySize size);
@@ -162,8 +164,7 @@ namespace shh {
 	// --------------------------------------------------------------------------
 	inline void  MemoryFrame::operator delete(void* mem)
 	{
-		MemoryLocator::Header& head = MemoryLocator::GetHeader(mem); \
-			head.myLocator->Deallocate(mem);
+		MemoryLocator::GetLocator(mem)->Deallocate(mem);
 	}
 
 
@@ -26,6 +26,7 @@
 #include "SecureStl.h"
 #include "MemoryManager.h"
 #include "MemoryStack.h"
+#include "MemoryProfiler.h"
 
 
 namespace shh {
@@ -38,5 +39,10 @@ namespace shh {
 		MemoryManager::StdAllocatorSize::ourMultiple = (unsigned int)memory.Get("multiple_stl_blocks", (long)MemoryManager::StdAllocatorSize::ourMultiple);
 		MemoryStack::ourDefaultAllocatorBlocks = (unsigned int)memory.Get("stack_blocks", (long)MemoryStack::ourDefaultAllocatorBlocks);
 		MemoryStack::ourGrowRate = (unsigned int)memory.Get("stack_grow_rate", (long)MemoryStack::ourGrowRate);
+		MemoryStack::ourReserveSize = (MemorySize)memory.Get("stack_reserve", (long)MemoryStack::ourReserveSize);
+		MemoryManager::ourDefragSlice = (MemorySize)memory.Get("defrag_slice", (long)MemoryManager::ourDefragSlice);
+		MemoryManager::ourDefragTime = memory.Get("defrag_time", MemoryManager::ourDefragTime);
+		MemoryProfiler::ourEnabled = memory.Get("profile", MemoryProfiler::ourEnabled);
+		MemoryProfiler::SetSampleRate((unsigned int)memory.Get("profile_sample_rate", (long)0));
 	}
 }
\ No newline at end of file
@@ -29,6 +29,8 @@
 #include "MemoryManager.h"
 #include "MemoryStack.h"
 #include "MemoryFrame.h"
+#include "Arena.h"
+#include "MemoryProfiler.h"
 #include "../Config/GCPtr.h"
 #include <type_traits>
 
@@ -56,25 +58,32 @@ namespace shh {
 
 
 #define CONFIGURE_SHHARC_MEMORYMANAGEMENT(DICT) ConfigureMemoryManagementSHHARC(DICT)
-#define UPDATE_SHHARC_MEMORYMANAGER(ARG) 
+#define UPDATE_SHHARC_MEMORYMANAGER(ARG) MemoryManager::GetManager().Update(ARG)
+#define DUMP_SHHARC_MEMORY_PROFILE(FILE) MemoryProfiler::Dump(FILE)
 
 
 #define DECLARE_SHHARC_MEMORY_MANAGED(CLASS) \
 	public: \
-	inline void* operator new(const size_t bytes){ GCPtr<CLASS>::ourMemoryManaged = true; CLASS *p = (CLASS*)ourAllocator->Allocate(); MemoryLocator::MemoryDestructor<CLASS>::Add(p); SetMemoryStart(p); return p; } \
+	inline void* operator new(const size_t bytes){ GCPtr<CLASS>::ourMemoryManaged = true; CLASS *p = (CLASS*)shh::Arena::Allocate(ourAllocator); PROFILE_MEMORY_ALLOCATED(#CLASS, sizeof(CLASS)); MemoryLocator::MemoryDestructor<CLASS>::Add(p); SetMemoryStart(p); return p; } \
 	inline void* operator new(const size_t bytes, shh::MemoryStack* m) { GCPtr<CLASS>::ourMemoryManaged = true; CLASS* p = (CLASS*)m->Malloc((unsigned int)bytes); MemoryLocator::MemoryDestructor<CLASS>::Add(p); SetMemoryStart(p); return p; } \
 	inline void* operator new(const size_t bytes, shh::MemoryFrame* m) { GCPtr<CLASS>::ourMemoryManaged = true; CLASS* p = (CLASS*)m->Malloc((unsigned int)bytes); MemoryLocator::MemoryDestructor<CLASS>::Add(p); SetMemoryStart(p); return p; } \
 	inline void* operator new(const size_t bytes, void* place) { SetMemoryStart((CLASS*)place); return place; } \
 	inline void operator delete(void* mem, shh::MemoryFrame *m){ } \
 	inline void operator delete(void* mem) { \
-	MemoryLocator::Header& head = MemoryLocator::GetHeader(mem); \
-	head.myLocator->Deallocate(mem); } \
+	PROFILE_MEMORY_DEALLOCATED(#CLASS, sizeof(CLASS)); MemoryLocator::GetLocator(mem)->Deallocate(mem); } \
 	private: \
 	static shh::Allocator* ourAllocator;
 
 #define IMPLEMENT_SHHARC_MEMORY_MANAGED(CLASS) \
 	shh::Allocator *CLASS::ourAllocator = shh::MemoryManager::GetManager().GetAllocator(sizeof(CLASS)); \
 
+// compact managed classes share one allocator per type so blocks need only 
+// a small header, classes derived from them must declare their own
+#define DECLARE_SHHARC_COMPACT_MEMORY_MANAGED(CLASS) DECLARE_SHHARC_MEMORY_MANAGED(CLASS)
+
+#define IMPLEMENT_SHHARC_COMPACT_MEMORY_MANAGED(CLASS) \
+	shh::Allocator *CLASS::ourAllocator = shh::MemoryManager::GetManager().GetCompactAllocator(sizeof(CLASS), &MemoryLocator::MemoryDestructor<CLASS>::Destroy); \
+
 	template<class T> class Dictionary;
 	void ConfigureMemoryManagementSHHARC(const  Dictionary<std::string>& memory);
 
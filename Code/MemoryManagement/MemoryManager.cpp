@@ -27,7 +27,17 @@
 #include "../Common/Debug.h"
 #include "../Common/ThreadSafety.h"
 #include "../Common/Mutex.h"
+#include "../Common/PreciseTime.h"
 #include "MemoryManager.h"
+#include "MemoryStack.h"
+#include "MemoryProfiler.h"
+#include <new>
+
+#ifdef _WIN64
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
 
 namespace shh {
 
@@ -40,6 +50,8 @@ namespace shh {
 
 	MemoryManager* MemoryManager::ourManager = NULL;
 	int MemoryManager::ourGranularity = sizeof(MemorySize);
+	MemorySize MemoryManager::ourDefragSlice = 16384;
+	double MemoryManager::ourDefragTime = 0.001;
 
 
 
@@ -81,9 +93,12 @@ namespace shh {
 	// Returns:		none
 	// --------------------------------------------------------------------------
 	MemoryManager::MemoryManager() :
-		myMaxBlocks(256)
+		myMaxBlocks(256),
+		myDefragAllocator(0)
 	{
 		myMutex = new Mutex;
+		for (unsigned int c = 0; c != numSizeClasses; c++)
+			mySizeClasses[c].store(NULL, std::memory_order_relaxed);
 
 		SetDynamicDefrag(0.75);
 	}
@@ -98,13 +113,8 @@ namespace shh {
 	MemoryManager::~MemoryManager()
 	{
 		delete myMutex;
-		Allocators::iterator it = myAllocators.begin();
-		while (it != myAllocators.end())
-		{
-			delete it->second;
-			it++;
-		}
-
+		for (unsigned int a = 0; a != myAllocatorList.size(); a++)
+			delete myAllocatorList[a];
 	}
 
 
@@ -124,14 +134,117 @@ namespace shh {
 		Allocators::iterator it = myAllocators.find(newDataSize);
 		if (it == myAllocators.end())
 		{
-			myAllocators[dataSize] = new Allocator(newDataSize, (maxBlocks == 0 ? myMaxBlocks : maxBlocks), myLimitingRatio);
-			it = myAllocators.find(dataSize);
+			myAllocators[newDataSize] = new Allocator(newDataSize, (maxBlocks == 0 ? myMaxBlocks : maxBlocks), myLimitingRatio);
+			it = myAllocators.find(newDataSize);
+			myAllocatorList.push_back(it->second);
+		}
+		UNLOCK_MUTEX(myMutex);
+		return it->second;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	GetCompactAllocator
+	// Description:	get allocator of blocks with compact headers for a type, 
+	//				types too large for a compact chunk get a normal allocator
+	// Arguments:	data block size, destructor of type, max blocks in a chunk
+	// Returns:		allocator
+	// --------------------------------------------------------------------------
+	Allocator* MemoryManager::GetCompactAllocator(MemorySize dataSize, void (*destructor)(void*), unsigned int maxBlocks)
+	{
+		if (Chunk::GetCompactBlocks(dataSize) < 16)
+			return GetAllocator(dataSize, maxBlocks);
+
+		LOCK_MUTEX(myMutex);
+		CompactAllocators::iterator it = myCompactAllocators.find(destructor);
+		if (it == myCompactAllocators.end())
+		{
+			myCompactAllocators[destructor] = new Allocator(dataSize, (maxBlocks == 0 ? myMaxBlocks : maxBlocks), myLimitingRatio, destructor);
+			it = myCompactAllocators.find(destructor);
+			myAllocatorList.push_back(it->second);
 		}
 		UNLOCK_MUTEX(myMutex);
 		return it->second;
 	}
 
 
+	// --------------------------------------------------------------------------						
+	// Function:	GetSizeClassAllocator
+	// Description:	get allocator of size class that holds data size, so 
+	//				arrays of near sizes share allocators, an allocator is 
+	//				published only once fully constructed so it can be read 
+	//				without locking
+	// Arguments:	data size no larger than largeObjectSize, max blocks in 
+	//				a chunk
+	// Returns:		allocator
+	// --------------------------------------------------------------------------
+	Allocator* MemoryManager::GetSizeClassAllocator(MemorySize dataSize, unsigned int maxBlocks)
+	{
+		DEBUG_ASSERT(dataSize <= largeObjectSize);
+
+		unsigned int sizeClass = GetSizeClass(dataSize);
+		Allocator* allocator = mySizeClasses[sizeClass].load(std::memory_order_acquire);
+		if (allocator != NULL)
+			return allocator;
+
+		LOCK_MUTEX(myMutex);
+		allocator = mySizeClasses[sizeClass].load(std::memory_order_relaxed);
+		if (allocator == NULL)
+		{
+			allocator = new Allocator(GetSizeClassSize(sizeClass), (maxBlocks == 0 ? myMaxBlocks : maxBlocks), myLimitingRatio);
+			myAllocatorList.push_back(allocator);
+			mySizeClasses[sizeClass].store(allocator, std::memory_order_release);
+		}
+		UNLOCK_MUTEX(myMutex);
+		return allocator;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	AllocateLarge
+	// Description:	maps pages for allocation too large for size classes
+	// Arguments:	size in bytes
+	// Returns:		pointer to memory
+	// --------------------------------------------------------------------------
+	void* MemoryManager::AllocateLarge(MemorySize size)
+	{
+#ifdef _WIN64
+		void* p = VirtualAlloc(NULL, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+		if (p == NULL)
+			throw std::bad_alloc();
+#else
+		void* p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (p == MAP_FAILED)
+			throw std::bad_alloc();
+#endif
+#if MEMORY_PROFILING
+		if (MemoryProfiler::ourEnabled)
+			MemoryProfiler::AllocatedLarge(size);
+#endif
+		return p;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	DeallocateLarge
+	// Description:	unmaps pages of large allocation
+	// Arguments:	pointer to memory, size in bytes
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void MemoryManager::DeallocateLarge(void* p, MemorySize size)
+	{
+#if MEMORY_PROFILING
+		if (MemoryProfiler::ourEnabled)
+			MemoryProfiler::DeallocatedLarge(size);
+#endif
+#ifdef _WIN64
+		VirtualFree(p, 0, MEM_RELEASE);
+#else
+		munmap(p, size);
+#endif
+	}
+
+
 	// --------------------------------------------------------------------------						
 	// Function:	SetMaxBlocks
 	// Description:	sets global max blocks per chunk default
@@ -142,14 +255,9 @@ namespace shh {
 	{
 		myMaxBlocks = maxBlocks;
 		LOCK_MUTEX(myMutex);
-		Allocators::iterator it = myAllocators.begin();
-		if (it == myAllocators.end())
-		{
-			it->second->SetMaxBlocks(myMaxBlocks);
-			it++;
-		}
+		for (unsigned int a = 0; a != myAllocatorList.size(); a++)
+			myAllocatorList[a]->SetMaxBlocks(myMaxBlocks);
 		UNLOCK_MUTEX(myMutex);
-		return;
 	}
 
 
@@ -163,12 +271,22 @@ namespace shh {
 	{
 		myLimitingRatio = limitingRatio;
 		LOCK_MUTEX(myMutex);
-		Allocators::iterator it = myAllocators.begin();
-		while (it != myAllocators.end())
-		{
-			it->second->SetDynamicDefrag(myLimitingRatio);
-			it++;
-		}
+		for (unsigned int a = 0; a != myAllocatorList.size(); a++)
+			myAllocatorList[a]->SetDynamicDefrag(myLimitingRatio);
+		UNLOCK_MUTEX(myMutex);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	GetAllocators
+	// Description:	gets all global allocators
+	// Arguments:	returned allocators
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void MemoryManager::GetAllocators(AllocatorList& allocators)
+	{
+		LOCK_MUTEX(myMutex);
+		allocators = myAllocatorList;
 		UNLOCK_MUTEX(myMutex);
 	}
 
@@ -182,14 +300,9 @@ namespace shh {
 	void MemoryManager::RecordUsage()
 	{
 		LOCK_MUTEX(myMutex);
-		Allocators::iterator it = myAllocators.begin();
-		while (it != myAllocators.end())
-		{
-			it->second->RecordUsage();
-			it++;
-		}
+		for (unsigned int a = 0; a != myAllocatorList.size(); a++)
+			myAllocatorList[a]->RecordUsage();
 		UNLOCK_MUTEX(myMutex);
-		return;
 	}
 
 
@@ -202,17 +315,90 @@ namespace shh {
 	void MemoryManager::Defrag()
 	{
 		LOCK_MUTEX(myMutex);
-		Allocators::iterator it = myAllocators.begin();
-		while (it != myAllocators.end())
+		for (unsigned int a = 0; a != myAllocatorList.size(); a++)
+			myAllocatorList[a]->Defrag();
+		UNLOCK_MUTEX(myMutex);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	AddStack
+	// Description:	registers memory stack so it is packed on update
+	// Arguments:	memory stack
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void MemoryManager::AddStack(MemoryStack* stack)
+	{
+		MemoryManager& manager = GetManager();
+		LOCK_MUTEX(manager.myMutex);
+		manager.myStackList.push_back(stack);
+		UNLOCK_MUTEX(manager.myMutex);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	RemoveStack
+	// Description:	unregisters memory stack
+	// Arguments:	memory stack
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void MemoryManager::RemoveStack(MemoryStack* stack)
+	{
+		if (ourManager == NULL)
+			return;
+
+		LOCK_MUTEX(ourManager->myMutex);
+		StackList& stacks = ourManager->myStackList;
+		for (unsigned int s = 0; s != stacks.size(); s++)
 		{
-			it->second->Defrag();
-			it++;
+			if (stacks[s] == stack)
+			{
+				stacks.erase(stacks.begin() + s);
+				break;
+			}
 		}
-		UNLOCK_MUTEX(myMutex);
-		return;
+		UNLOCK_MUTEX(ourManager->myMutex);
 	}
 
 
+	// --------------------------------------------------------------------------						
+	// Function:	Update
+	// Description:	records usage then defrags allocators and packs memory 
+	//				stacks in slices of ourDefragSlice bytes until time runs 
+	//				out, resuming with the one last call stopped at
+	// Arguments:	seconds available, capped at ourDefragTime
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void MemoryManager::Update(double seconds)
+	{
+		double start = GetPreciseTime();
+		if (seconds > ourDefragTime)
+			seconds = ourDefragTime;
+		RecordUsage();
 
+		LOCK_MUTEX(myMutex);
+		unsigned int completed = 0;
+		unsigned int total = (unsigned int)(myAllocatorList.size() + myStackList.size());
+		while (completed < total && GetPreciseTime() - start < seconds)
+		{
+			if (myDefragAllocator >= total)
+				myDefragAllocator = 0;
+
+			MemorySize budget = ourDefragSlice;
+			bool done;
+			if (myDefragAllocator < myAllocatorList.size())
+				done = myAllocatorList[myDefragAllocator]->Defrag(budget);
+			else
+				done = myStackList[myDefragAllocator - myAllocatorList.size()]->Pack(budget);
+
+			if (done)
+			{
+				// pass is done, move on to next
+				myDefragAllocator++;
+				completed++;
+			}
+		}
+		UNLOCK_MUTEX(myMutex);
+	}
 
 }
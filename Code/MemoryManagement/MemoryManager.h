@@ -31,10 +31,16 @@
 #include "Chunk.h"
 #include <vector>
 #include <map>
+#include <atomic>
+
+#ifdef _WIN64
+#include <intrin.h>
+#endif
 
 namespace shh {
 
 	class MemoryFrame;
+	class MemoryStack;
 	class Mutex;
 
 	class MemoryManager
@@ -77,17 +83,37 @@ namespace shh {
 		};
 		
 		typedef std::map<MemorySize, Allocator*> Allocators;
+		typedef std::map<void (*)(void*), Allocator*> CompactAllocators;
+		typedef std::vector<Allocator*> AllocatorList;
+		typedef std::vector<MemoryStack*> StackList;
+
+		// arrays are bucketed in size classes of multiples of 8 bytes up to
+		// 32 then four classes per power of two, larger arrays are mapped
+		enum { largeObjectSize = 65536 };
+		enum { numSizeClasses = 48 };
 
 
 		static MemoryManager& GetManager();
 		static void CloseManager();
 
 		Allocator* GetAllocator(MemorySize dataSize, unsigned int maxBlocks = 0);
+		Allocator* GetCompactAllocator(MemorySize dataSize, void (*destructor)(void*), unsigned int maxBlocks = 0);
+		Allocator* GetSizeClassAllocator(MemorySize dataSize, unsigned int maxBlocks = 0);
+		static void* AllocateLarge(MemorySize size);
+		static void DeallocateLarge(void* p, MemorySize size);
+		static inline unsigned int GetSizeClass(MemorySize dataSize);
+		static inline MemorySize GetSizeClassSize(unsigned int sizeClass);
 		void SetMaxBlocks(unsigned int maxBlocks);
 		void SetDynamicDefrag(float limitingRatio);
+		void GetAllocators(AllocatorList& allocators);
+		static void AddStack(MemoryStack* stack);
+		static void RemoveStack(MemoryStack* stack);
 		void RecordUsage();
 		void Defrag();
+		void Update(double seconds);
 
+		static MemorySize ourDefragSlice;
+		static double ourDefragTime;
 
 	private:
 
@@ -96,6 +122,11 @@ namespace shh {
 		unsigned int myMaxBlocks;
 		float myLimitingRatio;
 		Allocators myAllocators;
+		CompactAllocators myCompactAllocators;
+		AllocatorList myAllocatorList;
+		StackList myStackList;
+		std::atomic<Allocator*> mySizeClasses[numSizeClasses];
+		unsigned int myDefragAllocator;
 
 		Mutex* myMutex;
 
@@ -146,7 +177,10 @@ namespace shh {
 	{
 		if (_Count == 1)
 			return (pointer)ourAllocator->Allocate();
-		Allocator* allocator = MemoryManager::GetManager().GetAllocator(sizeof(T) * _Count, S::GetMultiple());
+		MemorySize size = sizeof(T) * _Count;
+		if (size > largeObjectSize)
+			return (pointer)MemoryManager::AllocateLarge(size);
+		Allocator* allocator = MemoryManager::GetManager().GetSizeClassAllocator(size, S::GetMultiple());
 		return (pointer)allocator->Allocate();
 	}
 
@@ -171,7 +205,53 @@ namespace shh {
 	// --------------------------------------------------------------------------
 	template<class T, class S = StdAllocatorSize > 	void MemoryManager::StdAllocator<T, S>::deallocate(pointer _Ptr, size_type _Count)
 	{ 
-		Allocator::Deallocate(_Ptr); 
+		if (_Count != 1 && sizeof(T) * _Count > largeObjectSize)
+			MemoryManager::DeallocateLarge(_Ptr, sizeof(T) * _Count);
+		else
+			Allocator::Deallocate(_Ptr); 
+	}
+
+
+	// MemoryManager Inlines //////////////////////////////////////////////////////////////////
+
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	GetSizeClass
+	// Description:	returns size class that holds data size
+	// Arguments:	data size no larger than largeObjectSize
+	// Returns:		size class
+	// --------------------------------------------------------------------------
+	inline unsigned int MemoryManager::GetSizeClass(MemorySize dataSize)
+	{
+		if (dataSize <= 32)
+			return dataSize == 0 ? 0 : (unsigned int)((dataSize - 1) >> 3);
+
+		// find power of two below size then which quarter of it size is in
+		unsigned long long below = (unsigned long long)(dataSize - 1);
+#ifdef _WIN64
+		unsigned long power;
+		_BitScanReverse64(&power, below);
+#else
+		unsigned int power = 63 - __builtin_clzll(below);
+#endif
+		return 4 + ((unsigned int)power - 5) * 4 + (unsigned int)((below - (1ull << power)) >> (power - 2));
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	GetSizeClassSize
+	// Description:	returns largest data size in size class
+	// Arguments:	size class
+	// Returns:		data size
+	// --------------------------------------------------------------------------
+	inline MemorySize MemoryManager::GetSizeClassSize(unsigned int sizeClass)
+	{
+		if (sizeClass < 4)
+			return (MemorySize)(sizeClass + 1) << 3;
+
+		unsigned int power = 5 + (sizeClass - 4) / 4;
+		return ((MemorySize)1 << power) + (MemorySize)((sizeClass - 4) % 4 + 1) * ((MemorySize)1 << (power - 2));
 	}
 
 }
@@ -0,0 +1,357 @@
+///////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2025 David K Bhowmik. All rights reserved.
+// This file is part of shhArc.
+//
+// This Software is available under the MIT License with a No Modification clause.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this file and associated documentation files (the "Software"), to use the
+// Software for any purpose, including commercial applications, provided that:
+//
+//   1. You do NOT modify, alter, or create derivative works of this file.
+//   2. Redistributions must include this notice and may only distribute it 
+//      unmodified.
+//
+// The full MIT License text, including this Custom No Modification clause,
+// is available in the LICENSE file in the root of the project.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND.
+//
+// You may alternatively use this source under the terms of a specific 
+// version of the shhArc Unrestricted License provided you have obtained 
+// such a license from the copyright holder.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "../Common/Debug.h"
+#include "../Common/ThreadSafety.h"
+#include "../Common/Mutex.h"
+#include "MemoryManager.h"
+#include "Arena.h"
+#include "MemoryProfiler.h"
+#include <fstream>
+#include <stdio.h>
+#ifdef _WIN64
+#include <windows.h>
+#else
+#include <execinfo.h>
+#endif
+
+
+
+namespace shh {
+
+
+	bool MemoryProfiler::ourEnabled = false;
+	thread_local std::string MemoryProfiler::ourOwner;
+	unsigned int MemoryProfiler::ourSampleRate = 0;
+	unsigned int MemoryProfiler::ourSampleCount = 0;
+	MemoryProfiler::TypeUsages MemoryProfiler::ourTypes;
+	MemoryProfiler::Usage MemoryProfiler::ourLarge;
+	MemoryProfiler::Categories MemoryProfiler::ourCategories;
+	MemoryProfiler::Stacks MemoryProfiler::ourStacks;
+	Mutex* MemoryProfiler::ourMutex = NULL;
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Escape
+	// Description:	escapes string for writing as json
+	// Arguments:	string
+	// Returns:		escaped string
+	// --------------------------------------------------------------------------
+	static std::string Escape(const std::string& s)
+	{
+		std::string escaped;
+		for (unsigned int c = 0; c != s.size(); c++)
+		{
+			if (s[c] == '"' || s[c] == '\\')
+				escaped += '\\';
+			if ((unsigned char)s[c] >= 0x20)
+				escaped += s[c];
+		}
+		return escaped;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	WriteUsage
+	// Description:	writes usage as json object
+	// Arguments:	stream, name of usage, usage
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	static void WriteUsage(std::ofstream& out, const std::string& name, const MemoryProfiler::Usage& usage)
+	{
+		out << "{\"name\": \"" << Escape(name) << "\", \"bytes\": " << usage.myBytes << ", \"count\": " << usage.myCount 
+			<< ", \"allocations\": " << usage.myAllocations << ", \"peak_bytes\": " << usage.myPeakBytes << "}";
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Allocated
+	// Description:	records allocation of memory managed type
+	// Arguments:	type name, bytes allocated
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void MemoryProfiler::Allocated(const char* type, MemorySize bytes)
+	{
+		Mutex* mutex = GetMutex();
+		LOCK_MUTEX(mutex);
+		ourTypes[type].Add(bytes);
+		if (ourSampleRate != 0 && ++ourSampleCount >= ourSampleRate)
+		{
+			ourSampleCount = 0;
+			Sample(bytes);
+		}
+		UNLOCK_MUTEX(mutex);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Deallocated
+	// Description:	records deallocation of memory managed type
+	// Arguments:	type name, bytes deallocated
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void MemoryProfiler::Deallocated(const char* type, MemorySize bytes)
+	{
+		Mutex* mutex = GetMutex();
+		LOCK_MUTEX(mutex);
+		ourTypes[type].Remove(bytes);
+		UNLOCK_MUTEX(mutex);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	AllocatedLarge
+	// Description:	records allocation of pages too large for size classes
+	// Arguments:	bytes allocated
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void MemoryProfiler::AllocatedLarge(MemorySize bytes)
+	{
+		Mutex* mutex = GetMutex();
+		LOCK_MUTEX(mutex);
+		ourLarge.Add(bytes);
+		UNLOCK_MUTEX(mutex);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	DeallocatedLarge
+	// Description:	records deallocation of pages too large for size classes
+	// Arguments:	bytes deallocated
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void MemoryProfiler::DeallocatedLarge(MemorySize bytes)
+	{
+		Mutex* mutex = GetMutex();
+		LOCK_MUTEX(mutex);
+		ourLarge.Remove(bytes);
+		UNLOCK_MUTEX(mutex);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	GetUsage
+	// Description:	gets usage of named owner of memory in a category, such as
+	//				a lua process or realm, created on first use
+	// Arguments:	category, name
+	// Returns:		usage, remains valid until removed
+	// --------------------------------------------------------------------------
+	MemoryProfiler::Usage* MemoryProfiler::GetUsage(const std::string& category, const std::string& name)
+	{
+		Mutex* mutex = GetMutex();
+		LOCK_MUTEX(mutex);
+		Usage* usage = &ourCategories[category][name];
+		UNLOCK_MUTEX(mutex);
+		return usage;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	RemoveUsage
+	// Description:	removes usage of named owner of memory
+	// Arguments:	category, name
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void MemoryProfiler::RemoveUsage(const std::string& category, const std::string& name)
+	{
+		Mutex* mutex = GetMutex();
+		LOCK_MUTEX(mutex);
+		Categories::iterator it = ourCategories.find(category);
+		if (it != ourCategories.end())
+			it->second.erase(name);
+		UNLOCK_MUTEX(mutex);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Resize
+	// Description:	records a reallocation in usage and usage of its owner
+	// Arguments:	usage, owner usage or NULL, old size (0 if new), new size 
+	//				(0 if freed)
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void MemoryProfiler::Resize(Usage* usage, Usage* ownerUsage, MemorySize oldSize, MemorySize newSize)
+	{
+		Mutex* mutex = GetMutex();
+		LOCK_MUTEX(mutex);
+		if (oldSize != 0)
+		{
+			usage->Remove(oldSize);
+			if (ownerUsage != NULL)
+				ownerUsage->Remove(oldSize);
+		}
+		if (newSize != 0)
+		{
+			usage->Add(newSize);
+			if (ownerUsage != NULL)
+				ownerUsage->Add(newSize);
+		}
+		UNLOCK_MUTEX(mutex);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	SetSampleRate
+	// Description:	sets how often the call stack of an allocation of a memory
+	//				managed type is recorded
+	// Arguments:	one in how many allocations are sampled, 0 for none
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void MemoryProfiler::SetSampleRate(unsigned int rate)
+	{
+		Mutex* mutex = GetMutex();
+		LOCK_MUTEX(mutex);
+		ourSampleRate = rate;
+		ourSampleCount = 0;
+		UNLOCK_MUTEX(mutex);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Sample
+	// Description:	records call stack of an allocation, profiler must be 
+	//				locked
+	// Arguments:	bytes allocated
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void MemoryProfiler::Sample(MemorySize bytes)
+	{
+		void* frames[maxStackFrames];
+#ifdef _WIN64
+		int numFrames = CaptureStackBackTrace(2, maxStackFrames, frames, NULL);
+#else
+		int numFrames = backtrace(frames, maxStackFrames);
+#endif
+		if (numFrames <= 0)
+			return;
+
+		Stack stack(frames, frames + numFrames);
+		ourStacks[stack].Add(bytes);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Dump
+	// Description:	writes profile as json, with usage of memory managed 
+	//				types, large allocations, allocators, arenas, named owners
+	//				of memory and sampled allocation stacks
+	// Arguments:	file name
+	// Returns:		if successful
+	// --------------------------------------------------------------------------
+	bool MemoryProfiler::Dump(const std::string& filename)
+	{
+		std::ofstream out(filename.c_str(), std::ios::out | std::ios::trunc);
+		if (!out.is_open())
+			return false;
+
+		// gather allocator and arena usage first as they lock themselves
+		MemoryManager::AllocatorList allocators;
+		MemoryManager::GetManager().GetAllocators(allocators);
+		Arena::Usages arenas;
+		Arena::GetUsages(arenas);
+
+		out << "{\n\t\"enabled\": " << (ourEnabled ? "true" : "false") << ",\n";
+		out << "\t\"sample_rate\": " << ourSampleRate << ",\n";
+
+		out << "\t\"allocators\": [";
+		for (unsigned int a = 0; a != allocators.size(); a++)
+		{
+			unsigned int blocksInUse, blocksReserved;
+			allocators[a]->GetUsage(blocksInUse, blocksReserved);
+			MemorySize dataSize = allocators[a]->GetDataSize();
+			out << (a == 0 ? "\n\t\t" : ",\n\t\t") << "{\"index\": " << allocators[a]->GetIndex() << ", \"block_size\": " << dataSize
+				<< ", \"compact\": " << (allocators[a]->IsCompact() ? "true" : "false")
+				<< ", \"blocks\": " << blocksInUse << ", \"blocks_reserved\": " << blocksReserved
+				<< ", \"bytes\": " << blocksInUse * dataSize << ", \"bytes_reserved\": " << blocksReserved * dataSize << "}";
+		}
+		out << "\n\t],\n";
+
+		out << "\t\"arenas\": [";
+		for (unsigned int a = 0; a != arenas.size(); a++)
+		{
+			out << (a == 0 ? "\n\t\t" : ",\n\t\t") << "{\"name\": \"" << Escape(arenas[a].myName) << "\", \"bytes\": " << arenas[a].myBytesInUse 
+				<< ", \"bytes_reserved\": " << arenas[a].myBytesReserved << "}";
+		}
+		out << "\n\t],\n";
+
+		Mutex* mutex = GetMutex();
+		LOCK_MUTEX(mutex);
+
+		out << "\t\"large\": ";
+		WriteUsage(out, "large", ourLarge);
+		out << ",\n";
+
+		out << "\t\"types\": [";
+		for (TypeUsages::const_iterator it = ourTypes.begin(); it != ourTypes.end(); ++it)
+		{
+			out << (it == ourTypes.begin() ? "\n\t\t" : ",\n\t\t");
+			WriteUsage(out, it->first, it->second);
+		}
+		out << "\n\t],\n";
+
+		for (Categories::const_iterator cit = ourCategories.begin(); cit != ourCategories.end(); ++cit)
+		{
+			out << "\t\"" << Escape(cit->first) << "\": [";
+			for (NamedUsages::const_iterator it = cit->second.begin(); it != cit->second.end(); ++it)
+			{
+				out << (it == cit->second.begin() ? "\n\t\t" : ",\n\t\t");
+				WriteUsage(out, it->first, it->second);
+			}
+			out << "\n\t],\n";
+		}
+
+		out << "\t\"stacks\": [";
+		for (Stacks::const_iterator it = ourStacks.begin(); it != ourStacks.end(); ++it)
+		{
+			out << (it == ourStacks.begin() ? "\n\t\t" : ",\n\t\t") << "{\"frames\": [";
+			for (unsigned int f = 0; f != it->first.size(); f++)
+			{
+				char address[32];
+				snprintf(address, sizeof(address), "\"0x%llx\"", (unsigned long long)it->first[f]);
+				out << (f == 0 ? "" : ", ") << address;
+			}
+			out << "], \"bytes\": " << it->second.myBytes << ", \"count\": " << it->second.myCount << "}";
+		}
+		out << "\n\t]\n}\n";
+
+		UNLOCK_MUTEX(mutex);
+
+		return out.good();
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	GetMutex
+	// Description:	gets mutex guarding profile
+	// Arguments:	none
+	// Returns:		mutex
+	// --------------------------------------------------------------------------
+	Mutex* MemoryProfiler::GetMutex()
+	{
+		if (ourMutex == NULL)
+			ourMutex = new Mutex;
+		return ourMutex;
+	}
+
+}
@@ -0,0 +1,168 @@
+///////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2025 David K Bhowmik. All rights reserved.
+// This file is part of shhArc.
+//
+// This Software is available under the MIT License with a No Modification clause.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this file and associated documentation files (the "Software"), to use the
+// Software for any purpose, including commercial applications, provided that:
+//
+//   1. You do NOT modify, alter, or create derivative works of this file.
+//   2. Redistributions must include this notice and may only distribute it 
+//      unmodified.
+//
+// The full MIT License text, including this Custom No Modification clause,
+// is available in the LICENSE file in the root of the project.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND.
+//
+// You may alternatively use this source under the terms of a specific 
+// version of the shhArc Unrestricted License provided you have obtained 
+// such a license from the copyright holder.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef MEMORY_PROFILER_H
+#define MEMORY_PROFILER_H
+
+#include "SecureStl.h"
+#include "../Config/Config.h"
+#include "../GCPtr/MemoryLocator.h"
+#include <string>
+#include <vector>
+#include <map>
+
+
+
+namespace shh {
+
+	class Mutex;
+
+	// records live bytes and counts of memory managed types, lua processes 
+	// and the realms they were created in, with sampled allocation stacks,
+	// allocator and arena usage is gathered when the profile is dumped
+	class MemoryProfiler
+	{
+	public:
+
+		class Usage
+		{
+		public:
+			Usage() : myBytes(0), myCount(0), myAllocations(0), myPeakBytes(0) {}
+			inline void Add(MemorySize bytes);
+			inline void Remove(MemorySize bytes);
+
+			long long myBytes;
+			long long myCount;
+			long long myAllocations;
+			long long myPeakBytes;
+		};
+
+		enum { maxStackFrames = 16 };
+
+		static bool ourEnabled;
+
+		static void Allocated(const char* type, MemorySize bytes);
+		static void Deallocated(const char* type, MemorySize bytes);
+		static void AllocatedLarge(MemorySize bytes);
+		static void DeallocatedLarge(MemorySize bytes);
+		static Usage* GetUsage(const std::string& category, const std::string& name);
+		static void RemoveUsage(const std::string& category, const std::string& name);
+		static void Resize(Usage* usage, Usage* ownerUsage, MemorySize oldSize, MemorySize newSize);
+		static void SetSampleRate(unsigned int rate);
+		static inline const std::string& GetOwner();
+		static inline void SetOwner(const std::string& owner);
+		static bool Dump(const std::string& filename);
+
+	private:
+
+		typedef std::map<const char*, Usage> TypeUsages;
+		typedef std::map<std::string, Usage> NamedUsages;
+		typedef std::map<std::string, NamedUsages> Categories;
+		typedef std::vector<void*> Stack;
+		typedef std::map<Stack, Usage> Stacks;
+
+		static thread_local std::string ourOwner;
+		static unsigned int ourSampleRate;
+		static unsigned int ourSampleCount;
+		static TypeUsages ourTypes;
+		static Usage ourLarge;
+		static Categories ourCategories;
+		static Stacks ourStacks;
+		static Mutex* ourMutex;
+
+		static Mutex* GetMutex();
+		static void Sample(MemorySize bytes);
+	};
+
+
+
+	// MemoryProfiler Inlines //////////////////////////////////////////////////////////
+
+	// --------------------------------------------------------------------------						
+	// Function:	Add
+	// Description:	records an allocation
+	// Arguments:	bytes allocated
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	inline void MemoryProfiler::Usage::Add(MemorySize bytes)
+	{
+		myBytes += bytes;
+		myCount++;
+		myAllocations++;
+		if (myBytes > myPeakBytes)
+			myPeakBytes = myBytes;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Remove
+	// Description:	records a deallocation, clamped at zero as memory 
+	//				allocated before profiling was enabled is not counted
+	// Arguments:	bytes deallocated
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	inline void MemoryProfiler::Usage::Remove(MemorySize bytes)
+	{
+		myBytes = (myBytes > (long long)bytes ? myBytes - (long long)bytes : 0);
+		if (myCount > 0)
+			myCount--;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	GetOwner
+	// Description:	returns name allocations on this thread are attributed to
+	// Arguments:	none
+	// Returns:		owner name, empty if none
+	// --------------------------------------------------------------------------
+	inline const std::string& MemoryProfiler::GetOwner()
+	{
+		return ourOwner;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	SetOwner
+	// Description:	sets name allocations on this thread are attributed to
+	// Arguments:	owner name, empty if none
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	inline void MemoryProfiler::SetOwner(const std::string& owner)
+	{
+		ourOwner = owner;
+	}
+
+}
+
+
+
+#if MEMORY_PROFILING
+#define PROFILE_MEMORY_ALLOCATED(TYPE, BYTES) if (shh::MemoryProfiler::ourEnabled) shh::MemoryProfiler::Allocated(TYPE, BYTES)
+#define PROFILE_MEMORY_DEALLOCATED(TYPE, BYTES) if (shh::MemoryProfiler::ourEnabled) shh::MemoryProfiler::Deallocated(TYPE, BYTES)
+#else
+#define PROFILE_MEMORY_ALLOCATED(TYPE, BYTES)
+#define PROFILE_MEMORY_DEALLOCATED(TYPE, BYTES)
+#endif
+
+#endif // MEMORY_PROFILER_H
@@ -28,10 +28,18 @@
 #include "MemoryManager.h"
 #include <algorithm>
 
+#ifdef _WIN64
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 namespace shh {
 
 	unsigned int MemoryStack::ourDefaultAllocatorBlocks = 64;
 	unsigned int MemoryStack::ourGrowRate = 0;
+	MemorySize MemoryStack::ourReserveSize = 0;
 
 
 	// MemoryStack ////////////////////////////////////////////////////////////
@@ -47,8 +55,14 @@ namespace shh {
 		myAllocatorBlocks(ourDefaultAllocatorBlocks),
 		myIsDeleteableMemory(false),
 		myMemory(NULL),
-		myMinSize(0)
+		myMinSize(0),
+		myDefragFrame(0),
+		myPackFrame(0),
+		myReservedMemory(NULL),
+		myReserved(0),
+		myCommitted(0)
 	{
+		MemoryManager::AddStack(this);
 	}
 
 
@@ -63,9 +77,15 @@ namespace shh {
 		myAllocatorBlocks(allocatorBlocks == 0 ? ourDefaultAllocatorBlocks : allocatorBlocks),
 		myIsDeleteableMemory(false),
 		myMemory(NULL),
-		myMinSize(size)
+		myMinSize(size),
+		myDefragFrame(0),
+		myPackFrame(0),
+		myReservedMemory(NULL),
+		myReserved(0),
+		myCommitted(0)
 	{
 		Resize(size);
+		MemoryManager::AddStack(this);
 	}
 
 
@@ -110,6 +130,7 @@ namespace shh {
 	// --------------------------------------------------------------------------
 	MemoryStack::~MemoryStack()
 	{
+		MemoryManager::RemoveStack(this);
 		Clean();
 	}
 
@@ -150,7 +171,8 @@ namespace shh {
 
 	// --------------------------------------------------------------------------						
 	// Function:	New
-	// Description:	allocate memory for stack
+	// Description:	allocate memory for stack, reserving ourReserveSize of 
+	//				address space if set so stack can later grow in place
 	// Arguments:	memory size
 	// Returns:		none
 	// --------------------------------------------------------------------------
@@ -161,6 +183,24 @@ namespace shh {
 			MemorySize aligned = ((size / ourGrowRate) * ourGrowRate);
 			size = (aligned < size) ? aligned + ourGrowRate : aligned;
 		}
+
+		if (ourReserveSize > 0 && size + sizeof(MemoryStack*) <= ourReserveSize)
+		{
+			myMemory = Reserve(ourReserveSize);
+			if (myMemory != NULL)
+			{
+				if (Commit(size + sizeof(MemoryStack*)))
+				{
+					MemoryStack** header = (MemoryStack**)myMemory;
+					*header = this;
+					return myMemory + sizeof(MemoryStack*);
+				}
+				Unreserve(myMemory, myReserved);
+				myReservedMemory = NULL;
+				myReserved = 0;
+			}
+		}
+
 		Allocator* allocator = MemoryManager::GetManager().GetAllocator(size + sizeof(MemoryStack*), myAllocatorBlocks);
 		myMemory = (char*)allocator->Allocate();
 		MemoryStack** header = (MemoryStack**)myMemory;
@@ -182,10 +222,122 @@ namespace shh {
 			return;
 
 		char* memory = oldBase - sizeof(MemoryStack*);
+		if (memory == myReservedMemory)
+		{
+			Unreserve(myReservedMemory, myReserved);
+			myReservedMemory = NULL;
+			myReserved = 0;
+			myCommitted = 0;
+			return;
+		}
 		Allocator::Deallocate(memory);
 	}
 
 
+	// --------------------------------------------------------------------------						
+	// Function:	Reserve
+	// Description:	reserve address space for stack without committing it
+	// Arguments:	size to reserve
+	// Returns:		reserved memory or NULL if failed
+	// --------------------------------------------------------------------------
+	char* MemoryStack::Reserve(MemorySize size)
+	{
+		MemorySize pageSize = GetPageSize();
+		size = ((size + pageSize - 1) / pageSize) * pageSize;
+#ifdef _WIN64
+		void* memory = VirtualAlloc(NULL, size, MEM_RESERVE, PAGE_NOACCESS);
+		if (memory == NULL)
+			return NULL;
+#else
+		void* memory = mmap(NULL, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+		if (memory == MAP_FAILED)
+			return NULL;
+#endif
+		myReservedMemory = (char*)memory;
+		myReserved = size;
+		myCommitted = 0;
+		return myReservedMemory;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Commit
+	// Description:	commit pages of reserved memory to cover size, pages
+	//				above it are decommitted
+	// Arguments:	size from start of reserved memory
+	// Returns:		if successful
+	// --------------------------------------------------------------------------
+	bool MemoryStack::Commit(MemorySize size)
+	{
+		MemorySize pageSize = GetPageSize();
+		size = ((size + pageSize - 1) / pageSize) * pageSize;
+		if (size > myReserved)
+			return false;
+
+		if (size > myCommitted)
+		{
+#ifdef _WIN64
+			if (VirtualAlloc(myReservedMemory + myCommitted, size - myCommitted, MEM_COMMIT, PAGE_READWRITE) == NULL)
+				return false;
+#else
+			if (mprotect(myReservedMemory + myCommitted, size - myCommitted, PROT_READ | PROT_WRITE) != 0)
+				return false;
+#endif
+		}
+		else if (size < myCommitted)
+		{
+#ifdef _WIN64
+			VirtualFree(myReservedMemory + size, myCommitted - size, MEM_DECOMMIT);
+#else
+			madvise(myReservedMemory + size, myCommitted - size, MADV_DONTNEED);
+			mprotect(myReservedMemory + size, myCommitted - size, PROT_NONE);
+#endif
+		}
+		myCommitted = size;
+		return true;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Unreserve
+	// Description:	release reserved address space
+	// Arguments:	reserved memory, size reserved
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void MemoryStack::Unreserve(char* memory, MemorySize size)
+	{
+#ifdef _WIN64
+		VirtualFree(memory, 0, MEM_RELEASE);
+#else
+		munmap(memory, size);
+#endif
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	GetPageSize
+	// Description:	get size of virtual memory page
+	// Arguments:	none
+	// Returns:		page size
+	// --------------------------------------------------------------------------
+	MemorySize MemoryStack::GetPageSize()
+	{
+#ifdef _WIN64
+		static MemorySize pageSize = 0;
+		if (pageSize == 0)
+		{
+			SYSTEM_INFO info;
+			GetSystemInfo(&info);
+			pageSize = info.dwPageSize;
+		}
+		return pageSize;
+#else
+		static MemorySize pageSize = (MemorySize)sysconf(_SC_PAGESIZE);
+		return pageSize;
+#endif
+	}
+
+
 	// --------------------------------------------------------------------------						
 	// Function:	Grow
 	// Description:	grow memory stack size
@@ -259,6 +411,24 @@ namespace shh {
 			size = myTop - myBase + 1;
 			return size;
 		}
+
+		if (myReservedMemory != NULL && myBase != 0 && Commit(size + sizeof(MemoryStack*)))
+		{
+			// grow or shrink in place within reserved memory, nothing moves
+			char* oldEnd = myEnd;
+			myEnd = myBase + size - 1;
+			if (myEnd > oldEnd)
+				memset(oldEnd + 1, 0, myEnd - oldEnd);
+			return size;
+		}
+
+		// moving out of reserved memory so release it after copying
+		char* reserved = myReservedMemory;
+		MemorySize reservedSize = myReserved;
+		myReservedMemory = NULL;
+		myReserved = 0;
+		myCommitted = 0;
+
 		char* oldBase = myBase;
 		char* newBase = New(size);
 		memset(newBase, 0, size);
@@ -270,7 +440,10 @@ namespace shh {
 		{
 			MemorySize dataSize = myTop - myBase + 1;
 			memcpy(newBase, myBase, dataSize);
-			Delete(oldBase);
+			if (reserved != NULL)
+				Unreserve(reserved, reservedSize);
+			else
+				Delete(oldBase);
 		}
 		myIsDeleteableMemory = true;
 
@@ -446,11 +619,32 @@ namespace shh {
 	// --------------------------------------------------------------------------
 	void MemoryStack::Defrag()
 	{
+		myDefragFrame = 0;
 		for (int s = 0; s != myStack.size(); s++)
 			myStack[s]->Defrag();
 	}
 
 
+	// --------------------------------------------------------------------------						
+	// Function:	Defrag
+	// Description:	defragment frames within budget, resuming from where 
+	//				last call stopped
+	// Arguments:	bytes that may be processed (decremented by bytes used)
+	// Returns:		true if pass over all frames completed
+	// --------------------------------------------------------------------------
+	bool MemoryStack::Defrag(MemorySize& budget)
+	{
+		while (myDefragFrame < myStack.size())
+		{
+			if (!myStack[myDefragFrame]->Defrag(budget))
+				return false;
+			myDefragFrame++;
+		}
+		myDefragFrame = 0;
+		return true;
+	}
+
+
 	// --------------------------------------------------------------------------						
 	// Function:	Pack
 	// Description:	defrag and trim free space in all frames, then remove
@@ -460,6 +654,7 @@ namespace shh {
 	// --------------------------------------------------------------------------
 	void MemoryStack::Pack()
 	{
+		myPackFrame = 0;
 		for (int s =(int) myStack.size() - 1; s >= 0; s--)
 		{
 			myStack[s]->Defrag();
@@ -469,6 +664,30 @@ namespace shh {
 	}
 
 
+	// --------------------------------------------------------------------------						
+	// Function:	Pack
+	// Description:	defrag and trim frames from the top within budget, 
+	//				resuming from where last call stopped, then remove free
+	//				space at end of memory when all frames are done
+	// Arguments:	bytes that may be processed (decremented by bytes used)
+	// Returns:		true if pass over all frames completed
+	// --------------------------------------------------------------------------
+	bool MemoryStack::Pack(MemorySize& budget)
+	{
+		while (myPackFrame < myStack.size())
+		{
+			MemoryFrame* frame = myStack[myStack.size() - 1 - myPackFrame];
+			if (!frame->Defrag(budget))
+				return false;
+			frame->Trim();
+			myPackFrame++;
+		}
+		myPackFrame = 0;
+		Shrink();
+		return true;
+	}
+
+
 	// --------------------------------------------------------------------------						
 	// Function:	AddFrame
 	// Description:	creates new frame at end
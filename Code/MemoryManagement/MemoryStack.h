@@ -56,6 +56,7 @@ namespace shh {
 		};
 
 		static unsigned int ourGrowRate;
+		static MemorySize ourReserveSize;
 		int myShrinkLimit;
 		MemorySize myMinSize;
 		unsigned int myAllocatorBlocks;
@@ -76,7 +77,9 @@ namespace shh {
 		bool Shrink(bool trimAll = false);
 		void ShiftAbove(MemoryFrame* f);
 		void Defrag();
+		bool Defrag(MemorySize& budget);
 		void Pack();
+		bool Pack(MemorySize& budget);
 
 
 		MemoryFrame* AddFrame();
@@ -97,11 +100,20 @@ namespace shh {
 	private:
 
 		Stack myStack;
+		unsigned int myDefragFrame;
+		unsigned int myPackFrame;
+		char* myReservedMemory;
+		MemorySize myReserved;
+		MemorySize myCommitted;
 		std::vector< GCPtr<MoveCallbackInterface> > myMemoryMovedCallbacks;
 
 
 		char* New(MemorySize size);
 		void Delete(char* oldBase);
+		char* Reserve(MemorySize size);
+		bool Commit(MemorySize size);
+		static void Unreserve(char* memory, MemorySize size);
+		static MemorySize GetPageSize();
 
 		MemorySize Resize(MemorySize size);
 		virtual void Register(MemoryFrame& f);
@@ -70,6 +70,8 @@ namespace shh {
 			Api::RegisterFunction("DestroyWorld", DestroyWorld, 2, me);
 			Api::RegisterFunction("EnterWorld", EnterWorld, 2, me);
 			Api::RegisterFunction("ExitWorld", ExitWorld, 1, me);
+			Api::RegisterFunction("Checkpoint", Checkpoint, 5, me);
+			Api::RegisterFunction("Restore", Restore, 3, me);
 			Api::RegisterFunction("SetGlobal", SetGlobalStr, 3, me);
 			Api::RegisterFunction("SetGlobal", SetGlobalNum, 3, me);
 		}
@@ -167,6 +169,41 @@ namespace shh {
 	}
 
 
+	//! /namespace Environment
+	//! /function Checkpoint
+	//! /privilege God
+	//! /param string file_name
+	//! /param boolean incremental
+	//! /param boolean background
+	//! /param string callback_function_name
+	//! /returns boolean
+	//! Requests a checkpoint of god and all worlds be saved at the end of this update. 
+	//! A background checkpoint is written by a forked copy so updates carry on (blocks
+	//! on Windows). Callback is sent (ok, file_name) when saved. Returns bool if requested.
+	ExecutionState EnvironmentModule::Checkpoint(std::string& file, bool& incremental, bool& background, std::string& callback, bool& result)
+	{
+		result = God::GetGod()->RequestCheckpoint(file, incremental, background, Scheduler::GetCurrentProcess(), callback);
+		return ExecutionOk;
+	}
+
+
+	//! /namespace Environment
+	//! /function Restore
+	//! /privilege God
+	//! /param string file_name
+	//! /param string callback_function_name
+	//! /returns boolean
+	//! Requests a checkpoint and its increments be restored at the end of this update,
+	//! once any background checkpoint has been written. Worlds must have been booted from
+	//! the same config as when saved. Callback is sent (ok, file_name) when restored. 
+	//! Returns bool if requested.
+	ExecutionState EnvironmentModule::Restore(std::string& file, std::string& callback, bool& result)
+	{
+		result = God::GetGod()->RequestRestore(file, Scheduler::GetCurrentProcess(), callback);
+		return ExecutionOk;
+	}
+
+
 	//! /namespace Environment
 	//! /function GetLocal
 	//! /param string variable_name
@@ -44,6 +44,8 @@ namespace shh {
 		static ExecutionState DestroyWorld(std::string& worldName, bool& result);
 		static ExecutionState EnterWorld(std::string& worldName, bool& result);
 		static ExecutionState ExitWorld();
+		static ExecutionState Checkpoint(std::string& file, bool& incremental, bool& background, std::string& callback, bool& result);
+		static ExecutionState Restore(std::string& file, std::string& callback, bool& result);
 
 
 		static ExecutionState GetLocalStr(std::string& key, std::string& defaultValue, std::string& value);
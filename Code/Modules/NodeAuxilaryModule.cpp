@@ -63,6 +63,8 @@ namespace shh {
 		Api::RegisterMemberFunction(example, "CreateEdge", CreateEdge, 5, me);
 		Api::RegisterMemberFunction(example, "ReadInput", ReadInput, 4, me);
 		Api::RegisterMemberFunction(example, "WriteOutput", WriteOutput, 5, me);
+		Api::RegisterMemberFunction(example, "ReadInputs", ReadInputs, 3, me);
+		Api::RegisterMemberFunction(example, "WriteOutputs", WriteOutputs, 4, me);
 		
 		return Module::Register(alias, sd, privileges);
 	}
@@ -285,7 +287,7 @@ namespace shh {
 		caller.DynamicCast(object);
 		if (caller.IsValid())
 		{
-			if (caller == node)
+			if (caller == node || caller->IsBatchedWith(node))
 				node->ReadInput(id, index, result);
 		}
 		return ExecutionOk;
@@ -305,11 +307,82 @@ namespace shh {
 		caller.DynamicCast(object);
 		if (caller.IsValid())
 		{
-			if (caller == node)
+			if (caller == node || caller->IsBatchedWith(node))
 				node->WriteOutput(id, index, value);
 		}
 		return ExecutionOk;
 	}
 
-}
 
+
+	//! /member Node
+	//! /function ReadInputs
+	//! /param string input_interface_id
+	//! /return table_of_doubles
+	//! Returns all the variable values in the input interface of the given name as an array.
+	//! May be called on any Node updated in the same shhUpdateBatch as the caller.
+	ExecutionState NodeAuxilaryModule::ReadInputs(GCPtr<Node>& node, std::string& id, VariantKeyDictionary& result)
+	{
+		GCPtr<Object> object = Scheduler::GetCurrentProcess()->GetObject();
+		GCPtr<Node> caller;
+		caller.DynamicCast(object);
+		if (caller.IsValid())
+		{
+			if (caller == node || caller->IsBatchedWith(node))
+			{
+				Node::Interface::const_iterator it = node->GetInputs().find(id);
+				if (it != node->GetInputs().end())
+				{
+					for (unsigned int i = 0; i != it->second.size(); i++)
+						result.Set(NonVariant<int>((int)i + 1), it->second[i]);
+				}
+			}
+		}
+		return ExecutionOk;
+	}
+
+
+	//! /member Node
+	//! /function WriteOutputs
+	//! /param string output_interface_id
+	//! /param table_of_doubles values
+	//! Writes an array of variable values to the output interface of the given name.
+	//! May be called on any Node updated in the same shhUpdateBatch as the caller.
+	ExecutionState NodeAuxilaryModule::WriteOutputs(GCPtr<Node>& node, std::string& id, VariantKeyDictionary& values)
+	{
+		GCPtr<Object> object = Scheduler::GetCurrentProcess()->GetObject();
+		GCPtr<Node> caller;
+		caller.DynamicCast(object);
+		if (caller.IsValid())
+		{
+			if (caller == node || caller->IsBatchedWith(node))
+			{
+				Node::Interface::iterator it = node->GetOutputs().find(id);
+				if (it != node->GetOutputs().end())
+				{
+					for (VariantKeyDictionary::VariablesConstIterator vit = values.Begin(); vit != values.End(); vit++)
+					{
+						// script numbers may arrive as floats or integers
+						double d;
+						long long n;
+						unsigned int index = 0;
+						if (vit->first->Get(d))
+							index = (unsigned int)d;
+						else if (vit->first->Get(n))
+							index = (unsigned int)n;
+
+						if (index == 0 || index > it->second.size())
+							continue;
+
+						if (vit->second->Get(d))
+							it->second[index - 1] = d;
+						else if (vit->second->Get(n))
+							it->second[index - 1] = (double)n;
+					}
+				}
+			}
+		}
+		return ExecutionOk;
+	}
+
+}
\ No newline at end of file
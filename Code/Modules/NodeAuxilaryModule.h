@@ -51,6 +51,8 @@ namespace shh {
 		static ExecutionState CreateEdge(GCPtr<Node>& node, std::string &sourceId, std::string& inputId, std::string& outputId, bool& result);
 		static ExecutionState ReadInput(GCPtr<Node>& node, std::string& id, unsigned int& index, double& result);
 		static ExecutionState WriteOutput(GCPtr<Node>& node, std::string& id, unsigned int& index, double& value);
+		static ExecutionState ReadInputs(GCPtr<Node>& node, std::string& id, VariantKeyDictionary& result);
+		static ExecutionState WriteOutputs(GCPtr<Node>& node, std::string& id, VariantKeyDictionary& values);
 
 
 	};
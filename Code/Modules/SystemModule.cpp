@@ -65,6 +65,9 @@ namespace shh {
 		Api::RegisterFunction("GetDirectoryContents", GetDirectoryContents, 4, me);
 		Api::RegisterFunction("GetLabeledPath", GetLabeledPath, 2, me);
 
+		if (privileges & GodPrivilege)
+			Api::RegisterFunction("DumpMemoryProfile", DumpMemoryProfile, 2, me);
+
 		if (!(privileges & GodPrivilege))
 			Api::RegisterFunction("SetLabeledPath", SetLabeledPath, 3, me);
 
@@ -200,4 +203,20 @@ namespace shh {
 		FileSystem::SetVariable(label, fullPath);
 		return ExecutionOk;
 	}
+
+
+	//! /namespace System
+	//! /function DumpMemoryProfile
+	//! /privilege God
+	//! /param string filename
+	//! /returns bool
+	//! Writes live memory by type, allocator, arena, lua process and realm 
+	//! with sampled allocation stacks as json, if profiling is enabled in 
+	//! the memory config. Labeled paths in filename are expanded.
+	ExecutionState SystemModule::DumpMemoryProfile(std::string& filename, bool& ok)
+	{
+		std::string fullPath;
+		ok = FileSystem::Resolve(filename, fullPath) && Api::DumpMemoryProfile(fullPath);
+		return ExecutionOk;
+	}
 }
\ No newline at end of file
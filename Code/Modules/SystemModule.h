@@ -50,6 +50,7 @@ namespace shh {
 		static ExecutionState GetDirectoryContents(std::string &directory, std::string &wildcard, unsigned int &flags, VariantKeyDictionary &contents);
 		static ExecutionState GetLabeledPath(std::string &label, std::string &fullPath);
 		static ExecutionState SetLabeledPath(std::string& label, std::string& fullPath);
+		static ExecutionState DumpMemoryProfile(std::string& filename, bool& ok);
 
 	};
 
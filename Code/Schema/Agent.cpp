@@ -214,6 +214,46 @@ namespace shh {
 		return mySlaveProcesses.empty(); 
 	}
 
-}
 
+	// --------------------------------------------------------------------------						
+	// Function:	TraceReferences
+	// Description:	reports vm, object and schema references to the cycle collector
+	// Arguments:	tracer
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void Agent::TraceReferences(GCTracer& tracer) const
+	{
+		VM::TraceReferences(tracer);
+		Object::TraceReferences(tracer);
+		Schema::TraceReferences(tracer);
+	}
 
+
+	// --------------------------------------------------------------------------						
+	// Function:	Write
+	// Description:	serialization out of processes, schema tree and collections
+	// Arguments:	io stream interface, version to log as
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void Agent::Write(IOInterface& io, int version) const
+	{
+		VM::Write(io, version);
+		WriteSchema(io, version);
+		Whole::Write(io, version);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Read
+	// Description:	serialization in of processes, schema tree and collections
+	// Arguments:	io stream interface, version to log as
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void Agent::Read(IOInterface& io, int version)
+	{
+		VM::Read(io, version);
+		ReadSchema(io, version);
+		Whole::Read(io, version);
+	}
+
+}
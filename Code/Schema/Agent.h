@@ -70,6 +70,10 @@ namespace shh {
 		virtual void PushSelf(Implementation i);
 
 		virtual bool CanFinalize() const;
+		virtual void TraceReferences(GCTracer& tracer) const;
+
+		virtual void Write(IOInterface& io, int version) const;
+		virtual void Read(IOInterface& io, int version);
 	
 
 		static GCPtr<Agent> GetActiveAgent();
@@ -22,6 +22,8 @@
 // such a license from the copyright holder.
 ///////////////////////////////////////////////////////////////////////////////
 
+#include "../Common/Debug.h"
+#include "../File/IOInterface.h"
 #include "Collection.h"
 
 
@@ -85,4 +87,87 @@ namespace shh {
 		return *this;
 	}
 
+
+	// --------------------------------------------------------------------------						
+	// Function:	Write
+	// Description:	serialization out of part ids and names, sub collections
+	//				are written whole
+	// Arguments:	io stream interface, version to log as
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void Collection::Write(IOInterface& io, int version) const
+	{
+		SERIALIZE_OUT(io, myNextId);
+
+		unsigned int parts = (unsigned int)myPartIds.size();
+		SERIALIZE_OUT(io, parts);
+		for (ConstIdIterator it = myPartIds.begin(); it != myPartIds.end(); it++)
+		{
+			const Collection* collection = dynamic_cast<const Collection*>(it->second.myObject.GetObject());
+			bool isCollection = collection != NULL;
+			SERIALIZE_OUT(io, it->second.myId);
+			SERIALIZE_OUT(io, it->second.myName);
+			SERIALIZE_OUT(io, isCollection);
+			if (isCollection)
+				collection->Write(io, version);
+		}
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Read
+	// Description:	serialization in, parts are matched by id and name as 
+	//				objects can not be recreated, parts not written are 
+	//				removed (not destroyed) and missing sub collections are 
+	//				recreated
+	// Arguments:	io stream interface, version to log as
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void Collection::Read(IOInterface& io, int version)
+	{
+		unsigned int nextId;
+		unsigned int parts;
+		SERIALIZE_IN(io, nextId);
+		SERIALIZE_IN(io, parts);
+
+		PartIdMap partIds;
+		for (unsigned int p = 0; p != parts; p++)
+		{
+			Part part;
+			bool isCollection;
+			SERIALIZE_IN(io, part.myId);
+			SERIALIZE_IN(io, part.myName);
+			SERIALIZE_IN(io, isCollection);
+
+			IdIterator it = myPartIds.find(part.myId);
+			if (it != myPartIds.end() && it->second.myName == part.myName)
+				part.myObject = it->second.myObject;
+
+			if (isCollection)
+			{
+				GCPtr<Collection> collection;
+				collection.DynamicCast(part.myObject);
+				if (!collection.IsValid())
+				{
+					collection = GCPtr<Collection>(new Collection);
+					part.myObject = collection;
+				}
+				collection->Read(io, version);
+			}
+			else if (!part.myObject.IsValid())
+			{
+				DEBUG_TRACE("\nCheckpoint part %s of collection no longer exists.\n", part.myName.c_str());
+				continue;
+			}
+
+			partIds[part.myId] = part;
+		}
+
+		myPartIds.swap(partIds);
+		myPartNames.clear();
+		for (IdIterator it = myPartIds.begin(); it != myPartIds.end(); it++)
+			myPartNames[it->second.myName] = it->first;
+		myNextId = nextId;
+	}
+
 }
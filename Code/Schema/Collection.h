@@ -32,6 +32,8 @@
 
 namespace shh {
 
+	class IOInterface;
+
 	class Collection : public GCObject
 	{
 	public:
@@ -75,6 +77,9 @@ namespace shh {
 		inline IdIterator End();
 		inline ConstIdIterator End() const;
 
+		void Write(IOInterface& io, int version) const;
+		void Read(IOInterface& io, int version);
+
 	
 	private:
 
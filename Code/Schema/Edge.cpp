@@ -29,7 +29,7 @@
 
 namespace shh
 {
-	IMPLEMENT_MEMORY_MANAGED(Edge);
+	IMPLEMENT_COMPACT_MEMORY_MANAGED(Edge);
 
 	// --------------------------------------------------------------------------						
 	// Function:	Edge
@@ -86,4 +86,18 @@ namespace shh
 		}
 		return true;
 	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	TraceReferences
+	// Description:	reports destination node to the cycle collector, source is
+	//				weak
+	// Arguments:	tracer
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void Edge::TraceReferences(GCTracer& tracer) const
+	{
+		tracer.Trace(myDestination);
+	}
+
 }
\ No newline at end of file
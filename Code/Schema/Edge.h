@@ -37,7 +37,7 @@ namespace shh
 
 	class Edge : public GCObject
 	{
-		DECLARE_MEMORY_MANAGED(Edge);
+		DECLARE_COMPACT_MEMORY_MANAGED(Edge);
 /*
 	public: 
 		inline void* operator new(const size_t bytes) { GCPtr<Edge>::ourMemoryManaged = true; Edge* p = (Edge*)ourAllocator->Allocate(); MemoryLocator::MemoryDestructor<Edge>::Add(p); 
@@ -64,12 +64,13 @@ namespace shh
 
 		Edge(const GCPtr<Node>& source, const GCPtr<Node>& destination, const std::string &sourceId, const std::string &inputId, const std::string& outputId);
 		bool Update();
+		virtual void TraceReferences(GCTracer& tracer) const;
 
 
 	protected:
 
 		
-		GCPtr<Node> mySource;
+		WeakGCPtr<Node> mySource;
 		GCPtr<Node> myDestination;
 		std::string mySourceId;
 		std::string myInputId;
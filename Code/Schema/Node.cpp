@@ -23,6 +23,9 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 #include "../VM/SoftProcess.h"
+#include "../VM/Scheduler.h"
+#include "../Common/Exception.h"
+#include "../File/IOInterface.h"
 #include "Node.h"
 
 namespace shh
@@ -97,8 +100,8 @@ namespace shh
 	// --------------------------------------------------------------------------
 	bool Node::Configure(const StringKeyDictionary& config) 
 	{ 
-		StringKeyDictionary inputs;
-		inputs = config.Get("inputs", inputs);
+		StringKeyDictionary noInputs;
+		const StringKeyDictionary& inputs = *config.GetConstPtr("inputs", &noInputs);
 		for (StringKeyDictionary::VariablesConstIterator it = inputs.Begin(); it != inputs.End(); it++)
 		{
 			long size;
@@ -113,8 +116,8 @@ namespace shh
 			}
 		}
 
-		StringKeyDictionary outputs;
-		outputs = config.Get("outputs", outputs);
+		StringKeyDictionary noOutputs;
+		const StringKeyDictionary& outputs = *config.GetConstPtr("outputs", &noOutputs);
 		for (StringKeyDictionary::VariablesConstIterator it = outputs.Begin(); it != outputs.End(); it++)
 		{
 			long size;
@@ -130,8 +133,8 @@ namespace shh
 		}
 
 
-		ArrayKeyDictionary edges;
-		edges = config.Get("edges", edges);
+		ArrayKeyDictionary noEdges;
+		const ArrayKeyDictionary& edges = *config.GetConstPtr("edges", &noEdges);
 		for (ArrayKeyDictionary::VariablesConstIterator it = edges.Begin(); it != edges.End(); it++)
 		{
 			StringKeyDictionary edge;
@@ -349,11 +352,34 @@ namespace shh
 			}
 		}
 		myEdgeSpecs.clear();
+
+		if (!myKernel.IsValid())
+			myKernel = NodeKernel::Attach(myProcess->GetScheduler(), GCPtr<Node>(this));
 		
 		return Object::PostInitialization();
 	}
 
 
+	// --------------------------------------------------------------------------						
+	// Function:	Finalize
+	// Description:	detaches node from its kernel before finalizing it
+	// Arguments:	pointer to this
+	// Returns:		if finalized
+	// --------------------------------------------------------------------------
+	bool Node::Finalize(GCObject* me)
+	{
+		if (!myFinalized && myKernel.IsValid())
+		{
+			GCPtr<Scheduler> scheduler;
+			if (myProcess.IsValid())
+				scheduler = myProcess->GetScheduler();
+			NodeKernel::Detach(scheduler, myKernel, GCPtr<Node>(this));
+			myKernel.SetNull();
+		}
+		return Object::Finalize(me);
+	}
+
+
 	// --------------------------------------------------------------------------						
 	// Function:	Update
 	// Description:	updates the node, clear interfaces and updates edges
@@ -364,48 +390,177 @@ namespace shh
 	{
 		if (myProcess->GetState() == ExecutionReady)
 		{
-			for (Interface::iterator it = myOutputs.begin(); it != myOutputs.end(); it++)
+			ClearOutputs();
+			GatherInputs();
+			return Object::Update(until, phase);
+		}
+		return false;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	IsBatchUpdated
+	// Description:	flags whether this node is updated by a c++ kernel of its
+	//				class rather than by its process
+	// Arguments:	none
+	// Returns:		flag
+	// --------------------------------------------------------------------------
+	bool Node::IsBatchUpdated() const
+	{
+		return myKernel.IsValid();
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	IsBatchedWith
+	// Description:	returns if this node and another are updated by the same 
+	//				kernel, in which case a batch update run in either may access 
+	//				the others interfaces
+	// Arguments:	other node
+	// Returns:		flag
+	// --------------------------------------------------------------------------
+	bool Node::IsBatchedWith(const GCPtr<Node>& other) const
+	{
+		return myKernel.IsValid() && other.IsValid() && other->myKernel == myKernel;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	ClearOutputs
+	// Description:	zeros the output interfaces
+	// Arguments:	none
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void Node::ClearOutputs()
+	{
+		for (Interface::iterator it = myOutputs.begin(); it != myOutputs.end(); it++)
+		{
+			for (int i = 0; i != it->second.size(); i++)
+				it->second[i] = 0.0;
+		}
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	GatherInputs
+	// Description:	clears the input interfaces and fills them with the average
+	//				of the outputs of the source nodes of the edges
+	// Arguments:	none
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void Node::GatherInputs()
+	{
+		if (myEdges.size() > 0)
+		{
+			for (Interface::iterator it = myInputs.begin(); it != myInputs.end(); it++)
 			{
 				for (int i = 0; i != it->second.size(); i++)
 					it->second[i] = 0.0;
 			}
-
-			if (myEdges.size() > 0)
+			for (Counters::iterator cit = myCounters.begin(); cit != myCounters.end(); cit++)
 			{
-				for (Interface::iterator it = myInputs.begin(); it != myInputs.end(); it++)
-				{
-					for (int i = 0; i != it->second.size(); i++)
-						it->second[i] = 0.0;
-				}
-				for (Counters::iterator cit = myCounters.begin(); cit != myCounters.end(); cit++)
-				{
-					for (int i = 0; i != cit->second.size(); i++)
-						cit->second[i] = 0;
-				}
+				for (int i = 0; i != cit->second.size(); i++)
+					cit->second[i] = 0;
+			}
 
-				Edges::iterator it = myEdges.end();
-				it--;
-				for (unsigned int e = (unsigned int)myEdges.size(); e > 0; e--)
-				{
-					Edges::iterator next = it;
-					if(next != myEdges.begin())
-						next--;
-					if (!(*it)->Update())
-						myEdges.erase(it);
-					if (it != myEdges.begin())
-						it--;
-				}
+			Edges::iterator it = myEdges.end();
+			it--;
+			for (unsigned int e = (unsigned int)myEdges.size(); e > 0; e--)
+			{
+				Edges::iterator next = it;
+				if(next != myEdges.begin())
+					next--;
+				if (!(*it)->Update())
+					myEdges.erase(it);
+				if (it != myEdges.begin())
+					it--;
+			}
 
 
-				Counters::iterator cit = myCounters.begin();
-				for (Interface::iterator it = myInputs.begin(); it != myInputs.end(); it++, cit++)
-				{
-					for (int i = 0; i != it->second.size(); i++)
-						it->second[i] /= cit->second[i];
-				}
+			Counters::iterator cit = myCounters.begin();
+			for (Interface::iterator it = myInputs.begin(); it != myInputs.end(); it++, cit++)
+			{
+				for (int i = 0; i != it->second.size(); i++)
+					it->second[i] /= cit->second[i];
 			}
-			return Object::Update(until, phase);
 		}
-		return false;
 	}
-}
\ No newline at end of file
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	TraceReferences
+	// Description:	reports object and schema references, edges and kernel to the
+	//				cycle collector
+	// Arguments:	tracer
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void Node::TraceReferences(GCTracer& tracer) const
+	{
+		Object::TraceReferences(tracer);
+		Schema::TraceReferences(tracer);
+		tracer.TraceAll(myEdges);
+		tracer.Trace(myKernel);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	MatchesInterface
+	// Description:	tests if two interfaces have same ids and buffer sizes
+	// Arguments:	interfaces to compare
+	// Returns:		if match
+	// --------------------------------------------------------------------------
+	template<class I> static bool MatchesInterface(const I& a, const I& b)
+	{
+		if (a.size() != b.size())
+			return false;
+
+		typename I::const_iterator bit = b.begin();
+		for (typename I::const_iterator ait = a.begin(); ait != a.end(); ait++, bit++)
+			if (ait->first != bit->first || ait->second.size() != bit->second.size())
+				return false;
+
+		return true;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	WriteSchema
+	// Description:	serialization out of interface buffers and counters
+	// Arguments:	io stream interface, version to log as
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void Node::WriteSchema(IOInterface& io, int version) const
+	{
+		SERIALIZE_OUT(io, myInputs);
+		SERIALIZE_OUT(io, myOutputs);
+		SERIALIZE_OUT(io, myCounters);
+		Schema::WriteSchema(io, version);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	ReadSchema
+	// Description:	serialization in of interface buffers and counters, 
+	//				interfaces must match those written
+	// Arguments:	io stream interface, version to log as
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void Node::ReadSchema(IOInterface& io, int version)
+	{
+		Interface inputs;
+		Interface outputs;
+		Counters counters;
+		SERIALIZE_IN(io, inputs);
+		SERIALIZE_IN(io, outputs);
+		SERIALIZE_IN(io, counters);
+
+		if (!MatchesInterface(inputs, myInputs) || !MatchesInterface(outputs, myOutputs) || !MatchesInterface(counters, myCounters))
+			Exception::Throw("Checkpoint interfaces of node %s do not match", myName.c_str());
+
+		myInputs.swap(inputs);
+		myOutputs.swap(outputs);
+		myCounters.swap(counters);
+		Schema::ReadSchema(io, version);
+	}
+
+}
@@ -30,6 +30,7 @@
 #include "../VM/Object.h"
 #include "Edge.h"
 #include "Schema.h"
+#include "NodeKernel.h"
 #include <vector>
 #include <map>
 #include <string>
@@ -67,10 +68,17 @@ namespace shh
 		bool ReadInput(const std::string& id, unsigned int index, double& value);
 		bool WriteOutput(const std::string& id, unsigned int index, double value);
 		bool CreateEdge(const std::string &sourceId, const std::string& inputId, const std::string& outputId);
+		void ClearOutputs();
+		void GatherInputs();
+		bool IsBatchedWith(const GCPtr<Node>& other) const;
+		inline Interface& GetInputs();
+		inline Interface& GetOutputs();
 
 		virtual bool Initialize(const GCPtr<GCObject>& owner, const std::string& id, const StringKeyDictionary& sd);
 		virtual bool PostInitialization();
 		virtual bool Update(double until, unsigned int phase);
+		virtual bool IsBatchUpdated() const;
+		virtual void TraceReferences(GCTracer& tracer) const;
 
 
 
@@ -83,8 +91,38 @@ namespace shh
 		Interface myInputs;
 		Interface myOutputs;
 		Counters myCounters;
+		GCPtr<NodeKernel> myKernel;
+
+		virtual bool Finalize(GCObject* me);
+		virtual void WriteSchema(IOInterface& io, int version) const;
+		virtual void ReadSchema(IOInterface& io, int version);
 		
 	};
+
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	GetInputs
+	// Description:	gets the input interface buffers
+	// Arguments:	none
+	// Returns:		inputs
+	// --------------------------------------------------------------------------
+	inline Node::Interface& Node::GetInputs()
+	{
+		return myInputs;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	GetOutputs
+	// Description:	gets the output interface buffers
+	// Arguments:	none
+	// Returns:		outputs
+	// --------------------------------------------------------------------------
+	inline Node::Interface& Node::GetOutputs()
+	{
+		return myOutputs;
+	}
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,352 @@
+///////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2025 David K Bhowmik. All rights reserved.
+// This file is part of shhArc.
+//
+// This Software is available under the MIT License with a No Modification clause.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this file and associated documentation files (the "Software"), to use the
+// Software for any purpose, including commercial applications, provided that:
+//
+//   1. You do NOT modify, alter, or create derivative works of this file.
+//   2. Redistributions must include this notice and may only distribute it 
+//      unmodified.
+//
+// The full MIT License text, including this Custom No Modification clause,
+// is available in the LICENSE file in the root of the project.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND.
+//
+// You may alternatively use this source under the terms of a specific 
+// version of the shhArc Unrestricted License provided you have obtained 
+// such a license from the copyright holder.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "../VM/Scheduler.h"
+#include "../VM/Class.h"
+#include "../VM/VM.h"
+#include "../VM/SoftProcess.h"
+#include "NodeKernel.h"
+#include "Node.h"
+
+namespace shh
+{
+	NodeKernel::Functions NodeKernel::ourFunctions;
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Register
+	// Description:	registers a c++ function to update all nodes of a given 
+	//				class directly on their interface buffers
+	// Arguments:	class name, kernel function
+	// Returns:		if registered (false if class already has a kernel)
+	// --------------------------------------------------------------------------
+	bool NodeKernel::Register(const std::string& className, Function function)
+	{
+		if (function == NULL || ourFunctions.find(className) != ourFunctions.end())
+			return false;
+
+		ourFunctions[className] = function;
+		return true;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	GetFunction
+	// Description:	gets kernel function registered for a class
+	// Arguments:	class name
+	// Returns:		function or NULL if class has no kernel
+	// --------------------------------------------------------------------------
+	NodeKernel::Function NodeKernel::GetFunction(const std::string& className)
+	{
+		Functions::const_iterator it = ourFunctions.find(className);
+		if (it == ourFunctions.end())
+			return NULL;
+		return it->second;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Attach
+	// Description:	adds a node to the kernel of its class, creating the kernel 
+	//				updater if need be. classes with a c++ kernel share one per 
+	//				scheduler, soft classes with a batch update function share 
+	//				one per vm as script can only see nodes in its own vm
+	// Arguments:	scheduler, node
+	// Returns:		kernel or null if nodes class is not batch updated
+	// --------------------------------------------------------------------------
+	GCPtr<NodeKernel> NodeKernel::Attach(const GCPtr<Scheduler>& scheduler, const GCPtr<Node>& node)
+	{
+		GCPtr<NodeKernel> kernel;
+		const GCPtr<Class>& nodeClass = node->GetClass();
+		std::string name = "shhNodeKernel_" + nodeClass->GetName();
+		Function function = GetFunction(nodeClass->GetName());
+		if (function == NULL)
+		{
+			if (nodeClass->GetImplementation() == Engine || !nodeClass->HasFunction(SoftProcess::ourUpdateBatchMessage))
+				return kernel;
+			name += "_" + std::to_string(node->GetProcess()->GetVM()->GetId());
+		}
+
+		GCPtr<Module> updater;
+		if (scheduler->GetBatchUpdater(name, updater))
+		{
+			kernel.DynamicCast(updater);
+		}
+		else
+		{
+			kernel = GCPtr<NodeKernel>(new NodeKernel(name, nodeClass, function));
+			updater.DynamicCast(kernel);
+			if (!scheduler->AddBatchUpdater(name, updater))
+			{
+				kernel.Destroy();
+				kernel.SetNull();
+			}
+		}
+
+		if (kernel.IsValid())
+			kernel->AddNode(node);
+
+		return kernel;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Detach
+	// Description:	removes a node from its kernel, removing the kernel updater
+	//				from the scheduler once it has no nodes left
+	// Arguments:	scheduler, kernel, node
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void NodeKernel::Detach(const GCPtr<Scheduler>& scheduler, const GCPtr<NodeKernel>& kernel, const GCPtr<Node>& node)
+	{
+		if (!kernel.IsValid())
+			return;
+
+		kernel->RemoveNode(node);
+		for (Nodes::iterator it = kernel->myNodes.begin(); it != kernel->myNodes.end(); it++)
+		{
+			if (it->IsValid())
+				return;
+		}
+
+		kernel->myNodes.clear();
+		if (scheduler.IsValid())
+		{
+			GCPtr<Module> updater;
+			updater.DynamicCast(kernel);
+			scheduler->RemoveUpdater(updater);
+		}
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	NodeKernel
+	// Description:	constructor
+	// Arguments:	name of updater, class of nodes updated, kernel function 
+	//				(NULL if class uses its soft batch update function)
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	NodeKernel::NodeKernel(const std::string& name, const GCPtr<Class>& nodeClass, Function function) :
+		myName(name),
+		myFunction(function)
+	{
+		myPriority = 0;
+		mySubPriority = 0;
+		myImplementation = myFunction != NULL ? Engine : nodeClass->GetImplementation();
+		myUpdateMessage.myDeletable = false;
+		myUpdateMessage.myFunctionName = SoftProcess::ourUpdateBatchMessage;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	~NodeKernel
+	// Description:	destructor
+	// Arguments:	none
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	NodeKernel::~NodeKernel()
+	{
+		myUpdateMessage.DeleteArguments();
+		myNodes.clear();
+		myBatch.clear();
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	AddNode
+	// Description:	adds a node to be updated by this kernel
+	// Arguments:	node
+	// Returns:		if added
+	// --------------------------------------------------------------------------
+	bool NodeKernel::AddNode(const GCPtr<Node>& node)
+	{
+		for (Nodes::iterator it = myNodes.begin(); it != myNodes.end(); it++)
+		{
+			if (it->GetObject() == node.GetObject())
+				return false;
+		}
+
+		myNodes.push_back(node);
+		return true;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	RemoveNode
+	// Description:	removes a node from being updated by this kernel
+	// Arguments:	node
+	// Returns:		if removed
+	// --------------------------------------------------------------------------
+	bool NodeKernel::RemoveNode(const GCPtr<Node>& node)
+	{
+		for (Nodes::iterator it = myNodes.begin(); it != myNodes.end(); it++)
+		{
+			if (it->GetObject() == node.GetObject())
+			{
+				myNodes.erase(it);
+				return true;
+			}
+		}
+		return false;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	GetNextMessage
+	// Description:	c++ kernels are run here once per scheduler update and never
+	//				generate messages, soft kernels return the batch update 
+	//				message to be sent to the process of the first node
+	// Arguments:	until time, phase of update, message returned
+	// Returns:		if got a message
+	// --------------------------------------------------------------------------
+	bool NodeKernel::GetNextMessage(double until, unsigned int phase, Message*& msg)
+	{
+		msg = NULL;
+		if (myFunction != NULL)
+		{
+			if (until > myUpdateUntilTime)
+			{
+				myRequiresUpdate = true;
+				if (Update(until, phase))
+					FlagUpdateCompleted();
+			}
+			myRequiresUpdate = false;
+			return false;
+		}
+
+		const GCPtr<Messenger>& to = myUpdateMessage.myTo;
+		if (to.IsValid() && to->GetState() == ExecutionBusy && to->GetCurrentMessage() == &myUpdateMessage)
+		{
+			myRequiresUpdate = false;
+			msg = &myUpdateMessage;
+			return true;
+		}
+
+		if (until > myUpdateUntilTime)
+		{
+			GCPtr<Process> leader = GetLeader();
+			if (leader.IsValid() && leader->GetVM()->IsInitialized() && leader->GetState() == ExecutionReady)
+			{
+				myUpdateMessage.myTo = leader;
+				myRequiresUpdate = true;
+				msg = &myUpdateMessage;
+				return true;
+			}
+		}
+		myRequiresUpdate = false;
+		return false;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Update
+	// Description:	gathers the inputs of all nodes whose process is ready from
+	//				their edges then calls the kernel function once for the 
+	//				whole batch, or for soft kernels sets the batch update 
+	//				message arguments to the delta and a table of the nodes
+	// Arguments:	time to update until, phase of update
+	// Returns:		if successful
+	// --------------------------------------------------------------------------
+	bool NodeKernel::Update(double until, unsigned int phase)
+	{
+		if (!Module::Update(until, phase))
+			return false;
+
+		myBatch.clear();
+		Nodes::iterator it = myNodes.begin();
+		while (it != myNodes.end())
+		{
+			if (it->IsValid())
+			{
+				if ((*it)->GetProcess()->GetState() == ExecutionReady)
+				{
+					(*it)->GatherInputs();
+					myBatch.push_back(it->GetObject());
+
+					const GCPtr<VM>& vm = (*it)->GetProcess()->GetVM();
+					if (vm.IsValid())
+						vm->SetDirty();
+				}
+				it++;
+			}
+			else
+			{
+				it = myNodes.erase(it);
+			}
+		}
+
+		// outputs are only cleared once all inputs have been gathered so
+		// edges between nodes in the batch read last updates outputs
+		for (unsigned int n = 0; n != myBatch.size(); n++)
+			myBatch[n]->ClearOutputs();
+
+		if (myFunction != NULL)
+		{
+			if (!myBatch.empty())
+				myFunction(myBatch, myDelta);
+		}
+		else
+		{
+			VariantKeyDictionary* nodes = new VariantKeyDictionary();
+			for (unsigned int n = 0; n != myBatch.size(); n++)
+				nodes->Set(NonVariant<int>((int)n + 1), GCPtr<Node>(myBatch[n]));
+
+			myUpdateMessage.DeleteArguments();
+			myUpdateMessage.AddArgument(new double(myDelta));
+			myUpdateMessage.AddArgument(nodes);
+		}
+
+		return true;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	GetName
+	// Description:	gets name of module
+	// Arguments:	none
+	// Returns:		name
+	// --------------------------------------------------------------------------
+	std::string NodeKernel::GetName() const
+	{
+		return myName;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	GetLeader
+	// Description:	gets the process of the first valid node which is the 
+	//				process soft batch updates are run in
+	// Arguments:	none
+	// Returns:		process or null if no nodes
+	// --------------------------------------------------------------------------
+	GCPtr<Process> NodeKernel::GetLeader()
+	{
+		for (unsigned int n = 0; n != myNodes.size(); n++)
+		{
+			if (myNodes[n].IsValid())
+				return myNodes[n]->GetProcess();
+		}
+		return GCPtr<Process>();
+	}
+}
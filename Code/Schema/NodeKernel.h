@@ -0,0 +1,82 @@
+///////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2025 David K Bhowmik. All rights reserved.
+// This file is part of shhArc.
+//
+// This Software is available under the MIT License with a No Modification clause.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this file and associated documentation files (the "Software"), to use the
+// Software for any purpose, including commercial applications, provided that:
+//
+//   1. You do NOT modify, alter, or create derivative works of this file.
+//   2. Redistributions must include this notice and may only distribute it 
+//      unmodified.
+//
+// The full MIT License text, including this Custom No Modification clause,
+// is available in the LICENSE file in the root of the project.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND.
+//
+// You may alternatively use this source under the terms of a specific 
+// version of the shhArc Unrestricted License provided you have obtained 
+// such a license from the copyright holder.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef NODEKERNEL_H
+#define NODEKERNEL_H
+
+#include "../Common/SecureStl.h"
+#include "../Config/GCPtr.h"
+#include "../Arc/Module.h"
+#include "../VM/Message.h"
+#include <vector>
+#include <map>
+#include <string>
+
+namespace shh
+{
+	class Node;
+	class Class;
+	class Process;
+	class Scheduler;
+
+	class NodeKernel : public Module
+	{
+	public:
+
+		typedef std::vector<Node*> Batch;
+		typedef void (*Function)(const Batch& batch, double delta);
+
+		static bool Register(const std::string& className, Function function);
+		static Function GetFunction(const std::string& className);
+		static GCPtr<NodeKernel> Attach(const GCPtr<Scheduler>& scheduler, const GCPtr<Node>& node);
+		static void Detach(const GCPtr<Scheduler>& scheduler, const GCPtr<NodeKernel>& kernel, const GCPtr<Node>& node);
+
+		NodeKernel(const std::string& name, const GCPtr<Class>& nodeClass, Function function);
+		virtual ~NodeKernel();
+
+		bool AddNode(const GCPtr<Node>& node);
+		bool RemoveNode(const GCPtr<Node>& node);
+
+		virtual bool GetNextMessage(double until, unsigned int phase, Message*& msg);
+		virtual bool Update(double until, unsigned int phase);
+		virtual std::string GetName() const;
+
+	protected:
+
+		GCPtr<Process> GetLeader();
+
+		typedef std::map<std::string, Function> Functions;
+		typedef std::vector<WeakGCPtr<Node>> Nodes;
+
+		static Functions ourFunctions;
+
+		std::string myName;
+		Function myFunction;
+		Nodes myNodes;
+		Batch myBatch;
+		Message myUpdateMessage;
+	};
+}
+
+#endif
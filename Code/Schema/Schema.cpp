@@ -23,11 +23,13 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 #include "../Common/Debug.h"
+#include "../Common/Exception.h"
+#include "../File/IOInterface.h"
 #include "../VM/ClassManager.h"
 #include "../VM/Scheduler.h"
 #include "../VM/SoftProcess.h"
 #include "../File/FileSystem.h"
-#include "../File/JsonFile.h"
+#include "../File/CompiledFile.h"
 #include "Schema.h"
 #include "Agent.h"
 
@@ -40,7 +42,9 @@ namespace shh
 
 	// --------------------------------------------------------------------------						
 	// Function:	LoadSchema
-	// Description:	loads schema from a file definition
+	// Description:	loads schema from a file definition, files are mapped and
+	//				read in place with only parameters and configurations of 
+	//				each schema read into dictionaries
 	// Arguments:	environment schema belongs to, parent schema, file name,
 	//				name of meta schema file
 	// Returns:		if sucessfull
@@ -50,22 +54,20 @@ namespace shh
 		std::string folder;
 		FileSystem::GetVariable("SCHEMA", folder);
 		std::string fullPath = folder + "/" + file + "." + ourSchemaFileExtension;
-		StringKeyDictionary spec;
-		BinaryFile schemaIn(fullPath, IOInterface::In);
-		if (!JsonFile::Read(schemaIn, spec))
+		CompiledFile spec;
+		if (!spec.Open(fullPath))
 			return false;
 
 		FileSystem::GetVariable("META", folder);
 		std::string metaPath = folder + "/" + metaFile + "." + Class::ourMetaFileExtension;
-		StringKeyDictionary meta;
-		BinaryFile metaIn(metaPath, IOInterface::In);
-		if (!JsonFile::Read(metaIn, meta))
+		CompiledFile meta;
+		if (!meta.Open(metaPath))
 			return false;
 
-		if (!ValidateSchema(env, spec, meta))
+		if (!ValidateSchema(env, spec.GetRoot(), meta.GetRoot()))
 			return false;
 
-		return ExpressSchema(env, parent, spec);
+		return ExpressSchema(env, parent, spec.GetRoot());
 	}
 
 
@@ -76,20 +78,21 @@ namespace shh
 	//				meta schema
 	// Returns:		if sucessfull
 	// --------------------------------------------------------------------------
-	bool Schema::ValidateSchema(const GCPtr<Environment>& env, const StringKeyDictionary& spec, const StringKeyDictionary& meta)
+	bool Schema::ValidateSchema(const GCPtr<Environment>& env, const CompiledDictionary& spec, const CompiledDictionary& meta)
 	{
-		ArrayKeyDictionary schemas;
-		schemas = spec.Get("schemas", schemas);
+		CompiledDictionary schemas = spec.Get("schemas", CompiledDictionary());
+		if (!schemas.IsArray())
+			schemas = CompiledDictionary();
 
 		typedef std::map<std::string, int> Counters;
 		typedef std::map<std::string, Counters> Types;
 
 		Types types;
 
-		for (ArrayKeyDictionary::VariablesConstIterator sit = schemas.Begin(); sit != schemas.End(); sit++)
+		for (const CompiledDictionary::Entry* sit = schemas.Begin(); sit != schemas.End(); sit++)
 		{
-			StringKeyDictionary schemaDef;
-			if (sit->second->Get(schemaDef))
+			CompiledDictionary schemaDef;
+			if (schemas.GetValue(*sit, schemaDef) && !schemaDef.IsArray())
 			{
 				std::string typeName;
 				typeName = schemaDef.Get("type", typeName);
@@ -115,21 +118,24 @@ namespace shh
 		}
 
 
-		StringKeyDictionary metaSchemas;
-		metaSchemas = meta.Get("schemas", metaSchemas);
+		CompiledDictionary metaSchemas = meta.Get("schemas", CompiledDictionary());
+		if (metaSchemas.IsArray())
+			metaSchemas = CompiledDictionary();
 
-		for (StringKeyDictionary::VariablesConstIterator mit = metaSchemas.Begin(); mit != metaSchemas.End(); mit++)
+		for (const CompiledDictionary::Entry* mit = metaSchemas.Begin(); mit != metaSchemas.End(); mit++)
 		{
-			std::string typeName = *mit->first;
-			StringKeyDictionary classes;
-			if (!mit->second->Get(classes))
+			std::string typeName;
+			metaSchemas.GetKey(*mit, typeName);
+			CompiledDictionary classes;
+			if (!metaSchemas.GetValue(*mit, classes) || classes.IsArray())
 				return false;	// error in meta file
 			
-			for (StringKeyDictionary::VariablesConstIterator cit = classes.Begin(); cit != classes.End(); cit++)
+			for (const CompiledDictionary::Entry* cit = classes.Begin(); cit != classes.End(); cit++)
 			{
-				std::string className = *cit->first;
-				StringKeyDictionary classConstraint;
-				if (!cit->second->Get(classConstraint))
+				std::string className;
+				classes.GetKey(*cit, className);
+				CompiledDictionary classConstraint;
+				if (!classes.GetValue(*cit, classConstraint) || classConstraint.IsArray())
 					return false; 	// error in meta file
 
 				long min = classConstraint.Get("min", (long) -1);
@@ -163,25 +169,29 @@ namespace shh
 			return false;	// unwanted subSchemas in schema
 
 
-		StringKeyDictionary params;
-		params = spec.Get("parameters", params);
-		StringKeyDictionary metaParams;
-		metaParams = meta.Get("parameters", metaParams);
+		CompiledDictionary params = spec.Get("parameters", CompiledDictionary());
+		if (params.IsArray())
+			params = CompiledDictionary();
+		CompiledDictionary metaParams = meta.Get("parameters", CompiledDictionary());
+		if (metaParams.IsArray())
+			metaParams = CompiledDictionary();
 
-		for (StringKeyDictionary::VariablesConstIterator pit = metaParams.Begin(); pit != metaParams.End(); pit++)
+		for (const CompiledDictionary::Entry* pit = metaParams.Begin(); pit != metaParams.End(); pit++)
 		{
-			std::string paramName = *pit->first;
-			StringKeyDictionary paramConstraint;
-			if (!pit->second->Get(paramConstraint))
+			std::string paramName;
+			metaParams.GetKey(*pit, paramName);
+			CompiledDictionary paramConstraint;
+			if (!metaParams.GetValue(*pit, paramConstraint) || paramConstraint.IsArray())
 				return false; 	// error in meta file
 
-			if (!params.Exists(paramName))
+			const CompiledDictionary::Entry* param = params.Find(paramName);
+			if (param == NULL)
 				return false; // parameter not present
 
-			std::string type = paramConstraint.Get("type", "");
+			std::string type = paramConstraint.Get("type", std::string());
 			if (type == "float")
 			{
-				if (!params.IsType<double>(paramName))
+				if (param->myType != CompiledDictionary::RealType)
 					return false;
 
 				double min = paramConstraint.Get("min", (double)0.0);
@@ -193,7 +203,7 @@ namespace shh
 			}
 			else if (type == "integer")
 			{
-				if (!params.IsType<long>(paramName))
+				if (param->myType != CompiledDictionary::IntegerType)
 					return false;
 
 				long min = paramConstraint.Get("min", (long)0);
@@ -205,27 +215,27 @@ namespace shh
 			}
 			else if (type == "boolean")
 			{
-				if (!params.IsType<bool>(paramName))
+				if (param->myType != CompiledDictionary::BoolType)
 					return false;
 			}
 			else if (type == "string")
 			{
-				if (!params.IsType<std::string>(paramName))
+				if (param->myType != CompiledDictionary::StringType)
 					return false;
 			}
 			else if (type == "object")
 			{
-				if (!params.IsType<StringKeyDictionary>(paramName))
+				if (param->myType != CompiledDictionary::ObjectType)
 					return false;
 			}
 			else if (type == "array")
 			{
-				if (!params.IsType<ArrayKeyDictionary>(paramName))
+				if (param->myType != CompiledDictionary::ArrayType)
 					return false;
 			}
 			else if (type == "null")
 			{
-				if (!params.IsType<Variant::NullType>(paramName))
+				if (param->myType != CompiledDictionary::NullType)
 					return false;
 			}
 			else
@@ -235,10 +245,10 @@ namespace shh
 					
 		}
 
-		for (ArrayKeyDictionary::VariablesConstIterator sit = schemas.Begin(); sit != schemas.End(); sit++)
+		for (const CompiledDictionary::Entry* sit = schemas.Begin(); sit != schemas.End(); sit++)
 		{
-			StringKeyDictionary schemaDef;
-			if (sit->second->Get(schemaDef))
+			CompiledDictionary schemaDef;
+			if (schemas.GetValue(*sit, schemaDef) && !schemaDef.IsArray())
 			{
 				std::string typeName;
 				typeName = schemaDef.Get("type", typeName);
@@ -254,7 +264,7 @@ namespace shh
 				if (!cls.IsValid())
 					return false;
 
-				const StringKeyDictionary& metaDef = cls->GetMeta();
+				const CompiledDictionary& metaDef = cls->GetMeta();
 
 				if (!ValidateSchema(env, schemaDef, metaDef))
 					return false;
@@ -271,14 +281,16 @@ namespace shh
 	//				definition dictionary
 	// Returns:		if sucessfull
 	// --------------------------------------------------------------------------
-	bool Schema::ExpressSchema(const GCPtr<Environment>&env, const GCPtr<Schema>&parent, const StringKeyDictionary &spec)
+	bool Schema::ExpressSchema(const GCPtr<Environment>&env, const GCPtr<Schema>&parent, const CompiledDictionary &spec)
 	{
-		ArrayKeyDictionary schemas;
-		schemas = spec.Get("schemas", schemas);
-		for (ArrayKeyDictionary::VariablesConstIterator sit = schemas.Begin(); sit != schemas.End(); sit++)
+		CompiledDictionary schemas = spec.Get("schemas", CompiledDictionary());
+		if (!schemas.IsArray())
+			schemas = CompiledDictionary();
+
+		for (const CompiledDictionary::Entry* sit = schemas.Begin(); sit != schemas.End(); sit++)
 		{
-			StringKeyDictionary schemaDef;
-			if (sit->second->Get(schemaDef))
+			CompiledDictionary schemaDef;
+			if (schemas.GetValue(*sit, schemaDef) && !schemaDef.IsArray())
 			{
 				std::string typeName;
 				typeName = schemaDef.Get("type", typeName);
@@ -300,12 +312,11 @@ namespace shh
 	//				type name, class name of the schema, schema config specification
 	// Returns:		created schema
 	// --------------------------------------------------------------------------
-	GCPtr<Object> Schema::Create(const GCPtr<Environment>& env, const GCPtr<Schema>& parent, const std::string& typeName, const std::string& className, const StringKeyDictionary& spec)
+	GCPtr<Object> Schema::Create(const GCPtr<Environment>& env, const GCPtr<Schema>& parent, const std::string& typeName, const std::string& className, const CompiledDictionary& spec)
 	{
 		bool ok = true;
 
-		StringKeyDictionary stringParameters;
-		stringParameters = spec.Get("parameters", stringParameters);
+		StringKeyDictionary stringParameters = spec.Get("parameters", StringKeyDictionary());
 		
 
 	
@@ -345,14 +356,13 @@ namespace shh
 						parent->AddSchema(schema);
 					}
 					
-					schema->myName = spec.Get("name", "__NONAME");
-					schema->myType = spec.Get("type", "__NOTYPE");
+					schema->myName = spec.Get("name", std::string("__NONAME"));
+					schema->myType = spec.Get("type", std::string("__NOTYPE"));
 					ourTypeCodes.Add(schema->myType);
 					schema->myTypeCode = GetTypeCode(schema->myType);
 
 					// configure schema interfaces and edges
-					StringKeyDictionary config;
-					config = spec.Get("configuration", config);
+					StringKeyDictionary config = spec.Get("configuration", StringKeyDictionary());
 					ok = schema->Configure(config);
 
 					object->Initialize(env->GetScheduler(), className, stringParameters);
@@ -364,12 +374,14 @@ namespace shh
 					if (ok)
 					{
 						// build sub schemas
-						ArrayKeyDictionary schemas;
-						schemas = spec.Get("schemas", schemas);
-						for (ArrayKeyDictionary::VariablesConstIterator sit = schemas.Begin(); sit != schemas.End(); sit++)
+						CompiledDictionary schemas = spec.Get("schemas", CompiledDictionary());
+						if (!schemas.IsArray())
+							schemas = CompiledDictionary();
+
+						for (const CompiledDictionary::Entry* sit = schemas.Begin(); sit != schemas.End(); sit++)
 						{
-							StringKeyDictionary schemaDef;
-							if (sit->second->Get(schemaDef))
+							CompiledDictionary schemaDef;
+							if (schemas.GetValue(*sit, schemaDef) && !schemaDef.IsArray())
 							{
 								std::string typeName;
 								typeName = schemaDef.Get("type", typeName);
@@ -487,9 +499,9 @@ namespace shh
 	// Arguments:	none
 	// Returns:		parent schema
 	// --------------------------------------------------------------------------
-	const GCPtr<Schema>& Schema::GetParent() const 
+	GCPtr<Schema> Schema::GetParent() const 
 	{ 
-		return myParent; 
+		return myParent.Lock(); 
 	}
 
 
@@ -633,4 +645,83 @@ namespace shh
 	{ 
 		return myExpressed; 
 	}
-}
\ No newline at end of file
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	TraceReferences
+	// Description:	reports sub schemas to the cycle collector, parent is weak
+	// Arguments:	tracer
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void Schema::TraceReferences(GCTracer& tracer) const
+	{
+		tracer.TraceAll(mySchemas);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	WriteSchema
+	// Description:	serialization out of schema tree, sub agents are not 
+	//				written as they are written as vms by their scheduler
+	// Arguments:	io stream interface, version to log as
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void Schema::WriteSchema(IOInterface& io, int version) const
+	{
+		SERIALIZE_OUT(io, myName);
+		SERIALIZE_OUT(io, myType);
+
+		unsigned int schemas = (unsigned int)mySchemas.size();
+		SERIALIZE_OUT(io, schemas);
+		for (unsigned int s = 0; s != schemas; s++)
+		{
+			bool isVM = dynamic_cast<const VM*>(mySchemas[s].GetObject()) != NULL;
+			SERIALIZE_OUT(io, isVM);
+			if (!isVM)
+				mySchemas[s]->WriteSchema(io, version);
+		}
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	ReadSchema
+	// Description:	serialization in of schema tree, tree must match the one
+	//				written, sub schemas of a schema recreated by a restore
+	//				are not rebuilt so it must have had none
+	// Arguments:	io stream interface, version to log as
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void Schema::ReadSchema(IOInterface& io, int version)
+	{
+		std::string name;
+		std::string type;
+		SERIALIZE_IN(io, name);
+		SERIALIZE_IN(io, type);
+
+		// a schema recreated by a restore has not been expressed so takes 
+		// the name and type it was written with
+		if (!myExpressed && mySchemas.empty())
+		{
+			myName = name;
+			myType = type;
+		}
+		else if (name != myName || type != myType)
+			Exception::Throw("Checkpoint schema %s of type %s does not match %s of type %s", name.c_str(), type.c_str(), myName.c_str(), myType.c_str());
+
+		unsigned int schemas;
+		SERIALIZE_IN(io, schemas);
+		if (schemas != mySchemas.size())
+			Exception::Throw("Checkpoint schema %s has %u sub schemas not %u", myName.c_str(), schemas, (unsigned int)mySchemas.size());
+
+		for (unsigned int s = 0; s != schemas; s++)
+		{
+			bool isVM;
+			SERIALIZE_IN(io, isVM);
+			if (isVM != (dynamic_cast<VM*>(mySchemas[s].GetObject()) != NULL))
+				Exception::Throw("Checkpoint schema %s sub schema %u does not match", myName.c_str(), s);
+			if (!isVM)
+				mySchemas[s]->ReadSchema(io, version);
+		}
+	}
+
+}
@@ -37,6 +37,8 @@
 
 namespace shh
 {
+	class IOInterface;
+	class CompiledDictionary;
 	class Schema : public virtual GCObject
 	{
 	public:
@@ -46,13 +48,13 @@ namespace shh
 		class NullType {};
 
 		static bool LoadSchema(const GCPtr<Environment>& env, const GCPtr<Schema>& parent, const std::string& file, const std::string& metaFile);
-		static bool ValidateSchema(const GCPtr<Environment>& env, const StringKeyDictionary& spec, const StringKeyDictionary& meta);
-		static bool ExpressSchema(const GCPtr<Environment>& env, const GCPtr<Schema>& parent, const StringKeyDictionary& spec);
-		static GCPtr<Object> Create(const GCPtr<Environment>& env, const GCPtr<Schema>& parent, const std::string& typeName, const std::string& className, const StringKeyDictionary& spec);
+		static bool ValidateSchema(const GCPtr<Environment>& env, const CompiledDictionary& spec, const CompiledDictionary& meta);
+		static bool ExpressSchema(const GCPtr<Environment>& env, const GCPtr<Schema>& parent, const CompiledDictionary& spec);
+		static GCPtr<Object> Create(const GCPtr<Environment>& env, const GCPtr<Schema>& parent, const std::string& typeName, const std::string& className, const CompiledDictionary& spec);
 
 		virtual bool RequiresConfiguration() const;
 		virtual bool Configure(const StringKeyDictionary& conf);
-		const GCPtr<Schema>& GetParent() const;
+		GCPtr<Schema> GetParent() const;
 		const Schemas& GetSchemas() const;
 		Schemas GetSubSchemas(const std::string& type) const;
 		void AddSchema(const GCPtr<Schema>& s);
@@ -64,6 +66,7 @@ namespace shh
 		unsigned int GetTypeCode() const;
 		static unsigned int GetTypeCode(const std::string& type);
 		bool IsExpressed() const;
+		virtual void TraceReferences(GCTracer& tracer) const;
 
 		static const std::string ourSchemaFileExtension;
 
@@ -73,7 +76,7 @@ namespace shh
 		std::string myType;
 		std::string myName;
 		unsigned int myTypeCode;
-		GCPtr<Schema> myParent;
+		WeakGCPtr<Schema> myParent;
 		Schemas mySchemas;
 		bool myExpressed;
 
@@ -81,6 +84,9 @@ namespace shh
 
 		Schema();
 		virtual ~Schema();
+
+		virtual void WriteSchema(IOInterface& io, int version) const;
+		virtual void ReadSchema(IOInterface& io, int version);
 		
 
 	};
@@ -314,4 +314,28 @@ namespace shh {
 		return NULL;
 	}
 
-}
\ No newline at end of file
+
+	// --------------------------------------------------------------------------						
+	// Function:	Write
+	// Description:	serialization out of collections
+	// Arguments:	io stream interface, version to log as
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void Whole::Write(IOInterface& io, int version) const
+	{
+		myCollections.Write(io, version);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Read
+	// Description:	serialization in of collections
+	// Arguments:	io stream interface, version to log as
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void Whole::Read(IOInterface& io, int version)
+	{
+		myCollections.Read(io, version);
+	}
+
+}
@@ -54,6 +54,9 @@ namespace shh {
 		void DestroyPart(unsigned int& collectionId, unsigned int& partId);
 	
 		static Whole*GetActiveWhole();
+
+		void Write(IOInterface& io, int version) const;
+		void Read(IOInterface& io, int version);
 		
 	private:
 
@@ -28,12 +28,14 @@
 
 #include "../File/FileSystem.h"
 #include "../File/TextFile.h"
-#include "../File/JsonFile.h"
+#include "../File/CompiledFile.h"
 #include "../Common/Exception.h"
 #include "Class.h"
 #include "Object.h"
 #include "ClassManager.h"
 #include "SoftProcess.h"
+#include "Scheduler.h"
+#include "VM.h"
 #include <algorithm>
 
 
@@ -54,9 +56,11 @@ namespace shh {
 		myClassifiers(other->myClassifiers),
 		myProcessConstructor(other->myProcessConstructor),
 		myObjectConstructor(other->myObjectConstructor),
-		myMeta(other->myMeta)
+		myMetaFile(other->myMetaFile)
 	{
 		myProcess = myProcessConstructor(Privileges(), other->myProcess);
+		if (!myMetaFile.empty())
+			myMeta.Open(myMetaFile);
 	}
 
 
@@ -113,12 +117,9 @@ namespace shh {
 			sp->SetVM(GCPtr<VM>());
 		}
 
-		std::string metaFile = mySpec.myPath + "/" + mySpec.myFilename.substr(0, mySpec.myFilename.rfind("."))+"."+ ourMetaFileExtension;
-		if (FileSystem::IsValidFile(metaFile))
-		{
-			BinaryFile pathIn(metaFile, IOInterface::In);
-			JsonFile::Read(pathIn, myMeta);
-		}
+		// meta is kept mapped and read in place when schemas are validated
+		myMetaFile = mySpec.myPath + "/" + mySpec.myFilename.substr(0, mySpec.myFilename.rfind("."))+"."+ ourMetaFileExtension;
+		myMeta.Open(myMetaFile);
 	}
 
 	
@@ -253,13 +254,27 @@ namespace shh {
 
 	// --------------------------------------------------------------------------						
 	// Function:	GetMeta
-	// Description:	returns meta dictionary of class 
+	// Description:	returns view of meta dictionary of class, invalid and
+	//				empty if class has no meta file
 	// Arguments:	none
 	// Returns:		dictionary
 	// --------------------------------------------------------------------------
-	const StringKeyDictionary& Class::GetMeta() const
+	const CompiledDictionary& Class::GetMeta() const
+	{
+		return myMeta.GetRoot();
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	IsLightweight
+	// Description:	returns if objects of class are hosted in the process of
+	//				the agent creating them (meta "lightweight" : true)
+	// Arguments:	none
+	// Returns:		if lightweight
+	// --------------------------------------------------------------------------
+	bool Class::IsLightweight() const
 	{
-		return myMeta;
+		return myMeta.GetRoot().Get("lightweight", false);
 	}
 
 
@@ -335,7 +350,12 @@ namespace shh {
 	// --------------------------------------------------------------------------
 	GCPtr<Object> Class::CreateObject(const GCPtr<ClassManager>& manager)
 	{
-		GCPtr<Process> process = myProcess->Clone();
+		GCPtr<Process> process;
+		GCPtr<Process> current = Scheduler::GetCurrentProcess();
+		if (IsLightweight() && current.IsValid() && current->GetVM().IsValid())
+			process = myProcess->CloneHosted(current->GetVM()->GetMasterProcess());
+		else
+			process = myProcess->Clone();
 		GCPtr<Object> object(myObjectConstructor(manager, GCPtr<Class>(this), process));
 		return object;
 	}
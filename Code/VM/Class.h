@@ -31,6 +31,7 @@
 #include "../Arc/Registry.h"
 #include "../Common/Classifier.h"	
 #include "../Common/Enums.h"
+#include "../File/CompiledFile.h"
 #include "Object.h"
 #include <string>
 #include <list>
@@ -71,7 +72,8 @@ namespace shh {
 
 		bool HasFunction(const std::string& functionName) const;
 
-		const StringKeyDictionary& GetMeta() const;
+		const CompiledDictionary& GetMeta() const;
+		bool IsLightweight() const;
 
 		static const std::string ourMetaFileExtension;
 	
@@ -98,7 +100,8 @@ namespace shh {
 		Registry::ProcessConstructor myProcessConstructor;
 		Registry::ObjectConstructor myObjectConstructor;
 		ClassMap myDerived; 
-		StringKeyDictionary myMeta;
+		std::string myMetaFile;
+		CompiledFile myMeta;
 
 		
 
@@ -30,6 +30,8 @@
 #include "Messenger.h"
 #include "SoftProcess.h"
 #include "Scheduler.h"
+#include "VM.h"
+#include "../File/IOVariant.h"
 
 
 namespace shh
@@ -52,6 +54,11 @@ namespace shh
 		ExecutionState retVal = ExecutionFailed;
 		if (myTo.IsValid())
 		{
+			// recipient may change so must be in the next checkpoint
+			const GCPtr<VM>& vm = myTo->GetVM();
+			if (vm.IsValid())
+				vm->SetDirty();
+
 			if (myTo->GetCurrentMessage() == this)
 			{
 				// resume update
@@ -227,7 +234,7 @@ namespace shh
 		{
 			// asynchronous is queued
 			GCPtr<Messenger> tmp = myTo;
-			myTo = myFrom;
+			myTo = myFrom.Lock();
 			myFrom = tmp;
 			myCallType = Decoupled;
 			myFunctionName = myCallbackFunction;
@@ -261,5 +268,101 @@ namespace shh
 	}
 
 
+	// --------------------------------------------------------------------------						
+	// Function:	IsPersistable
+	// Description:	tests if message can be saved in a checkpoint, only 
+	//				messages waiting in a queue that are not part of a 
+	//				suspended call or a boot are
+	// Arguments:	none
+	// Returns:		bool
+	// --------------------------------------------------------------------------
+	bool Message::IsPersistable() const
+	{
+		if (myState != ExecutionScheduled || !myDeletable || myCancelled || !myTo.IsValid())
+			return false;
+
+		if (myCallbackMessage != NULL || myFunctionName == SoftProcess::ourBootMessage)
+			return false;
+
+		return myCallType == Decoupled || myCallType == Asynchronous || myCallType == TimerMsg;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Write
+	// Description:	serialization out, sender and receiver are written by
+	//				the scheduler as ids
+	// Arguments:	io stream interface, version to log as
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void Message::Write(IOInterface& io, int version) const
+	{
+		SERIALIZE_OUT(io, myId);
+		SERIALIZE_OUT(io, myFunctionName);
+		SERIALIZE_OUT(io, myPriority);
+		SERIALIZE_OUT(io, (int)myCallType);
+		SERIALIZE_OUT(io, myDestroyOnCompletion);
+		SERIALIZE_OUT(io, myCallbackFunction);
+		SERIALIZE_OUT(io, myRepeatTimer);
+		SERIALIZE_OUT(io, myScheduledTime);
+		SERIALIZE_OUT(io, myReceivedTime);
+
+		VariantKeyDictionary arguments;
+		for (unsigned int i = 0; i != myArguments.size(); i++)
+		{
+			NonVariant<unsigned int> key(i);
+			myArguments[i].myType->SetDictionary(&key, myArguments[i].myValue, &arguments);
+		}
+		IODictionary<Variant> ioArguments(arguments);
+		SERIALIZE_OUT(io, ioArguments);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Read
+	// Description:	serialization in, message is left built and scheduled
+	// Arguments:	io stream interface, version to log as
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void Message::Read(IOInterface& io, int version)
+	{
+		int callType;
+		SERIALIZE_IN(io, myId);
+		SERIALIZE_IN(io, myFunctionName);
+		SERIALIZE_IN(io, myPriority);
+		SERIALIZE_IN(io, callType);
+		SERIALIZE_IN(io, myDestroyOnCompletion);
+		SERIALIZE_IN(io, myCallbackFunction);
+		SERIALIZE_IN(io, myRepeatTimer);
+		SERIALIZE_IN(io, myScheduledTime);
+		SERIALIZE_IN(io, myReceivedTime);
+		myCallType = (CallType)callType;
+
+		if (myId > ourLastId)
+			ourLastId = myId;
+
+		VariantKeyDictionary arguments;
+		IODictionary<Variant> ioArguments(arguments);
+		SERIALIZE_IN(io, ioArguments);
+
+		DeleteArguments();
+		for (unsigned int i = 0; i != (unsigned int)arguments.Size(); i++)
+		{
+			Variant const* const value = arguments.Get(NonVariant<unsigned int>(i));
+			BaseType* type = value != NULL ? value->GetRegisteredType() : NULL;
+			if (type == NULL)
+				Exception::Throw("Message %s argument %d has no registered type", myFunctionName.c_str(), i);
+
+			Argument argument;
+			argument.myType = type;
+			argument.myValue = type->Clone((void*)value->GetValuePtr());
+			myArguments.push_back(argument);
+		}
+
+		myState = ExecutionScheduled;
+		myBuilt = true;
+		myCancelled = false;
+	}
+
 
 }
@@ -37,6 +37,7 @@ namespace shh {
 
 	class Node;
 	class BaseType;
+	class IOInterface;
 
 	class Message
 	{
@@ -106,9 +107,13 @@ namespace shh {
 		template<class T> inline void AddArgument(T* arg);
 		void DeleteArguments();
 
+		bool IsPersistable() const;
+		void Write(IOInterface& io, int version) const;
+		void Read(IOInterface& io, int version);
+
 		std::string myFunctionName;
 		GCPtr<Messenger> myTo;
-		GCPtr<Messenger> myFrom;
+		WeakGCPtr<Messenger> myFrom;
 		int myPriority;
 		ExecutionState myState;
 		bool myDestroyOnCompletion;
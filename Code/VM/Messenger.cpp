@@ -49,6 +49,7 @@ namespace shh
 		myId(++ourLastId), 
 		myCurrentMessage(NULL), 
 		myNumMessagesSentThisUpdate(0), 
+		myLastMessageTime(0.0),
 		myInitializing(false), 
 		myInitialized(false), 
 		myFinalizing(false), 
@@ -68,6 +68,7 @@ namespace shh {
 		inline Message* GetCurrentMessage() const;
 		inline shhId GetId() const;
 		inline unsigned int GetNumMessagesSentThisUpdate() const;
+		inline double GetLastMessageTime() const;
 		inline void IncMessagesSentThisUpdate();
 
 		virtual const GCPtr<VM> &GetVM() const = 0;
@@ -91,6 +92,7 @@ namespace shh {
 		shhId myId;
 		unsigned int myNumMessagesSentThisUpdate;
 		Message* myCurrentMessage;
+		double myLastMessageTime;
 
 		bool myInitializing;
 		bool myInitialized;
@@ -170,6 +172,19 @@ namespace shh {
 	}
 
 
+	// --------------------------------------------------------------------------						
+	// Function:	GetLastMessageTime
+	// Description:	returns scheduler time a message was last dispatched to 
+	//				this messenger
+	// Arguments:	none
+	// Returns:		time
+	// --------------------------------------------------------------------------
+	inline double Messenger::GetLastMessageTime() const
+	{
+		return myLastMessageTime;
+	}
+
+
 	// --------------------------------------------------------------------------						
 	// Function:	IncMessagesSentThisUpdate
 	// Description:	does what it says on the tin
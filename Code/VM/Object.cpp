@@ -285,6 +285,19 @@ namespace shh {
 	}
 
 
+	// --------------------------------------------------------------------------						
+	// Function:	IsBatchUpdated
+	// Description:	flags whether this object is updated by a batch updater of
+	//				its class rather than being an updater itself
+	// Arguments:	none
+	// Returns:		flag
+	// --------------------------------------------------------------------------
+	bool Object::IsBatchUpdated() const
+	{
+		return false;
+	}
+
+
 	// --------------------------------------------------------------------------						
 	// Function:	Update
 	// Description:	updates object 
@@ -301,5 +314,21 @@ namespace shh {
 		}
 		return false;
 	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	TraceReferences
+	// Description:	reports class, manager and process to the cycle collector
+	// Arguments:	tracer
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void Object::TraceReferences(GCTracer& tracer) const
+	{
+		Module::TraceReferences(tracer);
+		tracer.Trace(myClassManager);
+		tracer.Trace(myClass);
+		tracer.Trace(myProcess);
+	}
+
 }
 
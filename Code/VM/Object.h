@@ -73,6 +73,8 @@ namespace shh {
 		virtual bool PostInitialization();
 		virtual bool GetNextMessage(double until, unsigned int phase, Message*& msg);
 		virtual	bool Update(double until, unsigned int phase);
+		virtual bool IsBatchUpdated() const;
+		virtual void TraceReferences(GCTracer& tracer) const;
 
 		static void PushMessenger(Implementation i, const GCPtr<Messenger>& m);
 
@@ -28,6 +28,7 @@
 #include "../Arc/Environment.h"
 #include "Process.h"
 #include "VM.h"
+#include "Scheduler.h"
 #include "Object.h"
 
 
@@ -65,6 +66,20 @@ namespace shh {
 	}
 
 
+	// --------------------------------------------------------------------------						
+	// Function:	CloneHosted
+	// Description:	clones process to run inside the given host process sharing 
+	//				its resources (e.g. script heap), processes that do not 
+	//				support hosting return a normal clone
+	// Arguments:	process to host the clone
+	// Returns:		cloned process
+	// --------------------------------------------------------------------------
+	GCPtr<Process> Process::CloneHosted(const GCPtr<Process>& host)
+	{
+		return Clone();
+	}
+
+
 	// --------------------------------------------------------------------------						
 	// Function:	Process
 	// Description:	constructor
@@ -327,6 +342,78 @@ namespace shh {
 	void Process::SetVM(const GCPtr<VM>& vm)
 	{ 
 		myVM = vm; 
+
+		// idle time for hibernation counts from joining, not time 0
+		if (vm.IsValid() && vm->GetScheduler().IsValid())
+			myLastMessageTime = vm->GetScheduler()->GetCurrentUpdateTime();
 	}
-	
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	TraceReferences
+	// Description:	reports object, vm and environments to the cycle collector
+	// Arguments:	tracer
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void Process::TraceReferences(GCTracer& tracer) const
+	{
+		tracer.Trace(myObject);
+		tracer.Trace(myVM);
+		tracer.Trace(myEnvironment);
+		tracer.Trace(myHomeEnvironment);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Write
+	// Description:	serialization out, derived processes add their state
+	// Arguments:	io stream interface, version to log as
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void Process::Write(IOInterface& io, int version) const
+	{
+		SERIALIZE_OUT(io, (int)myPrivileges);
+		SERIALIZE_OUT(io, myYieldable);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Read
+	// Description:	serialization in
+	// Arguments:	io stream interface, version to log as
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void Process::Read(IOInterface& io, int version)
+	{
+		int privileges;
+		SERIALIZE_IN(io, privileges);
+		SERIALIZE_IN(io, myYieldable);
+		myPrivileges = (Privileges)privileges;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Hibernate
+	// Description:	frees state of an idle process until it is next used,
+	//				processes that cannot hibernate do nothing
+	// Arguments:	directory to store state in, "" to keep in memory
+	// Returns:		if hibernated
+	// --------------------------------------------------------------------------
+	bool Process::Hibernate(const std::string& path)
+	{
+		return false;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	IsHibernating
+	// Description:	returns if process is hibernating
+	// Arguments:	none
+	// Returns:		bool
+	// --------------------------------------------------------------------------
+	bool Process::IsHibernating() const
+	{
+		return false;
+	}
+
 }
@@ -40,6 +40,7 @@ namespace shh {
 
 	class Object;
 	class Environment;
+	class IOInterface;
 
 	class Process : public Messenger
 	{
@@ -59,6 +60,7 @@ namespace shh {
 		virtual ~Process();
 
 		virtual GCPtr<Process> Clone() = 0;
+		virtual GCPtr<Process> CloneHosted(const GCPtr<Process>& host);
 
 
 		virtual const GCPtr<VM> &GetVM() const;
@@ -80,6 +82,13 @@ namespace shh {
 		virtual bool CompleteInitialization();
 		virtual bool Terminate(const GCPtr<Messenger>& caller);
 		virtual bool CompleteFinalization();
+		virtual void TraceReferences(GCTracer& tracer) const;
+
+		virtual void Write(IOInterface& io, int version) const;
+		virtual void Read(IOInterface& io, int version);
+
+		virtual bool Hibernate(const std::string& path);
+		virtual bool IsHibernating() const;
 
 		inline Privileges GetPrivileges() const;
 		inline const GCPtr<Object>& GetObject() const;
@@ -34,7 +34,13 @@
 #include "VM.h"
 #include "Process.h"
 #include "SoftProcess.h"
+#include "Object.h"
+#include "Class.h"
+#include "ClassManager.h"
+#include "../Arc/Environment.h"
+#include "../File/IOInterface.h"
 #include <algorithm>
+#include <set>
 
 
 namespace shh {
@@ -43,6 +49,7 @@ namespace shh {
 	Scheduler::Array Scheduler::ourSchedulers;
 	double Scheduler::ourMinDelay(0.0001);
 	unsigned int Scheduler::ourMaxMessagesPerUpdate = 0;
+	bool Scheduler::ourIncrementalWrite = false;
 
 	Mutex::Lock Scheduler::ourLock;
 	Mutex* Scheduler::ourMutex = new Mutex;
@@ -119,7 +126,9 @@ namespace shh {
 		myExecutePrivileges(BasicPrivilege),
 		myStopWork(false),
 		myActiveWorkers(0),
-		myBusy(false)
+		myBusy(false),
+		myHibernateAfter(0.0),
+		myNextHibernateTime(0.0)
 	{
 		myRequiresUpdate = true;
 		myCurrentMessageQueue = &myActiveMessageQueue1;
@@ -264,6 +273,12 @@ namespace shh {
 			return false;
 		vm->SetScheduler(GCPtr<Scheduler>(this));
 		myVMs[vm->GetId()] = vm.GetObject();
+
+		// idle time for hibernation counts from joining, not time 0
+		if (vm->myMasterProcess.IsValid())
+			vm->myMasterProcess->myLastMessageTime = myCurrentUpdateTime;
+		for (VM::Processes::iterator it = vm->mySlaveProcesses.begin(); it != vm->mySlaveProcesses.end(); it++)
+			it->second->myLastMessageTime = myCurrentUpdateTime;
 		return true;
 	}
 
@@ -301,6 +316,28 @@ namespace shh {
 	}
 
 
+	// --------------------------------------------------------------------------						
+	// Function:	FindProcess
+	// Description:	finds a process of any vm managed by this scheduler
+	// Arguments:	messenger id of process
+	// Returns:		process or null
+	// --------------------------------------------------------------------------
+	GCPtr<Process> Scheduler::FindProcess(shhId id) const
+	{
+		for (VMs::const_iterator it = myVMs.begin(); it != myVMs.end(); it++)
+		{
+			const VM* vm = it->second;
+			if (vm->myMasterProcess.IsValid() && vm->myMasterProcess->GetId() == id)
+				return vm->myMasterProcess;
+
+			VM::Processes::const_iterator pit = vm->mySlaveProcesses.find(id);
+			if (pit != vm->mySlaveProcesses.end())
+				return pit->second;
+		}
+		return GCPtr<Process>();
+	}
+
+
 	// --------------------------------------------------------------------------						
 	// Function:	AddUpdater
 	// Description:	adds an updater to be updated in the update queue
@@ -326,6 +363,43 @@ namespace shh {
 	}
 
 
+	// --------------------------------------------------------------------------						
+	// Function:	AddBatchUpdater
+	// Description:	adds a named updater that updates many objects in one call
+	//				(e.g. all nodes of a class), only one per name is allowed
+	// Arguments:	name, updater
+	// Returns:		if added
+	// --------------------------------------------------------------------------
+	bool Scheduler::AddBatchUpdater(const std::string& name, const GCPtr<Module>& updater)
+	{
+		if (myBatchUpdaters.find(name) != myBatchUpdaters.end())
+			return false;
+
+		if (!AddUpdater(updater))
+			return false;
+
+		myBatchUpdaters[name] = updater;
+		return true;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	GetBatchUpdater
+	// Description:	gets a named batch updater
+	// Arguments:	name, updater returned
+	// Returns:		if found
+	// --------------------------------------------------------------------------
+	bool Scheduler::GetBatchUpdater(const std::string& name, GCPtr<Module>& updater) const
+	{
+		BatchUpdaters::const_iterator it = myBatchUpdaters.find(name);
+		if (it == myBatchUpdaters.end())
+			return false;
+
+		updater = it->second;
+		return true;
+	}
+
+
 	// --------------------------------------------------------------------------						
 	// Function:	RemoveUpdater
 	// Description:	removed an updater from being updated in the update queue
@@ -334,6 +408,14 @@ namespace shh {
 	// --------------------------------------------------------------------------
 	bool Scheduler::RemoveUpdater(const GCPtr<Module>& updater)
 	{
+		for (BatchUpdaters::iterator bit = myBatchUpdaters.begin(); bit != myBatchUpdaters.end(); bit++)
+		{
+			if (bit->second == updater)
+			{
+				myBatchUpdaters.erase(bit);
+				break;
+			}
+		}
 
 		if (myCurrentUpdater != myUpdaters.end() && myCurrentUpdater->second == updater)
 		{
@@ -466,6 +548,14 @@ namespace shh {
 		Unlock();
 
 		myCurrentUpdateTime = until;
+
+		// evict processes idle for too long to compact storage
+		if (myHibernateAfter > 0.0 && myCurrentUpdateTime >= myNextHibernateTime)
+		{
+			HibernateIdle();
+			myNextHibernateTime = myCurrentUpdateTime + myHibernateAfter;
+		}
+
 		myBusy = false;
 		return true;
 	}
@@ -516,6 +606,10 @@ namespace shh {
 						{
 							// ready for a freah update
 							// call the updaters hard update function
+							GCPtr<VM> vm;
+							vm.DynamicCast(updater->GetVM());
+							if (vm.IsValid())
+								vm->SetDirty();
 							if (updater->Update(myUpdateUntilTime, 0))
 								updater->FlagUpdateCompleted();
 
@@ -639,12 +733,13 @@ namespace shh {
 	{
 		ExecutionState state = ExecutionOk;
 		
-		GCPtr<Messenger> from = msg->myFrom;
+		GCPtr<Messenger> from = msg->myFrom.Lock();
 
 		if (msg->myTo.IsValid())
 		{
 			// call message
 			msg->myReceivedTime = myCurrentUpdateTime;
+			msg->myTo->myLastMessageTime = myCurrentUpdateTime;
 			Message::CallType ct = msg->GetCallType();
 			state = msg->Call(ct != Message::Decoupled && ct != Message::UpdateMsg && ct != Message::TimerMsg);
 		}
@@ -823,6 +918,77 @@ namespace shh {
 	}
 
 
+	// --------------------------------------------------------------------------						
+	// Function:	SetHibernation
+	// Description:	sets how long processes may go without a message before
+	//				they are hibernated and where their state is stored
+	// Arguments:	idle time before hibernating (0 = never), directory to 
+	//				store state in ("" = in memory)
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void Scheduler::SetHibernation(double after, const std::string& path)
+	{
+		myHibernateAfter = after;
+		myHibernatePath = path;
+		myNextHibernateTime = myCurrentUpdateTime + after;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	HibernateIdle
+	// Description:	hibernates processes of all vms that have not been sent a
+	//				message for the hibernation time, they are revived when
+	//				next used. Processes with timers set or messages queued
+	//				to them are not idle so are not hibernated
+	// Arguments:	none
+	// Returns:		number of processes hibernated
+	// --------------------------------------------------------------------------
+	unsigned int Scheduler::HibernateIdle()
+	{
+		std::set<shhId> waiting;
+		for (Timers::const_iterator it = myTimers.begin(); it != myTimers.end(); it++)
+			if (it->second->myTo.IsValid())
+				waiting.insert(it->second->myTo->GetId());
+
+		// pending queue can not be iterated so drain a copy
+		Lock();
+		PendingMessageQueue pending = myPendingMessageQueue;
+		while (!pending.empty())
+		{
+			if (pending.top().second->myTo.IsValid())
+				waiting.insert(pending.top().second->myTo->GetId());
+			pending.pop();
+		}
+		for (ActiveMessageQueue::const_iterator it = myCurrentMessageQueue->begin(); it != myCurrentMessageQueue->end(); it++)
+			if (it->second->myTo.IsValid())
+				waiting.insert(it->second->myTo->GetId());
+		for (ActiveMessageQueue::const_iterator it = myNextMessageQueue->begin(); it != myNextMessageQueue->end(); it++)
+			if (it->second->myTo.IsValid())
+				waiting.insert(it->second->myTo->GetId());
+		Unlock();
+
+		unsigned int hibernated = 0;
+		double idleBefore = myCurrentUpdateTime - myHibernateAfter;
+		for (VMs::iterator it = myVMs.begin(); it != myVMs.end(); it++)
+		{
+			VM* vm = it->second;
+			if (vm->Busy())
+				continue;
+
+			const GCPtr<Process>& master = vm->myMasterProcess;
+			if (master.IsValid() && master->GetLastMessageTime() <= idleBefore && waiting.find(master->GetId()) == waiting.end() && master->Hibernate(myHibernatePath))
+				hibernated++;
+
+			for (VM::Processes::iterator pit = vm->mySlaveProcesses.begin(); pit != vm->mySlaveProcesses.end(); pit++)
+			{
+				if (pit->second->GetLastMessageTime() <= idleBefore && waiting.find(pit->second->GetId()) == waiting.end() && pit->second->Hibernate(myHibernatePath))
+					hibernated++;
+			}
+		}
+		return hibernated;
+	}
+
+
 	// --------------------------------------------------------------------------						
 	// Function:	SetTimer
 	// Description:	sets a timer message
@@ -1067,4 +1233,415 @@ namespace shh {
 
 	}
 
+
+	// --------------------------------------------------------------------------						
+	// Function:	ClearDirty
+	// Description:	flags all vms as saved by a checkpoint
+	// Arguments:	none
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void Scheduler::ClearDirty()
+	{
+		for (VMs::iterator it = myVMs.begin(); it != myVMs.end(); it++)
+			it->second->SetDirty(false);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	GetSpawn
+	// Description:	gets what a vm was made from, the class of the object it
+	//				is if it is one such as an agent
+	// Arguments:	vm
+	// Returns:		spawn
+	// --------------------------------------------------------------------------
+	Scheduler::Spawn Scheduler::GetSpawn(const VM& vm)
+	{
+		Spawn spawn;
+		spawn.myId = vm.GetId();
+		spawn.myImplementation = 0;
+		spawn.myPrivileges = 0;
+
+		const Object* object = dynamic_cast<const Object*>(&vm);
+		if (object != NULL && object->GetClass().IsValid())
+		{
+			spawn.myTypeName = object->GetClass()->GetTypeName();
+			spawn.myClassName = object->GetClass()->GetName();
+		}
+		return spawn;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	GetSpawn
+	// Description:	gets what a process was made from, the class of its 
+	//				object if it has one else the base process for its 
+	//				implementation and privileges
+	// Arguments:	process, may be null
+	// Returns:		spawn, with id 0 if there is no process
+	// --------------------------------------------------------------------------
+	Scheduler::Spawn Scheduler::GetSpawn(const GCPtr<Process>& process)
+	{
+		Spawn spawn;
+		spawn.myId = 0;
+		spawn.myImplementation = 0;
+		spawn.myPrivileges = 0;
+		if (!process.IsValid())
+			return spawn;
+
+		spawn.myId = process->GetId();
+		spawn.myImplementation = (int)process->GetImplementation();
+		spawn.myPrivileges = (int)process->GetPrivileges();
+
+		const GCPtr<Object>& object = process->GetObject();
+		if (object.IsValid() && object->GetClass().IsValid())
+		{
+			spawn.myTypeName = object->GetClass()->GetTypeName();
+			spawn.myClassName = object->GetClass()->GetName();
+		}
+		return spawn;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	WriteSpawn
+	// Description:	serialization out of what a vm or process was made from
+	// Arguments:	io stream interface, spawn
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void Scheduler::WriteSpawn(IOInterface& io, const Spawn& spawn)
+	{
+		SERIALIZE_OUT(io, spawn.myId);
+		SERIALIZE_OUT(io, spawn.myImplementation);
+		SERIALIZE_OUT(io, spawn.myPrivileges);
+		SERIALIZE_OUT(io, spawn.myTypeName);
+		SERIALIZE_OUT(io, spawn.myClassName);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	ReadSpawn
+	// Description:	serialization in of what a vm or process was made from
+	// Arguments:	io stream interface, spawn
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void Scheduler::ReadSpawn(IOInterface& io, Spawn& spawn)
+	{
+		SERIALIZE_IN(io, spawn.myId);
+		SERIALIZE_IN(io, spawn.myImplementation);
+		SERIALIZE_IN(io, spawn.myPrivileges);
+		SERIALIZE_IN(io, spawn.myTypeName);
+		SERIALIZE_IN(io, spawn.myClassName);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Respawn
+	// Description:	makes a vm and its processes match those a checkpoint was
+	//				written with, a missing vm or process is recreated from
+	//				its class, or the base process of its implementation if 
+	//				it has none, and given its old id, processes created 
+	//				since the checkpoint are destroyed
+	// Arguments:	vm, master and slave processes written, environment whose
+	//				class managers recreate objects
+	// Returns:		vm
+	// --------------------------------------------------------------------------
+	GCPtr<VM> Scheduler::Respawn(const Spawn& vmSpawn, const Spawn& master, const Spawns& slaves, const GCPtr<Environment>& env)
+	{
+		GCPtr<VM> vm = GetVM(vmSpawn.myId);
+		bool created = !vm.IsValid();
+		if (created)
+		{
+			if (vmSpawn.myClassName.empty())
+			{
+				vm = GCPtr<VM>(new VM());
+			}
+			else
+			{
+				// objects such as agents are their own vm
+				GCPtr<Object> object = RespawnObject(vmSpawn, env);
+				vm.DynamicCast(object);
+				if (!vm.IsValid())
+				{
+					object.Destroy();
+					Exception::Throw("Checkpoint vm %lld of class %s could not be recreated", vmSpawn.myId, vmSpawn.myClassName.c_str());
+				}
+			}
+
+			vm->myId = vmSpawn.myId;
+			if (VM::ourLastId < vmSpawn.myId)
+				VM::ourLastId = vmSpawn.myId;
+			AddVM(vm);
+		}
+
+		if (master.myId == 0)
+		{
+			if (vm->myMasterProcess.IsValid())
+			{
+				GCPtr<Process> process = vm->myMasterProcess;
+				vm->RemoveProcess(process);
+				process.Destroy();
+			}
+		}
+		else if (!vm->myMasterProcess.IsValid())
+		{
+			if (!master.myClassName.empty() || !vm->CreateMasterProcess((Implementation)master.myImplementation, (Privileges)master.myPrivileges).IsValid())
+				Exception::Throw("Checkpoint master process %lld of vm %lld could not be recreated", master.myId, vmSpawn.myId);
+			RespawnId(vm->myMasterProcess, master.myId);
+		}
+		else if (created)
+		{
+			RespawnId(vm->myMasterProcess, master.myId);
+		}
+
+		std::set<shhId> ids;
+		for (unsigned int s = 0; s != slaves.size(); s++)
+		{
+			const Spawn& slave = slaves[s];
+			ids.insert(slave.myId);
+			if (vm->mySlaveProcesses.find(slave.myId) != vm->mySlaveProcesses.end())
+				continue;
+
+			GCPtr<Process> process;
+			if (slave.myClassName.empty())
+			{
+				process = vm->CreateSlaveProcess((Implementation)slave.myImplementation, (Privileges)slave.myPrivileges);
+			}
+			else
+			{
+				GCPtr<Object> object = RespawnObject(slave, env);
+				process = object->GetProcess();
+				if (!vm->AddSlaveProcess(process))
+				{
+					object.Destroy();
+					process.SetNull();
+				}
+			}
+			if (!process.IsValid())
+				Exception::Throw("Checkpoint process %lld of vm %lld could not be recreated", slave.myId, vmSpawn.myId);
+
+			vm->mySlaveProcesses.erase(process->GetId());
+			RespawnId(process, slave.myId);
+			vm->mySlaveProcesses[slave.myId] = process;
+		}
+
+		// processes created since the checkpoint
+		Processes extra;
+		for (VM::Processes::iterator it = vm->mySlaveProcesses.begin(); it != vm->mySlaveProcesses.end(); it++)
+			if (ids.find(it->first) == ids.end())
+				extra.push_back(it->second);
+		for (unsigned int e = 0; e != extra.size(); e++)
+		{
+			vm->RemoveProcess(extra[e]);
+			extra[e].Destroy();
+		}
+
+		return vm;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	RespawnObject
+	// Description:	recreates an object from its class for a restore, it is
+	//				initialized as though created by the environment
+	// Arguments:	spawn, environment whose class managers create objects
+	// Returns:		object
+	// --------------------------------------------------------------------------
+	GCPtr<Object> Scheduler::RespawnObject(const Spawn& spawn, const GCPtr<Environment>& env)
+	{
+		GCPtr<ClassManager> manager;
+		if (env.IsValid())
+			env->GetClassManager(spawn.myTypeName, manager);
+		if (!manager.IsValid() || !manager->GetClass(spawn.myClassName).IsValid())
+			Exception::Throw("Checkpoint %s class %s does not exist", spawn.myTypeName.c_str(), spawn.myClassName.c_str());
+
+		// objects initialize within the vm of the current process
+		GCPtr<Process> oldProcess = GetCurrentProcess();
+		if (env->GetVM().IsValid())
+			SetCurrentProcess(env->GetVM()->GetMasterProcess());
+
+		GCPtr<Object> object;
+		try
+		{
+			object = manager->CreateObject(spawn.myClassName, env);
+			if (object.IsValid())
+				object->Initialize(env->GetScheduler(), spawn.myClassName, StringKeyDictionary());
+		}
+		catch (...)
+		{
+			SetCurrentProcess(oldProcess);
+			throw;
+		}
+		SetCurrentProcess(oldProcess);
+
+		if (!object.IsValid())
+			Exception::Throw("Checkpoint %s %s could not be recreated", spawn.myTypeName.c_str(), spawn.myClassName.c_str());
+		return object;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	RespawnId
+	// Description:	gives a recreated process the id it was written with
+	// Arguments:	process, id
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void Scheduler::RespawnId(const GCPtr<Process>& process, shhId id)
+	{
+		process->myId = id;
+		if (Messenger::ourLastId < id)
+			Messenger::ourLastId = id;
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Write
+	// Description:	serialization out of vms and queued messages, messages 
+	//				mid execution are not written, what every vm and process
+	//				was made from is written but an incremental write only
+	//				holds the processes of vms dirtied since the last one
+	// Arguments:	io stream interface, version to log as
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void Scheduler::Write(IOInterface& io, int version) const
+	{
+		SERIALIZE_OUT(io, myCurrentUpdateTime);
+		SERIALIZE_OUT(io, myLastUpdateTime);
+
+		unsigned int vms = (unsigned int)myVMs.size();
+		SERIALIZE_OUT(io, vms);
+		for (VMs::const_iterator it = myVMs.begin(); it != myVMs.end(); it++)
+		{
+			const VM* vm = it->second;
+			WriteSpawn(io, GetSpawn(*vm));
+			WriteSpawn(io, GetSpawn(vm->myMasterProcess));
+			unsigned int slaves = (unsigned int)vm->mySlaveProcesses.size();
+			SERIALIZE_OUT(io, slaves);
+			for (VM::Processes::const_iterator pit = vm->mySlaveProcesses.begin(); pit != vm->mySlaveProcesses.end(); pit++)
+				WriteSpawn(io, GetSpawn(pit->second));
+
+			bool written = !ourIncrementalWrite || vm->IsDirty();
+			SERIALIZE_OUT(io, written);
+			if (written)
+				it->second->Write(io, version);
+		}
+
+		// pending queue can not be iterated so drain a copy
+		std::vector<Message*> messages;
+		const_cast<Scheduler*>(this)->Lock();
+		PendingMessageQueue pending = myPendingMessageQueue;
+		while (!pending.empty())
+		{
+			if (pending.top().second->IsPersistable())
+				messages.push_back(pending.top().second);
+			pending.pop();
+		}
+		for (ActiveMessageQueue::const_iterator it = myCurrentMessageQueue->begin(); it != myCurrentMessageQueue->end(); it++)
+			if (it->second->IsPersistable())
+				messages.push_back(it->second);
+		for (ActiveMessageQueue::const_iterator it = myNextMessageQueue->begin(); it != myNextMessageQueue->end(); it++)
+			if (it->second->IsPersistable())
+				messages.push_back(it->second);
+		const_cast<Scheduler*>(this)->Unlock();
+
+		unsigned int count = (unsigned int)messages.size();
+		SERIALIZE_OUT(io, count);
+		for (unsigned int m = 0; m != count; m++)
+		{
+			const Message* msg = messages[m];
+			shhId to = msg->myTo->GetId();
+			shhId from = msg->myFrom.IsValid() ? msg->myFrom->GetId() : 0;
+			SERIALIZE_OUT(io, to);
+			SERIALIZE_OUT(io, from);
+			msg->Write(io, version);
+		}
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Read
+	// Description:	serialization in, missing vms and processes are 
+	//				recreated with the ids they were written with and those 
+	//				created since are destroyed, all queued messages and 
+	//				timers are replaced
+	// Arguments:	io stream interface, version to log as, environment 
+	//				whose class managers recreate objects
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void Scheduler::Read(IOInterface& io, int version, const GCPtr<Environment>& env)
+	{
+		SERIALIZE_IN(io, myCurrentUpdateTime);
+		SERIALIZE_IN(io, myLastUpdateTime);
+
+		std::set<shhId> ids;
+		unsigned int vms;
+		SERIALIZE_IN(io, vms);
+		for (unsigned int v = 0; v != vms; v++)
+		{
+			Spawn vmSpawn;
+			Spawn master;
+			ReadSpawn(io, vmSpawn);
+			ReadSpawn(io, master);
+			unsigned int slaves;
+			SERIALIZE_IN(io, slaves);
+			Spawns slaveSpawns(slaves);
+			for (unsigned int s = 0; s != slaves; s++)
+				ReadSpawn(io, slaveSpawns[s]);
+			ids.insert(vmSpawn.myId);
+
+			GCPtr<VM> vm = Respawn(vmSpawn, master, slaveSpawns, env);
+			bool written;
+			SERIALIZE_IN(io, written);
+			if (written)
+				vm->Read(io, version);
+		}
+
+		// vms created since the checkpoint
+		std::vector< GCPtr<VM> > extra;
+		for (VMs::iterator it = myVMs.begin(); it != myVMs.end(); it++)
+			if (ids.find(it->first) == ids.end())
+				extra.push_back(GCPtr<VM>(it->second));
+		for (unsigned int e = 0; e != extra.size(); e++)
+		{
+			RemoveVM(extra[e]);
+			extra[e].Destroy();
+		}
+
+		Lock();
+		ClearAllMessages();
+		myTimers.clear();
+
+		unsigned int count;
+		SERIALIZE_IN(io, count);
+		for (unsigned int m = 0; m != count; m++)
+		{
+			shhId to, from;
+			SERIALIZE_IN(io, to);
+			SERIALIZE_IN(io, from);
+
+			Message* msg = new Message();
+			msg->Read(io, version);
+			msg->myTo = FindProcess(to);
+			if (from != 0)
+				msg->myFrom = FindProcess(from);
+
+			if (!msg->myTo.IsValid())
+			{
+				DEBUG_TRACE("\nCheckpoint message %s to missing process %lld dropped.\n", msg->myFunctionName.c_str(), to);
+				msg->DeleteArguments();
+				delete msg;
+				continue;
+			}
+
+			MessagePair mp;
+			mp.first.first = msg->myScheduledTime;
+			mp.first.second = msg->myPriority;
+			mp.second = msg;
+			myPendingMessageQueue.push(mp);
+			if (msg->GetCallType() == Message::TimerMsg)
+				myTimers[msg->GetId()] = msg;
+		}
+		Unlock();
+	}
+
+
 }
@@ -42,6 +42,9 @@
 namespace shh {
 
 	class Process;
+	class Object;
+	class Environment;
+	class IOInterface;
 
 	class Scheduler : public Module
 	{
@@ -58,6 +61,7 @@ namespace shh {
 
 		Privileges myExecutePrivileges;
 		static unsigned int ourMaxMessagesPerUpdate;
+		static bool ourIncrementalWrite;
 
 		static GCPtr<Scheduler> CreateScheduler(unsigned int numWorkers, double maxTimePerUpdate, Privileges privileges = BasicPrivilege);
 
@@ -71,10 +75,13 @@ namespace shh {
 		bool AddVM(const GCPtr<VM>& vm);
 		bool RemoveVM(const GCPtr<VM> &vm);
 		GCPtr<VM> GetVM(shhId id) const;
+		GCPtr<Process> FindProcess(shhId id) const;
 
 
 		bool AddUpdater(const GCPtr<Module>& updater);
 		bool RemoveUpdater(const GCPtr<Module>& updater);
+		bool AddBatchUpdater(const std::string& name, const GCPtr<Module>& updater);
+		bool GetBatchUpdater(const std::string& name, GCPtr<Module>& updater) const;
 		
 
 		virtual bool Busy() const;
@@ -100,11 +107,18 @@ namespace shh {
 
 
 
+		void SetHibernation(double after, const std::string& path);
+		unsigned int HibernateIdle();
+
 		bool SetTimer(Message* const msg);
 		bool StopTimer(shhId id, const GCPtr<Process> &requester);
 
 		void ClearAllMessages();
 
+		void ClearDirty();
+		void Write(IOInterface& io, int version) const;
+		void Read(IOInterface& io, int version, const GCPtr<Environment>& env);
+
 	protected:
 
 		Scheduler(unsigned int numWorkers, double maxTimePerUpdate, Privileges privileges);
@@ -113,6 +127,25 @@ namespace shh {
 		ExecutionState DispatchMessage(Message* msg);
 		bool RecieveMsg(Message* const msg, double recieveTime);
 		void ReceiveCallback(Message* const callback);
+
+		// what a vm or process was made from so a restore can recreate it
+		struct Spawn
+		{
+			shhId myId;
+			int myImplementation;
+			int myPrivileges;
+			std::string myTypeName;
+			std::string myClassName;
+		};
+		typedef std::vector<Spawn> Spawns;
+
+		static Spawn GetSpawn(const VM& vm);
+		static Spawn GetSpawn(const GCPtr<Process>& process);
+		static void WriteSpawn(IOInterface& io, const Spawn& spawn);
+		static void ReadSpawn(IOInterface& io, Spawn& spawn);
+		GCPtr<VM> Respawn(const Spawn& vmSpawn, const Spawn& master, const Spawns& slaves, const GCPtr<Environment>& env);
+		GCPtr<Object> RespawnObject(const Spawn& spawn, const GCPtr<Environment>& env);
+		static void RespawnId(const GCPtr<Process>& process, shhId id);
 		
 
 
@@ -174,6 +207,7 @@ namespace shh {
 		};
 
 		typedef std::multimap<UpdaterPair, GCPtr<Module>, UpdaterCompare> Updaters;
+		typedef std::map<std::string, GCPtr<Module>> BatchUpdaters;
 
 
 		typedef std::priority_queue<MessagePair, std::vector<MessagePair>, MessagePairCompare > PendingMessageQueue;
@@ -213,9 +247,14 @@ namespace shh {
 		ActiveMessageQueue *myNextMessageQueue;
 		Timers myTimers;
 
+		double myHibernateAfter;
+		std::string myHibernatePath;
+		double myNextHibernateTime;
+
 
 		Updaters myUpdaters;
 		Updaters::iterator myCurrentUpdater;
+		BatchUpdaters myBatchUpdaters;
 
 
 		typedef std::map<long, GCPtr<Process> > ProcessThreads;
@@ -44,6 +44,7 @@ namespace shh {
 	std::string SoftProcess::ourInitializeMessage = "shhInitialize";
 	std::string SoftProcess::ourFinalizeMessage = "shhFinalize";
 	std::string SoftProcess::ourUpdateMessage = "shhUpdate";
+	std::string SoftProcess::ourUpdateBatchMessage = "shhUpdateBatch";
 	std::string SoftProcess::ourMessagePrefix = "shhMessage";
 	std::string SoftProcess::ourTimerPrefix = "shhTimer";
 	std::string SoftProcess::ourSystemPrefix = "shhSystem";
@@ -83,6 +83,7 @@ namespace shh {
 		static std::string ourInitializeMessage;
 		static std::string ourFinalizeMessage;
 		static std::string ourUpdateMessage;
+		static std::string ourUpdateBatchMessage;
 		static std::string ourMessagePrefix;
 		static std::string ourTimerPrefix;
 		static std::string ourSystemPrefix;
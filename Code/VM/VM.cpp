@@ -33,6 +33,8 @@
 #include "Messenger.h"
 #include "Class.h"
 #include "SoftProcess.h"
+#include "../Common/Exception.h"
+#include "../File/IOInterface.h"
 
 
 
@@ -53,6 +55,7 @@ namespace shh {
 		myId(++ourLastId),
 		myScheduler(NULL),
 		myUnintializedCount(0),
+		myDirty(true),
 		myInitialized(true)
 	{
 		myProcessStack.resize(2);
@@ -70,6 +73,7 @@ namespace shh {
 	VM::VM(const GCPtr<VM>& other) :
 		myId(++ourLastId),
 		myUnintializedCount(0),
+		myDirty(true),
 		myInitialized(true)
 	{
 		if(other->myMasterProcess.IsValid())
@@ -145,6 +149,7 @@ namespace shh {
 			myMasterProcess = p->Clone();
 			myMasterProcess->SetVM(GCPtr<VM>(this));
 			myMasterProcess->myPrivileges = myMasterProcess->myPrivileges | privileges;
+			myDirty = true;
 			return myMasterProcess;
 		}
 
@@ -219,6 +224,7 @@ namespace shh {
 
 		slave->SetVM(GCPtr<VM>(this));
 		mySlaveProcesses[slave->myId] = slave;
+		myDirty = true;
 
 		return true;
 	}
@@ -259,6 +265,7 @@ namespace shh {
 				myScheduler->RemoveUpdater(updater);
 
 			myMasterProcess.SetNull();
+			myDirty = true;
 			return true;
 		}
 
@@ -272,6 +279,7 @@ namespace shh {
 			myScheduler->RemoveUpdater(updater);
 
 		mySlaveProcesses.erase(it);
+		myDirty = true;
 		return true;
 	}
 
@@ -400,7 +408,7 @@ namespace shh {
 			{
 				o->PostInitialization();
 				const GCPtr<Class>& cls = o->GetClass();
-				if (cls->HasFunction(SoftProcess::ourUpdateMessage) || cls->GetImplementation() == Engine)
+				if ((cls->HasFunction(SoftProcess::ourUpdateMessage) || cls->GetImplementation() == Engine) && !o->IsBatchUpdated())
 					myScheduler->AddUpdater(o);
 			}
 			for (Processes::iterator it = mySlaveProcesses.begin(); it != mySlaveProcesses.end(); it++)
@@ -412,7 +420,7 @@ namespace shh {
 				{
 					o->PostInitialization();
 					const GCPtr<Class>& cls = o->GetClass();
-					if (cls->HasFunction(SoftProcess::ourUpdateMessage) || cls->GetImplementation() == Engine)
+					if ((cls->HasFunction(SoftProcess::ourUpdateMessage) || cls->GetImplementation() == Engine) && !o->IsBatchUpdated())
 						myScheduler->AddUpdater(o);
 				}
 			}
@@ -446,5 +454,72 @@ namespace shh {
 	}
 
 
+	// --------------------------------------------------------------------------						
+	// Function:	TraceReferences
+	// Description:	reports scheduler and processes to the cycle collector
+	// Arguments:	tracer
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void VM::TraceReferences(GCTracer& tracer) const
+	{
+		tracer.Trace(myScheduler);
+		tracer.Trace(myMasterProcess);
+		tracer.TraceValues(mySlaveProcesses);
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Write
+	// Description:	serialization out of processes
+	// Arguments:	io stream interface, version to log as
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void VM::Write(IOInterface& io, int version) const
+	{
+		bool hasMaster = myMasterProcess.IsValid();
+		SERIALIZE_OUT(io, hasMaster);
+		if (hasMaster)
+			myMasterProcess->Write(io, version);
+
+		unsigned int slaves = (unsigned int)mySlaveProcesses.size();
+		SERIALIZE_OUT(io, slaves);
+		for (Processes::const_iterator it = mySlaveProcesses.begin(); it != mySlaveProcesses.end(); it++)
+		{
+			SERIALIZE_OUT(io, it->first);
+			it->second->Write(io, version);
+		}
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	Read
+	// Description:	serialization in, processes must already exist with the 
+	//				ids they were written with, the scheduler recreates any 
+	//				missing before reading a vm
+	// Arguments:	io stream interface, version to log as
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	void VM::Read(IOInterface& io, int version)
+	{
+		bool hasMaster;
+		SERIALIZE_IN(io, hasMaster);
+		if (hasMaster != myMasterProcess.IsValid())
+			Exception::Throw("Checkpoint master process of vm %lld does not match", myId);
+		if (hasMaster)
+			myMasterProcess->Read(io, version);
+
+		unsigned int slaves;
+		SERIALIZE_IN(io, slaves);
+		for (unsigned int s = 0; s != slaves; s++)
+		{
+			shhId id;
+			SERIALIZE_IN(io, id);
+			Processes::iterator it = mySlaveProcesses.find(id);
+			if (it == mySlaveProcesses.end())
+				Exception::Throw("Checkpoint process %lld of vm %lld does not exist", id, myId);
+			it->second->Read(io, version);
+		}
+		myDirty = false;
+	}
 
 } // namespace shh
@@ -41,6 +41,7 @@
 namespace shh {
 
 	class Module;
+	class IOInterface;
 	
 
 	class VM : public virtual GCObject
@@ -80,12 +81,18 @@ namespace shh {
 		virtual void FlagUninitialized(const GCPtr<Process>& p);
 		virtual void FlagInitialized(const GCPtr<Process>& p);
 		virtual bool Finalize(GCObject* me);
+		virtual void TraceReferences(GCTracer& tracer) const;
+
+		virtual void Write(IOInterface& io, int version) const;
+		virtual void Read(IOInterface& io, int version);
 
 		inline const GCPtr<Process>& GetMasterProcess() const;
 		inline const GCPtr<Process>& GetRootCallingProcess() const;
 		inline const GCPtr<Process>& GetCallingProcess() const;
 		inline bool IsInitialized() const;
 		inline shhId GetId() const;
+		inline bool IsDirty() const;
+		inline void SetDirty(bool dirty = true);
 
 	protected:
 
@@ -105,6 +112,7 @@ namespace shh {
 
 		shhId myId;
 		unsigned int myUnintializedCount;
+		bool myDirty;
 		static int ourStackSize;
 		static shhId ourLastId;
 		
@@ -173,6 +181,32 @@ namespace shh {
 	}
 
 
+	// --------------------------------------------------------------------------						
+	// Function:	IsDirty
+	// Description:	returns if any process of this vm may have changed since
+	//				the last checkpoint
+	// Arguments:	none
+	// Returns:		bool
+	// --------------------------------------------------------------------------
+	inline bool VM::IsDirty() const 
+	{ 
+		return myDirty; 
+	}
+
+
+	// --------------------------------------------------------------------------						
+	// Function:	SetDirty
+	// Description:	flags if processes of this vm need writing to the next
+	//				incremental checkpoint
+	// Arguments:	flag
+	// Returns:		none
+	// --------------------------------------------------------------------------
+	inline void VM::SetDirty(bool dirty) 
+	{ 
+		myDirty = dirty; 
+	}
+
+
 	// --------------------------------------------------------------------------						
 	// Function:	SetScheduler
 	// Description:	sets the scheduler managing this vm
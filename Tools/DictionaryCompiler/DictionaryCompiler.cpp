@@ -0,0 +1,55 @@
+///////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2025 David K Bhowmik. All rights reserved.
+// This file is part of shhArc.
+//
+// This Software is available under the MIT License with a No Modification clause.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this file and associated documentation files (the "Software"), to use the
+// Software for any purpose, including commercial applications, provided that:
+//
+//   1. You do NOT modify, alter, or create derivative works of this file.
+//   2. Redistributions must include this notice and may only distribute it 
+//      unmodified.
+//
+// The full MIT License text, including this Custom No Modification clause,
+// is available in the LICENSE file in the root of the project.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND.
+//
+// You may alternatively use this source under the terms of a specific 
+// version of the shhArc Unrestricted License provided you have obtained 
+// such a license from the copyright holder.
+///////////////////////////////////////////////////////////////////////////////
+// Compiles json .schema and .meta files into the memory mappable form read
+// by CompiledFile, writing each next to its source with the .bin extension.
+// Usage: DictionaryCompiler file [file ...]
+
+#include "../../Code/File/CompiledFile.h"
+#include <cstdio>
+
+int main(int argc, char* argv[])
+{
+	if (argc < 2)
+	{
+		printf("Usage: DictionaryCompiler file [file ...]\n");
+		return 1;
+	}
+
+	int failed = 0;
+	for (int i = 1; i < argc; i++)
+	{
+		std::string source = argv[i];
+		std::string compiled = shh::CompiledFile::GetCompiledPath(source);
+		if (shh::CompiledFile::Compile(source, compiled))
+		{
+			printf("%s -> %s\n", source.c_str(), compiled.c_str());
+		}
+		else
+		{
+			printf("Failed to compile %s\n", source.c_str());
+			failed++;
+		}
+	}
+	return failed == 0 ? 0 : 1;
+}